@@ -48,16 +48,6 @@ FetchContent_MakeAvailable(fetch_fastgltf)
 target_link_libraries(${Z0_TARGET} fastgltf)
 #target_link_libraries(${GLTF2ZRES} fastgltf)
 
-###### Using GLFW3 to create a window to transcode image with GPU for gltf2zres
-message(NOTICE "Fetching GLFW3 from https://github.com/glfw/glfw ...")
-FetchContent_Declare(
-        fetch_glfw
-        GIT_REPOSITORY https://github.com/glfw/glfw
-        GIT_TAG        3.4
-)
-FetchContent_MakeAvailable(fetch_glfw)
-target_link_libraries(${GLTF2ZRES} glfw)
-
 ###### Using meshoptimizer to optimize meshes
 message(NOTICE "Fetching meshoptimizer from https://github.com/zeux/meshoptimizer ...")
 FetchContent_Declare(
@@ -68,6 +58,33 @@ FetchContent_Declare(
 FetchContent_MakeAvailable(fetch_meshopt)
 target_link_libraries(${Z0_TARGET} meshoptimizer)
 
+###### Using Zstandard & LZ4 for the ZRes chunks compression
+message(NOTICE "Fetching Zstandard from https://github.com/facebook/zstd ...")
+set(ZSTD_BUILD_PROGRAMS OFF CACHE BOOL "" FORCE)
+set(ZSTD_BUILD_SHARED OFF CACHE BOOL "" FORCE)
+set(ZSTD_BUILD_TESTS OFF CACHE BOOL "" FORCE)
+FetchContent_Declare(
+        fetch_zstd
+        GIT_REPOSITORY https://github.com/facebook/zstd
+        GIT_TAG        v1.5.6
+        SOURCE_SUBDIR  build/cmake
+)
+FetchContent_MakeAvailable(fetch_zstd)
+target_link_libraries(${Z0_TARGET} libzstd_static)
+target_include_directories(${Z0_TARGET} PUBLIC ${fetch_zstd_SOURCE_DIR}/lib)
+
+message(NOTICE "Fetching LZ4 from https://github.com/lz4/lz4 ...")
+FetchContent_Declare(
+        fetch_lz4
+        GIT_REPOSITORY https://github.com/lz4/lz4
+        GIT_TAG        v1.10.0
+)
+FetchContent_MakeAvailable(fetch_lz4)
+# only the two library sources are needed
+add_library(lz4 STATIC ${fetch_lz4_SOURCE_DIR}/lib/lz4.c ${fetch_lz4_SOURCE_DIR}/lib/lz4hc.c)
+target_include_directories(lz4 PUBLIC ${fetch_lz4_SOURCE_DIR}/lib)
+target_link_libraries(${Z0_TARGET} lz4)
+
 
 ###### Using KTX to transcode KTX2 to compressed images
 #message(NOTICE "Fetching LibKTX from https://github.com/KhronosGroup/KTX-Software ...")
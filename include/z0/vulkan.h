@@ -20,6 +20,7 @@ extern PFN_vkEnumerateInstanceLayerProperties vkEnumerateInstanceLayerProperties
 extern PFN_vkEnumeratePhysicalDevices vkEnumeratePhysicalDevices;
 extern PFN_vkGetInstanceProcAddr vkGetInstanceProcAddr;
 extern PFN_vkGetPhysicalDeviceFeatures vkGetPhysicalDeviceFeatures;
+extern PFN_vkGetPhysicalDeviceFeatures2 vkGetPhysicalDeviceFeatures2;
 extern PFN_vkGetPhysicalDeviceFormatProperties vkGetPhysicalDeviceFormatProperties;
 extern PFN_vkGetPhysicalDeviceMemoryProperties vkGetPhysicalDeviceMemoryProperties;
 extern PFN_vkGetPhysicalDeviceMemoryProperties2 vkGetPhysicalDeviceMemoryProperties2;
@@ -66,6 +67,7 @@ extern PFN_vkCmdSetRasterizerDiscardEnable vkCmdSetRasterizerDiscardEnable;
 extern PFN_vkCmdSetScissorWithCount vkCmdSetScissorWithCount;
 extern PFN_vkCmdSetViewportWithCount vkCmdSetViewportWithCount;
 extern PFN_vkCreateComputePipelines vkCreateComputePipelines;
+extern PFN_vkCreatePipelineCache vkCreatePipelineCache;
 extern PFN_vkCreateBuffer vkCreateBuffer;
 extern PFN_vkCreateCommandPool vkCreateCommandPool;
 extern PFN_vkCreateDescriptorPool vkCreateDescriptorPool;
@@ -86,6 +88,7 @@ extern PFN_vkDestroyFence vkDestroyFence;
 extern PFN_vkDestroyImage vkDestroyImage;
 extern PFN_vkDestroyImageView vkDestroyImageView;
 extern PFN_vkDestroyPipeline vkDestroyPipeline;
+extern PFN_vkDestroyPipelineCache vkDestroyPipelineCache;
 extern PFN_vkDestroyPipelineLayout vkDestroyPipelineLayout;
 extern PFN_vkDestroySampler vkDestroySampler;
 extern PFN_vkDestroySemaphore vkDestroySemaphore;
@@ -102,6 +105,7 @@ extern PFN_vkGetDeviceBufferMemoryRequirements vkGetDeviceBufferMemoryRequiremen
 extern PFN_vkGetDeviceImageMemoryRequirements vkGetDeviceImageMemoryRequirements;
 extern PFN_vkGetDeviceQueue vkGetDeviceQueue;
 extern PFN_vkGetImageMemoryRequirements vkGetImageMemoryRequirements;
+extern PFN_vkGetPipelineCacheData vkGetPipelineCacheData;
 extern PFN_vkGetImageMemoryRequirements2 vkGetImageMemoryRequirements2;
 extern PFN_vkCmdPushConstants vkCmdPushConstants;
 extern PFN_vkQueueSubmit vkQueueSubmit;
@@ -144,6 +148,7 @@ extern PFN_vkQueuePresentKHR vkQueuePresentKHR;
 extern PFN_vkCmdBindShadersEXT vkCmdBindShadersEXT;
 extern PFN_vkCreateShadersEXT vkCreateShadersEXT;
 extern PFN_vkDestroyShaderEXT vkDestroyShaderEXT;
+extern PFN_vkGetShaderBinaryDataEXT vkGetShaderBinaryDataEXT;
 
 /*
  * VK_EXT_extended_dynamic_state3 device extension
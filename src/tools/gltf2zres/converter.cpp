@@ -4,373 +4,638 @@
  * This software is released under the MIT License.
  * https://opensource.org/licenses/MIT
 */
-// Derived from
-// https://github.com/GPUOpen-Tools/compressonator/blob/master/applications/_plugins/cmp_gpu/gpuhw/compute_gpuhw.cpp
-//=============================================================================
-// Copyright (c) 2020-2024    Advanced Micro Devices, Inc. All rights reserved.
-//
-// Permission is hereby granted, free of charge, to any person obtaining a copy
-// of this software and associated documentation files(the "Software"), to deal
-// in the Software without restriction, including without limitation the rights
-// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
-// copies of the Software, and to permit persons to whom the Software is
-// furnished to do so, subject to the following conditions :
-//
-// The above copyright notice and this permission notice shall be included in
-// all copies or substantial portions of the Software.
-//
-// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
-// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
-// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
-// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
-// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
-// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
-// THE SOFTWARE.
-//
-//==============================================================================
+// BCn blocks layouts : https://registry.khronos.org/DataFormat/specs/1.3/dataformat.1.3.html#S3TC
 module;
-#include "glad/glad.h"
-#include <GLFW/glfw3.h>
 #include "z0/libraries.h"
 
 module converter;
 
-const string WIN_SHADER_VERT =
-R"(#version 330 core
-layout(location = 0) in vec2 position;
+import miplevel;
 
-out vec2 v_texCoords;
+// RGBA pixels of a 4x4 block, in rows order
+using Block = array<array<uint8_t, 4>, 16>;
 
-void main() {
-    v_texCoords = (position + 1.0) * 0.5;
-    gl_Position = vec4(position, 1.0, 1.0);
-}
-)";
-
-const string SHADER_FRAG =
-R"(#version 330 core
-in vec2 v_texCoords;
+// Endpoint color, only the first channels are used for the RGB formats
+using Color = array<float, 4>;
 
-out vec4 fragmentColor;
+// Writes bit fields in a zero-filled block, least significant bit first
+class BitWriter {
+public:
+    explicit BitWriter(uint8_t* data): data{data} {}
 
-uniform sampler2D tex;
+    void write(const uint32_t value, const uint32_t bits) {
+        for (auto bit = 0u; bit < bits; bit++) {
+            data[position >> 3] |= static_cast<uint8_t>(((value >> bit) & 1) << (position & 7));
+            position += 1;
+        }
+    }
 
-void main() {
-    fragmentColor = texture(tex, v_texCoords);
+private:
+    uint8_t* data;
+    uint32_t position{0};
+};
+
+// Number of least-squares refinements of the endpoints
+uint32_t refinements(const Quality quality) {
+    switch (quality) {
+    case Quality::FAST:
+        return 0;
+    case Quality::NORMAL:
+        return 2;
+    default:
+        return 8;
+    }
 }
-)";
-
-constexpr float FULL_SCREEN_QUAD[] = {-1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f};
-
-// void APIENTRY OpenGLDebugMessageCallback(GLenum source, GLenum type, GLuint id,
-//                                          GLenum severity, GLsizei length,
-//                                          const GLchar* message,
-//                                          const void* userParam) {
-//     std::cerr << "OpenGL Debug Message:\n";
-//     std::cerr << "Source: " << source << "\n";
-//     std::cerr << "Type: " << type << "\n";
-//     std::cerr << "ID: " << id << "\n";
-//     std::cerr << "Severity: " << severity << "\n";
-//     std::cerr << "Message: " << message << "\n";
-//     std::cerr << "------------------------\n";
-// }
-
-Converter::Converter() {
-    {
-        // Initialize the GLFW window & OpenGL context
-        // Protected by a mutex to avoid errors with GLFW & GLAD
-        // (there is a lot of static variables in GLAD which makes it non thread-safe)
-        lock_guard lock(initMutex);
-        if (!glfwInit()) {
-            throw "Failed to initialize GLFW3";
+
+// Fits the endpoints of the line going through the selected pixels :
+// the extremes of the principal axis, or of the bounding box with the FAST quality
+void fitEndpoints(const Block&             block,
+                  const uint32_t           channels,
+                  const array<bool, 16>&   selected,
+                  const Quality            quality,
+                  Color&                   first,
+                  Color&                   second) {
+    auto count = 0u;
+    Color mean{};
+    Color minColor{255.0f, 255.0f, 255.0f, 255.0f};
+    Color maxColor{};
+    for (auto i = 0; i < 16; i++) {
+        if (!selected[i]) { continue; }
+        count += 1;
+        for (auto c = 0; c < channels; c++) {
+            const auto value = static_cast<float>(block[i][c]);
+            mean[c] += value;
+            minColor[c] = std::min(minColor[c], value);
+            maxColor[c] = std::max(maxColor[c], value);
         }
-        glfwWindowHint(GLFW_CLIENT_API, GLFW_OPENGL_API);
-        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
-        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GLFW_TRUE);
-        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
-        gltfWindow = glfwCreateWindow(512, 512, "Texture Compression", nullptr, nullptr);
-        if (!gltfWindow) {
-            glfwTerminate();
-            throw "Failed to create GLFW3 window";
+    }
+    first = {};
+    second = {};
+    if (count == 0) { return; }
+    for (auto c = 0; c < channels; c++) {
+        mean[c] /= static_cast<float>(count);
+    }
+
+    if (quality == Quality::FAST) {
+        // The bounding box is inset to reduce the error of the extreme colors
+        for (auto c = 0; c < channels; c++) {
+            const auto inset = (maxColor[c] - minColor[c]) / 16.0f;
+            first[c] = maxColor[c] - inset;
+            second[c] = minColor[c] + inset;
         }
-        glfwMakeContextCurrent(gltfWindow);
-        glfwSwapInterval(1);
-        gladLoadGLLoader(reinterpret_cast<GLADloadproc>(glfwGetProcAddress));
-    }
-
-    glEnable(GL_TEXTURE_2D);
-    glEnable(GL_RENDERBUFFER);
-    glEnable(GL_FRAMEBUFFER);
-    // glEnable(GL_DEBUG_OUTPUT);
-    // glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
-    // glDebugMessageCallback(OpenGLDebugMessageCallback, nullptr);
-
-    try {
-        // Initialize window shaders & buffers
-        const auto vertexSrc = WIN_SHADER_VERT.c_str();
-        w_vertex             = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(w_vertex, 1, &vertexSrc, nullptr);
-        glCompileShader(w_vertex);
-        checkShaderStatus(w_vertex);
-
-        const auto fragmentSrc = SHADER_FRAG.c_str();
-        w_fragment             = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(w_fragment, 1, &fragmentSrc, nullptr);
-        glCompileShader(w_fragment);
-        checkShaderStatus(w_fragment);
-
-        w_program = glCreateProgram();
-        glAttachShader(w_program, w_vertex);
-        glAttachShader(w_program, w_fragment);
-        glLinkProgram(w_program);
-        checkProgramStatus();
-
-        glGenVertexArrays(1, &w_vao_ref);
-        glGenVertexArrays(1, &w_vbo_ref);
-        glBindVertexArray(w_vao_ref);
-        glBindBuffer(GL_ARRAY_BUFFER, w_vbo_ref);
-        glBufferData(GL_ARRAY_BUFFER,
-                     sizeof(FULL_SCREEN_QUAD),
-                     reinterpret_cast<const uint8_t *>(FULL_SCREEN_QUAD),
-                     GL_STATIC_DRAW);
-
-        glEnableVertexAttribArray(0);
-
-        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), nullptr);
-
-        // Initialize conversion shaders & buffers
-        m_vertex = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(m_vertex, 1, &vertexSrc, nullptr);
-        glCompileShader(m_vertex);
-        checkShaderStatus(m_vertex);
-
-        m_fragment = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(m_fragment, 1, &fragmentSrc, nullptr);
-        glCompileShader(m_fragment);
-        checkShaderStatus(m_fragment);
-
-        m_program = glCreateProgram();
-        glAttachShader(m_program, m_vertex);
-        glAttachShader(m_program, m_fragment);
-        glLinkProgram(m_program);
-        checkProgramStatus();
-
-        glGenVertexArrays(1, &m_vao_ref);
-        glGenBuffers(1, &m_vbo_ref);
-    } catch (...) {
-        throw "Failed to create OpenGL shaders";
+        return;
     }
-}
 
-bool Converter::convert(const MipLevel& inMipLevel,
-                        MipLevel& outMipLevel,
-                        const uint32_t srcChannels,
-                        const string& dstFormat) const {
-    if (!formats.contains(dstFormat)) {
-        cerr << "Unsupported format " << dstFormat << endl;
-        return false;
+    array<Color, 4> covariance{};
+    for (auto i = 0; i < 16; i++) {
+        if (!selected[i]) { continue; }
+        for (auto a = 0; a < channels; a++) {
+            for (auto b = 0; b < channels; b++) {
+                covariance[a][b] += (block[i][a] - mean[a]) * (block[i][b] - mean[b]);
+            }
+        }
     }
-    if (srcChannels != 3 && srcChannels != 4) {
-        cerr << "Image must be RGB or RGBA\n";
-        return false;
+    // Principal axis by power iterations, starting from the bounding box diagonal
+    Color axis{};
+    for (auto c = 0; c < channels; c++) {
+        axis[c] = maxColor[c] - minColor[c];
     }
-    const auto srcWidth = inMipLevel.width;
-    const auto srcHeight = inMipLevel.height;
-    const auto srcData = inMipLevel.data.get();
-
-    glUniform1i(glGetUniformLocation(m_program, "tex"),0);
-    glBindVertexArray(m_vao_ref);
-    glBindBuffer(GL_ARRAY_BUFFER, m_vbo_ref);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(FULL_SCREEN_QUAD), reinterpret_cast<const uint8_t*>(FULL_SCREEN_QUAD), GL_STATIC_DRAW);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), nullptr);
-
-    int width, height;
-    glfwGetFramebufferSize(gltfWindow, &width, &height);
-
-    // Create the destination texture
-    GLuint destination;
-    glGenTextures(1, &destination);
-    glBindTexture(GL_TEXTURE_2D, destination);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
-
-    // Create texture from the source image
-    GLuint source;
-    glGenTextures(1, &source);
-    glBindTexture(GL_TEXTURE_2D, source);
-    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
-    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
-
-    if (srcChannels == 4) {
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, srcWidth, srcHeight, 0,
-            GL_RGBA, GL_UNSIGNED_BYTE, srcData->data());
-    } else {
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, srcWidth, srcHeight, 0,
-            GL_RGB, GL_UNSIGNED_BYTE, srcData->data());
+    for (auto iteration = 0; iteration < 8; iteration++) {
+        Color next{};
+        auto length = 0.0f;
+        for (auto a = 0; a < channels; a++) {
+            for (auto b = 0; b < channels; b++) {
+                next[a] += covariance[a][b] * axis[b];
+            }
+            length = std::max(length, std::abs(next[a]));
+        }
+        if (length < 1e-6f) { break; }
+        for (auto c = 0; c < channels; c++) {
+            axis[c] = next[c] / length;
+        }
     }
+    auto length = 0.0f;
+    for (auto c = 0; c < channels; c++) {
+        length += axis[c] * axis[c];
+    }
+    if (length < 1e-12f) {
+        // Single color block
+        first = mean;
+        second = mean;
+        return;
+    }
+    length = std::sqrt(length);
+    auto minT = numeric_limits<float>::max();
+    auto maxT = numeric_limits<float>::lowest();
+    for (auto i = 0; i < 16; i++) {
+        if (!selected[i]) { continue; }
+        auto t = 0.0f;
+        for (auto c = 0; c < channels; c++) {
+            t += (block[i][c] - mean[c]) * axis[c] / length;
+        }
+        minT = std::min(minT, t);
+        maxT = std::max(maxT, t);
+    }
+    for (auto c = 0; c < channels; c++) {
+        first[c] = std::clamp(mean[c] + axis[c] / length * maxT, 0.0f, 255.0f);
+        second[c] = std::clamp(mean[c] + axis[c] / length * minT, 0.0f, 255.0f);
+    }
+}
 
-    // Create framebuffer with renderbuffer
-    GLuint fbo, fboColor, fboDepth;
-
-    glGenRenderbuffers(1, &fboDepth);
-    glBindRenderbuffer(GL_RENDERBUFFER, fboDepth);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, srcWidth, srcHeight);
-
-    glGenTextures(1, &fboColor);
-    glBindTexture(GL_TEXTURE_2D, fboColor);
+// Least-squares endpoints for the given indices.
+// weights : weight of the first endpoint for each index, indices >= count are ignored
+bool solveEndpoints(const Block&             block,
+                    const uint32_t           channels,
+                    const array<uint8_t, 16>& indices,
+                    const float*             weights,
+                    const uint32_t           count,
+                    Color&                   first,
+                    Color&                   second) {
+    auto aa = 0.0f;
+    auto ab = 0.0f;
+    auto bb = 0.0f;
+    Color ax{};
+    Color bx{};
+    for (auto i = 0; i < 16; i++) {
+        if (indices[i] >= count) { continue; }
+        const auto a = weights[indices[i]];
+        const auto b = 1.0f - a;
+        aa += a * a;
+        ab += a * b;
+        bb += b * b;
+        for (auto c = 0; c < channels; c++) {
+            ax[c] += a * block[i][c];
+            bx[c] += b * block[i][c];
+        }
+    }
+    const auto determinant = aa * bb - ab * ab;
+    if (std::abs(determinant) < 1e-6f) { return false; }
+    for (auto c = 0; c < channels; c++) {
+        first[c] = std::clamp((bb * ax[c] - ab * bx[c]) / determinant, 0.0f, 255.0f);
+        second[c] = std::clamp((aa * bx[c] - ab * ax[c]) / determinant, 0.0f, 255.0f);
+    }
+    return true;
+}
 
-    glGenFramebuffers(1, &fbo);
-    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDER, fboDepth);
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// BC1 color blocks, also used by BC2 & BC3
 
-    glBindTexture(GL_TEXTURE_2D, fboColor);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, srcWidth, srcHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+uint16_t packRGB565(const Color& color) {
+    const auto r = std::clamp(std::lround(color[0] * 31.0f / 255.0f), 0l, 31l);
+    const auto g = std::clamp(std::lround(color[1] * 63.0f / 255.0f), 0l, 63l);
+    const auto b = std::clamp(std::lround(color[2] * 31.0f / 255.0f), 0l, 31l);
+    return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
 
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, fboColor, 0);
+Color unpackRGB565(const uint16_t color) {
+    const auto r = (color >> 11) & 0x1f;
+    const auto g = (color >> 5) & 0x3f;
+    const auto b = color & 0x1f;
+    return {
+        static_cast<float>((r << 3) | (r >> 2)),
+        static_cast<float>((g << 2) | (g >> 4)),
+        static_cast<float>((b << 3) | (b >> 2)),
+        255.0f};
+}
 
-    glViewport(0, 0, srcWidth, srcHeight);
-    glBindVertexArray(m_vao_ref);
-    glBindTexture(GL_TEXTURE_2D, source);
-    glUseProgram(w_program);
-    glDrawArrays(GL_TRIANGLES, 0, 2 * 3);
+struct ColorFit {
+    array<uint16_t, 2> endpoints;
+    // 0 : first endpoint, 1 : second endpoint, then the interpolated colors from the first to the second endpoint
+    // and the transparent black in the three colors mode
+    array<uint8_t, 16> indices;
+    float              error;
+};
+
+ColorFit evaluateColors(const Block&           block,
+                        const array<bool, 16>& opaque,
+                        const uint16_t         first,
+                        const uint16_t         second,
+                        const bool             threeColors) {
+    array<Color, 4> palette{unpackRGB565(first), unpackRGB565(second)};
+    for (auto c = 0; c < 3; c++) {
+        if (threeColors) {
+            palette[2][c] = (palette[0][c] + palette[1][c]) / 2.0f;
+        } else {
+            palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+            palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+        }
+    }
+    const auto count = threeColors ? 3 : 4;
+    auto fit = ColorFit{{first, second}, {}, 0.0f};
+    for (auto i = 0; i < 16; i++) {
+        if (!opaque[i]) {
+            fit.indices[i] = 3;
+            continue;
+        }
+        auto bestError = numeric_limits<float>::max();
+        for (auto index = 0; index < count; index++) {
+            auto error = 0.0f;
+            for (auto c = 0; c < 3; c++) {
+                const auto delta = block[i][c] - palette[index][c];
+                error += delta * delta;
+            }
+            if (error < bestError) {
+                bestError = error;
+                fit.indices[i] = static_cast<uint8_t>(index);
+            }
+        }
+        fit.error += bestError;
+    }
+    return fit;
+}
 
-    outMipLevel.width = srcWidth;
-    outMipLevel.height = srcHeight;
-    outMipLevel.data = make_shared<vector<uint8_t>>(static_cast<vector<uint8_t>::size_type>(srcWidth * srcHeight * srcChannels));
+ColorFit fitColors(const Block& block, const array<bool, 16>& opaque, const bool threeColors, const Quality quality) {
+    static constexpr float weights4[]{1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+    static constexpr float weights3[]{1.0f, 0.0f, 0.5f};
+    Color first;
+    Color second;
+    fitEndpoints(block, 3, opaque, quality, first, second);
+    auto best = evaluateColors(block, opaque, packRGB565(first), packRGB565(second), threeColors);
+    for (auto iteration = 0; iteration < refinements(quality); iteration++) {
+        if (!solveEndpoints(block, 3, best.indices, threeColors ? weights3 : weights4, threeColors ? 3 : 4, first, second)) {
+            break;
+        }
+        const auto fit = evaluateColors(block, opaque, packRGB565(first), packRGB565(second), threeColors);
+        if (fit.error >= best.error) { break; }
+        best = fit;
+    }
+    return best;
+}
 
-    // Set the mipmap levels for the fbo color texture
-    glBindTexture(GL_TEXTURE_2D, fboColor);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+void writeColorBlock(const ColorFit& fit, const bool threeColors, uint8_t* dst) {
+    auto first = fit.endpoints[0];
+    auto second = fit.endpoints[1];
+    auto indices = fit.indices;
+    if (threeColors) {
+        // The three colors mode is selected with first <= second
+        if (first > second) {
+            swap(first, second);
+            for (auto& index : indices) {
+                if (index < 2) { index ^= 1; }
+            }
+        }
+    } else if (first < second) {
+        // The four colors mode is selected with first > second
+        swap(first, second);
+        for (auto& index : indices) {
+            index ^= 1;
+        }
+    } else if (first == second) {
+        indices.fill(0);
+    }
+    dst[0] = static_cast<uint8_t>(first & 0xff);
+    dst[1] = static_cast<uint8_t>(first >> 8);
+    dst[2] = static_cast<uint8_t>(second & 0xff);
+    dst[3] = static_cast<uint8_t>(second >> 8);
+    auto bits = BitWriter{dst + 4};
+    for (const auto index : indices) {
+        bits.write(index, 2);
+    }
+}
 
-    // Get the compressed image
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, fboColor, 0);
-    glBindTexture(GL_TEXTURE_2D, destination);
-    glCopyTexImage2D(GL_TEXTURE_2D, 0, formats.at(dstFormat), 0, 0, srcWidth, srcHeight, 0);
-    GLint compressedSize = 0;
-    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &compressedSize);
-    glGetCompressedTexImage(GL_TEXTURE_2D, 0, outMipLevel.data->data());
+// BC1 block, the pixels with an alpha < 128 are encoded as transparent black
+void encodeBC1(const Block& block, const Quality quality, uint8_t* dst) {
+    array<bool, 16> opaque;
+    auto transparent{false};
+    for (auto i = 0; i < 16; i++) {
+        opaque[i] = block[i][3] >= 128;
+        transparent |= !opaque[i];
+    }
+    auto fit = fitColors(block, opaque, transparent, quality);
+    auto threeColors = transparent;
+    if (!transparent && (quality == Quality::HIGH)) {
+        const auto fitThreeColors = fitColors(block, opaque, true, quality);
+        if (fitThreeColors.error < fit.error) {
+            fit = fitThreeColors;
+            threeColors = true;
+        }
+    }
+    writeColorBlock(fit, threeColors, dst);
+}
 
-    // Cleanup
-    glDeleteTextures(1, &source);
-    glDeleteTextures(1, &fboColor);
-    glDeleteRenderbuffers(1, &fboDepth);
-    glDeleteFramebuffers(1, &fbo);
+// Color part of the BC2 & BC3 blocks, always in the four colors mode
+void encodeColors(const Block& block, const Quality quality, uint8_t* dst) {
+    array<bool, 16> all;
+    all.fill(true);
+    writeColorBlock(fitColors(block, all, false, quality), false, dst);
+}
 
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// BC4 single channel blocks, also used by BC3 alpha & BC5
+
+struct ChannelFit {
+    array<int32_t, 2>  endpoints;
+    array<uint8_t, 16> indices;
+    float              error;
+};
+
+ChannelFit evaluateChannel(const array<int32_t, 16>& values,
+                           const int32_t             first,
+                           const int32_t             second,
+                           const int32_t             minValue,
+                           const int32_t             maxValue) {
+    array<float, 8> palette{static_cast<float>(first), static_cast<float>(second)};
+    if (first > second) {
+        for (auto i = 1; i < 7; i++) {
+            palette[i + 1] = static_cast<float>((7 - i) * first + i * second) / 7.0f;
+        }
+    } else {
+        for (auto i = 1; i < 5; i++) {
+            palette[i + 1] = static_cast<float>((5 - i) * first + i * second) / 5.0f;
+        }
+        palette[6] = static_cast<float>(minValue);
+        palette[7] = static_cast<float>(maxValue);
+    }
+    auto fit = ChannelFit{{first, second}, {}, 0.0f};
+    for (auto i = 0; i < 16; i++) {
+        auto bestError = numeric_limits<float>::max();
+        for (auto index = 0; index < 8; index++) {
+            const auto delta = static_cast<float>(values[i]) - palette[index];
+            if (delta * delta < bestError) {
+                bestError = delta * delta;
+                fit.indices[i] = static_cast<uint8_t>(index);
+            }
+        }
+        fit.error += bestError;
+    }
+    return fit;
+}
 
-    glViewport(0, 0, width, height);
-    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT);
+// Values of one channel of a block, in the [-127, 127] range for the signed formats
+array<int32_t, 16> channelValues(const Block& block, const uint32_t channel, const bool isSigned) {
+    array<int32_t, 16> values;
+    for (auto i = 0; i < 16; i++) {
+        values[i] = isSigned ? std::max(block[i][channel] - 128, -127) : block[i][channel];
+    }
+    return values;
+}
 
-    glBindBuffer(GL_ARRAY_BUFFER, w_vao_ref);
+void encodeChannel(const array<int32_t, 16>& values, const bool isSigned, const Quality quality, uint8_t* dst) {
+    const auto minValue = isSigned ? -127 : 0;
+    const auto maxValue = isSigned ? 127 : 255;
+    const auto [low, high] = ranges::minmax(values);
+    // Eight values mode with first > second, or a single value block
+    auto best = evaluateChannel(values, high, low, minValue, maxValue);
+    if ((quality != Quality::FAST) && (high > low)) {
+        // Six values mode, the extremes values are stored as explicit indices
+        auto low6 = maxValue;
+        auto high6 = minValue;
+        for (const auto value : values) {
+            if ((value != minValue) && (value != maxValue)) {
+                low6 = std::min(low6, value);
+                high6 = std::max(high6, value);
+            }
+        }
+        if (low6 <= high6) {
+            const auto fit = evaluateChannel(values, low6, high6, minValue, maxValue);
+            if (fit.error < best.error) { best = fit; }
+        }
+    }
+    if ((quality == Quality::HIGH) && (high > low)) {
+        // Inset endpoints search
+        for (auto insetHigh = 0; insetHigh < 4; insetHigh++) {
+            for (auto insetLow = 0; insetLow < 4; insetLow++) {
+                const auto first = high - insetHigh;
+                const auto second = low + insetLow;
+                if (first <= second) { continue; }
+                const auto fit = evaluateChannel(values, first, second, minValue, maxValue);
+                if (fit.error < best.error) { best = fit; }
+            }
+        }
+    }
+    dst[0] = static_cast<uint8_t>(best.endpoints[0]);
+    dst[1] = static_cast<uint8_t>(best.endpoints[1]);
+    auto bits = BitWriter{dst + 2};
+    for (const auto index : best.indices) {
+        bits.write(index, 3);
+    }
+}
 
-    // Bind the results
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, destination);
+// Explicit 4 bits alpha of the BC2 blocks
+void encodeExplicitAlpha(const Block& block, uint8_t* dst) {
+    auto bits = BitWriter{dst};
+    for (const auto& pixel : block) {
+        bits.write((pixel[3] * 15 + 127) / 255, 4);
+    }
+}
 
-    // shader
-    glUseProgram(w_program);
-    glUniform1i(glGetUniformLocation(w_program, "tex"), 0);
-    glDrawArrays(GL_TRIANGLES, 0, 2 * 3);
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// BC7 blocks, mode 6 only : one subset, RGBA endpoints with 7 bits per channel + 1 p-bit, 4 bits indices
 
-    glfwSwapBuffers(gltfWindow);
-    glfwPollEvents();
-    return true;
-}
+constexpr array<int32_t, 16> BC7_WEIGHTS{0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
 
+struct BC7Fit {
+    array<array<uint32_t, 4>, 2> endpoints;
+    array<uint32_t, 2>           pbits;
+    array<uint8_t, 16>           indices;
+    int32_t                      error;
+};
 
-void Converter::checkShaderStatus(const GLuint shader) const {
-    int  success;
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
-        throw "Failed to compile shader error: " + std::string(infoLog);
-    };
+array<uint32_t, 4> quantizeBC7(const Color& color, const uint32_t pbit) {
+    array<uint32_t, 4> quantized;
+    for (auto c = 0; c < 4; c++) {
+        quantized[c] = static_cast<uint32_t>(std::clamp(std::lround((color[c] - static_cast<float>(pbit)) / 2.0f), 0l, 127l));
+    }
+    return quantized;
 }
 
-void Converter::checkProgramStatus() const {
-    int  success;
-    glGetProgramiv(w_program, GL_LINK_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetProgramInfoLog(w_program, 512, nullptr, infoLog);
-        throw "Failed to link shader error: " + std::string(infoLog);
-    };
+// p-bit with the lowest quantization error
+uint32_t bestPbit(const Color& color) {
+    auto bestError = numeric_limits<float>::max();
+    auto best = 0u;
+    for (auto pbit = 0u; pbit < 2; pbit++) {
+        const auto quantized = quantizeBC7(color, pbit);
+        auto error = 0.0f;
+        for (auto c = 0; c < 4; c++) {
+            const auto delta = static_cast<float>((quantized[c] << 1) | pbit) - color[c];
+            error += delta * delta;
+        }
+        if (error < bestError) {
+            bestError = error;
+            best = pbit;
+        }
+    }
+    return best;
 }
 
-Converter::~Converter() {
-    if (m_vbo_ref) {
-        glDeleteVertexArrays(1, &m_vbo_ref);
+BC7Fit evaluateBC7(const Block&              block,
+                   const array<uint32_t, 4>& first,
+                   const array<uint32_t, 4>& second,
+                   const uint32_t            firstPbit,
+                   const uint32_t            secondPbit) {
+    array<array<int32_t, 4>, 16> palette;
+    for (auto c = 0; c < 4; c++) {
+        const auto e0 = static_cast<int32_t>((first[c] << 1) | firstPbit);
+        const auto e1 = static_cast<int32_t>((second[c] << 1) | secondPbit);
+        for (auto index = 0; index < 16; index++) {
+            palette[index][c] = ((64 - BC7_WEIGHTS[index]) * e0 + BC7_WEIGHTS[index] * e1 + 32) >> 6;
+        }
     }
-    if (m_vao_ref) {
-        glDeleteVertexArrays(1, &m_vao_ref);
+    auto fit = BC7Fit{{first, second}, {firstPbit, secondPbit}, {}, 0};
+    for (auto i = 0; i < 16; i++) {
+        auto bestError = numeric_limits<int32_t>::max();
+        for (auto index = 0; index < 16; index++) {
+            auto error = 0;
+            for (auto c = 0; c < 4; c++) {
+                const auto delta = block[i][c] - palette[index][c];
+                error += delta * delta;
+            }
+            if (error < bestError) {
+                bestError = error;
+                fit.indices[i] = static_cast<uint8_t>(index);
+            }
+        }
+        fit.error += bestError;
     }
-    if (m_program) {
-        glDeleteProgram(m_program);
+    return fit;
+}
+
+void encodeBC7(const Block& block, const Quality quality, uint8_t* dst) {
+    static constexpr auto weights = [] {
+        array<float, 16> weights{};
+        for (auto i = 0; i < 16; i++) {
+            weights[i] = static_cast<float>(64 - BC7_WEIGHTS[i]) / 64.0f;
+        }
+        return weights;
+    }();
+    array<bool, 16> all;
+    all.fill(true);
+    Color first;
+    Color second;
+    fitEndpoints(block, 4, all, quality, first, second);
+
+    auto best = BC7Fit{.error = numeric_limits<int32_t>::max()};
+    const auto tryEndpoints = [&] {
+        // All the p-bits combinations are tried, except with the FAST quality
+        const auto firstPbit = bestPbit(first);
+        const auto secondPbit = bestPbit(second);
+        for (auto p0 = 0u; p0 < 2; p0++) {
+            for (auto p1 = 0u; p1 < 2; p1++) {
+                if ((quality == Quality::FAST) && ((p0 != firstPbit) || (p1 != secondPbit))) { continue; }
+                const auto fit = evaluateBC7(block, quantizeBC7(first, p0), quantizeBC7(second, p1), p0, p1);
+                if (fit.error < best.error) { best = fit; }
+            }
+        }
+    };
+    tryEndpoints();
+    for (auto iteration = 0; iteration < refinements(quality); iteration++) {
+        if (!solveEndpoints(block, 4, best.indices, weights.data(), 16, first, second)) { break; }
+        const auto previousError = best.error;
+        tryEndpoints();
+        if (best.error >= previousError) { break; }
     }
-    if (m_vertex) {
-        glDeleteShader(m_vertex);
+
+    // The most significant bit of the first index is implicitly 0
+    if (best.indices[0] >= 8) {
+        swap(best.endpoints[0], best.endpoints[1]);
+        swap(best.pbits[0], best.pbits[1]);
+        for (auto& index : best.indices) {
+            index = 15 - index;
+        }
     }
-    if (m_fragment) {
-        glDeleteShader(m_fragment);
+    auto bits = BitWriter{dst};
+    bits.write(1 << 6, 7);
+    for (auto c = 0; c < 4; c++) {
+        bits.write(best.endpoints[0][c], 7);
+        bits.write(best.endpoints[1][c], 7);
     }
-    if (w_program) {
-        glDeleteProgram(w_program);
+    bits.write(best.pbits[0], 1);
+    bits.write(best.pbits[1], 1);
+    for (auto i = 0; i < 16; i++) {
+        bits.write(best.indices[i], i == 0 ? 3 : 4);
     }
-    if (w_vertex) {
-        glDeleteShader(w_vertex);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+Converter::Converter(const Quality quality, const uint32_t threads):
+    quality{quality},
+    threads{std::max(threads, 1u)} {
+}
+
+void Converter::encodeBlock(const BlockFormat format, const Block& block, uint8_t* dst) const {
+    switch (format) {
+    case BlockFormat::BC1:
+        encodeBC1(block, quality, dst);
+        break;
+    case BlockFormat::BC2:
+        encodeExplicitAlpha(block, dst);
+        encodeColors(block, quality, dst + 8);
+        break;
+    case BlockFormat::BC3:
+        encodeChannel(channelValues(block, 3, false), false, quality, dst);
+        encodeColors(block, quality, dst + 8);
+        break;
+    case BlockFormat::BC4:
+    case BlockFormat::BC4S: {
+        const auto isSigned = format == BlockFormat::BC4S;
+        encodeChannel(channelValues(block, 0, isSigned), isSigned, quality, dst);
+        break;
     }
-    if (w_fragment) {
-        glDeleteShader(w_fragment);
+    case BlockFormat::BC5:
+    case BlockFormat::BC5S: {
+        const auto isSigned = format == BlockFormat::BC5S;
+        encodeChannel(channelValues(block, 0, isSigned), isSigned, quality, dst);
+        encodeChannel(channelValues(block, 1, isSigned), isSigned, quality, dst + 8);
+        break;
     }
-    if (gltfWindow) {
-        glfwDestroyWindow(gltfWindow);
-        gltfWindow = nullptr;
+    case BlockFormat::BC7:
+        encodeBC7(block, quality, dst);
+        break;
     }
 }
 
-
-/*bool Converter::getMipMaps(vector<MipLevel>& inMipLevels,
-                   const uint32_t srcWidth,
-                   const uint32_t srcHeight,
-                   const uint32_t srcChannels,
-                   const uint8_t* srcData) const {
-    GLuint source;
-    glGenTextures(1, &source);
-    glBindTexture(GL_TEXTURE_2D, source);
-    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
-    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER );
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER );
-    glGenerateMipmap(GL_TEXTURE_2D);
-    if (srcChannels == 4) {
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, srcWidth, srcHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, srcData);
-    } else {
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, srcWidth, srcHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, srcData);
+bool Converter::convert(const MipLevel& inMipLevel,
+                        MipLevel& outMipLevel,
+                        const uint32_t srcChannels,
+                        const string& dstFormat) const {
+    if (!formats.contains(dstFormat)) {
+        cerr << "Unsupported format " << dstFormat << endl;
+        return false;
     }
-
-    int level = 0;
-    auto width = srcWidth;
-    auto height = srcHeight;
-    while (width > 1 || height > 1) {
-        const auto dataSize = width * height * srcChannels;
-        const auto data = new uint8_t[dataSize];
-        glGetTexImage(GL_TEXTURE_2D, level, GL_RGBA, GL_UNSIGNED_BYTE, data);
-        inMipLevels.push_back({width,height,dataSize, data});
-        level++;
-        width = width >> level;
-        height = height >> level;
+    if (srcChannels != 3 && srcChannels != 4) {
+        cerr << "Image must be RGB or RGBA\n";
+        return false;
     }
+    const auto& format = formats.at(dstFormat);
+    const auto width = inMipLevel.width;
+    const auto height = inMipLevel.height;
+    const auto blocksX = (width + 3) / 4;
+    const auto blocksY = (height + 3) / 4;
+    outMipLevel.width = width;
+    outMipLevel.height = height;
+    outMipLevel.data = make_shared<vector<uint8_t>>(static_cast<vector<uint8_t>::size_type>(blocksX * blocksY * format.blockSize));
+    const auto srcData = inMipLevel.data->data();
+    const auto dstData = outMipLevel.data->data();
+
+    // Encode the [firstRow, lastRow[ rows of blocks, the edges pixels are repeated for the incomplete blocks
+    const auto encodeRows = [&](const uint32_t firstRow, const uint32_t lastRow) {
+        Block block;
+        for (auto blockY = firstRow; blockY < lastRow; blockY++) {
+            for (auto blockX = 0u; blockX < blocksX; blockX++) {
+                for (auto y = 0u; y < 4; y++) {
+                    const auto srcY = std::min(blockY * 4 + y, height - 1);
+                    for (auto x = 0u; x < 4; x++) {
+                        const auto srcX = std::min(blockX * 4 + x, width - 1);
+                        const auto pixel = srcData + (srcY * width + srcX) * srcChannels;
+                        block[y * 4 + x] = {pixel[0], pixel[1], pixel[2], srcChannels == 4 ? pixel[3] : uint8_t{255}};
+                    }
+                }
+                encodeBlock(format.format, block, dstData + (blockY * blocksX + blockX) * format.blockSize);
+            }
+        }
+    };
 
-    glBindTexture(GL_TEXTURE_2D, 0);
-    glDeleteTextures(1, &source);
+    const auto workers = std::min(threads, blocksY);
+    if (workers <= 1) {
+        encodeRows(0, blocksY);
+    } else {
+        // Each thread encodes its own rows of blocks
+        vector<thread> encodingThreads;
+        for (auto worker = 0u; worker < workers; worker++) {
+            encodingThreads.emplace_back(encodeRows, blocksY * worker / workers, blocksY * (worker + 1) / workers);
+        }
+        ranges::for_each(encodingThreads, [](auto& thread) { thread.join(); });
+    }
     return true;
-}*/
\ No newline at end of file
+}
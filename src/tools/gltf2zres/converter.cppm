@@ -5,22 +5,30 @@
  * https://opensource.org/licenses/MIT
 */
 module;
-#include "glad/glad.h"
-#include <GLFW/glfw3.h>
 #include "z0/libraries.h"
 
 export module converter;
 
 import miplevel;
 
-// GPU based (OpenGL) image BCn compression.
-// Warning : only ONE Converter objet per thread
+// Compression quality/speed trade-off
+export enum class Quality {
+    // Bounding box endpoints, no refinement
+    FAST,
+    // Principal axis endpoints with a few least-squares refinements
+    NORMAL,
+    // Principal axis endpoints, more refinements and more encoding modes tried per block
+    HIGH,
+};
+
+// CPU based image BCn compression, for headless conversions.
+// Blocks are encoded independently : the output only depends on the image, the format & the quality
+// and is identical for any number of threads.
 export class Converter {
 public:
-    // Initialize the GLFW3 conversion window & associated OpenGL resources
-    Converter();
-    // Close the window and release OpenGL resource
-    ~Converter();
+    // quality : compression quality
+    // threads : number of threads used to compress one mipmaps level
+    explicit Converter(Quality quality = Quality::NORMAL, uint32_t threads = 1);
 
     // Compress one mipmaps level of an image
     bool convert(const MipLevel& inMipLevel,
@@ -28,46 +36,29 @@ public:
                  uint32_t srcChannels,
                  const string& dstFormat) const;
 
-    /*bool getMipMaps(vector<MipLevel>& inMipLevels,
-                    uint32_t srcWidth,
-                    uint32_t srcHeight,
-                    uint32_t srcChannels,
-                    const uint8_t* srcData) const;*/
-
 private:
-    // OpenGL equivalence table for compression formats
-    const map<string, GLuint> formats = {
-        { "bc1",  GL_COMPRESSED_RGBA_S3TC_DXT1_EXT},
-        { "bc2",  GL_COMPRESSED_RGBA_S3TC_DXT3_EXT},
-        { "bc3",  GL_COMPRESSED_RGBA_S3TC_DXT5_EXT},
-        { "bc4",  GL_COMPRESSED_RED_RGTC1_EXT},
-        { "bc4s", GL_COMPRESSED_SIGNED_RED_RGTC1_EXT},
-        { "bc5",  GL_COMPRESSED_RED_GREEN_RGTC2_EXT},
-        { "bc5s", GL_COMPRESSED_SIGNED_RED_GREEN_RGTC2_EXT},
-        { "bc7",  GL_COMPRESSED_RGBA_BPTC_UNORM},
-    };
+    enum class BlockFormat { BC1, BC2, BC3, BC4, BC4S, BC5, BC5S, BC7 };
 
-    // Window shaders & buffers
-    GLuint w_vertex{};
-    GLuint w_fragment{};
-    GLuint w_program{};
-    GLuint w_vao_ref{};
-    GLuint w_vbo_ref{};
-
-    // Conversion shaders & buffers
-    GLuint m_vertex{};
-    GLuint m_fragment{};
-    GLuint m_program{};
-    GLuint m_vao_ref{};
-    GLuint m_vbo_ref{};
+    struct Format {
+        BlockFormat format;
+        // Size in bytes of a 4x4 block
+        uint32_t    blockSize;
+    };
 
-    // Conversion window (hidden) with the OpenGL context
-    GLFWwindow* gltfWindow{nullptr};
+    // Compression formats with the size of their blocks
+    const map<string, Format> formats = {
+        { "bc1",  { BlockFormat::BC1,  8 }},
+        { "bc2",  { BlockFormat::BC2,  16 }},
+        { "bc3",  { BlockFormat::BC3,  16 }},
+        { "bc4",  { BlockFormat::BC4,  8 }},
+        { "bc4s", { BlockFormat::BC4S, 8 }},
+        { "bc5",  { BlockFormat::BC5,  16 }},
+        { "bc5s", { BlockFormat::BC5S, 16 }},
+        { "bc7",  { BlockFormat::BC7,  16 }},
+    };
 
-    // The GLFW initialization process & the GLAD library are NOT multi-threaded safe :
-    // we use a mutex to create the window & initialize the OpenGL resources
-    static inline mutex initMutex;
+    const Quality  quality;
+    const uint32_t threads;
 
-    void checkShaderStatus(GLuint shader) const;
-    void checkProgramStatus() const;
-};
\ No newline at end of file
+    void encodeBlock(BlockFormat format, const array<array<uint8_t, 4>, 16>& block, uint8_t* dst) const;
+};
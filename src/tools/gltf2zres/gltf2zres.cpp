@@ -10,6 +10,10 @@
 #include <fastgltf/glm_element_traits.hpp>
 #include <glm/gtx/quaternion.hpp>
 #include <glm/gtx/matrix_decompose.hpp>
+#include <lz4.h>
+#include <lz4hc.h>
+#include <meshoptimizer.h>
+#include <zstd.h>
 #include <z0/z0.h>
 #include "z0/libraries.h"
 namespace fs = std::filesystem;
@@ -18,11 +22,156 @@ import miplevel;
 import converter;
 import image;
 
+// One data bloc, encoded & compressed, ready to be written
+struct Chunk {
+    z0::ZRes::ChunkInfo info;
+    vector<char>        data;
+};
+
+// Encodes a data bloc with a meshoptimizer codec then compresses it.
+// The data is stored as is if the encoding & compression does not reduce its size.
+Chunk makeChunk(const z0::ZRes::ChunkType type,
+                z0::ZRes::ChunkEncoding encoding,
+                z0::ZRes::ChunkCompression compression,
+                const Quality quality,
+                const void* data,
+                const size_t size,
+                const uint32_t elementSize = 0) {
+    using namespace z0;
+    const auto count = elementSize == 0 ? 0 : size / elementSize;
+    if (size == 0) {
+        encoding = ZRes::ChunkEncoding::NONE;
+        compression = ZRes::ChunkCompression::NONE;
+    }
+    if (compression == ZRes::ChunkCompression::LZ4 && size > LZ4_MAX_INPUT_SIZE) {
+        compression = ZRes::ChunkCompression::ZSTD;
+    }
+
+    // meshoptimizer codecs
+    auto encoded = vector<char>{};
+    switch (encoding) {
+    case ZRes::ChunkEncoding::MESHOPT_VERTEX: {
+        encoded.resize(meshopt_encodeVertexBufferBound(count, elementSize));
+        encoded.resize(meshopt_encodeVertexBuffer(reinterpret_cast<unsigned char*>(encoded.data()), encoded.size(),
+                                                  data, count, elementSize));
+        break;
+    }
+    case ZRes::ChunkEncoding::MESHOPT_INDEX_BUFFER:
+    case ZRes::ChunkEncoding::MESHOPT_INDEX_SEQUENCE: {
+        const auto indices = static_cast<const uint32_t*>(data);
+        const auto vertexCount = count == 0 ? 0 : *ranges::max_element(indices, indices + count) + 1;
+        if (encoding == ZRes::ChunkEncoding::MESHOPT_INDEX_BUFFER) {
+            encoded.resize(meshopt_encodeIndexBufferBound(count, vertexCount));
+            encoded.resize(meshopt_encodeIndexBuffer(reinterpret_cast<unsigned char*>(encoded.data()), encoded.size(),
+                                                     indices, count));
+        } else {
+            encoded.resize(meshopt_encodeIndexSequenceBound(count, vertexCount));
+            encoded.resize(meshopt_encodeIndexSequence(reinterpret_cast<unsigned char*>(encoded.data()), encoded.size(),
+                                                       indices, count));
+        }
+        break;
+    }
+    default:
+        encoded.assign(static_cast<const char*>(data), static_cast<const char*>(data) + size);
+    }
+
+    // Zstandard & LZ4 compression
+    auto compressed = vector<char>{};
+    switch (compression) {
+    case ZRes::ChunkCompression::ZSTD: {
+        const auto level = quality == Quality::FAST ? 3 : quality == Quality::NORMAL ? 9 : 19;
+        compressed.resize(ZSTD_compressBound(encoded.size()));
+        const auto compressedSize = ZSTD_compress(compressed.data(), compressed.size(), encoded.data(), encoded.size(), level);
+        if (ZSTD_isError(compressedSize)) { throw string{"Zstandard compression error "} + ZSTD_getErrorName(compressedSize); }
+        compressed.resize(compressedSize);
+        break;
+    }
+    case ZRes::ChunkCompression::LZ4: {
+        compressed.resize(LZ4_compressBound(static_cast<int>(encoded.size())));
+        const auto compressedSize = quality == Quality::FAST ?
+            LZ4_compress_default(encoded.data(), compressed.data(),
+                                 static_cast<int>(encoded.size()), static_cast<int>(compressed.size())) :
+            LZ4_compress_HC(encoded.data(), compressed.data(),
+                            static_cast<int>(encoded.size()), static_cast<int>(compressed.size()),
+                            quality == Quality::NORMAL ? LZ4HC_CLEVEL_DEFAULT : LZ4HC_CLEVEL_MAX);
+        if (compressedSize <= 0) { throw string{"LZ4 compression error"}; }
+        compressed.resize(compressedSize);
+        break;
+    }
+    default:
+        break;
+    }
+
+    auto chunk = Chunk {
+        .info = {
+            .type = static_cast<uint32_t>(type),
+            .encoding = static_cast<uint32_t>(encoding),
+            .compression = static_cast<uint32_t>(compression),
+            .elementSize = elementSize,
+            .encodedSize = encoded.size(),
+            .size = size,
+        },
+    };
+    if (compression != ZRes::ChunkCompression::NONE && compressed.size() < encoded.size()) {
+        chunk.data = std::move(compressed);
+    } else {
+        chunk.info.compression = static_cast<uint32_t>(ZRes::ChunkCompression::NONE);
+        chunk.data = std::move(encoded);
+    }
+    if (chunk.data.size() >= size && encoding != ZRes::ChunkEncoding::NONE) {
+        // the codec does not reduce the size of the data, store it raw
+        return makeChunk(type, ZRes::ChunkEncoding::NONE, compression, quality, data, size, elementSize);
+    }
+    chunk.info.storedSize = chunk.data.size();
+    return chunk;
+}
+
+// Appends the simplified levels of detail of a mesh surface, from the finest to the coarsest, to the indices.
+// Same chain as Mesh::buildLODs() : each level targets half of the triangles of the previous one with a doubled error.
+vector<z0::ZRes::DataInfo> buildLODs(vector<uint32_t>& indices,
+                                     const z0::ZRes::DataInfo& surfaceIndices,
+                                     const glm::vec3* positions,
+                                     const size_t vertexCount,
+                                     const uint32_t lodsCount,
+                                     const bool lockBorder) {
+    constexpr auto lodTargetError = 2e-2f;
+    auto lods = vector<z0::ZRes::DataInfo>{};
+    if (vertexCount == 0) { return lods; }
+    auto source = vector<uint32_t>(indices.begin() + surfaceIndices.first,
+                                   indices.begin() + surfaceIndices.first + surfaceIndices.count);
+    for (auto level = 1u; level < lodsCount; level++) {
+        const auto targetIndexCount = (surfaceIndices.count >> level) / 3 * 3;
+        const auto targetError = lodTargetError * static_cast<float>(1 << (level - 1));
+        auto lod = vector<uint32_t>(source.size());
+        lod.resize(meshopt_simplify(lod.data(), source.data(), source.size(),
+                                    &positions[0].x, vertexCount, sizeof(glm::vec3),
+                                    targetIndexCount, targetError,
+                                    lockBorder ? meshopt_SimplifyLockBorder : 0, nullptr));
+        if (lod.size() > source.size() * 9 / 10) {
+            lod.resize(meshopt_simplifySloppy(lod.data(), source.data(), source.size(),
+                                              &positions[0].x, vertexCount, sizeof(glm::vec3),
+                                              targetIndexCount, targetError, nullptr));
+        }
+        if (lod.empty() || lod.size() >= source.size()) { break; }
+        lods.push_back({static_cast<uint32_t>(indices.size()), static_cast<uint32_t>(lod.size())});
+        indices.insert(indices.end(), lod.begin(), lod.end());
+        source = std::move(lod);
+    }
+    return lods;
+}
+
 int main(const int argc, char** argv) {
     cxxopts::Options options("gltl2zres", "Create a ZRes file from a glTF file");
     options.add_options()
         ("f", "Compression format for color textures : bc1 bc2 bc3 bc4 bc4s bc5 bc5s bc7, default : bc7", cxxopts::value<string>())
+        ("n", "Compression format for normal maps : bc1 bc2 bc3 bc4 bc5 bc7, default : bc5", cxxopts::value<string>())
+        ("m", "Compression format for metallic/roughness textures, default : bc7", cxxopts::value<string>())
+        ("q", "Compression quality : fast normal high, default : normal", cxxopts::value<string>())
         ("t", "Number of threads for transcoding, default : auto", cxxopts::value<int>())
+        ("c", "Data compression : none lz4 zstd, default : zstd", cxxopts::value<string>())
+        ("r", "Store the meshes data without the meshoptimizer codecs")
+        ("l", "Number of levels of detail of the meshes, including the full detail level : 1 to 5, default : 4", cxxopts::value<int>())
+        ("a", "Compress the animations : keys reduction with the given error tolerance and quantized rotations, default tolerance : 0.0001", cxxopts::value<float>()->implicit_value("0.0001"))
         ("v", "Verbose mode")
         ("input", "The binary glTF file to read", cxxopts::value<string>())
         ("output","The ZScene file to create", cxxopts::value<string>());
@@ -47,6 +196,90 @@ int main(const int argc, char** argv) {
     }
     if (verbose) { cout << "Using compression format " << formatName << " for color images" << endl; }
 
+    /// -n
+    auto normalFormatName = string{"bc5"};
+    if (result.count("n") == 1) {
+        normalFormatName = result["n"].as<string>();
+    }
+    if (!formats.contains(normalFormatName)) {
+        cerr << "Unsupported compression format " << normalFormatName << endl;
+        return EXIT_FAILURE;
+    }
+    // The shaders unpack the normals from unsigned [0, 1] values
+    if (normalFormatName == "bc4s" || normalFormatName == "bc5s") {
+        cerr << "Signed compression format " << normalFormatName << " not supported for normal maps" << endl;
+        return EXIT_FAILURE;
+    }
+    if (verbose) { cout << "Using compression format " << normalFormatName << " for normal maps" << endl; }
+
+    /// -m
+    auto metallicRoughnessFormatName = string{"bc7"};
+    if (result.count("m") == 1) {
+        metallicRoughnessFormatName = result["m"].as<string>();
+    }
+    if (!formats.contains(metallicRoughnessFormatName)) {
+        cerr << "Unsupported compression format " << metallicRoughnessFormatName << endl;
+        return EXIT_FAILURE;
+    }
+    if (verbose) { cout << "Using compression format " << metallicRoughnessFormatName << " for metallic/roughness images" << endl; }
+
+    /// -q
+    const auto qualities = map<string, Quality>{
+        { "fast",   Quality::FAST },
+        { "normal", Quality::NORMAL },
+        { "high",   Quality::HIGH },
+    };
+    auto quality = Quality::NORMAL;
+    if (result.count("q") == 1) {
+        const auto qualityName = result["q"].as<string>();
+        if (!qualities.contains(qualityName)) {
+            cerr << "Unsupported compression quality " << qualityName << endl;
+            return EXIT_FAILURE;
+        }
+        quality = qualities.at(qualityName);
+    }
+
+    // -c
+    const auto compressions = map<string, z0::ZRes::ChunkCompression>{
+        { "none", z0::ZRes::ChunkCompression::NONE },
+        { "lz4",  z0::ZRes::ChunkCompression::LZ4 },
+        { "zstd", z0::ZRes::ChunkCompression::ZSTD },
+    };
+    auto compression = z0::ZRes::ChunkCompression::ZSTD;
+    if (result.count("c") == 1) {
+        const auto compressionName = result["c"].as<string>();
+        if (!compressions.contains(compressionName)) {
+            cerr << "Unsupported compression " << compressionName << endl;
+            return EXIT_FAILURE;
+        }
+        compression = compressions.at(compressionName);
+    }
+
+    // -r
+    const auto meshoptCodecs = result.count("r") == 0;
+
+    // -l
+    auto lodsCount = 4;
+    if (result.count("l") == 1) {
+        lodsCount = result["l"].as<int>();
+        if (lodsCount < 1 || lodsCount > 5) {
+            cerr << "Unsupported number of levels of detail " << lodsCount << endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    // -a
+    const auto compressAnimations = result.count("a") == 1;
+    auto animationTolerance = z0::Animation::CompressionTolerance{};
+    if (compressAnimations) {
+        const auto tolerance = result["a"].as<float>();
+        if (tolerance < 0.0f) {
+            cerr << "Invalid animations error tolerance " << tolerance << endl;
+            return EXIT_FAILURE;
+        }
+        animationTolerance = { tolerance, tolerance, tolerance };
+    }
+
     // -t
     auto maxThreads = 0;
     if (result.count("t") == 1) {
@@ -98,11 +331,11 @@ int main(const int argc, char** argv) {
         }
         if (material.pbrData.metallicRoughnessTexture.has_value()&& gltf.textures[material.pbrData.metallicRoughnessTexture.value().textureIndex].imageIndex.has_value()) {
             imagesFormat[gltf.textures[material.pbrData.metallicRoughnessTexture.value().textureIndex].imageIndex.value()] =
-                { "bc7", formats.at("bc7").format };
+                { metallicRoughnessFormatName, formats.at(metallicRoughnessFormatName).format };
         }
         if (material.normalTexture.has_value()&& gltf.textures[material.normalTexture.value().textureIndex].imageIndex.has_value()) {
             imagesFormat[gltf.textures[material.normalTexture.value().textureIndex].imageIndex.value()] =
-                { "bc7", formats.at("bc7").format };
+                { normalFormatName, formats.at(normalFormatName).format };
         }
         if (material.emissiveTexture.has_value() && gltf.textures[material.emissiveTexture.value().textureIndex].imageIndex.has_value()) {
             imagesFormat[gltf.textures[material.emissiveTexture.value().textureIndex].imageIndex.value()] =
@@ -123,7 +356,7 @@ int main(const int argc, char** argv) {
                 imagesFormat.at(imageIndex).name,
                 verbose);
         }
-        startImagesLoading(maxThreads);
+        startImagesLoading(maxThreads, quality);
         if (verbose) {
             auto last_transcode_time = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - tStart).count();
             cout << "Total transcoding time for "  << gltf.images.size() << " images : " <<  last_transcode_time << "ms" << endl;
@@ -136,7 +369,7 @@ int main(const int argc, char** argv) {
     // Initialize the destination file headers
     if (verbose) { cout << "Creating destination file headers...\n"; }
     auto header = z0::ZRes::Header {
-        .version = 1,
+        .version = z0::ZRes::VERSION,
         .imagesCount = static_cast<uint32_t>(gltf.images.size()),
         .texturesCount = static_cast<uint32_t>(gltf.textures.size()),
         .materialsCount = static_cast<uint32_t>(gltf.materials.size()),
@@ -298,9 +531,12 @@ int main(const int argc, char** argv) {
     vector<glm::vec3> normals{};
     vector<glm::vec2> uvs{};
     vector<glm::vec4> tangents{};
+    vector<glm::u16vec4> joints{};
+    vector<glm::vec4> weights{};
     auto meshesHeaders = vector<z0::ZRes::MeshHeader> {gltf.meshes.size()};
     auto surfaceInfo = vector<vector<z0::ZRes::SurfaceInfo>> {gltf.meshes.size()};
     auto uvsInfos = vector<vector<vector<z0::ZRes::DataInfo>>> {gltf.meshes.size()};
+    auto lodsInfos = vector<vector<vector<z0::ZRes::DataInfo>>> {gltf.meshes.size()};
     for(auto meshIndex = 0; meshIndex < meshesHeaders.size(); meshIndex++) {
         auto& mesh = gltf.meshes[meshIndex];
         copyName(mesh.name.data(), meshesHeaders[meshIndex].name, meshIndex);
@@ -362,6 +598,24 @@ int main(const int argc, char** argv) {
                         });
                 }
             }
+            // load skinning joints & weights, parallel to the positions
+            {
+                const auto firstPosition = surfaceInfo[meshIndex][surfaceIndex].positions.first;
+                joints.resize(positions.size());
+                weights.resize(positions.size());
+                auto jointsAttr = p.findAttribute("JOINTS_0");
+                auto weightsAttr = p.findAttribute("WEIGHTS_0");
+                if (jointsAttr != p.attributes.end() && weightsAttr != p.attributes.end()) {
+                    fastgltf::iterateAccessorWithIndex<glm::uvec4>(
+                        gltf, gltf.accessors[jointsAttr->accessorIndex], [&](const glm::uvec4 v, const size_t index) {
+                            joints[firstPosition + index] = glm::u16vec4{v};
+                        });
+                    fastgltf::iterateAccessorWithIndex<glm::vec4>(
+                        gltf, gltf.accessors[weightsAttr->accessorIndex], [&](const glm::vec4 v, const size_t index) {
+                            weights[firstPosition + index] = v;
+                        });
+                }
+            }
             if (p.materialIndex.has_value()) {
                 surfaceInfo[meshIndex][surfaceIndex].materialIndex = p.materialIndex.value();
                 // load UVs
@@ -385,9 +639,26 @@ int main(const int argc, char** argv) {
                 surfaceInfo[meshIndex][surfaceIndex].materialIndex = -1;
             }
         }
+        // Levels of detail, using the positions of all the surfaces since the indices are relative to the mesh
+        lodsInfos[meshIndex].resize(mesh.primitives.size());
+        uint32_t lodsDataInfoCount{0};
+        if (!mesh.primitives.empty()) {
+            const auto* meshPositions = positions.data() + surfaceInfo[meshIndex][0].positions.first;
+            for(auto surfaceIndex = 0; surfaceIndex < mesh.primitives.size(); surfaceIndex++) {
+                lodsInfos[meshIndex][surfaceIndex] = buildLODs(indices,
+                                                               surfaceInfo[meshIndex][surfaceIndex].indices,
+                                                               meshPositions,
+                                                               initialVtx,
+                                                               lodsCount,
+                                                               mesh.primitives.size() > 1);
+                lodsDataInfoCount += lodsInfos[meshIndex][surfaceIndex].size();
+            }
+        }
         header.headersSize += sizeof(z0::ZRes::MeshHeader)
                             + sizeof(z0::ZRes::SurfaceInfo) * surfaceInfo[meshIndex].size()
-                            + sizeof(z0::ZRes::DataInfo) * uvsDataInfoCount;
+                            + sizeof(z0::ZRes::DataInfo) * uvsDataInfoCount
+                            + sizeof(uint32_t) * surfaceInfo[meshIndex].size()
+                            + sizeof(z0::ZRes::DataInfo) * lodsDataInfoCount;
     }
 
     // Fill the nodes header
@@ -423,11 +694,60 @@ int main(const int argc, char** argv) {
                             sizeof(uint32_t) * childrenIndexes[nodeIndex].size();
     }
 
+    // Fill the skeletons headers, the joints are indexed like in the glTF skins
+    auto nodesParents = vector<int32_t>(gltf.nodes.size(), -1);
+    for (auto nodeIndex = 0; nodeIndex < gltf.nodes.size(); ++nodeIndex) {
+        for (const auto child : childrenIndexes[nodeIndex]) {
+            nodesParents[child] = nodeIndex;
+        }
+    }
+    const function<glm::mat4(int32_t)> worldTransform = [&](const int32_t nodeIndex) {
+        return nodeIndex == -1 ? glm::mat4{1.0f} : worldTransform(nodesParents[nodeIndex]) * nodesHeaders[nodeIndex].transform;
+    };
+    auto skinHeaders = vector<z0::ZRes::SkinHeader>{};
+    auto jointsInfos = vector<vector<z0::ZRes::JointInfo>>{};
+    auto jointsNodes = set<int32_t>{};
+    for (auto nodeIndex = 0; nodeIndex < gltf.nodes.size(); ++nodeIndex) {
+        const auto &node = gltf.nodes[nodeIndex];
+        if (!node.skinIndex.has_value() || !node.meshIndex.has_value()) { continue; }
+        const auto& skin = gltf.skins[node.skinIndex.value()];
+        auto inverseBindMatrices = vector<glm::mat4>(skin.joints.size(), glm::mat4{1.0f});
+        if (skin.inverseBindMatrices.has_value()) {
+            fastgltf::copyFromAccessor<glm::mat4>(
+                gltf, gltf.accessors[skin.inverseBindMatrices.value()], inverseBindMatrices.data());
+        }
+        auto& skinHeader = skinHeaders.emplace_back();
+        skinHeader.nodeIndex = nodeIndex;
+        skinHeader.jointsCount = skin.joints.size();
+        skinHeader.transform = glm::mat4{1.0f};
+        auto& infos = jointsInfos.emplace_back(skin.joints.size());
+        auto haveRoot = false;
+        for (auto jointIndex = 0; jointIndex < skin.joints.size(); ++jointIndex) {
+            const auto jointNode = static_cast<int32_t>(skin.joints[jointIndex]);
+            const auto parent = ranges::find(skin.joints, static_cast<size_t>(nodesParents[jointNode]));
+            auto& info = infos[jointIndex];
+            copyName(gltf.nodes[jointNode].name.data(), info.name, jointIndex);
+            info.nodeIndex = jointNode;
+            info.parent = parent == skin.joints.end() ? -1 : static_cast<int32_t>(distance(skin.joints.begin(), parent));
+            info.inverseBindMatrix = inverseBindMatrices[jointIndex];
+            glm::vec3 skew;
+            glm::vec4 perspective;
+            glm::decompose(nodesHeaders[jointNode].transform, info.scale, info.rotation, info.position, skew, perspective);
+            // the skinned node transform is ignored by glTF, the joints are moved in the mesh space
+            if (info.parent == -1 && !haveRoot) {
+                skinHeader.transform = glm::inverse(worldTransform(nodeIndex)) * worldTransform(nodesParents[jointNode]);
+                haveRoot = true;
+            }
+            jointsNodes.insert(jointNode);
+        }
+        header.headersSize += sizeof(z0::ZRes::SkinHeader) + sizeof(z0::ZRes::JointInfo) * infos.size();
+    }
+    header.headersSize += sizeof(uint32_t);
+
     // Fill the animations headers
     auto animationHeaders = vector<z0::ZRes::AnimationHeader>(gltf.animations.size());
     auto tracksInfos = vector<vector<z0::ZRes::TrackInfo>>(gltf.animations.size());
-    auto tracksKeyTimes = vector<vector<vector<float>>>(gltf.animations.size());
-    auto tracksKeyValues = vector<vector<vector<glm::vec3>>>(gltf.animations.size());
+    auto tracks = vector<vector<z0::Animation::Track>>(gltf.animations.size());
     for (auto animationIndex = 0; animationIndex < gltf.animations.size(); ++animationIndex) {
         const auto &animation = gltf.animations[animationIndex];
         auto& animationHeader = animationHeaders[animationIndex];
@@ -436,31 +756,35 @@ int main(const int argc, char** argv) {
         const string name{regex_replace(animation.name.data(), pattern, "")};
         copyName(name, animationHeader.name, animationIndex);
         tracksInfos[animationIndex].resize(animationHeader.tracksCount);
-        tracksKeyTimes[animationIndex].resize(animationHeader.tracksCount);
-        tracksKeyValues[animationIndex].resize(animationHeader.tracksCount);
+        tracks[animationIndex].resize(animationHeader.tracksCount);
         for (auto trackIndex = 0; trackIndex < animationHeader.tracksCount; trackIndex++) {
             const auto& channel = animation.channels[trackIndex];
             auto& trackInfo = tracksInfos[animationIndex][trackIndex];
-            auto& keyTimes = tracksKeyTimes[animationIndex][trackIndex];
-            auto& KeyValues = tracksKeyValues[animationIndex][trackIndex];
+            auto& track = tracks[animationIndex][trackIndex];
+            auto& keyTimes = track.keyTime;
+            auto& KeyValues = track.keyValue;
+            auto& keyRotations = track.keyRotation;
             auto position = z0::VEC3ZERO;
-            auto rotation = z0::VEC3ZERO;
+            auto rotation = z0::QUATERNION_IDENTITY;
             auto scale = z0::VEC3ZERO;
+            // joints tracks stores absolute values
+            const auto joint = channel.nodeIndex.has_value() && jointsNodes.contains(channel.nodeIndex.value());
             if (channel.nodeIndex.has_value()) {
                 trackInfo.nodeIndex = static_cast<int32_t>(channel.nodeIndex.value());
+            }
+            if (channel.nodeIndex.has_value() && !joint) {
                 glm::vec3 skew;
                 glm::vec4 perspective;
-                glm::quat orientation;
                 glm::decompose(nodesHeaders[trackInfo.nodeIndex].transform,
-                    scale, orientation, position, skew, perspective);
-                rotation = glm::eulerAngles(orientation);
+                    scale, rotation, position, skew, perspective);
                 // position = nodesHeaders[trackInfo.nodeIndex].transform[3];
             }
             const auto &sampler = animation.samplers.at(channel.samplerIndex);
-            trackInfo.interpolation = static_cast<uint32_t>(
+            track.interpolation =
                 sampler.interpolation == fastgltf::AnimationInterpolation::Linear ?
                     z0::AnimationInterpolation::LINEAR :
-                    z0::AnimationInterpolation::STEP);
+                    z0::AnimationInterpolation::STEP;
+            trackInfo.interpolation = static_cast<uint32_t>(track.interpolation);
 
             const auto&inputAccessor = gltf.accessors.at(sampler.inputAccessor);
             trackInfo.keysCount = inputAccessor.count;
@@ -468,44 +792,129 @@ int main(const int argc, char** argv) {
             fastgltf::copyFromAccessor<float>(gltf, inputAccessor, keyTimes.data());
 
             const auto&outputAccessor = gltf.accessors.at(sampler.outputAccessor);
-            KeyValues.resize(trackInfo.keysCount);
             // can't use copyFromAccessor here because translation to parent relative transform
             switch (channel.path) {
                 case fastgltf::AnimationPath::Translation: {
-                    trackInfo.type = static_cast<uint32_t>(z0::AnimationType::TRANSLATION);
+                    track.type = z0::AnimationType::TRANSLATION;
+                    KeyValues.resize(trackInfo.keysCount);
                     fastgltf::iterateAccessorWithIndex<glm::vec3>(
                         gltf, outputAccessor, [&](const glm::vec3 vec, const size_t index) {
-                            KeyValues[index] = vec - position;
+                            KeyValues[index] = joint ? vec : vec - position;
                             // cout << to_string(KeyValues[index]) << endl;
                     });
                     break;
                 }
                 case fastgltf::AnimationPath::Rotation: {
-                    trackInfo.type = static_cast<uint32_t>(z0::AnimationType::ROTATION);
-                    auto absoluteRotations = vector<glm::quat>(trackInfo.keysCount);
+                    track.type = z0::AnimationType::ROTATION;
+                    keyRotations.resize(trackInfo.keysCount);
+                    const auto inverseRotation = glm::inverse(rotation);
                     fastgltf::iterateAccessorWithIndex<glm::vec4>(
                         gltf, outputAccessor, [&](const glm::vec4 vec, const size_t index) {
-                            auto rot = glm::eulerAngles(glm::quat(vec.w, vec.x, vec.y, vec.z));
-                            KeyValues[index] = rot - rotation;
+                            const auto rot = glm::quat(vec.w, vec.x, vec.y, vec.z);
+                            keyRotations[index] = joint ? rot : inverseRotation * rot;
                     });
                     break;
                 }
                 case fastgltf::AnimationPath::Scale: {
-                    trackInfo.type = static_cast<uint32_t>(z0::AnimationType::SCALE);
+                    track.type = z0::AnimationType::SCALE;
+                    KeyValues.resize(trackInfo.keysCount);
                     fastgltf::iterateAccessorWithIndex<glm::vec3>(
                         gltf, outputAccessor, [&](const glm::vec3 vec, const size_t index) {
-                            KeyValues[index] = vec - scale + glm::vec3{1.0f};
+                            KeyValues[index] = joint ? vec : vec - scale + glm::vec3{1.0f};
                     });
                     break;
                 }
                 default:
-                    break;
+                    continue;
+            }
+            trackInfo.type = static_cast<uint32_t>(track.type);
+            if (compressAnimations) {
+                z0::Animation::compress(track, animationTolerance);
+                trackInfo.keysCount = track.keyTime.size();
             }
+            trackInfo.encoding = static_cast<uint32_t>(track.keyQuantizedRotation.empty() ?
+                z0::ZRes::TrackEncoding::NONE :
+                z0::ZRes::TrackEncoding::QUANTIZED);
         }
         header.headersSize += sizeof(z0::ZRes::AnimationHeader) +
             animationHeader.tracksCount * sizeof(z0::ZRes::TrackInfo);
     }
 
+    // Encode & compress the data blocs, in parallel
+    if (verbose) { cout << "Compressing data...\n"; }
+    auto animationsData = vector<char>{};
+    for (auto animationIndex = 0; animationIndex < gltf.animations.size(); animationIndex++) {
+        for (auto trackIndex = 0; trackIndex < animationHeaders[animationIndex].tracksCount; trackIndex++) {
+            const auto& keyTimes = tracks[animationIndex][trackIndex].keyTime;
+            const auto& keyValues = tracks[animationIndex][trackIndex].keyValue;
+            const auto& keyRotations = tracks[animationIndex][trackIndex].keyRotation;
+            const auto& keyQuantizedRotations = tracks[animationIndex][trackIndex].keyQuantizedRotation;
+            animationsData.insert(animationsData.end(),
+                reinterpret_cast<const char*>(keyTimes.data()),
+                reinterpret_cast<const char*>(keyTimes.data() + keyTimes.size()));
+            animationsData.insert(animationsData.end(),
+                reinterpret_cast<const char*>(keyValues.data()),
+                reinterpret_cast<const char*>(keyValues.data() + keyValues.size()));
+            animationsData.insert(animationsData.end(),
+                reinterpret_cast<const char*>(keyRotations.data()),
+                reinterpret_cast<const char*>(keyRotations.data() + keyRotations.size()));
+            animationsData.insert(animationsData.end(),
+                reinterpret_cast<const char*>(keyQuantizedRotations.data()),
+                reinterpret_cast<const char*>(keyQuantizedRotations.data() + keyQuantizedRotations.size()));
+        }
+    }
+    const auto vertexEncoding = meshoptCodecs ? z0::ZRes::ChunkEncoding::MESHOPT_VERTEX : z0::ZRes::ChunkEncoding::NONE;
+    const auto indexEncoding = !meshoptCodecs ? z0::ZRes::ChunkEncoding::NONE :
+        indices.size() % 3 == 0 ? z0::ZRes::ChunkEncoding::MESHOPT_INDEX_BUFFER :
+        z0::ZRes::ChunkEncoding::MESHOPT_INDEX_SEQUENCE;
+    auto chunksFutures = vector<future<Chunk>>{};
+    auto compressChunk = [&](const z0::ZRes::ChunkType type,
+                             const z0::ZRes::ChunkEncoding encoding,
+                             const void* data, const size_t size, const uint32_t elementSize) {
+        chunksFutures.push_back(async(launch::async, makeChunk, type, encoding, compression, quality, data, size, elementSize));
+    };
+    compressChunk(z0::ZRes::ChunkType::INDICES, indexEncoding,
+                  indices.data(), indices.size() * sizeof(uint32_t), sizeof(uint32_t));
+    compressChunk(z0::ZRes::ChunkType::POSITIONS, vertexEncoding,
+                  positions.data(), positions.size() * sizeof(glm::vec3), sizeof(glm::vec3));
+    compressChunk(z0::ZRes::ChunkType::NORMALS, vertexEncoding,
+                  normals.data(), normals.size() * sizeof(glm::vec3), sizeof(glm::vec3));
+    compressChunk(z0::ZRes::ChunkType::UVS, vertexEncoding,
+                  uvs.data(), uvs.size() * sizeof(glm::vec2), sizeof(glm::vec2));
+    compressChunk(z0::ZRes::ChunkType::TANGENTS, vertexEncoding,
+                  tangents.data(), tangents.size() * sizeof(glm::vec4), sizeof(glm::vec4));
+    if (!skinHeaders.empty()) {
+        compressChunk(z0::ZRes::ChunkType::JOINTS, vertexEncoding,
+                      joints.data(), joints.size() * sizeof(glm::u16vec4), sizeof(glm::u16vec4));
+        compressChunk(z0::ZRes::ChunkType::WEIGHTS, vertexEncoding,
+                      weights.data(), weights.size() * sizeof(glm::vec4), sizeof(glm::vec4));
+    }
+    compressChunk(z0::ZRes::ChunkType::ANIMATIONS, z0::ZRes::ChunkEncoding::NONE,
+                  animationsData.data(), animationsData.size(), 0);
+    // One chunk per image, with all the mip levels
+    auto imagesData = vector<vector<char>>(gltf.images.size());
+    for (auto imageIndex = 0; imageIndex < gltf.images.size(); imageIndex++) {
+        for (const auto& mipLevel : outMipLevels.at(imageIndex)) {
+            imagesData[imageIndex].insert(imagesData[imageIndex].end(), mipLevel.data->begin(), mipLevel.data->end());
+        }
+        compressChunk(z0::ZRes::ChunkType::IMAGE, z0::ZRes::ChunkEncoding::NONE,
+                      imagesData[imageIndex].data(), imagesData[imageIndex].size(), 0);
+    }
+    auto chunks = vector<Chunk>{};
+    auto chunksOffset = uint64_t{0};
+    try {
+        for (auto& chunkFuture : chunksFutures) {
+            auto chunk = chunkFuture.get();
+            chunk.info.offset = chunksOffset;
+            chunksOffset += chunk.info.storedSize;
+            chunks.push_back(std::move(chunk));
+        }
+    } catch (string& e) {
+        cerr << e << endl;
+        return EXIT_FAILURE;
+    }
+    header.headersSize += sizeof(uint32_t) + chunks.size() * sizeof(z0::ZRes::ChunkInfo);
+
     if (verbose) { z0::ZRes::print(header); }
 
     // header.headersPadding = calculatePadding(header.headersSize, VK_FORMAT_BC1_RGBA_UNORM_BLOCK); // use largest padding
@@ -543,6 +952,9 @@ int main(const int argc, char** argv) {
             // ZScene::print(uvsInfos[meshIndex][surfaceIndex][0]);
             // ZScene::print(uvsInfos[meshIndex][surfaceIndex][1]);
             outputFile.write(reinterpret_cast<const char*>(uvsInfos[meshIndex][surfaceIndex].data()), uvsInfos[meshIndex][surfaceIndex].size() * sizeof(z0::ZRes::DataInfo));
+            const auto surfaceLodsCount = static_cast<uint32_t>(lodsInfos[meshIndex][surfaceIndex].size());
+            outputFile.write(reinterpret_cast<const char*>(&surfaceLodsCount), sizeof(uint32_t));
+            outputFile.write(reinterpret_cast<const char*>(lodsInfos[meshIndex][surfaceIndex].data()), surfaceLodsCount * sizeof(z0::ZRes::DataInfo));
         }
     }
     for (auto nodeIndex = 0; nodeIndex < gltf.nodes.size(); ++nodeIndex) {
@@ -553,75 +965,28 @@ int main(const int argc, char** argv) {
         outputFile.write(reinterpret_cast<const char*>(&animationHeaders[animationIndex]),sizeof(z0::ZRes::AnimationHeader));
         outputFile.write(reinterpret_cast<const char*>(tracksInfos[animationIndex].data()),tracksInfos[animationIndex].size() * sizeof(z0::ZRes::TrackInfo));
     }
-
-    // Write meshes data
-    if (verbose) { cout << "\tMeshes data...\n"; }
-    uint32_t count = indices.size();
-    outputFile.write(reinterpret_cast<const char*>(&count),sizeof(uint32_t));
-    outputFile.write(reinterpret_cast<const char*>(indices.data()),count * sizeof(uint32_t));
-
-    count = positions.size();
-    outputFile.write(reinterpret_cast<const char*>(&count),sizeof(uint32_t));
-    outputFile.write(reinterpret_cast<const char*>(positions.data()),count * sizeof(glm::vec3));
-
-    count = normals.size();
-    outputFile.write(reinterpret_cast<const char*>(&count),sizeof(uint32_t));
-    outputFile.write(reinterpret_cast<const char*>(normals.data()),count * sizeof(glm::vec3));
-
-    count = uvs.size();
-    outputFile.write(reinterpret_cast<const char*>(&count),sizeof(uint32_t));
-    outputFile.write(reinterpret_cast<const char*>(uvs.data()),count * sizeof(glm::vec2));
-
-    count = tangents.size();
-    outputFile.write(reinterpret_cast<const char*>(&count),sizeof(uint32_t));
-    outputFile.write(reinterpret_cast<const char*>(tangents.data()),count * sizeof(glm::vec4));
-
-    // cout << format("{} indices, {} positions, {} normals, {} uvs, {} tangents",
-        // indices.size(), positions.size(), normals.size(), uvs.size(), tangents.size()) << endl;
-    // for(const auto&p : positions) {
-        // cout << to_string(p) << endl;
-    // }
-
-    // Write animations data
-    if (verbose) { cout << "\tAnimations data...\n"; }
-    for (auto animationIndex = 0; animationIndex < gltf.animations.size(); animationIndex++) {
-        const auto &animation = animationHeaders[animationIndex];
-        for (auto trackIndex = 0; trackIndex < animation.tracksCount; trackIndex++) {
-            outputFile.write(
-                reinterpret_cast<const char*>(tracksKeyTimes[animationIndex][trackIndex].data()),
-                sizeof(float) * tracksKeyTimes[animationIndex][trackIndex].size());
-            outputFile.write(
-                reinterpret_cast<const char*>(tracksKeyValues[animationIndex][trackIndex].data()),
-                sizeof(glm::vec3) * tracksKeyValues[animationIndex][trackIndex].size());
-        }
+    const auto skinsCount = static_cast<uint32_t>(skinHeaders.size());
+    outputFile.write(reinterpret_cast<const char*>(&skinsCount), sizeof(uint32_t));
+    for (auto skinIndex = 0; skinIndex < skinHeaders.size(); ++skinIndex) {
+        outputFile.write(reinterpret_cast<const char*>(&skinHeaders[skinIndex]),sizeof(z0::ZRes::SkinHeader));
+        outputFile.write(reinterpret_cast<const char*>(jointsInfos[skinIndex].data()),jointsInfos[skinIndex].size() * sizeof(z0::ZRes::JointInfo));
     }
 
+    // Write the chunks table
+    const auto chunksCount = static_cast<uint32_t>(chunks.size());
+    outputFile.write(reinterpret_cast<const char*>(&chunksCount), sizeof(uint32_t));
+    for (const auto& chunk : chunks) {
+        if (verbose) { z0::ZRes::print(chunk.info); }
+        outputFile.write(reinterpret_cast<const char*>(&chunk.info), sizeof(z0::ZRes::ChunkInfo));
+    }
 
-    // Write images
-    if (verbose) { cout << "\tImages data...\n"; }
-    for (auto imageIndex = 0; imageIndex < gltf.images.size(); imageIndex++) {
-        const auto& mipOut = outMipLevels.at(imageIndex);
-        // saveImageDDS("out" + to_string(imageIndex) + ".dds", mipOut, formatName);
-        // z0::ZScene::print(imageHeaders[imageIndex]);
-        // if (verbose) {
-            // std::printf("Writing image %d %dx%d...\n", imageIndex,
-                // mipOut[0].width,
-                // mipOut[0].height);
-        // }
-        for(auto mipLevel = 0; mipLevel <mipOut.size(); ++mipLevel) {
-            // std::printf("Writing image %d level %d %dx%d (%llu, %llu, %llu)...\n", imageIndex, mipLevel,
-            //     mipOut[mipLevel].width,
-            //     mipOut[mipLevel].height,
-            //     mipOut[mipLevel].dataSize,
-            //     mipHeaders[imageIndex][mipLevel].offset,
-            //     mipHeaders[imageIndex][mipLevel].size);
-            outputFile.write(
-                reinterpret_cast<const char*>(mipOut[mipLevel].data->data()),
-                mipOut[mipLevel].data->size());
-            if (!outputFile) {
-                cerr << "Error writing to file!" << endl;
-                return 1;
-            }
+    // Write the meshes, animations & images data
+    if (verbose) { cout << "\tChunks data...\n"; }
+    for (const auto& chunk : chunks) {
+        outputFile.write(chunk.data.data(), chunk.data.size());
+        if (!outputFile) {
+            cerr << "Error writing to file!" << endl;
+            return 1;
         }
     }
 
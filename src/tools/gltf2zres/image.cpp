@@ -35,14 +35,20 @@ struct JobUnit {
 queue<JobUnit> jobsQueue;
 mutex          jobsQueueMutex;
 
+// Compression quality & number of threads used to compress each image
+Quality        compressionQuality{Quality::NORMAL};
+uint32_t       compressionThreads{1};
+
 // Used to check the image compatibility with the compression format
 const map<uint32_t, uint32_t> blockSizes = {
     { VK_FORMAT_BC1_RGBA_UNORM_BLOCK,  8 },
     { VK_FORMAT_BC1_RGBA_SRGB_BLOCK,  8 },
     { VK_FORMAT_BC2_UNORM_BLOCK,  16 },
     { VK_FORMAT_BC2_SRGB_BLOCK,  16 },
+    { VK_FORMAT_BC3_UNORM_BLOCK,  16 },
     { VK_FORMAT_BC3_SRGB_BLOCK,  16 },
     { VK_FORMAT_BC4_UNORM_BLOCK,  16 },
+    { VK_FORMAT_BC4_SNORM_BLOCK,  16 },
     { VK_FORMAT_BC5_UNORM_BLOCK,  8 },
     { VK_FORMAT_BC5_SNORM_BLOCK,  8 },
     { VK_FORMAT_BC7_UNORM_BLOCK,  16 },
@@ -105,7 +111,7 @@ void generateMipMaps(vector<MipLevel>& outMipLevels,
 }
 
 // Load the image from the raw data buffer into an RGBA uncompressed image,
-// generate the mipmaps using the CPU and run the converter on each mipmap level using the GPU
+// generate the mipmaps and run the converter on each mipmap level
 void loadAndConvertImage(const string&     name,
                          vector<MipLevel>& outMipLevels,
                          const void*       srcData,
@@ -174,7 +180,7 @@ void loadAndConvertImage(const string&     name,
 
         // Compress all the mipmaps levels
         outMipLevels.resize(inMipLevels.size());
-        const Converter converter; // We use one converter per image to allow multi-threading
+        const Converter converter{compressionQuality, compressionThreads};
         {
             auto lock = lock_guard(loadingThreadsExceptionMutex);
             if (loadingThreadsException) { return; }
@@ -193,7 +199,10 @@ void loadAndConvertImage(const string&     name,
     }
 }
 
-void startImagesLoading(const int maxThreads) {
+void startImagesLoading(const int maxThreads, const Quality quality) {
+    // The threads not needed to load the images are used to compress the blocks of each image
+    compressionQuality = quality;
+    compressionThreads = std::max(1u, static_cast<uint32_t>(maxThreads) / std::max(1u, static_cast<uint32_t>(jobsQueue.size())));
     // Start maxThreads threads to load & transcode the images in multi-threaded batch mode
     for (auto i = 0; i < maxThreads; i++) {
         loadingThreads.push_back(thread([i] {
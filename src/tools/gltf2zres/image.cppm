@@ -29,7 +29,7 @@ struct Format {
 export const map<string, Format> formats = {
     { "bc1",  {VK_FORMAT_BC1_RGBA_UNORM_BLOCK, VK_FORMAT_BC1_RGBA_SRGB_BLOCK}},
     { "bc2",  { VK_FORMAT_BC2_UNORM_BLOCK, VK_FORMAT_BC2_SRGB_BLOCK}},
-    { "bc3",  { VK_FORMAT_BC3_SRGB_BLOCK, VK_FORMAT_BC3_SRGB_BLOCK}},
+    { "bc3",  { VK_FORMAT_BC3_UNORM_BLOCK, VK_FORMAT_BC3_SRGB_BLOCK}},
     { "bc4",  { VK_FORMAT_BC4_UNORM_BLOCK, VK_FORMAT_BC4_UNORM_BLOCK}},
     { "bc4s", { VK_FORMAT_BC4_SNORM_BLOCK, VK_FORMAT_BC4_SNORM_BLOCK}},
     { "bc5",  { VK_FORMAT_BC5_UNORM_BLOCK, VK_FORMAT_BC5_UNORM_BLOCK}},
@@ -46,7 +46,7 @@ export void equeueImageLoading(fastgltf::Asset&   asset,
                                bool               verbose);
 
 // Start maxThreads threads to load & convert the images in multi-threaded batch mode
-export void startImagesLoading(int maxThread);
+export void startImagesLoading(int maxThread, Quality quality);
 
 // export uint32_t calculatePadding(const uint64_t size, const uint32_t format);
 // export void saveImageDDS(const string& filename, const vector<MipLevel>& outMipLevels, const string& dstFormat);
@@ -26,9 +26,11 @@ import z0.InputEvent;
 import z0.Loader;
 import z0.Log;
 import z0.Tools;
+import z0.Tween;
 import z0.TypeRegistry;
 import z0.Window;
 
+import z0.nodes.AnimationPlayer;
 import z0.nodes.Camera;
 import z0.nodes.CollisionArea;
 import z0.nodes.DirectionalLight;
@@ -122,6 +124,7 @@ namespace z0 {
         _lockDeferredUpdate();
         {
             auto lock = lock_guard(frameDataMutex);
+            nodesByType[node->getType()].insert(node);
             for (auto& frame : frameData) {
                 if (async) {
                     frame.addedNodesAsync.push_back(node );
@@ -157,6 +160,10 @@ namespace z0 {
                 }
             }
         }
+        {
+            auto lock = lock_guard(frameDataMutex);
+            nodesByType[node->getType()].erase(node);
+        }
         node->_setAddedToScene(false);
         node->_onExitScene();
         _unlockDeferredUpdate();
@@ -228,10 +235,18 @@ namespace z0 {
             while (accumulator >= dt) {
                 physicsSystem.Update(dt, 1, temp_allocator.get(), job_system.get());
                 physicsProcess(rootNode, dt);
+                Node::_beginTransformBatch();
+                TweenManager::_update(dt);
+                Node::_endTransformBatch();
+                TweenManager::_runCallbacks();
                 t += dt;
                 accumulator -= dt;
             }
             process(rootNode, static_cast<float>(accumulator / dt));
+            Node::_beginTransformBatch();
+            AnimationPlayer::_updatePlayers();
+            Node::_endTransformBatch();
+            AnimationPlayer::_emitFinished();
         }
         renderFrame(currentFrame);
         currentFrame = (currentFrame + 1) % applicationConfig.framesInFlight;
@@ -289,14 +304,15 @@ namespace z0 {
     bool Application::input(const shared_ptr<Node> &node, InputEvent &inputEvent) {
         // TRACE();
         assert(node != nullptr);
-        if (!node->_isAddedToScene()) {
+        // skip the subtrees without any node receiving input events
+        if ((!node->_isAddedToScene()) || (node->_getInputListeners() == 0)) {
             return false;
         }
         for (auto &child : node->_getChildren()) {
             if (input(child, inputEvent))
                 return true;
         }
-        if (node->isProcessed()) {
+        if (node->isProcessInput() && node->isProcessed()) {
             return node->onInput(inputEvent);
         }
         return false;
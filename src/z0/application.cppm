@@ -199,6 +199,23 @@ namespace z0 {
          */
         inline auto getDisplayDebug() const { return displayDebug; }
 
+        /**
+         * Returns all the nodes of the given type currently in the scene tree.<br>
+         * Uses the per-type registry updated when nodes enter or exit the scene, the scene tree is not walked.
+         * Nodes are registered under their own type only : an OmniLight is not returned for Node::LIGHT.
+         */
+        template <typename T = Node>
+        [[nodiscard]] list<shared_ptr<T>> findAllNodes(const Node::Type type) {
+            auto lock = lock_guard(frameDataMutex);
+            list<shared_ptr<T>> result;
+            for (const auto &node : nodesByType[type]) {
+                if (const auto &found = dynamic_pointer_cast<T>(node)) {
+                    result.push_back(found);
+                }
+            }
+            return result;
+        }
+
         virtual void addPostprocessing(const string& fragShaderName, void* data = nullptr, uint32_t dataSize = 0) = 0;
 
         virtual void removePostprocessing(const string& fragShaderName) = 0;
@@ -298,6 +315,8 @@ namespace z0 {
         };
         vector<FrameData> frameData;
         mutex frameDataMutex;
+        // Nodes currently in the scene tree, by type. Protected by frameDataMutex
+        array<unordered_set<shared_ptr<Node>>, Node::TypeNames.size()> nodesByType;
         bool doDeferredUpdates{true};
 
         // Deferred nodes calls, to be called after processDeferredUpdates()
@@ -344,6 +363,9 @@ namespace z0 {
 
         unique_ptr<JPH::TempAllocatorImpl> &_getTempAllocator() { return temp_allocator; }
 
+        // Persistent worker threads shared by the physics system and the engine
+        JPH::JobSystem &_getJobSystem() const { return *job_system; }
+
         // Add a node to the current scene
         void _addNode(const shared_ptr<Node> &node, bool async);
 
@@ -70,16 +70,35 @@ export namespace z0 {
         vec3             clearColor                 = WINDOW_CLEAR_COLOR;
         //! Number of simultaneous frames during rendering
         uint32_t         framesInFlight             = 3;
+        //! Size in bytes, for each frame in flight, of the ring buffer used by the renderers for the per-frame uniform data
+        uint64_t         frameDataSize              = 1024 * 1024;
         //! Size (width & height) in pixels of the cascaded (directional lights) shadow maps
         uint32_t         cascadedShadowMapSize      = 4096;
         //! Size (width & height) in pixels of the omni & spotlights shadow maps
         uint32_t         pointLightShadowMapSize    = 1024;
+        //! Bin the omni & spot lights into the clusters with a compute shader. Set to `false` to use the CPU implementation
+        bool             gpuLightsCulling           = true;
+        //! Skip the models hidden behind the depth pre-pass of the previous frames (hierarchical-Z occlusion culling). Needs `useDepthPrepass`.
+        //! The models becoming visible appear a few frames late when the camera moves
+        bool             occlusionCulling           = false;
         //! Enable the debug renderer
         bool             debug                      = false;
         //! Configuration for the debug rendering
         DebugConfig      debugConfig                = {};
         //! Threshold for meshes simplification with meshoptimizer (only works with one surface meshes), 1.0f -> no simplification
         float            meshSimplifyThreshold      = 1.0f;
+        //! Number of levels of detail of the meshes, including the full detail level (1 to 5), for the meshes without precomputed levels. 1 -> no levels of detail
+        uint32_t         meshLODCount               = 4;
+        //! Size, relative to the screen height, of a mesh bounding sphere under which the first simplified level of detail is used. Each next level is used under the half of the previous size
+        float            meshLODScreenSize          = 0.25f;
+        //! Relative margin around the levels of detail screen sizes to avoid switching back and forth between two levels
+        float            meshLODHysteresis          = 0.1f;
+        //! Number of levels of detail added to the level of a mesh for the shadow maps
+        uint32_t         shadowLODBias              = 1;
+        //! Directory, relative to appDir, for the precomputed image based lighting maps. Empty to disable the cache
+        string           iblCacheDir                = "ibl_cache";
+        //! Directory, relative to appDir, for the shader binaries & pipeline cache of the GPU driver. Empty to disable the cache
+        string           shaderCacheDir             = "shader_cache";
         //! Name for the default vertex shader for the scene renderer
         string           sceneVertexShader          = "default";
         //! Name for the default fragment shader for the scene renderer
@@ -272,7 +272,13 @@ export namespace z0 {
      */
     enum class TransitionType : uint8_t {
         /** The animation is interpolated linearly */
-        LINEAR = 0,
+        LINEAR      = 0,
+        /** The animation starts slowly and accelerates (quadratic) */
+        EASE_IN     = 1,
+        /** The animation starts quickly and decelerates (quadratic) */
+        EASE_OUT    = 2,
+        /** The animation accelerates then decelerates (quadratic) */
+        EASE_IN_OUT = 3,
     };
 
     /**
@@ -811,4 +817,14 @@ export namespace z0 {
         LINEAR  = 1,
     };
 
+    /**
+     * How an animation layer is combined with the animations played below it
+     */
+    enum class AnimationBlendMode : uint8_t {
+        //! The layer values replace the values below, in proportion of the layer weight (default)
+        OVERRIDE = 0,
+        //! The differences between the layer values and the first keys of the layer animation are added to the values below
+        ADDITIVE = 1,
+    };
+
 }
@@ -5,6 +5,7 @@
  * https://opensource.org/licenses/MIT
 */
 module;
+#include <glm/gtx/matrix_decompose.hpp>
 #include <glm/gtx/quaternion.hpp>
 #include <fastgltf/core.hpp>
 #include <fastgltf/glm_element_traits.hpp>
@@ -15,6 +16,7 @@ module;
 module z0.GlTF;
 
 import z0.Constants;
+import z0.KTX2;
 import z0.Tools;
 import z0.VirtualFS;
 
@@ -28,6 +30,7 @@ import z0.resources.Image;
 import z0.resources.Material;
 import z0.resources.Mesh;
 import z0.resources.Resource;
+import z0.resources.Skeleton;
 import z0.resources.Texture;
 
 import z0.vulkan.Buffer;
@@ -88,6 +91,7 @@ namespace z0 {
         auto &device = Device::get();
         auto getter = VirtualFS::openGltf(filepath);
         fastgltf::Parser parser{fastgltf::Extensions::KHR_materials_specular |
+                                fastgltf::Extensions::KHR_texture_basisu |
                                 fastgltf::Extensions::KHR_texture_transform |
                                 fastgltf::Extensions::KHR_materials_emissive_strength};
         constexpr auto gltfOptions =
@@ -157,6 +161,19 @@ namespace z0 {
                                      const void   * srcData,
                                      const size_t   size,
                                      const VkFormat format) -> shared_ptr<Image> {
+                if (KTX2::isKTX2(srcData, size)) {
+                    // Unsupported files are replaced by the fallback image of the texture, if any
+                    if (!KTX2::isSupported(srcData, size)) { return nullptr; }
+                    // Block compressed images are uploaded with their mip levels, in the color space of the file
+                    const auto ktx = KTX2{srcData, size, name};
+                    if (ktx.getFaces() != 1 || !device.isFormatSupported(static_cast<VkFormat>(ktx.getFormat()))) {
+                        return nullptr;
+                    }
+                    return make_shared<VulkanImage>(
+                        device, name,
+                        ktx, static_cast<VkFormat>(ktx.getFormat()),
+                        magFilter, minFilter, wrapU, wrapV);
+                }
                 int width, height, channels;
                 auto *data = stbi_load_from_memory(static_cast<stbi_uc const *>(srcData),
                                                             static_cast<int>(size),
@@ -180,18 +197,24 @@ namespace z0 {
                 const auto& texture = gltf.textures.at(sourceTextureInfo.textureIndex);
                 materialsTexCoords[material->getId()] = sourceTextureInfo.texCoordIndex;
                 if (texture.samplerIndex.has_value()) { convertSamplerData(texture); }
-                shared_ptr<Image> image;
-                if (texture.imageIndex.has_value()) {
-                    const auto imageIndex = texture.imageIndex.value();
-                    if (images.contains(imageIndex)) {
-                        image = images[imageIndex];
-                    } else {
-                        image = loadImage(gltf, gltf.images[imageIndex], format, loadImageRGBA);
-                        images.emplace(imageIndex, image);
+                auto getImage = [&](const size_t imageIndex) {
+                    if (!images.contains(imageIndex)) {
+                        images.emplace(imageIndex, loadImage(gltf, gltf.images[imageIndex], format, loadImageRGBA));
                     }
-                } else {
+                    return images[imageIndex];
+                };
+                if (!texture.basisuImageIndex.has_value() && !texture.imageIndex.has_value()) {
                     die("Texture without supported image category");
                 }
+                shared_ptr<Image> image;
+                // KHR_texture_basisu images are KTX2 files, preferred over the fallback image
+                // when their payload can be used without transcoding
+                if (texture.basisuImageIndex.has_value()) {
+                    image = getImage(texture.basisuImageIndex.value());
+                }
+                if (image == nullptr && texture.imageIndex.has_value()) {
+                    image = getImage(texture.imageIndex.value());
+                }
                 if (image == nullptr) return StandardMaterial::TextureInfo{};
                 auto texInfo = StandardMaterial::TextureInfo {
                     .texture = make_shared<ImageTexture>(image)
@@ -287,6 +310,23 @@ namespace z0 {
                             });
                     }
                 }
+                // load skinning joints & weights
+                {
+                    auto joints = p.findAttribute("JOINTS_0");
+                    auto weights = p.findAttribute("WEIGHTS_0");
+                    if (joints != p.attributes.end() && weights != p.attributes.end()) {
+                        auto &skinVertices = mesh->getSkinVertices();
+                        skinVertices.resize(vertices.size());
+                        fastgltf::iterateAccessorWithIndex<uvec4>(
+                            gltf, gltf.accessors[joints->accessorIndex], [&](const uvec4 v, const size_t index) {
+                                skinVertices[index + initial_vtx].joints = v;
+                            });
+                        fastgltf::iterateAccessorWithIndex<vec4>(
+                            gltf, gltf.accessors[weights->accessorIndex], [&](const vec4 v, const size_t index) {
+                                skinVertices[index + initial_vtx].weights = v;
+                            });
+                    }
+                }
                 if (p.materialIndex.has_value()) {
                     // associate material to surface and keep track of all materials used in the Mesh
                     const auto& material     = materials[p.materialIndex.value()];
@@ -337,6 +377,10 @@ namespace z0 {
                 }
                 mesh->getSurfaces().push_back(surface);
             }
+            // The skinning attributes are parallel to the vertices
+            if (!mesh->getSkinVertices().empty()) {
+                mesh->getSkinVertices().resize(vertices.size());
+            }
             // Check if we already have a similar mesh
             auto it = std::find(meshes.begin(), meshes.end(), mesh);
             if (it != meshes.end()) {
@@ -351,24 +395,13 @@ namespace z0 {
             // to_string(images.size()), "images,",
             // to_string(meshes.size()), "meshes (", to_string(meshesCount), "uniques)");
 
-        // load all nodes and their meshes
-        vector<shared_ptr<Node>> nodes;
-        for (const auto &node : gltf.nodes) {
-            shared_ptr<Node> newNode;
-            string           name{node.name.data()};
-            // find if the node has a mesh, and if it does hook it to the mesh pointer and allocate it with the
-            // MeshInstance class
-            if (node.meshIndex.has_value()) {
-                auto mesh = meshes[*node.meshIndex];
-                mesh->buildModel();
-                newNode = make_shared<MeshInstance>(mesh, name);
-            } else {
-                newNode = make_shared<Node>(name);
-            }
-
+        // local & world transforms of the nodes, used by the nodes, the skeletons and the animations
+        auto localTransforms = vector<mat4>(gltf.nodes.size(), mat4{1.0f});
+        auto parents = vector<int32_t>(gltf.nodes.size(), -1);
+        for (auto i = 0; i < gltf.nodes.size(); i++) {
             visit(fastgltf::visitor{
               [&](fastgltf::math::fmat4x4 matrix) {
-                  memcpy(&newNode->_getTransformLocal(), matrix.data(), sizeof(matrix));
+                  memcpy(&localTransforms[i], matrix.data(), sizeof(matrix));
               },
               [&](fastgltf::TRS transform) {
                   const vec3 tl(transform.translation[0], transform.translation[1], transform.translation[2]);
@@ -380,85 +413,191 @@ namespace z0 {
                   const mat4 tm = translate(mat4(1.f), tl);
                   const mat4 rm = toMat4(rot);
                   const mat4 sm = scale(mat4(1.f), sc);
-                  newNode->_setTransform(tm * rm * sm);
+                  localTransforms[i] = tm * rm * sm;
               }},
-              node.transform);
+              gltf.nodes[i].transform);
+            for (const auto child : gltf.nodes[i].children) {
+                parents[child] = i;
+            }
+        }
+        auto worldTransforms = vector<optional<mat4>>(gltf.nodes.size());
+        const function<mat4(int32_t)> getWorldTransform = [&](const int32_t nodeIndex) {
+            if (nodeIndex == -1) { return mat4{1.0f}; }
+            if (!worldTransforms[nodeIndex].has_value()) {
+                worldTransforms[nodeIndex] = getWorldTransform(parents[nodeIndex]) * localTransforms[nodeIndex];
+            }
+            return worldTransforms[nodeIndex].value();
+        };
+        const auto getRestTransform = [&](const size_t nodeIndex) {
+            auto rest = Skeleton::JointTransform{};
+            vec3 skew;
+            vec4 perspective;
+            decompose(localTransforms[nodeIndex], rest.scale, rest.rotation, rest.position, skew, perspective);
+            return rest;
+        };
+
+        // build the skeletons of the skinned meshes, the joints are indexed like in the glTF skin.
+        // skinnedJoints associates each joint node with the skinned nodes & joints indices it animates
+        auto skinnedJoints = map<size_t, vector<pair<size_t, int32_t>>>{};
+        for (auto i = 0; i < gltf.nodes.size(); i++) {
+            const auto& node = gltf.nodes[i];
+            if (!node.skinIndex.has_value() || !node.meshIndex.has_value()) { continue; }
+            const auto& mesh = meshes[node.meshIndex.value()];
+            if (mesh->getSkinVertices().empty()) { continue; }
+            const auto& skin = gltf.skins[node.skinIndex.value()];
+            auto inverseBindMatrices = vector<mat4>(skin.joints.size(), mat4{1.0f});
+            if (skin.inverseBindMatrices.has_value()) {
+                fastgltf::copyFromAccessor<mat4>(
+                    gltf, gltf.accessors[skin.inverseBindMatrices.value()], inverseBindMatrices.data());
+            }
+            auto joints = vector<Skeleton::Joint>(skin.joints.size());
+            auto rootTransform = optional<mat4>{};
+            for (auto jointIndex = 0; jointIndex < skin.joints.size(); jointIndex++) {
+                const auto jointNode = skin.joints[jointIndex];
+                const auto parent = ranges::find(skin.joints, static_cast<size_t>(parents[jointNode]));
+                auto& joint = joints[jointIndex];
+                joint.name = gltf.nodes[jointNode].name.data();
+                joint.parent = parent == skin.joints.end() ? -1 : static_cast<int32_t>(std::distance(skin.joints.begin(), parent));
+                joint.inverseBindMatrix = inverseBindMatrices[jointIndex];
+                joint.rest = getRestTransform(jointNode);
+                // the skinned node transform is ignored by glTF, the joints are moved in the mesh space
+                if (joint.parent == -1 && !rootTransform.has_value()) {
+                    rootTransform = inverse(getWorldTransform(i)) * getWorldTransform(parents[jointNode]);
+                }
+                skinnedJoints[jointNode].push_back({i, jointIndex});
+            }
+            if (mesh->getSkeleton() == nullptr) {
+                mesh->setSkeleton(make_shared<Skeleton>(joints, rootTransform.value_or(mat4{1.0f}), skin.name.data()));
+            }
+        }
+
+        // load all nodes and their meshes
+        vector<shared_ptr<Node>> nodes;
+        for (auto i = 0; i < gltf.nodes.size(); i++) {
+            const auto &node = gltf.nodes[i];
+            shared_ptr<Node> newNode;
+            string           name{node.name.data()};
+            // find if the node has a mesh, and if it does hook it to the mesh pointer and allocate it with the
+            // MeshInstance class
+            if (node.meshIndex.has_value()) {
+                auto mesh = meshes[*node.meshIndex];
+                mesh->buildModel();
+                newNode = make_shared<MeshInstance>(mesh, name);
+            } else {
+                newNode = make_shared<Node>(name);
+            }
+            newNode->_setTransform(localTransforms[i]);
             newNode->_updateTransform(mat4{1.0f});
             nodes.push_back(newNode);
         }
 
-        // Read the animations
-        auto animationPlayers = map<uint32_t, shared_ptr<AnimationPlayer>>{};
+        // Read the animations.
+        // The channels of the nodes are tracks relative to the node transform, shared by the animation players
+        // of all the animated nodes. The channels of the joints are absolute joint tracks, in one animation per
+        // skinned node.
+        auto animationPlayers = map<size_t, shared_ptr<AnimationPlayer>>{};
+        const auto getAnimationPlayer = [&](const size_t nodeIndex) {
+            if (!animationPlayers.contains(nodeIndex)) {
+                auto animationPlayer = make_shared<AnimationPlayer>();
+                animationPlayer->add("", make_shared<AnimationLibrary>());
+                animationPlayers[nodeIndex] = animationPlayer;
+                nodes[nodeIndex]->addChild(animationPlayer);
+            }
+            return animationPlayers[nodeIndex];
+        };
+        const auto loadTrack = [&](const fastgltf::Animation& animation,
+                                   const fastgltf::AnimationChannel& channel,
+                                   Animation::Track& track,
+                                   const int32_t joint) {
+            const auto &sampler = animation.samplers.at(channel.samplerIndex);
+            const auto&inputAccessor = gltf.accessors.at(sampler.inputAccessor);
+            track.keyTime.resize(inputAccessor.count);
+            fastgltf::copyFromAccessor<float>(gltf, inputAccessor, track.keyTime.data());
+
+            track.duration = track.keyTime.back() + track.keyTime.front();
+            track.interpolation =
+                sampler.interpolation == fastgltf::AnimationInterpolation::Linear ?
+                    AnimationInterpolation::LINEAR :
+                    AnimationInterpolation::STEP;
+            track.joint = joint;
+
+            const auto rest = getRestTransform(channel.nodeIndex.value());
+            const auto&outputAccessor = gltf.accessors.at(sampler.outputAccessor);
+            // can't use copyFromAccessor here because of the translation to the node relative transform
+            switch (channel.path) {
+                case fastgltf::AnimationPath::Translation: {
+                    track.type = AnimationType::TRANSLATION;
+                    track.keyValue.resize(outputAccessor.count);
+                    fastgltf::iterateAccessorWithIndex<vec3>(
+                        gltf, outputAccessor, [&](const vec3 vec, const size_t index) {
+                            track.keyValue[index] = joint == -1 ? vec - rest.position : vec;
+                    });
+                    break;
+                }
+                case fastgltf::AnimationPath::Rotation: {
+                    track.type = AnimationType::ROTATION;
+                    track.keyRotation.resize(outputAccessor.count);
+                    const auto inverseRest = inverse(rest.rotation);
+                    fastgltf::iterateAccessorWithIndex<vec4>(
+                        gltf, outputAccessor, [&](const vec4 vec, const size_t index) {
+                            const auto rotation = quat(vec.w, vec.x, vec.y, vec.z);
+                            track.keyRotation[index] = joint == -1 ? inverseRest * rotation : rotation;
+                    });
+                    break;
+                }
+                case fastgltf::AnimationPath::Scale: {
+                    track.type = AnimationType::SCALE;
+                    track.keyValue.resize(outputAccessor.count);
+                    fastgltf::iterateAccessorWithIndex<vec3>(
+                        gltf, outputAccessor, [&](const vec3 vec, const size_t index) {
+                            track.keyValue[index] = joint == -1 ? vec - rest.scale : vec;
+                    });
+                    break;
+                }
+                default:
+                    break;
+            }
+        };
         for (const auto& animation : gltf.animations) {
-            auto anim = make_shared<Animation>(static_cast<uint32_t>(animation.channels.size()), animation.name.data());
-            for (auto trackIndex = 0; trackIndex < animation.channels.size(); trackIndex++) {
-                const auto& channel = animation.channels[trackIndex];
-                if (!channel.nodeIndex.has_value()) {
+            const string name{animation.name.data()};
+            auto nodeChannels = vector<const fastgltf::AnimationChannel*>{};
+            auto jointChannels = map<size_t, vector<pair<const fastgltf::AnimationChannel*, int32_t>>>{};
+            for (const auto& channel : animation.channels) {
+                // morph targets weights are not supported
+                if (!channel.nodeIndex.has_value() || channel.path == fastgltf::AnimationPath::Weights) {
                     continue;
                 }
-                auto animationPlayer = shared_ptr<AnimationPlayer>{};
-                auto nodeIndex = channel.nodeIndex.value();
-                if (animationPlayers.contains(nodeIndex)) {
-                    animationPlayer = animationPlayers[nodeIndex];
+                const auto nodeIndex = channel.nodeIndex.value();
+                if (skinnedJoints.contains(nodeIndex)) {
+                    for (const auto& [skinnedNode, joint] : skinnedJoints[nodeIndex]) {
+                        jointChannels[skinnedNode].push_back({&channel, joint});
+                    }
                 } else {
-                    animationPlayer = make_shared<AnimationPlayer>();
-                    animationPlayer->add("", make_shared<AnimationLibrary>());
-                    animationPlayers[nodeIndex] = animationPlayer;
-                    nodes[nodeIndex]->addChild(animationPlayer);
+                    nodeChannels.push_back(&channel);
                 }
-                animationPlayer->getLibrary()->add(animation.name.data(), anim);
-                animationPlayer->setCurrentAnimation(animation.name.data());
-                auto& track = anim->getTrack(trackIndex);
-
-                const auto &sampler = animation.samplers.at(channel.samplerIndex);
-                const auto&inputAccessor = gltf.accessors.at(sampler.inputAccessor);
-                track.keyTime.resize(inputAccessor.count);
-                fastgltf::copyFromAccessor<float>(gltf, inputAccessor, track.keyTime.data());
-
-                track.duration = track.keyTime.back() + track.keyTime.front();
-                track.interpolation =
-                    sampler.interpolation == fastgltf::AnimationInterpolation::Linear ?
-                        AnimationInterpolation::LINEAR :
-                        AnimationInterpolation::STEP;
-
-                const auto&outputAccessor = gltf.accessors.at(sampler.outputAccessor);
-                track.keyValue.resize(outputAccessor.count);
-                // can't use copyFromAccessor here because of variant
-                /*switch (channel.path) {
-                    case fastgltf::AnimationPath::Translation: {
-                        track.type = AnimationType::TRANSLATION;
-                        fastgltf::iterateAccessorWithIndex<vec3>(
-                            gltf, outputAccessor, [&](const vec3 vec, const size_t index) {
-                                track.keyValue[index] = vec;
-                        });
-                        break;
-                    }
-                    case fastgltf::AnimationPath::Rotation: {
-                        track.type = AnimationType::ROTATION;
-                        fastgltf::iterateAccessorWithIndex<vec4>(
-                            gltf, outputAccessor, [&](const vec4 vec, const size_t index) {
-                                track.keyValue[index] = quat(vec.w, vec.x, vec.y, vec.z);
-                        });
-                        break;
-                    }
-                    case fastgltf::AnimationPath::Scale: {
-                        track.type = AnimationType::SCALE;
-                        fastgltf::iterateAccessorWithIndex<vec3>(
-                            gltf, outputAccessor, [&](const vec3 vec, const size_t index) {
-                                track.keyValue[index] = vec;
-                        });
-                        break;
-                    }
-                    default:
-                        break;
-                }*/
+            }
+            if (!nodeChannels.empty()) {
+                auto anim = make_shared<Animation>(static_cast<uint32_t>(nodeChannels.size()), name);
+                for (auto trackIndex = 0; trackIndex < nodeChannels.size(); trackIndex++) {
+                    const auto& channel = *nodeChannels[trackIndex];
+                    loadTrack(animation, channel, anim->getTrack(trackIndex), -1);
+                    const auto animationPlayer = getAnimationPlayer(channel.nodeIndex.value());
+                    animationPlayer->getLibrary()->add(name, anim);
+                    animationPlayer->setCurrentAnimation(name);
+                }
+            }
+            for (const auto& [skinnedNode, channels] : jointChannels) {
+                auto anim = make_shared<Animation>(static_cast<uint32_t>(channels.size()), name);
+                for (auto trackIndex = 0; trackIndex < channels.size(); trackIndex++) {
+                    const auto& [channel, joint] = channels[trackIndex];
+                    loadTrack(animation, *channel, anim->getTrack(trackIndex), joint);
+                }
+                const auto animationPlayer = getAnimationPlayer(skinnedNode);
+                animationPlayer->getLibrary()->add(name, anim);
+                animationPlayer->setCurrentAnimation(name);
             }
         }
 
-        // for (auto [k,v] : animationPlayers) {
-        //     v->getNode()->addChild(v);
-        // }
-
         // Build node tree
         for (uint32_t i = 0; i < gltf.nodes.size(); i++) {
             fastgltf::Node   &node      = gltf.nodes[i];
@@ -25,29 +25,65 @@ import z0.Window;
 
 namespace z0 {
 
-    void Input::addAction(const InputAction& action) {
-        inputActions[action.name] = action;
+    uint32_t Input::addAction(const InputAction& action) {
+        CompiledAction compiled;
+        for (const auto& entry : action.entries) {
+            switch (entry.type) {
+            case InputActionEntry::KEYBOARD:
+                (entry.pressed ? compiled.keysPressed : compiled.keysReleased).set(entry.value);
+                break;
+            case InputActionEntry::MOUSE:
+                (entry.pressed ? compiled.mouseButtonsPressed : compiled.mouseButtonsReleased) |= entry.value;
+                break;
+            case InputActionEntry::GAMEPAD:
+                if (entry.value < GAMEPAD_BUTTONS_COUNT) {
+                    (entry.pressed ? compiled.gamepadButtonsPressed : compiled.gamepadButtonsReleased).set(entry.value);
+                }
+                break;
+            }
+        }
+        if (inputActionsIds.contains(action.name)) {
+            const auto id = inputActionsIds[action.name];
+            inputActions[id] = compiled;
+            return id;
+        }
+        const auto id = static_cast<uint32_t>(inputActions.size());
+        inputActions.push_back(compiled);
+        inputActionsIds[action.name] = id;
+        return id;
+    }
+
+    uint32_t Input::getActionId(const string& actionName) {
+        const auto it = inputActionsIds.find(actionName);
+        return it == inputActionsIds.end() ? INVALID_ACTION : it->second;
     }
 
     bool Input::isAction(const string& actionName, const InputEvent &inputEvent) {
-        auto result = false;
-        if (inputActions.contains(actionName)) {
-            const auto& action = inputActions[actionName];
-            for (const auto& entry : action.entries) {
-                if (entry.type == InputActionEntry::KEYBOARD && inputEvent.getType() == InputEventType::KEY) {
-                    const auto &event = dynamic_cast<const InputEventKey &>(inputEvent);
-                    result = (event.getKey() == entry.value) && (event.isPressed() == entry.pressed) ;
-                } else if (entry.type == InputActionEntry::MOUSE && inputEvent.getType() == InputEventType::MOUSE_BUTTON) {
-                    const auto &event = dynamic_cast<const InputEventMouseButton &>(inputEvent);
-                    result = (static_cast<uint8_t>(event.getMouseButton()) & entry.value) && (event.isPressed() == entry.pressed);
-                } else if (entry.type == InputActionEntry::GAMEPAD && inputEvent.getType() == InputEventType::GAMEPAD_BUTTON) {
-                    const auto &event = dynamic_cast<const InputEventGamepadButton &>(inputEvent);
-                    result = (static_cast<uint8_t>(event.getGamepadButton()) & entry.value) && (event.isPressed() == entry.pressed);
-                }
-                if (result) { break; }
-            }
+        return isAction(getActionId(actionName), inputEvent);
+    }
+
+    bool Input::isAction(const uint32_t actionId, const InputEvent &inputEvent) {
+        if (actionId >= inputActions.size()) { return false; }
+        const auto& action = inputActions[actionId];
+        // the event type is checked first, so the static casts are safe
+        switch (inputEvent.getType()) {
+        case InputEventType::KEY: {
+            const auto &event = static_cast<const InputEventKey &>(inputEvent);
+            return (event.isPressed() ? action.keysPressed : action.keysReleased).test(event.getKey());
+        }
+        case InputEventType::MOUSE_BUTTON: {
+            const auto &event = static_cast<const InputEventMouseButton &>(inputEvent);
+            return (event.isPressed() ? action.mouseButtonsPressed : action.mouseButtonsReleased) &
+                    static_cast<uint8_t>(event.getMouseButton());
+        }
+        case InputEventType::GAMEPAD_BUTTON: {
+            const auto &event = static_cast<const InputEventGamepadButton &>(inputEvent);
+            return (event.isPressed() ? action.gamepadButtonsPressed : action.gamepadButtonsReleased).test(
+                    static_cast<size_t>(event.getGamepadButton()));
+        }
+        default:
+            return false;
         }
-        return result;
     }
 
     bool Input::isKeyPressed(const Key key) {
@@ -55,25 +91,25 @@ namespace z0 {
     }
 
     bool Input::isKeyJustPressed(const Key key) {
-        const auto result          = _keyJustPressedStates[key];
+        const bool result          = _keyJustPressedStates[key];
         _keyJustPressedStates[key] = false;
         return result;
     }
 
     bool Input::isKeyJustReleased(const Key key) {
-        const auto result           = _keyJustReleasedStates[key];
+        const bool result           = _keyJustReleasedStates[key];
         _keyJustReleasedStates[key] = false;
         return result;
     }
 
     bool Input::isGamepadButtonJustPressed(const GamepadButton button) {
-        const auto result = _gamepadButtonJustPressedStates[button];
+        const bool result = _gamepadButtonJustPressedStates[button];
         _gamepadButtonJustPressedStates[button] = false;
         return result;
     }
 
     bool Input::isGamepadButtonJustReleased(const GamepadButton button) {
-        const auto result = _gamepadButtonJustReleasedStates[button];
+        const bool result = _gamepadButtonJustReleasedStates[button];
         _gamepadButtonJustReleasedStates[button] = false;
         return result;
     }
@@ -83,26 +119,26 @@ namespace z0 {
     }
 
     bool Input::isMouseButtonJustPressed(const MouseButton mouseButton) {
-        const auto result                          = _mouseButtonJustPressedStates[mouseButton];
+        const bool result                          = _mouseButtonJustPressedStates[mouseButton];
         _mouseButtonJustPressedStates[mouseButton] = false;
         return result;
     }
 
     bool Input::isMouseButtonJustReleased(const MouseButton mouseButton) {
-        const auto result                           = _mouseButtonJustReleasedStates[mouseButton];
+        const bool result                           = _mouseButtonJustReleasedStates[mouseButton];
         _mouseButtonJustReleasedStates[mouseButton] = false;
         return result;
     }
 
-    unordered_map<Key, bool>           Input::_keyPressedStates;
-    unordered_map<Key, bool>           Input::_keyJustPressedStates;
-    unordered_map<Key, bool>           Input::_keyJustReleasedStates;
-    unordered_map<MouseButton, bool>   Input::_mouseButtonPressedStates;
-    unordered_map<MouseButton, bool>   Input::_mouseButtonJustPressedStates;
-    unordered_map<MouseButton, bool>   Input::_mouseButtonJustReleasedStates;
-    unordered_map<GamepadButton, bool> Input::_gamepadButtonPressedStates;
-    unordered_map<GamepadButton, bool> Input::_gamepadButtonJustPressedStates;
-    unordered_map<GamepadButton, bool> Input::_gamepadButtonJustReleasedStates;
+    InputStates<Key, Input::KEYS_COUNT>                      Input::_keyPressedStates;
+    InputStates<Key, Input::KEYS_COUNT>                      Input::_keyJustPressedStates;
+    InputStates<Key, Input::KEYS_COUNT>                      Input::_keyJustReleasedStates;
+    InputStates<MouseButton, Input::MOUSE_BUTTONS_COUNT>     Input::_mouseButtonPressedStates;
+    InputStates<MouseButton, Input::MOUSE_BUTTONS_COUNT>     Input::_mouseButtonJustPressedStates;
+    InputStates<MouseButton, Input::MOUSE_BUTTONS_COUNT>     Input::_mouseButtonJustReleasedStates;
+    InputStates<GamepadButton, Input::GAMEPAD_BUTTONS_COUNT> Input::_gamepadButtonPressedStates;
+    InputStates<GamepadButton, Input::GAMEPAD_BUTTONS_COUNT> Input::_gamepadButtonJustPressedStates;
+    InputStates<GamepadButton, Input::GAMEPAD_BUTTONS_COUNT> Input::_gamepadButtonJustReleasedStates;
 
     static map<Key, OsKey> _keyMap{
             {KEY_SPACE, OS_KEY_SPACE},
@@ -217,15 +253,18 @@ namespace z0 {
     }
 
     Key Input::osKeyToKey(OsKey key) {
-        auto it = find_if(_keyMap.begin(),
-                          _keyMap.end(),
-                          [&key] (const auto &p) {
-                              return p.second == key;
-                          });
-
-        if (it != _keyMap.end())
-            return it->first;
-        return KEY_NONE;
+        // Reverse lookup table indexed by scan code, built once from the keys map
+        static const auto osKeyMap = [] {
+            array<Key, Input::KEYS_COUNT> table;
+            table.fill(KEY_NONE);
+            for (const auto &[k, osKey] : _keyMap) {
+                if (osKey < table.size() && table[osKey] == KEY_NONE) {
+                    table[osKey] = k;
+                }
+            }
+            return table;
+        }();
+        return (key >= 0 && key < osKeyMap.size()) ? osKeyMap[key] : KEY_NONE;
     }
 
     float Input::applyDeadzone(const float value, const float deadzonePercent) {
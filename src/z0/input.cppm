@@ -29,6 +29,18 @@ export namespace z0 {
         vector<InputActionEntry> entries;
     };
 
+    /**
+     * Fixed-size pressed/released states table for keys or buttons, indexed by code
+     */
+    template<typename T, size_t N>
+    struct InputStates {
+        bitset<N> states;
+
+        inline auto operator[](const T code) { return states[static_cast<size_t>(code)]; }
+
+        inline bool operator[](const T code) const { return states[static_cast<size_t>(code)]; }
+    };
+
     /**
      * %A singleton for handling inputs
      */
@@ -128,25 +140,59 @@ export namespace z0 {
         static bool isGamepadButtonJustReleased(GamepadButton button);
         static bool isGamepadButtonJustPressed(GamepadButton button);
 
-        static void addAction(const InputAction& action);
-        static bool isAction(const string& actionName, const InputEvent &inputEvent);
+        /**
+         * Adds (or replaces) an input action. The action entries are compiled into lookup tables.
+         * @return the action id, to use with the faster version of isAction()
+         */
+        static uint32_t addAction(const InputAction& action);
+
+        /**
+         * Returns the id of an action, or INVALID_ACTION if the action does not exist
+         */
+        [[nodiscard]] static uint32_t getActionId(const string& actionName);
+
+        /**
+         * Returns `true` if the event matches one of the action entries
+         */
+        [[nodiscard]] static bool isAction(const string& actionName, const InputEvent &inputEvent);
+
+        /**
+         * Returns `true` if the event matches one of the action entries, without the action name lookup
+         */
+        [[nodiscard]] static bool isAction(uint32_t actionId, const InputEvent &inputEvent);
+
+        static constexpr uint32_t INVALID_ACTION = numeric_limits<uint32_t>::max();
+
+        static constexpr size_t KEYS_COUNT{256};
+        static constexpr size_t MOUSE_BUTTONS_COUNT{16};
+        static constexpr size_t GAMEPAD_BUTTONS_COUNT{static_cast<size_t>(GamepadButton::LAST) + 1};
 
     private:
-        static inline map<string, InputAction> inputActions;
+        // Action entries compiled into lookup tables, indexed by key or button code
+        struct CompiledAction {
+            bitset<KEYS_COUNT>            keysPressed;
+            bitset<KEYS_COUNT>            keysReleased;
+            uint8_t                       mouseButtonsPressed{0};
+            uint8_t                       mouseButtonsReleased{0};
+            bitset<GAMEPAD_BUTTONS_COUNT> gamepadButtonsPressed;
+            bitset<GAMEPAD_BUTTONS_COUNT> gamepadButtonsReleased;
+        };
+        static inline unordered_map<string, uint32_t> inputActionsIds;
+        static inline vector<CompiledAction>           inputActions;
 
         [[nodiscard]] static float applyDeadzone(float value, float deadzonePercent);
         static void generateGamepadButtonEvent(GamepadButton, bool);
 
     public:
-        static unordered_map<Key, bool> _keyPressedStates;
-        static unordered_map<Key, bool> _keyJustPressedStates;
-        static unordered_map<Key, bool> _keyJustReleasedStates;
-        static unordered_map<MouseButton, bool> _mouseButtonPressedStates;
-        static unordered_map<MouseButton, bool> _mouseButtonJustPressedStates;
-        static unordered_map<MouseButton, bool> _mouseButtonJustReleasedStates;
-        static unordered_map<GamepadButton, bool> _gamepadButtonPressedStates;
-        static unordered_map<GamepadButton, bool> _gamepadButtonJustPressedStates;
-        static unordered_map<GamepadButton, bool> _gamepadButtonJustReleasedStates;
+        static InputStates<Key, KEYS_COUNT>                      _keyPressedStates;
+        static InputStates<Key, KEYS_COUNT>                      _keyJustPressedStates;
+        static InputStates<Key, KEYS_COUNT>                      _keyJustReleasedStates;
+        static InputStates<MouseButton, MOUSE_BUTTONS_COUNT>     _mouseButtonPressedStates;
+        static InputStates<MouseButton, MOUSE_BUTTONS_COUNT>     _mouseButtonJustPressedStates;
+        static InputStates<MouseButton, MOUSE_BUTTONS_COUNT>     _mouseButtonJustReleasedStates;
+        static InputStates<GamepadButton, GAMEPAD_BUTTONS_COUNT> _gamepadButtonPressedStates;
+        static InputStates<GamepadButton, GAMEPAD_BUTTONS_COUNT> _gamepadButtonJustPressedStates;
+        static InputStates<GamepadButton, GAMEPAD_BUTTONS_COUNT> _gamepadButtonJustReleasedStates;
 
         static OsKey keyToOsKey(Key key);
         static Key osKeyToKey(OsKey key);
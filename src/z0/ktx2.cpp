@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2024-2025 Henri Michelon
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+*/
+module;
+#include "z0/libraries.h"
+
+module z0.KTX2;
+
+import z0.Tools;
+
+namespace z0 {
+
+    // https://registry.khronos.org/KTX/specs/2.0/ktxspec.v2.html#_file_structure
+    struct KTX2Header {
+        uint8_t  identifier[12];
+        uint32_t vkFormat;
+        uint32_t typeSize;
+        uint32_t pixelWidth;
+        uint32_t pixelHeight;
+        uint32_t pixelDepth;
+        uint32_t layerCount;
+        uint32_t faceCount;
+        uint32_t levelCount;
+        uint32_t supercompressionScheme;
+        uint32_t dfdByteOffset;
+        uint32_t dfdByteLength;
+        uint32_t kvdByteOffset;
+        uint32_t kvdByteLength;
+        uint64_t sgdByteOffset;
+        uint64_t sgdByteLength;
+    };
+
+    struct KTX2LevelIndex {
+        uint64_t byteOffset;
+        uint64_t byteLength;
+        uint64_t uncompressedByteLength;
+    };
+
+    bool KTX2::isKTX2(const void* data, const uint64_t size) {
+        return size >= sizeof(IDENTIFIER) && memcmp(data, IDENTIFIER, sizeof(IDENTIFIER)) == 0;
+    }
+
+    bool KTX2::isSupported(const void* data, const uint64_t size) {
+        if (!isKTX2(data, size) || size < sizeof(KTX2Header)) { return false; }
+        KTX2Header header;
+        memcpy(&header, data, sizeof(KTX2Header));
+        return header.vkFormat != 0 &&
+               header.supercompressionScheme == 0 &&
+               header.pixelDepth <= 1 &&
+               header.layerCount <= 1 &&
+               header.pixelHeight != 0 &&
+               (header.faceCount == 1 || header.faceCount == 6);
+    }
+
+    KTX2::KTX2(const void* data, const uint64_t size, const string& name):
+        data{static_cast<const byte*>(data)}, dataSize{size} {
+        if (!isKTX2(data, size) || size < sizeof(KTX2Header)) {
+            die("Invalid KTX2 file", name);
+        }
+        KTX2Header header;
+        memcpy(&header, data, sizeof(KTX2Header));
+        if (header.vkFormat == 0) {
+            die("KTX2 Basis Universal payloads are not supported, transcode", name, "to a BCn or ASTC format");
+        }
+        if (header.supercompressionScheme != 0) {
+            die("KTX2 supercompression is not supported for", name);
+        }
+        if (header.pixelDepth > 1 || header.layerCount > 1 || header.pixelHeight == 0) {
+            die("Only 2D and cubemap KTX2 files are supported for", name);
+        }
+        if (header.faceCount != 1 && header.faceCount != 6) {
+            die("Invalid KTX2 faces count for", name);
+        }
+        format = header.vkFormat;
+        width  = header.pixelWidth;
+        height = header.pixelHeight;
+        faces  = header.faceCount;
+
+        // A level count of 0 asks for the mip levels to be generated at load time, which is not possible for
+        // block compressed formats : only the base level is used
+        const auto levelCount = std::max(1u, header.levelCount);
+        if (size < sizeof(KTX2Header) + levelCount * sizeof(KTX2LevelIndex)) {
+            die("Invalid KTX2 level index for", name);
+        }
+        levels.resize(levelCount);
+        for (uint32_t level = 0; level < levelCount; level++) {
+            KTX2LevelIndex index;
+            memcpy(&index, this->data + sizeof(KTX2Header) + level * sizeof(KTX2LevelIndex), sizeof(KTX2LevelIndex));
+            if (index.byteOffset + index.byteLength > size) {
+                die("Truncated KTX2 file", name);
+            }
+            levels[level] = { index.byteOffset, index.byteLength };
+        }
+    }
+
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2024-2025 Henri Michelon
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+*/
+module;
+#include "z0/libraries.h"
+
+export module z0.KTX2;
+
+export namespace z0 {
+
+    /*
+     * Reader for the [KTX2](https://registry.khronos.org/KTX/specs/2.0/ktxspec.v2.html) texture container.<br>
+     * Only the non-supercompressed 2D textures and cubemaps are supported : the payload, usually BCn or ASTC
+     * compressed, is uploaded as is in GPU memory with all its precomputed mip levels.
+     * Basis Universal payloads must be transcoded offline, for example with `ktx transcode`.
+     */
+    class KTX2 {
+    public:
+        /*
+         * KTX2 file identifier
+         */
+        static constexpr uint8_t IDENTIFIER[]{ 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+        /*
+         * One mip level, for all the faces
+         */
+        struct Level {
+            //! Start of the level, relative to the start of the file
+            uint64_t offset;
+            //! Size in bytes of the level, for all the faces
+            uint64_t size;
+        };
+
+        /*
+         * Parses the header and the level index of a KTX2 file stored in memory.<br>
+         * The file data must stay alive as long as this object.
+         */
+        KTX2(const void* data, uint64_t size, const string& name);
+
+        /*
+         * Returns `true` if the data starts with the KTX2 identifier
+         */
+        [[nodiscard]] static bool isKTX2(const void* data, uint64_t size);
+
+        /*
+         * Returns `true` if the file is a 2D texture or a cubemap with a payload that can be uploaded without
+         * transcoding nor decompression. The format support of the GPU is not checked.
+         */
+        [[nodiscard]] static bool isSupported(const void* data, uint64_t size);
+
+        /*
+         * Returns the [VkFormat](https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkFormat.html) of the payload
+         */
+        [[nodiscard]] inline auto getFormat() const { return format; }
+
+        [[nodiscard]] inline auto getWidth() const { return width; }
+
+        [[nodiscard]] inline auto getHeight() const { return height; }
+
+        /*
+         * Returns the number of faces, 6 for a cubemap
+         */
+        [[nodiscard]] inline auto getFaces() const { return faces; }
+
+        /*
+         * Returns the mip levels, from the biggest to the smallest
+         */
+        [[nodiscard]] inline const auto& getLevels() const { return levels; }
+
+        /*
+         * Returns the size in bytes of one face of a mip level
+         */
+        [[nodiscard]] inline auto getFaceSize(const uint32_t level) const { return levels.at(level).size / faces; }
+
+        /*
+         * Returns the file data
+         */
+        [[nodiscard]] inline auto getData() const { return data; }
+
+        /*
+         * Returns the size in bytes of the file data
+         */
+        [[nodiscard]] inline auto getDataSize() const { return dataSize; }
+
+    private:
+        const byte*   data;
+        uint64_t      dataSize;
+        uint32_t      format{0};
+        uint32_t      width{0};
+        uint32_t      height{0};
+        uint32_t      faces{1};
+        vector<Level> levels;
+    };
+
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2024-2025 Henri Michelon
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+*/
+module;
+#include "z0/libraries.h"
+
+module z0.LightClusters;
+
+import z0.AABB;
+
+namespace z0 {
+
+    void LightClusters::setProjection(const mat4& projection, const float nearDistance, const float farDistance) {
+        if ((this->projection == projection) && (this->nearDistance == nearDistance) && (this->farDistance == farDistance)) {
+            return;
+        }
+        this->projection = projection;
+        this->nearDistance = nearDistance;
+        this->farDistance = farDistance;
+        // Exponential depth slices : slice = log(depth / near) * CLUSTERS_Z / log(far / near)
+        sliceScale = static_cast<float>(CLUSTERS_Z) / std::log(farDistance / nearDistance);
+        sliceBias = -static_cast<float>(CLUSTERS_Z) * std::log(nearDistance) / std::log(farDistance / nearDistance);
+
+        // Same computation as in light_clusters.comp
+        const auto inverseProjection = inverse(projection);
+        const auto tileSize = vec2{2.0f / CLUSTERS_X, 2.0f / CLUSTERS_Y};
+        bounds.resize(CLUSTERS_COUNT);
+        for (auto z = 0; z < CLUSTERS_Z; z++) {
+            const auto nearDepth = getSliceDepth(z);
+            const auto farDepth = getSliceDepth(z + 1);
+            for (auto y = 0; y < CLUSTERS_Y; y++) {
+                for (auto x = 0; x < CLUSTERS_X; x++) {
+                    auto minBounds = vec3{numeric_limits<float>::max()};
+                    auto maxBounds = vec3{numeric_limits<float>::lowest()};
+                    for (auto corner = 0; corner < 4; corner++) {
+                        // Ray from the camera to the tile corner
+                        const auto ndc = vec2{-1.0f} + (vec2{x, y} + vec2{corner & 1, corner >> 1}) * tileSize;
+                        auto ray = inverseProjection * vec4{ndc, 0.0f, 1.0f};
+                        const auto point = vec3{ray} / ray.w;
+                        const auto nearPoint = point * (nearDepth / -point.z);
+                        const auto farPoint = point * (farDepth / -point.z);
+                        minBounds = min(minBounds, min(nearPoint, farPoint));
+                        maxBounds = max(maxBounds, max(nearPoint, farPoint));
+                    }
+                    bounds[getClusterIndex(x, y, z)] = AABB{minBounds, maxBounds};
+                }
+            }
+        }
+    }
+
+    void LightClusters::bin(const mat4& view, const vector<LightSphere>& lights, const uint32_t firstIndex, Grid& grid) const {
+        grid.counts.fill(0);
+        if (bounds.empty()) { return; }
+        // Lights are visited in order so each cluster list is sorted like the lists built by the compute shader
+        for (auto lightIndex = 0; lightIndex < lights.size(); lightIndex++) {
+            const auto& light = lights[lightIndex];
+            const auto center = vec3{view * vec4{light.center, 1.0f}};
+            const auto depth = -center.z;
+            if ((depth + light.radius < nearDistance) || (depth - light.radius > farDistance)) {
+                continue;
+            }
+            // Only the depth slices overlapped by the light sphere can be touched
+            const auto firstSlice = getSlice(std::max(depth - light.radius, nearDistance));
+            const auto lastSlice = getSlice(std::min(depth + light.radius, farDistance));
+            const auto radius2 = light.radius * light.radius;
+            for (auto z = firstSlice; z <= lastSlice; z++) {
+                for (auto y = 0; y < CLUSTERS_Y; y++) {
+                    for (auto x = 0; x < CLUSTERS_X; x++) {
+                        const auto clusterIndex = getClusterIndex(x, y, z);
+                        const auto& aabb = bounds[clusterIndex];
+                        const auto closest = clamp(center, aabb.min, aabb.max);
+                        const auto distance = closest - center;
+                        auto& count = grid.counts[clusterIndex];
+                        if ((dot(distance, distance) <= radius2) && (count < MAX_LIGHTS_PER_CLUSTER)) {
+                            grid.indices[clusterIndex * MAX_LIGHTS_PER_CLUSTER + count] = firstIndex + lightIndex;
+                            count += 1;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    uint32_t LightClusters::getSlice(const float depth) const {
+        const auto slice = static_cast<int32_t>(std::log(depth) * sliceScale + sliceBias);
+        return static_cast<uint32_t>(std::clamp(slice, 0, static_cast<int32_t>(CLUSTERS_Z) - 1));
+    }
+
+    float LightClusters::getSliceDepth(const uint32_t slice) const {
+        return std::exp((static_cast<float>(slice) - sliceBias) / sliceScale);
+    }
+
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2024-2025 Henri Michelon
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+*/
+module;
+#include "z0/libraries.h"
+
+export module z0.LightClusters;
+
+import z0.AABB;
+
+export namespace z0 {
+
+    /**
+     * Clustered forward lighting : the camera frustum is divided into a 3D grid of clusters (froxels),
+     * CLUSTERS_X * CLUSTERS_Y screen tiles and CLUSTERS_Z exponential depth slices.
+     * Each cluster references the omni and spot lights touching it so the fragment shader
+     * only evaluates the lights of the fragment's cluster.<br>
+     * The binning is done on the GPU by the `light_clusters.comp` compute shader, this class is the CPU reference
+     * implementation of the same binning, used when ApplicationConfig::gpuLightsCulling is `false`.
+     */
+    class LightClusters {
+    public:
+        //! Number of screen tiles on the X axis
+        static constexpr uint32_t CLUSTERS_X{16};
+        //! Number of screen tiles on the Y axis
+        static constexpr uint32_t CLUSTERS_Y{9};
+        //! Number of depth slices
+        static constexpr uint32_t CLUSTERS_Z{24};
+        //! Total number of clusters
+        static constexpr uint32_t CLUSTERS_COUNT{CLUSTERS_X * CLUSTERS_Y * CLUSTERS_Z};
+        //! Maximum number of lights referenced by a cluster
+        static constexpr uint32_t MAX_LIGHTS_PER_CLUSTER{64};
+
+        /**
+         * Bounding sphere of an omni or spot light, in global space
+         */
+        struct LightSphere {
+            vec3  center;
+            float radius;
+        };
+
+        /**
+         * Lights lists of all the clusters, with the same memory layout as the GPU buffer
+         */
+        struct Grid {
+            //! Number of lights of each cluster
+            array<uint32_t, CLUSTERS_COUNT> counts;
+            //! Lights indices, MAX_LIGHTS_PER_CLUSTER entries per cluster
+            array<uint32_t, CLUSTERS_COUNT * MAX_LIGHTS_PER_CLUSTER> indices;
+        };
+
+        /**
+         * Computes the clusters bounds for a camera. Does nothing if the projection did not change.
+         * @param projection camera projection matrix
+         * @param nearDistance camera near clipping distance
+         * @param farDistance camera far clipping distance
+         */
+        void setProjection(const mat4& projection, float nearDistance, float farDistance);
+
+        /**
+         * Bins the lights into the clusters
+         * @param view camera view matrix
+         * @param lights bounding spheres of the lights
+         * @param firstIndex index of the first light in the lights buffer
+         * @param grid destination lists
+         */
+        void bin(const mat4& view, const vector<LightSphere>& lights, uint32_t firstIndex, Grid& grid) const;
+
+        /**
+         * Returns the scale of the depth slices : `slice = log(depth) * scale + bias`
+         */
+        [[nodiscard]] inline auto getSliceScale() const { return sliceScale; }
+
+        /**
+         * Returns the bias of the depth slices : `slice = log(depth) * scale + bias`
+         */
+        [[nodiscard]] inline auto getSliceBias() const { return sliceBias; }
+
+        /**
+         * Returns the bounds of a cluster in view space
+         */
+        [[nodiscard]] inline const auto& getClusterBounds(const uint32_t index) const { return bounds[index]; }
+
+        /**
+         * Returns the cluster index in the lights lists
+         */
+        [[nodiscard]] static constexpr uint32_t getClusterIndex(const uint32_t x, const uint32_t y, const uint32_t z) {
+            return x + y * CLUSTERS_X + z * CLUSTERS_X * CLUSTERS_Y;
+        }
+
+    private:
+        mat4         projection{0.0f};
+        float        nearDistance{0.0f};
+        float        farDistance{0.0f};
+        float        sliceScale{0.0f};
+        float        sliceBias{0.0f};
+        // Clusters bounds in view space
+        vector<AABB> bounds;
+
+        // Depth slice for a positive view space depth
+        [[nodiscard]] uint32_t getSlice(float depth) const;
+
+        // View space depth of the near side of a slice
+        [[nodiscard]] float getSliceDepth(uint32_t slice) const;
+    };
+
+}
@@ -24,6 +24,8 @@ import z0.nodes.AnimationPlayer;
 import z0.nodes.MeshInstance;
 import z0.nodes.Node;
 
+import z0.resources.Prefab;
+
 namespace z0 {
 
     mutex Loader::resourcesMutex;
@@ -47,13 +49,28 @@ namespace z0 {
         }
     }
 
+    shared_ptr<Prefab> Loader::loadPrefab(const string& filepath) {
+        {
+            auto lock = lock_guard(resourcesMutex);
+            if (prefabs.contains(filepath)) {
+                return prefabs[filepath];
+            }
+        }
+        const auto prefab = make_shared<Prefab>(load(filepath, false), filepath);
+        auto lock = lock_guard(resourcesMutex);
+        prefabs[filepath] = prefab;
+        return prefab;
+    }
+
     void Loader::clearCache() {
         resources.clear();
+        prefabs.clear();
     }
 
     void Loader::addNode(Node *parent,
                          map<string, shared_ptr<Node>> &nodeTree,
                          map<string, SceneNode> &sceneTree,
+                         map<string, shared_ptr<Prefab>> &prefabTree,
                          const SceneNode &nodeDesc) {
         constexpr auto log_name{"Scene loader :"};
         if (nodeTree.contains(nodeDesc.id)) {
@@ -125,7 +142,12 @@ namespace z0 {
                     auto &childNode = nodeTree[child.id];
                     if (child.needDuplicate) {
                         // _LOG("Loader child.needDuplicate ", childNode->getName());
-                        parentNode->addChild(childNode->duplicate());
+                        // the flattened template is reused for all the copies of the same node.
+                        // The template is a detached copy : the node itself can be part of the scene and modified
+                        if (!prefabTree.contains(child.id)) {
+                            prefabTree[child.id] = make_shared<Prefab>(childNode->duplicate(), child.id);
+                        }
+                        parentNode->addChild(prefabTree[child.id]->instantiate());
                     } else {
                         // _LOG("Loader !child.needDuplicate ", childNode->getName());
                         if (childNode->getParent() != nullptr) {
@@ -135,7 +157,7 @@ namespace z0 {
                     }
                 } else {
                     // _LOG("Loader child addNode ", child.id);
-                    addNode(parentNode.get(), nodeTree, sceneTree, child);
+                    addNode(parentNode.get(), nodeTree, sceneTree, prefabTree, child);
                 }
             }
             for (const auto &prop : nodeDesc.properties) {
@@ -155,8 +177,9 @@ namespace z0 {
         // const auto tStart = chrono::high_resolution_clock::now();
         map<string, shared_ptr<Node>> nodeTree;
         map<string, SceneNode>        sceneTree;
+        map<string, shared_ptr<Prefab>> prefabTree;
         for (const auto &nodeDesc : loadSceneDescriptionFromJSON(filepath)) {
-            addNode(rootNode.get(), nodeTree, sceneTree, nodeDesc);
+            addNode(rootNode.get(), nodeTree, sceneTree, prefabTree, nodeDesc);
         }
         // https://jrouwe.github.io/JoltPhysics/class_physics_system.html#ab3cd9f2562f0f051c032b3bc298d9604
         app()._getPhysicsSystem().OptimizeBroadPhase();
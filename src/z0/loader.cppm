@@ -11,6 +11,8 @@ export module z0.Loader;
 
 import z0.nodes.Node;
 
+import z0.resources.Prefab;
+
 export namespace z0 {
     /**
      * Singleton for loading external resources
@@ -36,6 +38,14 @@ export namespace z0 {
             return rootNode;
         }
 
+        /**
+         * Load a JSON, glTF or ZRes file as an immutable Prefab template, to spawn multiple
+         * instances of the same resource without deep-copying the node tree with Node::duplicate().<br>
+         * Prefabs are cached by file path, separately from the resources cache, and released by clearCache().
+         * @param filepath path of the JSON/glTF/ZRes file, relative to the application path
+         */
+        static shared_ptr<Prefab> loadPrefab(const string& filepath);
+
         template<typename T = Node>
         static shared_ptr<T> findFirst(const string& nodename) {
             for (const auto& cachedResources : resources) {
@@ -71,6 +81,7 @@ export namespace z0 {
 
     private:
         static inline map<string, shared_ptr<Node>> resources;
+        static inline map<string, shared_ptr<Prefab>> prefabs;
         static mutex resourcesMutex;
 
         static void load(const shared_ptr<Node>&rootNode, const string& filepath, bool usecache);
@@ -79,10 +90,11 @@ export namespace z0 {
 
         [[nodiscard]] static vector<SceneNode> loadSceneDescriptionFromJSON(const string &filepath);
 
-        static void addNode(Node *                         parent,
-                            map<string, shared_ptr<Node>> &nodeTree,
-                            map<string, SceneNode> &       sceneTree,
-                            const SceneNode &              nodeDesc);
+        static void addNode(Node *                           parent,
+                            map<string, shared_ptr<Node>> &  nodeTree,
+                            map<string, SceneNode> &         sceneTree,
+                            map<string, shared_ptr<Prefab>> &prefabTree,
+                            const SceneNode &                nodeDesc);
     };
 
 }
@@ -5,77 +5,337 @@
  * https://opensource.org/licenses/MIT
 */
 module;
+#include <glm/gtx/matrix_decompose.hpp>
 #include <glm/gtx/quaternion.hpp>
+#include <Jolt/Jolt.h>
+#include <Jolt/Core/JobSystem.h>
 #include "z0/libraries.h"
 
 module z0.nodes.AnimationPlayer;
 
+import z0.Application;
 import z0.Constants;
 import z0.Log;
 import z0.Tools;
 
+import z0.nodes.MeshInstance;
+
 namespace z0 {
 
     void AnimationPlayer::seek(const float duration) {
-        const auto animation = getAnimation();
-        for (auto trackIndex = 0; trackIndex < animation->getTracksCount(); trackIndex++) {
-            const auto& value = animation->getInterpolatedValue(
-                       trackIndex,
-                       duration,
-                       false);
-            currentTracksState[trackIndex] = value.frameTime;
-            apply(value);
+        playingAnimation = getAnimation();
+        if (!playingAnimation || !target) { return; }
+        tracksCursors.resize(playingAnimation->getTracksCount());
+        auto position = vec3{};
+        auto rotation = quat{};
+        auto scale = vec3{};
+        auto animated = uint8_t{0};
+        auto ended = uint8_t{0};
+        sample(chrono::steady_clock::now(), duration, true, position, rotation, scale, animated, ended);
+        apply(position, rotation, scale, animated);
+    }
+
+    void AnimationPlayer::sample(const time_point& now,
+                                 const double time,
+                                 const bool seeking,
+                                 vec3& position,
+                                 quat& rotation,
+                                 vec3& scale,
+                                 uint8_t& animated,
+                                 uint8_t& ended) {
+        animated = 0;
+        ended = false;
+        const auto jointsCount = skinnedTarget == nullptr ? 0 : skinnedTarget->getPose().size();
+        accumulators.assign(1 + jointsCount, Accumulator{});
+        blended.resize(1 + jointsCount);
+        blendedAnimated.assign(1 + jointsCount, 0);
+
+        // Current animation, with its fade in weight
+        if (playingAnimation) {
+            const auto weight = mainFade.getWeight(now);
+            for (auto trackIndex = 0; trackIndex < playingAnimation->getTracksCount(); trackIndex++) {
+                const auto& value = playingAnimation->getInterpolatedValue(
+                    trackIndex,
+                    seeking ? time : time + lastTracksState[trackIndex],
+                    !seeking && reverse,
+                    tracksCursors[trackIndex]);
+                currentTracksState[trackIndex] = value.frameTime;
+                if (value.ended && !seeking) {
+                    ended = true;
+                    continue;
+                }
+                accumulate(value, weight);
+            }
+        }
+
+        // Previous animations, removed at the end of their fade out
+        erase_if(fadingClips, [&now](const FadingClip& clip) { return clip.fade.isDone(now); });
+        for (auto& clip : fadingClips) {
+            const auto weight = clip.fade.getWeight(now);
+            const auto clipTime = chrono::duration<double>(now - clip.startTime).count();
+            for (auto trackIndex = 0; trackIndex < clip.animation->getTracksCount(); trackIndex++) {
+                accumulate(clip.animation->getInterpolatedValue(
+                               trackIndex,
+                               clipTime + clip.lastTracksState[trackIndex],
+                               clip.reverse,
+                               clip.cursors[trackIndex]),
+                           weight);
+            }
+        }
+
+        // Normalized weighted average of the accumulated values. When the sum of the weights is below 1.0 the
+        // values are completed with the rest transform : the initial transform for the target,
+        // the rest pose for the joints.
+        for (auto index = 0; index < accumulators.size(); index++) {
+            const auto& accumulator = accumulators[index];
+            auto& value = blended[index];
+            auto rest = Skeleton::JointTransform{};
+            if (index == 0) {
+                value = Skeleton::JointTransform{ .scale = vec3{0.0f} };
+                rest = value;
+            } else {
+                // The joints not animated keep their current values
+                value = skinnedTarget->getPose()[index - 1];
+                rest = skinnedTarget->getMesh()->getSkeleton()->getJoints()[index - 1].rest;
+            }
+            if (accumulator.positionWeight > 0.0f) {
+                const auto fill = std::max(0.0f, 1.0f - accumulator.positionWeight);
+                value.position = (accumulator.position + fill * rest.position) /
+                                 std::max(1.0f, accumulator.positionWeight);
+                blendedAnimated[index] |= ANIMATED_POSITION;
+            }
+            if (accumulator.rotationWeight > 0.0f) {
+                const auto fill = std::max(0.0f, 1.0f - accumulator.rotationWeight);
+                auto restRotation = vec4{rest.rotation.x, rest.rotation.y, rest.rotation.z, rest.rotation.w};
+                if (dot(accumulator.rotation, restRotation) < 0.0f) { restRotation = -restRotation; }
+                const auto sum = accumulator.rotation + fill * restRotation;
+                value.rotation = normalize(quat{sum.w, sum.x, sum.y, sum.z});
+                blendedAnimated[index] |= ANIMATED_ROTATION;
+            }
+            if (accumulator.scaleWeight > 0.0f) {
+                const auto fill = std::max(0.0f, 1.0f - accumulator.scaleWeight);
+                value.scale = (accumulator.scale + fill * rest.scale) /
+                              std::max(1.0f, accumulator.scaleWeight);
+                blendedAnimated[index] |= ANIMATED_SCALE;
+            }
+        }
+
+        // Layers, in order, on top of the blended values
+        erase_if(layers, [&now](const Layer& layer) { return layer.stopping && layer.fade.isDone(now); });
+        for (auto& layer : layers) {
+            const auto weight = layer.fade.getWeight(now);
+            if (weight <= 0.0f) { continue; }
+            const auto layerTime = chrono::duration<double>(now - layer.startTime).count();
+            for (auto trackIndex = 0; trackIndex < layer.animation->getTracksCount(); trackIndex++) {
+                const auto index = static_cast<size_t>(layer.animation->getTrack(trackIndex).joint + 1);
+                if (index >= blended.size()) { continue; }
+                if (layer.masked && (index >= layer.mask.size() || !layer.mask[index])) { continue; }
+                blendLayer(layer,
+                           trackIndex,
+                           layer.animation->getInterpolatedValue(trackIndex, layerTime, false, layer.cursors[trackIndex]),
+                           weight);
+            }
+        }
+
+        // The target transform is written by the main thread, the pose only belongs to this player
+        animated = blendedAnimated[0];
+        position = initialPosition + blended[0].position;
+        rotation = initialRotation * blended[0].rotation;
+        scale = initialScale + blended[0].scale;
+        auto poseChanged = false;
+        for (auto index = 1; index < blended.size(); index++) {
+            const auto jointAnimated = blendedAnimated[index];
+            if (jointAnimated == 0) { continue; }
+            auto& joint = skinnedTarget->getPose()[index - 1];
+            if (jointAnimated & ANIMATED_POSITION) { joint.position = blended[index].position; }
+            if (jointAnimated & ANIMATED_ROTATION) { joint.rotation = blended[index].rotation; }
+            if (jointAnimated & ANIMATED_SCALE) { joint.scale = blended[index].scale; }
+            poseChanged = true;
+        }
+        if (poseChanged) {
+            skinnedTarget->updatePose();
         }
     }
 
-    void AnimationPlayer::apply(const Animation::TrackKeyValue& value) {
+    void AnimationPlayer::accumulate(const Animation::TrackKeyValue& value, const float weight) {
+        const auto index = static_cast<size_t>(value.joint + 1);
+        if (weight <= 0.0f || index >= accumulators.size()) { return; }
+        auto& accumulator = accumulators[index];
         switch (value.type) {
         case AnimationType::TRANSLATION:
-            target->setPosition(value.value + initialPosition);
+            accumulator.position += weight * value.value;
+            accumulator.positionWeight += weight;
+            break;
+        case AnimationType::ROTATION: {
+            // q and -q are the same rotation : the rotations are summed in the same hemisphere
+            auto rotation = vec4{value.rotation.x, value.rotation.y, value.rotation.z, value.rotation.w};
+            if (dot(accumulator.rotation, rotation) < 0.0f) { rotation = -rotation; }
+            accumulator.rotation += weight * rotation;
+            accumulator.rotationWeight += weight;
+            break;
+        }
+        case AnimationType::SCALE:
+            accumulator.scale += weight * value.value;
+            accumulator.scaleWeight += weight;
+            break;
+        default:
+            die("Unknown animation type");
+        }
+    }
+
+    void AnimationPlayer::blendLayer(const Layer& layer,
+                                     const uint32_t trackIndex,
+                                     const Animation::TrackKeyValue& value,
+                                     const float weight) {
+        const auto index = value.joint + 1;
+        auto& current = blended[index];
+        const auto additive = layer.mode == AnimationBlendMode::ADDITIVE;
+        switch (value.type) {
+        case AnimationType::TRANSLATION:
+            current.position = additive ?
+                current.position + weight * (value.value - layer.references[trackIndex].value) :
+                mix(current.position, value.value, weight);
+            blendedAnimated[index] |= ANIMATED_POSITION;
             break;
         case AnimationType::ROTATION:
-            target->setRotation(value.value + initialRotation);
+            current.rotation = additive ?
+                normalize(current.rotation * slerp(quat{QUATERNION_IDENTITY},
+                                                   inverse(layer.references[trackIndex].rotation) * value.rotation,
+                                                   weight)) :
+                slerp(current.rotation, value.rotation, weight);
+            blendedAnimated[index] |= ANIMATED_ROTATION;
             break;
         case AnimationType::SCALE:
-            target->setScale(value.value + initialScale);
+            current.scale = additive ?
+                current.scale + weight * (value.value - layer.references[trackIndex].value) :
+                mix(current.scale, value.value, weight);
+            blendedAnimated[index] |= ANIMATED_SCALE;
             break;
         default:
             die("Unknown animation type");
         }
     }
 
+    void AnimationPlayer::apply(vec3 position, quat rotation, vec3 scale, const uint8_t animated) const {
+        if (animated == 0) { return; }
+        if (animated != ANIMATED_ALL) {
+            // Keep the values not animated by the tracks
+            vec3 currentScale, currentPosition, skew;
+            vec4 perspective;
+            quat currentRotation;
+            decompose(target->getTransformLocal(), currentScale, currentRotation, currentPosition, skew, perspective);
+            if (!(animated & ANIMATED_POSITION)) { position = currentPosition; }
+            if (!(animated & ANIMATED_ROTATION)) { rotation = currentRotation; }
+            if (!(animated & ANIMATED_SCALE)) { scale = currentScale; }
+        }
+        target->setTransformLocal(glm::translate(mat4{1.0f}, position) *
+                                  toMat4(rotation) *
+                                  glm::scale(mat4{1.0f}, scale));
+    }
+
     void AnimationPlayer::_update(const float alpha) {
         Node::_update(alpha);
         if (starting) {
             startTime = chrono::steady_clock::now();
+            mainFade.start = startTime;
             playing = true;
             starting = false;
             auto params = Playback{.animationName = currentAnimation};
             emit(on_playback_start, &params);
-        } else if (!playing) {
+        } else if (!playing && fadingClips.empty() && layers.empty()) {
             return;
         }
+        // Sampled with all the other players by _updatePlayers()
+        playingAnimation = playing ? getAnimation() : nullptr;
+        if (target) {
+            if (playingAnimation) {
+                tracksCursors.resize(playingAnimation->getTracksCount());
+            }
+            samples.players.push_back(this);
+        }
+    }
+
+    void AnimationPlayer::_updatePlayers() {
+        const auto count = samples.players.size();
+        if (count == 0) { return; }
+        samples.positions.resize(count);
+        samples.rotations.resize(count);
+        samples.scales.resize(count);
+        samples.animated.resize(count);
+        samples.ended.resize(count);
         const auto now = chrono::steady_clock::now();
-        const auto duration = (chrono::duration_cast<chrono::milliseconds>(now - startTime).count()) / 1000.0;
-        const auto animation = getAnimation();
-        if (animation && target) {
-            for (auto trackIndex = 0; trackIndex < animation->getTracksCount(); trackIndex++) {
-                const auto& value = animation->getInterpolatedValue(
-                    trackIndex,
-                    duration + lastTracksState[trackIndex],
-                    reverse);
-                currentTracksState[trackIndex] = value.frameTime;
-                if (value.ended) {
-                    stop();
-                    auto params = Playback{.animationName = currentAnimation};
-                    emit(on_playback_finish, &params);
-                } else {
-                   apply(value);
-                }
+        const auto sampleBatch = [now](const size_t first, const size_t last) {
+            for (auto index = first; index < last; index++) {
+                auto* player = samples.players[index];
+                if (player == nullptr) { continue; }
+                const auto time = (chrono::duration_cast<chrono::milliseconds>(now - player->startTime).count()) / 1000.0;
+                player->sample(now,
+                               time,
+                               false,
+                               samples.positions[index],
+                               samples.rotations[index],
+                               samples.scales[index],
+                               samples.animated[index],
+                               samples.ended[index]);
             }
+        };
+        // The batches are sampled by the worker threads of the physics job system, not running at this point
+        auto& jobSystem = app()._getJobSystem();
+        const auto batchesCount = std::min(
+            static_cast<size_t>(std::max(1, jobSystem.GetMaxConcurrency())),
+            (count + PLAYERS_PER_BATCH - 1) / PLAYERS_PER_BATCH);
+        if (batchesCount > 1) {
+            const auto batchSize = (count + batchesCount - 1) / batchesCount;
+            auto* barrier = jobSystem.CreateBarrier();
+            for (auto first = size_t{0}; first < count; first += batchSize) {
+                const auto last = std::min(first + batchSize, count);
+                barrier->AddJob(jobSystem.CreateJob("AnimationPlayer", JPH::Color::sGreen, [&sampleBatch, first, last] {
+                    sampleBatch(first, last);
+                }));
+            }
+            jobSystem.WaitForJobs(barrier);
+            jobSystem.DestroyBarrier(barrier);
+        } else {
+            sampleBatch(0, count);
+        }
+        // The scene tree is only modified by the main thread.
+        // A target removed from the scene this frame is still referenced by the frame data of the application.
+        for (auto index = 0; index < count; index++) {
+            const auto* player = samples.players[index];
+            if (player == nullptr || !player->target->_isAddedToScene()) { continue; }
+            player->apply(samples.positions[index],
+                          samples.rotations[index],
+                          samples.scales[index],
+                          samples.animated[index]);
         }
     }
 
+    void AnimationPlayer::_emitFinished() {
+        // The signals handlers can play other animations or remove players from the scene
+        for (auto index = 0; index < samples.players.size(); index++) {
+            auto* player = samples.players[index];
+            if (player != nullptr && samples.ended[index]) {
+                player->stop();
+                auto params = Playback{.animationName = player->currentAnimation};
+                player->emit(on_playback_finish, &params);
+            }
+        }
+        samples.players.clear();
+    }
+
+    AnimationPlayer::~AnimationPlayer() {
+        unregisterSamples();
+    }
+
+    void AnimationPlayer::_onExitScene() {
+        unregisterSamples();
+        Node::_onExitScene();
+    }
+
+    void AnimationPlayer::unregisterSamples() const {
+        ranges::replace(samples.players, this, nullptr);
+    }
+
     void AnimationPlayer::_onEnterScene() {
         Node::_onEnterScene();
         if (!target && getParent()) {
@@ -89,8 +349,13 @@ namespace z0 {
     void AnimationPlayer::setTarget(Node *target) {
         this->target = target;
         initialPosition = target->getPosition();
-        initialRotation = target->getRotation();
+        initialRotation = target->getRotationQuaternion();
         initialScale = target->getScale();
+        const auto meshInstance = dynamic_cast<MeshInstance*>(target);
+        skinnedTarget = (meshInstance != nullptr && meshInstance->isSkinned()) ? meshInstance : nullptr;
+        for (auto& layer : layers) {
+            updateMask(layer);
+        }
     }
 
 
@@ -121,6 +386,7 @@ namespace z0 {
         }
         starting = true;
         reverse = false;
+        mainFade = Fade{};
     }
 
     void AnimationPlayer::playBackwards(const string &name) {
@@ -139,6 +405,116 @@ namespace z0 {
         }
     }
 
+    void AnimationPlayer::crossFade(const string &name, const float duration) {
+        if (playing) {
+            // The current animation continues until the end of its fade out
+            const auto now = chrono::steady_clock::now();
+            fadingClips.push_back({
+                .animation = getAnimation(),
+                .startTime = startTime,
+                .lastTracksState = lastTracksState,
+                .cursors = tracksCursors,
+                .reverse = reverse,
+                .fade = {mainFade.getWeight(now), 0.0f, duration, now},
+            });
+            fadingClips.back().cursors.resize(fadingClips.back().animation->getTracksCount());
+            stop();
+        }
+        play(name);
+        mainFade = Fade{0.0f, 1.0f, duration};
+    }
+
+    void AnimationPlayer::playLayer(const string &layer,
+                                    const string &name,
+                                    const float weight,
+                                    const AnimationBlendMode mode,
+                                    const float fadeDuration) {
+        if (!libraries[currentLibrary]->has(name)) { return; }
+        const auto now = chrono::steady_clock::now();
+        auto* current = findLayer(layer);
+        if (current == nullptr) {
+            current = &layers.emplace_back(Layer{ .name = layer });
+        }
+        current->animation = libraries[currentLibrary]->get(name);
+        current->mode = mode;
+        current->startTime = now;
+        current->cursors.assign(current->animation->getTracksCount(), 0);
+        current->references.clear();
+        if (mode == AnimationBlendMode::ADDITIVE) {
+            for (auto trackIndex = 0; trackIndex < current->animation->getTracksCount(); trackIndex++) {
+                current->references.push_back(current->animation->getInterpolatedValue(trackIndex, 0.0));
+            }
+        }
+        current->fade = {current->stopping ? 0.0f : current->fade.getWeight(now), weight, fadeDuration, now};
+        current->stopping = false;
+        updateMask(*current);
+    }
+
+    void AnimationPlayer::setLayerWeight(const string &layer, const float weight, const float fadeDuration) {
+        if (auto* current = findLayer(layer); current != nullptr && !current->stopping) {
+            const auto now = chrono::steady_clock::now();
+            current->fade = {current->fade.getWeight(now), weight, fadeDuration, now};
+        }
+    }
+
+    void AnimationPlayer::setLayerMask(const string &layer,
+                                       const vector<string> &joints,
+                                       const bool includeTarget,
+                                       const bool includeChildren) {
+        if (auto* current = findLayer(layer); current != nullptr) {
+            current->masked = !joints.empty();
+            current->maskJoints = joints;
+            current->maskTarget = includeTarget;
+            current->maskChildren = includeChildren;
+            updateMask(*current);
+        }
+    }
+
+    void AnimationPlayer::stopLayer(const string &layer, const float fadeDuration) {
+        if (auto* current = findLayer(layer); current != nullptr) {
+            const auto now = chrono::steady_clock::now();
+            current->fade = {current->fade.getWeight(now), 0.0f, fadeDuration, now};
+            current->stopping = true;
+        }
+    }
+
+    bool AnimationPlayer::isLayerPlaying(const string &layer) const {
+        const auto it = ranges::find(layers, layer, &Layer::name);
+        return it != layers.end() && !it->stopping;
+    }
+
+    AnimationPlayer::Layer* AnimationPlayer::findLayer(const string& name) {
+        const auto it = ranges::find(layers, name, &Layer::name);
+        return it == layers.end() ? nullptr : &*it;
+    }
+
+    void AnimationPlayer::updateMask(Layer& layer) const {
+        if (!layer.masked) { return; }
+        const auto jointsCount = skinnedTarget == nullptr ? 0 : skinnedTarget->getPose().size();
+        layer.mask.assign(1 + jointsCount, 0);
+        layer.mask[0] = layer.maskTarget;
+        if (skinnedTarget == nullptr) { return; }
+        const auto& skeleton = skinnedTarget->getMesh()->getSkeleton();
+        for (const auto& jointName : layer.maskJoints) {
+            const auto joint = skeleton->findJoint(jointName);
+            if (joint == -1) {
+                WARNING("AnimationPlayer ", getName(), " : unknown joint ", jointName, " in the mask of layer ", layer.name);
+                continue;
+            }
+            layer.mask[1 + joint] = 1;
+        }
+        if (layer.maskChildren) {
+            // A joint is masked if one of its ancestors is named in the mask
+            const auto& joints = skeleton->getJoints();
+            auto named = layer.mask;
+            for (auto index = 0; index < joints.size(); index++) {
+                for (auto parent = joints[index].parent; parent != -1 && !layer.mask[1 + index]; parent = joints[parent].parent) {
+                    layer.mask[1 + index] = named[1 + parent];
+                }
+            }
+        }
+    }
+
     shared_ptr<Animation> AnimationPlayer::getAnimation() {
         return libraries[currentLibrary]->get(currentAnimation);
     }
@@ -9,17 +9,25 @@ module;
 
 export module z0.nodes.AnimationPlayer;
 
+import z0.Constants;
 import z0.Signal;
 
+import z0.nodes.MeshInstance;
 import z0.nodes.Node;
 
 import z0.resources.Animation;
 import z0.resources.AnimationLibrary;
+import z0.resources.Skeleton;
 
 export namespace z0 {
 
     /**
-     * %A node used for animation playback.
+     * %A node used for animation playback.<br>
+     * The current animation can be cross-faded with the next one and layers can be played on top of it, replacing
+     * or adding to its values, optionally masked to some joints of a skinned target. All the animations of a player
+     * are sampled in one pass accumulating the weighted values per target and per joint before writing them once.<br>
+     * The playing players are sampled together once per frame, in batches on worker threads. %A target must be
+     * animated by only one player.
      */
     class AnimationPlayer : public Node {
     public:
@@ -42,6 +50,8 @@ export namespace z0 {
          */
         explicit AnimationPlayer(const string &name = TypeNames[ANIMATION_PLAYER]): Node{name, ANIMATION_PLAYER} {}
 
+        ~AnimationPlayer() override;
+
         /**
          * Returns the current library name
          */
@@ -98,6 +108,61 @@ export namespace z0 {
          */
         void stop(bool keepState = false);
 
+        /**
+         * Starts an animation by its name, fading out the currently playing animation while the new one fades in
+         * @param name Animation name
+         * @param duration Duration of the cross-fade, in seconds
+         */
+        void crossFade(const string &name, float duration);
+
+        /**
+         * Starts an animation of the current library in a layer, played on top of the current animation and of the
+         * previous layers. The layer is created if needed and keeps its mask.<br>
+         * The non looping animations of the layers hold their last keys until the layer is stopped.
+         * @param layer Layer name
+         * @param name Animation name
+         * @param weight Weight of the layer, from 0.0 to 1.0
+         * @param mode How the layer is combined with the animations below it
+         * @param fadeDuration Time to reach the weight, in seconds
+         */
+        void playLayer(const string &layer,
+                       const string &name,
+                       float weight = 1.0f,
+                       AnimationBlendMode mode = AnimationBlendMode::OVERRIDE,
+                       float fadeDuration = 0.0f);
+
+        /**
+         * Changes the weight of a layer
+         * @param layer Layer name
+         * @param weight Weight of the layer, from 0.0 to 1.0
+         * @param fadeDuration Time to reach the weight, in seconds
+         */
+        void setLayerWeight(const string &layer, float weight, float fadeDuration = 0.0f);
+
+        /**
+         * Restricts a layer to some joints of the skinned target
+         * @param layer Layer name
+         * @param joints Names of the joints animated by the layer, all the joints and the target if empty
+         * @param includeTarget `true` if the tracks of the target itself are also animated by the layer
+         * @param includeChildren `true` to also animate the children of the joints
+         */
+        void setLayerMask(const string &layer,
+                          const vector<string> &joints,
+                          bool includeTarget = false,
+                          bool includeChildren = true);
+
+        /**
+         * Fades out and removes a layer
+         * @param layer Layer name
+         * @param fadeDuration Time to reach a zero weight, in seconds
+         */
+        void stopLayer(const string &layer, float fadeDuration = 0.0f);
+
+        /**
+         * Returns `true` if the layer exists and is not stopping
+         */
+        [[nodiscard]] bool isLayerPlaying(const string &layer) const;
+
         /**
          * Returns `true` if the animation is currently playing
          */
@@ -114,7 +179,8 @@ export namespace z0 {
         inline auto setTarget(Node &target) { setTarget(&target); }
 
         /**
-         * Sets the node target on which to apply animations
+         * Sets the node target on which to apply animations.<br>
+         * The joints tracks are applied to the pose of the target if it is a skinned MeshInstance.
          */
         void setTarget(Node *target);
 
@@ -122,26 +188,155 @@ export namespace z0 {
 
         void _onEnterScene() override;
 
+        void _onExitScene() override;
+
+        // Samples all the players updated this frame and applies the sampled values to their targets
+        static void _updatePlayers();
+
+        // Emits the playback finished signals of the players updated this frame, called after the transform batch
+        static void _emitFinished();
+
     protected:
         shared_ptr<Node> duplicateInstance() const override;
 
     private:
+        using time_point = chrono::time_point<chrono::steady_clock>;
+
+        // Weight of an animation changing linearly over time
+        struct Fade {
+            float      from{1.0f};
+            float      to{1.0f};
+            float      duration{0.0f};
+            time_point start{};
+
+            [[nodiscard]] inline auto getWeight(const time_point& now) const {
+                if (duration <= 0.0f) { return to; }
+                const auto progress = chrono::duration<float>(now - start).count() / duration;
+                return from + (to - from) * std::clamp(progress, 0.0f, 1.0f);
+            }
+
+            [[nodiscard]] inline auto isDone(const time_point& now) const {
+                return duration <= 0.0f || chrono::duration<float>(now - start).count() >= duration;
+            }
+        };
+
+        // Previous animation still played while fading out after a cross-fade
+        struct FadingClip {
+            shared_ptr<Animation> animation;
+            time_point            startTime;
+            vector<float>         lastTracksState;
+            vector<uint32_t>      cursors;
+            bool                  reverse{false};
+            Fade                  fade;
+        };
+
+        struct Layer {
+            string                               name;
+            shared_ptr<Animation>                animation;
+            AnimationBlendMode                   mode{AnimationBlendMode::OVERRIDE};
+            time_point                           startTime;
+            vector<uint32_t>                     cursors;
+            // First keys of the tracks, subtracted from the values of the additive layers
+            vector<Animation::TrackKeyValue>     references;
+            Fade                                 fade{0.0f, 0.0f};
+            // The layer is removed at the end of the fade
+            bool                                 stopping{false};
+            bool                                 masked{false};
+            vector<string>                       maskJoints;
+            bool                                 maskTarget{false};
+            bool                                 maskChildren{true};
+            // Per blended index : 1 if animated by the layer
+            vector<uint8_t>                      mask;
+        };
+
+        // Weighted sum of the values of the target or of a joint
+        struct Accumulator {
+            vec3  position{0.0f};
+            vec4  rotation{0.0f};
+            vec3  scale{0.0f};
+            float positionWeight{0.0f};
+            float rotationWeight{0.0f};
+            float scaleWeight{0.0f};
+        };
+
         bool autoStart{false};
         bool playing{false};
         bool starting{false};
         bool reverse{false};
         vec3 initialPosition{0.0f};
-        vec3 initialRotation{0.0f};
+        quat initialRotation{QUATERNION_IDENTITY};
         vec3 initialScale{1.0f};
-        chrono::time_point<chrono::steady_clock> startTime;
+        time_point startTime;
         Node* target{nullptr};
+        // Target of the joints tracks, if the target is a skinned mesh
+        MeshInstance* skinnedTarget{nullptr};
         string currentLibrary;
         string currentAnimation;
         vector<float> currentTracksState;
         vector<float> lastTracksState;
         map<string, shared_ptr<AnimationLibrary>> libraries;
+        // Animation sampled this frame, resolved by the main thread
+        shared_ptr<Animation> playingAnimation;
+        // Last key found for each track of the animation
+        vector<uint32_t> tracksCursors;
+        // Fade in of the current animation
+        Fade mainFade;
+        vector<FadingClip> fadingClips;
+        vector<Layer> layers;
+        // Blending buffers, indexed by 0 for the target and 1 + joint index for the joints of the skinned target.
+        // The target values are relative to its initial transform.
+        vector<Accumulator>              accumulators;
+        vector<Skeleton::JointTransform> blended;
+        vector<uint8_t>                  blendedAnimated;
+
+        // Node values animated by the tracks
+        static constexpr uint8_t ANIMATED_POSITION{1 << 0};
+        static constexpr uint8_t ANIMATED_ROTATION{1 << 1};
+        static constexpr uint8_t ANIMATED_SCALE{1 << 2};
+        static constexpr uint8_t ANIMATED_ALL{ANIMATED_POSITION | ANIMATED_ROTATION | ANIMATED_SCALE};
+        // Minimum number of players sampled by a worker thread
+        static constexpr size_t  PLAYERS_PER_BATCH{32};
+
+        // Values sampled by the worker threads for the players updated this frame, applied by the main thread.
+        // The players removed from the scene during the frame are replaced by nullptr.
+        struct Samples {
+            vector<AnimationPlayer*> players;
+            vector<vec3>             positions;
+            vector<quat>             rotations;
+            vector<vec3>             scales;
+            vector<uint8_t>          animated;
+            vector<uint8_t>          ended;
+        };
+        static inline Samples samples;
+
+        // Removes the player from the players updated this frame
+        void unregisterSamples() const;
+
+        // Samples and blends the current animation at the time, the fading out animations and the layers.
+        // The joints values are written in the pose of the skinned target.
+        // When seeking the time is absolute and the ended tracks are also applied.
+        void sample(const time_point& now,
+                    double time,
+                    bool seeking,
+                    vec3& position,
+                    quat& rotation,
+                    vec3& scale,
+                    uint8_t& animated,
+                    uint8_t& ended);
+
+        // Adds a weighted value to the accumulator of its target or joint
+        void accumulate(const Animation::TrackKeyValue& value, float weight);
+
+        // Combines a value of a layer with the blended value of its target or joint
+        void blendLayer(const Layer& layer, uint32_t trackIndex, const Animation::TrackKeyValue& value, float weight);
+
+        // Writes the sampled values in the local transform of the target
+        void apply(vec3 position, quat rotation, vec3 scale, uint8_t animated) const;
+
+        // Resolves the joints names of the mask of a layer
+        void updateMask(Layer& layer) const;
 
-        void apply(const Animation::TrackKeyValue&);
+        [[nodiscard]] Layer* findLayer(const string& name);
     };
 
 }
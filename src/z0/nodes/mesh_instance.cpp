@@ -12,12 +12,24 @@ module z0.nodes.MeshInstance;
 import z0.nodes.Node;
 
 import z0.resources.Mesh;
+import z0.resources.Skeleton;
 
 namespace z0 {
 
     MeshInstance::MeshInstance(const shared_ptr<Mesh> &mesh, const string &name):
         Node{name, MESH_INSTANCE},
         mesh{mesh} {
+        if (isSkinned()) {
+            pose = mesh->getSkeleton()->getRestPose();
+            mesh->getSkeleton()->computePalette(pose, palette);
+        }
+    }
+
+    void MeshInstance::updatePose() {
+        if (!isSkinned()) { return; }
+        mesh->getSkeleton()->computePalette(pose, palette);
+        poseVersion += 1;
+        transformVersion += 1;
     }
 
     // MeshInstance::MeshInstance(const MeshInstance & original):
@@ -36,11 +48,13 @@ namespace z0 {
     void MeshInstance::_updateTransform(const mat4 &parentMatrix) {
         Node::_updateTransform(parentMatrix);
         worldAABB = mesh->getAABB().toGlobal(worldTransform) ; 
+        transformVersion += 1;
     }
 
     void MeshInstance::_updateTransform() {
         Node::_updateTransform() ;
         worldAABB = mesh->getAABB().toGlobal(worldTransform) ;
+        transformVersion += 1;
     }
 
 }
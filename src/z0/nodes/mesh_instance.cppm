@@ -16,6 +16,7 @@ import z0.nodes.Node;
 
 import z0.resources.Material;
 import z0.resources.Mesh;
+import z0.resources.Skeleton;
 
 namespace z0 {
 
@@ -61,6 +62,22 @@ namespace z0 {
          */
         [[nodiscard]] inline auto& getOutlineMaterial() { return outlineMaterial; }
 
+        /**
+         * Returns `true` if the Mesh is deformed by a Skeleton
+         */
+        [[nodiscard]] inline auto isSkinned() const { return mesh != nullptr && mesh->isSkinned(); }
+
+        /**
+         * Returns the current pose of the Skeleton of a skinned Mesh.<br>
+         * Call updatePose() after modifying it.
+         */
+        [[nodiscard]] inline auto& getPose() { return pose; }
+
+        /**
+         * Computes the skinning matrices of the current pose, the Mesh is deformed starting to the next frame
+         */
+        void updatePose();
+
         /**
          * Returns the world space axis aligned bounding box
          */
@@ -78,11 +95,31 @@ namespace z0 {
         bool                       outlined{false};
         shared_ptr<Mesh>           mesh;
         shared_ptr<ShaderMaterial> outlineMaterial;
-        
+        uint32_t                   transformVersion{0};
+        uint32_t                   poseVersion{0};
+        uint32_t                   lod{0};
+        Skeleton::Pose             pose;
+        vector<mat4>               palette;
+
         void _updateTransform(const mat4 &parentMatrix) override; 
 
         void _updateTransform() override;
 
+    public:
+        // Incremented each time the world transform or the pose is updated, used by the renderers to upload only the modified transforms
+        [[nodiscard]] inline auto _getTransformVersion() const { return transformVersion; }
+
+        // Incremented each time the pose is updated, used by the skinning renderer to deform only the modified meshes
+        [[nodiscard]] inline auto _getPoseVersion() const { return poseVersion; }
+
+        // Skinning matrices of the current pose, in the mesh space
+        [[nodiscard]] inline const auto& _getPalette() const { return palette; }
+
+        // Level of detail selected by the scene renderer for the current camera
+        [[nodiscard]] inline auto _getLOD() const { return lod; }
+
+        inline void _setLOD(const uint32_t level) { lod = level; }
+
     };
 
 }
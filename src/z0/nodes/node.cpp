@@ -21,6 +21,9 @@ namespace z0 {
 
     Node::~Node() {
         DEBUG("~", getName(), " ", to_string(getId()));
+        if (tweensTarget != TweenManager::NO_TARGET) {
+            TweenManager::_releaseTarget(tweensTarget);
+        }
     }
 
     Node::id_t Node::currentId = 1;
@@ -31,6 +34,8 @@ namespace z0 {
         localTransform = orig.localTransform;
         worldTransform = orig.worldTransform;
         processMode    = orig.processMode;
+        processInput   = orig.processInput;
+        inputListeners = processInput ? 1 : 0;
         type           = orig.type;
     }
 
@@ -50,17 +55,26 @@ namespace z0 {
     }
 
     vec3 Node::toGlobal(const vec3 local) const {
+        flushTransforms();
         return vec3{worldTransform * vec4{local, 1.0f}};
     }
 
     vec3 Node::toLocal(const vec3 global) const {
+        flushTransforms();
         return vec3{inverse(worldTransform) * localTransform * vec4{global, 1.0f}};
     }
 
+    void Node::setTransformLocal(const mat4& transform) {
+        if (transform != localTransform) {
+            localTransform = transform;
+            updateTransform();
+        }
+    }
+
     void Node::setPosition(const vec3 position) {
         if (position != getPosition()) {
             localTransform[3] = vec4{position, 1.0f};
-            _updateTransform();
+            updateTransform();
         }
     }
 
@@ -70,7 +84,7 @@ namespace z0 {
 
     void Node::translate(const vec3& localOffset) {
         localTransform = glm::translate(localTransform, localOffset);
-        _updateTransform();
+        updateTransform();
     }
 
     void Node::setPositionGlobal(const vec3& position) {
@@ -80,7 +94,7 @@ namespace z0 {
                 return;
             }
             localTransform[3] = inverse(parent->worldTransform) * vec4{position, 1.0};
-            _updateTransform();
+            updateTransform();
         }
     }
 
@@ -93,7 +107,7 @@ namespace z0 {
             localTransform = glm::translate(translation) *
                                    mat4_cast(orientation) *
                                    glm::scale(scale);
-            _updateTransform();
+            updateTransform();
         }
     }
 
@@ -114,46 +128,32 @@ namespace z0 {
     bool Node::haveChild(const shared_ptr<Node> &child, const bool recursive) const {
         if (!child) { return false;}
         if (recursive) {
-            if (haveChild(child, false)) {
-                return true;
-            }
-            for (const auto &node : children) {
-                if (node->haveChild(child, true))
-                    return true;
+            // walk up from the child instead of down the whole subtree
+            for (auto node = child->parent; node != nullptr; node = node->parent) {
+                if (node == this) { return true; }
             }
             return false;
         }
-        return find(children.begin(), children.end(), child) != children.end();
+        return child->parent == this;
     }
 
-    // shared_ptr<Node> Node::getChild(const string &name) const {
-    //     const auto it = std::find_if(children.begin(),
-    //                                  children.end(),
-    //                                  [name](std::shared_ptr<Node> elem) {
-    //                                      return elem->name == name;
-    //                                  });
-    //     return it == children.end() ? nullptr : *it;
-    // }
-
-    // shared_ptr<Node> Node::findFirstChild(const string& name) const {
-    //     for (const auto &node : children) {
-    //         if (node->name == name) return node;
-    //         if (const auto& found = node->findFirstChild(name)) return found;
-    //     }
-    //     return {nullptr};
-    // }
+    shared_ptr<Node> Node::_getChild(const string_view name) const {
+        const auto it = childrenByName.find(name);
+        return it == childrenByName.end() ? nullptr : it->second;
+    }
 
-    // shared_ptr<Node> Node::getChildByPath(const string &path) const {
-    //     const size_t pos = path.find('/');
-    //     if (pos != std::string::npos) {
-    //         const auto child = getChild(path.substr(0, pos));
-    //         if (child != nullptr) {
-    //             return child->getChildByPath(path.substr(pos + 1));
-    //         }
-    //         return nullptr;
-    //     }
-    //     return getChild(path);
-    // }
+    void Node::setName(const string &nodeName) {
+        const auto oldName = name;
+        name = nodeName;
+        if (parent != nullptr && oldName != nodeName) {
+            const auto it = parent->childrenByName.find(oldName);
+            if (it != parent->childrenByName.end() && it->second.get() == this) {
+                parent->childrenByName.erase(it);
+                parent->reindexChild(oldName);
+            }
+            parent->reindexChild(nodeName);
+        }
+    }
 
     void Node::setRotation(const vec3& rot) {
         if (rot != getRotation()) {
@@ -170,11 +170,12 @@ namespace z0 {
             localTransform = glm::translate(mat4{1.0f}, translation)
                     * toMat4(quater)
                     * glm::scale(mat4{1.0f}, scale);
-            _updateTransform();
+            updateTransform();
         }
     }
 
     vec3 Node::getScaleGlobal() const {
+        flushTransforms();
         // Extract scale as the length of the basis vectors (first 3 columns of the 3x3 rotation-scale part)
         vec3 scale;
         scale.x = glm::length(vec3(worldTransform[0]));
@@ -194,7 +195,7 @@ namespace z0 {
                                            glm::mat4_cast(quater) *
                                            glm::scale(mat4{1.0f}, getScaleGlobal());
             localTransform = glm::inverse(parent->worldTransform) * newGlobalTransform;
-            _updateTransform();
+            updateTransform();
         }
     }
 
@@ -202,27 +203,27 @@ namespace z0 {
         const auto currentRotation = quat_cast(localTransform);
         const auto newRotation = glm::slerp(currentRotation, targetRotation, glm::clamp(maxAngle, 0.0f, 1.0f));
         localTransform = toMat4(newRotation);
-        _updateTransform();
+        updateTransform();
     }
 
     void Node::rotate(const quat quaternion) {
         localTransform = localTransform * toMat4(quaternion);
-        _updateTransform();
+        updateTransform();
     }
 
     void Node::rotateX(const float angle) {
         localTransform = glm::rotate(localTransform, angle, AXIS_X);
-        _updateTransform();
+        updateTransform();
     }
 
     void Node::rotateY(const float angle) {
         localTransform = glm::rotate(localTransform, angle, AXIS_Y);
-        _updateTransform();
+        updateTransform();
     }
 
     void Node::rotateZ(const float angle) {
         localTransform = glm::rotate(localTransform, angle, AXIS_Z);
-        _updateTransform();
+        updateTransform();
     }
 
     void Node::setRotationX(const float angle) {
@@ -262,6 +263,10 @@ namespace z0 {
         return dup;
     }
 
+    void Node::killTween(const TweenManager::id_t tween) {
+        TweenManager::kill(tween);
+    }
+
     void Node::killTween(const shared_ptr<Tween> &tween) {
         if (tween != nullptr) {
             tween->_kill();
@@ -306,6 +311,10 @@ namespace z0 {
     }
 
     void Node::_physicsUpdate(const float delta) {
+        // The tweens of this node will be updated by the TweenManager during this physics step
+        if (tweensTarget != TweenManager::NO_TARGET) {
+            TweenManager::_setProcessed(tweensTarget);
+        }
         for (auto it = tweens.begin(); it != tweens.end();) {
             if ((*it)->update(delta)) {
                 it = tweens.erase(it);
@@ -315,6 +324,36 @@ namespace z0 {
         }
     }
 
+    void Node::updateTransform() {
+        if (batchTransforms) {
+            if (!transformPending) {
+                transformPending = true;
+                pendingTransforms.push_back(this);
+            }
+        } else {
+            _updateTransform();
+        }
+    }
+
+    void Node::_beginTransformBatch() {
+        batchTransforms = true;
+    }
+
+    void Node::_endTransformBatch() {
+        batchTransforms = false;
+        applyPendingTransforms();
+    }
+
+    void Node::applyPendingTransforms() {
+        // a parent updated after one of its children recomputes the child again, the result is the same
+        const auto nodes = std::move(pendingTransforms);
+        pendingTransforms.clear();
+        for (const auto node : nodes) {
+            node->transformPending = false;
+            node->_updateTransform();
+        }
+    }
+
     void Node::_updateTransform(const mat4 &parentMatrix) {
         worldTransform = parentMatrix * localTransform;
         for (const auto &child : children) {
@@ -334,6 +373,8 @@ namespace z0 {
         }
         child->parent = this;
         children.push_back(child);
+        childrenByName.try_emplace(child->name, child);
+        updateInputListeners(static_cast<int32_t>(child->inputListeners));
         child->_updateTransform(worldTransform);
         child->_onReady();
         child->visible = visible && child->visible;
@@ -347,7 +388,13 @@ namespace z0 {
         if (!haveChild(node, false)) { return false; }
         node->parent = nullptr;
         if (node->addedToScene) { app()._removeNode(node, async); }
+        updateInputListeners(-static_cast<int32_t>(node->inputListeners));
         children.remove(node);
+        const auto it = childrenByName.find(node->name);
+        if (it != childrenByName.end() && it->second == node) {
+            childrenByName.erase(it);
+            reindexChild(node->name);
+        }
         return true;
     }
 
@@ -362,8 +409,32 @@ namespace z0 {
         for (const auto &node : children) {
             node->parent = nullptr;
             if (node->addedToScene) { app()._removeNode(node, async); }
+            updateInputListeners(-static_cast<int32_t>(node->inputListeners));
         }
         children.clear();
+        childrenByName.clear();
+    }
+
+    void Node::setProcessInput(const bool process) {
+        if (process == processInput) { return; }
+        processInput = process;
+        updateInputListeners(process ? 1 : -1);
+    }
+
+    void Node::updateInputListeners(const int32_t delta) {
+        for (auto node = this; node != nullptr; node = node->parent) {
+            node->inputListeners += delta;
+        }
+    }
+
+    void Node::reindexChild(const string &childName) {
+        // another child with the same name takes the freed place in the index, if any
+        const auto it = ranges::find_if(children, [&childName](const shared_ptr<Node>& child) {
+            return child->name == childName;
+        });
+        if (it != children.end()) {
+            childrenByName.try_emplace(childName, *it);
+        }
     }
 
     string Node::getPath() const {
@@ -108,7 +108,8 @@ import z0.Tween;
         virtual void onPhysicsProcess(const float delta) {}
 
         /**
-         * Called on a keyboard, mouse or gamepad event
+         * Called on a keyboard, mouse or gamepad event.<br>
+         * Only called if the node receive input events, see setProcessInput()
          */
         virtual bool onInput(InputEvent &inputEvent) { return false; }
 
@@ -117,10 +118,18 @@ import z0.Tween;
          */
         [[nodiscard]] inline const mat4 &getTransformLocal() const { return localTransform; }
 
+        /**
+         * Sets the local space transformation matrix
+         */
+        void setTransformLocal(const mat4& transform);
+
         /**
          * Returns the world space transformation matrix
          */
-        [[nodiscard]] inline const mat4& getTransformGlobal() const { return worldTransform; }
+        [[nodiscard]] inline const mat4& getTransformGlobal() const {
+            flushTransforms();
+            return worldTransform;
+        }
 
         /**
          * Transforms a local vector from this node's local space to world space.
@@ -155,7 +164,10 @@ import z0.Tween;
         /**
          * Returns the world space position
          */
-        [[nodiscard]] inline vec3 getPositionGlobal() const { return worldTransform[3]; }
+        [[nodiscard]] inline vec3 getPositionGlobal() const {
+            flushTransforms();
+            return worldTransform[3];
+        }
 
         /**
          * Rotates the local transformation
@@ -235,7 +247,10 @@ import z0.Tween;
         /**
          * Returns the rotation of the world transformation
          */
-        [[nodiscard]] inline quat getRotationQuaternionGlobal() const { return toQuat(mat3(worldTransform)); }
+        [[nodiscard]] inline quat getRotationQuaternionGlobal() const {
+            flushTransforms();
+            return toQuat(mat3(worldTransform));
+        }
 
         /**
          * Returns the X axis rotation of the local transformation
@@ -287,6 +302,18 @@ import z0.Tween;
          */
         [[nodiscard]] bool isProcessed() const;
 
+        /**
+         * Enables or disables the input events for this node (enabled by default).<br>
+         * Subtrees without any node receiving input events are skipped when dispatching the events,
+         * disable the input events for nodes that do not override onInput() in large scenes.
+         */
+        void setProcessInput(bool process);
+
+        /**
+         * Returns true if the node receive input events
+         */
+        [[nodiscard]] inline bool isProcessInput() const { return processInput; }
+
         /**
          * Returns the node's parent in the scene tree
          */
@@ -326,32 +353,33 @@ import z0.Tween;
         [[nodiscard]] bool haveChild(const shared_ptr<Node> &child, bool recursive) const;
 
         /**
-        * Returns the child node by is name. Not recursive
+        * Returns the child node by is name. Not recursive.<br>
+        * Uses the per-parent name index, updated when children are added, removed or renamed.
         */
         template <typename T = Node>
         [[nodiscard]] shared_ptr<T> getChild(const string &name) const {
-            const auto it = std::find_if(children.begin(),
-                                         children.end(),
-                                         [name](const shared_ptr<Node>& elem) {
-                                             return elem->name == name;
-                                         });
-            return it == children.end() ? nullptr : dynamic_pointer_cast<T>(*it);
+            return dynamic_pointer_cast<T>(_getChild(name));
         }
 
         /**
-        * Returns the child node by its relative path (does not start with '/')
+        * Returns the child node by its relative path (does not start with '/').<br>
+        * Each path segment is resolved with the per-parent name index.
         */
         template <typename T = Node>
         [[nodiscard]] shared_ptr<T> getChildByPath(const string &path) const {
-            const size_t pos = path.find('/');
-            if (pos != std::string::npos) {
-                const auto child = getChild<Node>(path.substr(0, pos));
-                if (child != nullptr) {
-                    return child->template getChildByPath<T>(path.substr(pos + 1));
+            auto             node = this;
+            string_view      remaining{path};
+            shared_ptr<Node> child;
+            while (true) {
+                const size_t pos = remaining.find('/');
+                child = node->_getChild(remaining.substr(0, pos));
+                if (child == nullptr || pos == string_view::npos) {
+                    break;
                 }
-                return nullptr;
+                node = child.get();
+                remaining.remove_prefix(pos + 1);
             }
-            return getChild<T>(path);
+            return dynamic_pointer_cast<T>(child);
         }
 
         /**
@@ -427,7 +455,8 @@ import z0.Tween;
         }
 
         /**
-         * Finds all children by type
+         * Finds all children by type.<br>
+         * For scene-wide queries prefer Application::findAllNodes() which does not walk the tree.
          */
         template <typename T>
         [[nodiscard]] list<shared_ptr<T>> findAllChildren(const bool recursive = true) const {
@@ -463,39 +492,85 @@ import z0.Tween;
         /**
          * Returns the normalized right vector
          */
-        [[nodiscard]] inline vec3 getRightVector() const {  return normalize(mat3{worldTransform} * AXIS_RIGHT); }
+        [[nodiscard]] inline vec3 getRightVector() const {
+            flushTransforms();
+            return normalize(mat3{worldTransform} * AXIS_RIGHT);
+        }
 
         /**
          * Returns the normalized left vector
          */
-        [[nodiscard]] inline vec3 getLeftVector() const {  return normalize(mat3{worldTransform} * AXIS_LEFT); }
+        [[nodiscard]] inline vec3 getLeftVector() const {
+            flushTransforms();
+            return normalize(mat3{worldTransform} * AXIS_LEFT);
+        }
 
         /**
          * Returns the normalized front vector
          */
-        [[nodiscard]] inline vec3 getFrontVector() const {  return normalize(mat3{worldTransform} * AXIS_FRONT); }
+        [[nodiscard]] inline vec3 getFrontVector() const {
+            flushTransforms();
+            return normalize(mat3{worldTransform} * AXIS_FRONT);
+        }
 
         /**
          * Returns the normalized back vector
          */
-        [[nodiscard]] inline vec3 getBackVector() const {  return normalize(mat3{worldTransform} * AXIS_BACK); }
+        [[nodiscard]] inline vec3 getBackVector() const {
+            flushTransforms();
+            return normalize(mat3{worldTransform} * AXIS_BACK);
+        }
 
         /**
          * Returns the normalized up vector
          */
-        [[nodiscard]] inline vec3 getUpVector() const {  return normalize(mat3{worldTransform} * AXIS_UP); }
+        [[nodiscard]] inline vec3 getUpVector() const {
+            flushTransforms();
+            return normalize(mat3{worldTransform} * AXIS_UP);
+        }
 
         /**
          * Returns the normalized down vector
          */
-        [[nodiscard]] inline vec3 getDownVector() const {  return normalize(mat3{worldTransform} * AXIS_DOWN); }
+        [[nodiscard]] inline vec3 getDownVector() const {
+            flushTransforms();
+            return normalize(mat3{worldTransform} * AXIS_DOWN);
+        }
+
+
+        /**
+         * Creates a Tween to tweens a property of the node between an `initial` value
+         * and `final` value in a span of time equal to `duration`, in seconds.<br>
+         * The tween is managed and updated in batch by the TweenManager while the node is processed.
+         * @return the tween identifier, to use with killTween(TweenManager::id_t)
+         */
+        template <typename T>
+        TweenManager::id_t addPropertyTween(
+                PropertyTween<T>::Setter set,
+                T initial,
+                T final,
+                float duration,
+                const TransitionType ttype = TransitionType::LINEAR,
+                const Tween::Callback& callback = nullptr) {
+            if (tweensTarget == TweenManager::NO_TARGET) {
+                tweensTarget = TweenManager::_registerTarget();
+            }
+            return TweenManager::create<T>(this, set, initial, final, duration, ttype, callback, tweensTarget);
+        }
 
+        /**
+         * Removes the `tween` from the processing list
+         */
+        void killTween(TweenManager::id_t tween);
 
         /**
          * Creates a Tween to tweens a property of the node between an `initial` value
-         * and `final` value in a span of time equal to `duration`, in seconds.
+         * and `final` value in a span of time equal to `duration`, in seconds.<br>
+         * The tween is allocated and updated individually by the node.
+         * @deprecated use addPropertyTween(), which updates the tweens in batch
          */
         template <typename T>
+        [[deprecated("use addPropertyTween() and killTween(TweenManager::id_t)")]]
         shared_ptr<Tween> createPropertyTween(
                 PropertyTween<T>::Setter set,
                 T initial,
@@ -509,8 +584,10 @@ import z0.Tween;
         }
 
         /**
-         * Removes the `tween` from the processing list
+         * Removes a `tween` created with createPropertyTween() from the processing list
+         * @deprecated use killTween(TweenManager::id_t)
          */
+        [[deprecated("use addPropertyTween() and killTween(TweenManager::id_t)")]]
         void killTween(const shared_ptr<Tween> &tween);
 
         /**
@@ -520,9 +597,9 @@ import z0.Tween;
         virtual void setProperty(const string &property, const string &value);
 
         /**
-         * Sets the node name (purely informative)
+         * Sets the node name
          */
-        void setName(const string &nodeName) { name = nodeName; }
+        void setName(const string &nodeName);
 
         /**
          * Returns the immutable list of children nodes
@@ -596,24 +673,60 @@ import z0.Tween;
         virtual shared_ptr<Node> duplicateInstance() const;
 
     private:
+        // Transparent hash for heterogeneous lookups with string_view
+        struct NameHash {
+            using is_transparent = void;
+            inline size_t operator()(const string_view name) const { return hash<string_view>{}(name); }
+        };
+
         static id_t             currentId;
         id_t                    id;
         Type                    type;
         string                  name;
         Node *                  parent{nullptr};
         list<shared_ptr<Node>>  children;
+        // Index of the children by name, first child added wins for duplicated names
+        unordered_map<string, shared_ptr<Node>, NameHash, equal_to<>> childrenByName;
         bool                    visible{true};
         ProcessMode             processMode{ProcessMode::INHERIT};
+        bool                    processInput{true};
+        // Number of nodes receiving input events in this subtree, including this node
+        uint32_t                inputListeners{1};
         bool                    isReady{false};
         bool                    addedToScene{false};
+        TweenManager::target_t  tweensTarget{TweenManager::NO_TARGET};
+        // Tweens created with the deprecated createPropertyTween()
         list<shared_ptr<Tween>> tweens;
+        bool                    transformPending{false};
+        static inline bool          batchTransforms{false};
+        static inline vector<Node*> pendingTransforms;
         list<string>            groups;
         bool                    castShadows{true};
         bool                    dontDrawEdges{false};
 
+        void reindexChild(const string &childName);
+
+        // Adds `delta` to the input listeners count of this node and all its ancestors
+        void updateInputListeners(int32_t delta);
+
+        // Updates the world transform now, or at the end of the current transform batch
+        void updateTransform();
+
+        // Inside a transform batch, applies the pending world transforms updates before reading a world transform,
+        // so the tweens setters and the signals handlers called during the batch read up-to-date values
+        static inline void flushTransforms() {
+            if (batchTransforms && !pendingTransforms.empty()) {
+                applyPendingTransforms();
+            }
+        }
+
+        static void applyPendingTransforms();
+
     public:
         virtual void _onReady();
 
+        [[nodiscard]] inline auto _getInputListeners() const { return inputListeners; }
+
         inline virtual void _onPause() { }
 
         inline virtual void _onResume() { }
@@ -644,8 +757,19 @@ import z0.Tween;
 
         virtual void _updateTransform();
 
+        // Defers the world transforms updates made by the local transforms setters until _endTransformBatch(),
+        // so multiple writes to the same node are coalesced in one update
+        static void _beginTransformBatch();
+
+        static void _endTransformBatch();
+
         inline auto& _getChildren() { return children; }
 
+        [[nodiscard]] shared_ptr<Node> _getChild(string_view name) const;
+
+        // Shallow copy of this node only, used by Prefab to instantiate a template tree
+        inline shared_ptr<Node> _duplicateInstance() const { return duplicateInstance(); }
+
     };
 
 }
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2024-2025 Henri Michelon
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+*/
+module;
+#include "z0/libraries.h"
+
+module z0.OcclusionCulling;
+
+import z0.AABB;
+
+namespace z0 {
+
+    void OcclusionCulling::setDepthPyramid(const mat4& viewProjection, const vector<Level>& levels) {
+        this->viewProjection = viewProjection;
+        this->levels = levels;
+        const auto& last = levels.back();
+        depth.resize(last.offset + last.width * last.height);
+    }
+
+    bool OcclusionCulling::isOccluded(const AABB& aabb) const {
+        if (levels.empty()) { return false; }
+        // Screen space bounds of the box
+        auto minBounds = vec3{numeric_limits<float>::max()};
+        auto maxBounds = vec3{numeric_limits<float>::lowest()};
+        for (auto corner = 0; corner < 8; corner++) {
+            const auto point = vec3{
+                (corner & 1) ? aabb.max.x : aabb.min.x,
+                (corner & 2) ? aabb.max.y : aabb.min.y,
+                (corner & 4) ? aabb.max.z : aabb.min.z};
+            const auto clip = viewProjection * vec4{point, 1.0f};
+            // The box crosses the camera plane
+            if (clip.w <= numeric_limits<float>::epsilon()) { return false; }
+            const auto ndc = vec3{clip} / clip.w;
+            minBounds = min(minBounds, ndc);
+            maxBounds = max(maxBounds, ndc);
+        }
+        // The depth is unknown outside the screen and before the near plane
+        if ((minBounds.x < -1.0f) || (minBounds.y < -1.0f) ||
+            (maxBounds.x > 1.0f) || (maxBounds.y > 1.0f) ||
+            (minBounds.z < 0.0f)) {
+            return false;
+        }
+        const auto uvMin = vec2{minBounds} * 0.5f + 0.5f;
+        const auto uvMax = vec2{maxBounds} * 0.5f + 0.5f;
+        // Finest level where the box covers at most MAX_TEXELS texels on each axis
+        for (const auto& level : levels) {
+            const auto x1 = std::min(static_cast<uint32_t>(uvMax.x * level.width), level.width - 1);
+            const auto y1 = std::min(static_cast<uint32_t>(uvMax.y * level.height), level.height - 1);
+            const auto x0 = std::min(static_cast<uint32_t>(uvMin.x * level.width), x1);
+            const auto y0 = std::min(static_cast<uint32_t>(uvMin.y * level.height), y1);
+            if (((x1 - x0) >= MAX_TEXELS || (y1 - y0) >= MAX_TEXELS) && (&level != &levels.back())) {
+                continue;
+            }
+            auto farthest = 0.0f;
+            for (auto y = y0; y <= y1; y++) {
+                for (auto x = x0; x <= x1; x++) {
+                    farthest = std::max(farthest, depth[level.offset + y * level.width + x]);
+                }
+            }
+            return minBounds.z > farthest;
+        }
+        return false;
+    }
+
+}
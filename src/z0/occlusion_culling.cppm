@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2024-2025 Henri Michelon
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+*/
+module;
+#include "z0/libraries.h"
+
+export module z0.OcclusionCulling;
+
+import z0.AABB;
+
+export namespace z0 {
+
+    /**
+     * Hierarchical-Z occlusion test of world space bounding boxes.<br>
+     * The depth pyramid, where each texel holds the farthest depth of the area it covers, is built on the GPU
+     * from the depth pre-pass by the `depth_pyramid.comp` compute shader and read back when the frame is completed.
+     * Boxes are tested against it with the view projection matrix used to render the depth.<br>
+     * The pyramid is `framesInFlight` frames old : the test is not conservative when the camera or the occluders
+     * moved since, and the models becoming visible appear with a delay of a few frames.
+     */
+    class OcclusionCulling {
+    public:
+        //! Maximum number of pyramid texels read for each bounding box, on each axis
+        static constexpr uint32_t MAX_TEXELS{4};
+
+        /**
+         * One level of the depth pyramid
+         */
+        struct Level {
+            uint32_t width;
+            uint32_t height;
+            //! Index of the first texel in the depth data
+            size_t   offset;
+        };
+
+        /**
+         * Sets the depth pyramid to test against and resizes the depth data, to be filled with getDepthData()
+         * @param viewProjection camera projection * view matrix used to render the depth
+         * @param levels pyramid levels, from the finest to the coarsest
+         */
+        void setDepthPyramid(const mat4& viewProjection, const vector<Level>& levels);
+
+        /**
+         * Returns the depth data of all the levels
+         */
+        [[nodiscard]] inline auto getDepthData() { return depth.data(); }
+
+        /**
+         * Removes the depth pyramid, nothing is occluded until the next setDepthPyramid()
+         */
+        inline void reset() { levels.clear(); }
+
+        /**
+         * Returns `true` if the box is fully hidden behind the depth pyramid
+         */
+        [[nodiscard]] bool isOccluded(const AABB& aabb) const;
+
+    private:
+        mat4          viewProjection{1.0f};
+        vector<Level> levels;
+        vector<float> depth;
+    };
+
+}
@@ -7,6 +7,7 @@
 module;
 #include <cassert>
 #include <glm/gtx/compatibility.hpp>
+#include <glm/gtx/quaternion.hpp>
 #include "z0/libraries.h"
 
 module z0.resources.Animation;
@@ -20,6 +21,14 @@ namespace z0 {
     Animation::TrackKeyValue Animation::getInterpolatedValue(const uint32_t trackIndex,
                                                              const double currentTimeFromStart,
                                                              const bool reverse) const {
+        auto cursor = uint32_t{0};
+        return getInterpolatedValue(trackIndex, currentTimeFromStart, reverse, cursor);
+    }
+
+    Animation::TrackKeyValue Animation::getInterpolatedValue(const uint32_t trackIndex,
+                                                             const double currentTimeFromStart,
+                                                             const bool reverse,
+                                                             uint32_t& cursor) const {
         assert(trackIndex < tracks.size());
         const auto& track = tracks[trackIndex];
         auto value = TrackKeyValue{
@@ -27,54 +36,190 @@ namespace z0 {
                     (loopMode == AnimationLoopMode::NONE && currentTimeFromStart >= track.duration) ||
                     track.keyTime.size() < 2),
             .type = track.type,
+            .joint = track.joint,
         };
-        if (value.ended) {
-            if (reverse) {
-                value.value = track.keyValue[0];
+        const auto rotation = track.type == AnimationType::ROTATION;
+        // The rotations of the compressed tracks are decompressed on the fly
+        const auto getRotation = [&](const size_t index) {
+            return track.keyQuantizedRotation.empty() ?
+                track.keyRotation[index] :
+                dequantize(track.keyQuantizedRotation[index]);
+        };
+        const auto setKey = [&](const size_t index) {
+            if (rotation) {
+                value.rotation = getRotation(index);
             } else {
-                value.value = track.keyValue[track.keyValue.size() - 1];
+                value.value = track.keyValue[index];
             }
+        };
+        const auto keysCount = track.keyTime.size();
+        if (value.ended) {
+            setKey(reverse ? 0 : keysCount - 1);
             return value;
         }
 
         const auto currentTime = fmod(currentTimeFromStart, static_cast<double>(track.duration));
         value.frameTime = static_cast<float>(currentTime);
+        // Backward playback samples the track at the mirrored time
+        const auto time = static_cast<float>(reverse ? track.duration - currentTime : currentTime);
 
-        const auto it = ranges::lower_bound(track.keyTime, static_cast<float>(currentTime));
-        auto nextIndex = std::distance(track.keyTime.begin(), it);
-        if (nextIndex == 0) {
-            if (reverse) {
-                value.value = track.keyValue[track.keyValue.size() - 1];
+        // Find the last key before the time, starting from the key found by the previous call :
+        // between two frames the time usually stays between the same keys or moves to the next one
+        const auto& keys = track.keyTime;
+        const auto last = static_cast<uint32_t>(keys.size() - 1);
+        const auto isCurrent = [&](const uint32_t index) {
+            return keys[index] <= time && (index == last || time < keys[index + 1]);
+        };
+        if (cursor > last) {
+            cursor = 0;
+        }
+        if (!isCurrent(cursor)) {
+            if (cursor < last && isCurrent(cursor + 1)) {
+                cursor += 1;
+            } else if (cursor > 0 && isCurrent(cursor - 1)) {
+                cursor -= 1;
             } else {
-                value.value = track.keyValue[0];
+                // Seek, loop or large time step
+                const auto it = ranges::upper_bound(keys, time);
+                cursor = it == keys.begin() ? 0 : static_cast<uint32_t>(std::distance(keys.begin(), it) - 1);
             }
-            return value;
         }
-
-        auto       previousIndex = nextIndex;
-        const bool overflow = nextIndex == track.keyTime.size();
-
-        if (reverse) {
-            previousIndex = track.keyTime.size() - previousIndex;
-            nextIndex = track.keyTime.size() - nextIndex;
+        if (time < keys[cursor]) {
+            // Before the first key
+            setKey(0);
+            return value;
         }
 
-        const auto& previousTime = track.keyTime[previousIndex];
-        const auto nextTime = overflow ? track.duration : track.keyTime[nextIndex];
+        // After the last key the track is interpolated to the first key, for the loops
+        const auto nextIndex = cursor == last ? 0 : cursor + 1;
+        const auto previousTime = keys[cursor];
+        const auto nextTime = cursor == last ? track.duration : keys[nextIndex];
         const auto diffTime = nextTime - previousTime;
-        const auto interpolationValue = static_cast<float>((currentTime - previousTime) / (diffTime > 0 ? diffTime : 1.0f));
+        const auto interpolationValue = (time - previousTime) / (diffTime > 0 ? diffTime : 1.0f);
 
-        const auto& previousValue = track.keyValue[previousIndex];
+        if (rotation) {
+            if (track.interpolation == AnimationInterpolation::LINEAR) {
+                value.rotation = slerp(getRotation(cursor), getRotation(nextIndex), interpolationValue);
+            } else {
+                // STEP
+                value.rotation = getRotation(cursor);
+            }
+            return value;
+        }
         if (track.interpolation == AnimationInterpolation::LINEAR) {
-            const auto nextValue = overflow ? track.keyValue[0] : track.keyValue[nextIndex];
-            value.value = lerp(previousValue, nextValue, interpolationValue);
+            value.value = lerp(track.keyValue[cursor], track.keyValue[nextIndex], interpolationValue);
         } else {
             // STEP
-            value.value = previousValue;
+            value.value = track.keyValue[cursor];
         }
         return value;
     }
 
+    // The three smallest components of a normalized quaternion are in [-1/sqrt(2), 1/sqrt(2)]
+    constexpr auto QUANTIZED_RANGE = 0.70710678f;
+    constexpr auto QUANTIZED_MAX   = 32767.0f;
+
+    Animation::QuantizedRotation Animation::quantize(const quat& rotation) {
+        const auto q = normalize(rotation);
+        const float components[4]{ q.x, q.y, q.z, q.w };
+        auto largest = 0;
+        for (auto i = 1; i < 4; i++) {
+            if (abs(components[i]) > abs(components[largest])) { largest = i; }
+        }
+        // q and -q are the same rotation : the dropped component is always positive
+        const auto sign = components[largest] < 0.0f ? -1.0f : 1.0f;
+        auto result = QuantizedRotation{};
+        auto value = 0;
+        for (auto i = 0; i < 4; i++) {
+            if (i == largest) { continue; }
+            const auto normalized = clamp(components[i] * sign / QUANTIZED_RANGE, -1.0f, 1.0f) * 0.5f + 0.5f;
+            result.values[value++] = static_cast<uint16_t>(round(normalized * QUANTIZED_MAX));
+        }
+        result.values[0] |= (largest & 1) << 15;
+        result.values[1] |= (largest >> 1) << 15;
+        return result;
+    }
+
+    quat Animation::dequantize(const QuantizedRotation& rotation) {
+        const auto largest = (rotation.values[0] >> 15) | ((rotation.values[1] >> 15) << 1);
+        float components[4];
+        auto sum = 0.0f;
+        auto value = 0;
+        for (auto i = 0; i < 4; i++) {
+            if (i == largest) { continue; }
+            const auto quantized = rotation.values[value++] & 0x7fff;
+            components[i] = (quantized / QUANTIZED_MAX - 0.5f) * 2.0f * QUANTIZED_RANGE;
+            sum += components[i] * components[i];
+        }
+        components[largest] = sqrt(std::max(0.0f, 1.0f - sum));
+        return quat{components[3], components[0], components[1], components[2]};
+    }
+
+    void Animation::compress(Track& track, const CompressionTolerance& tolerance) {
+        const auto rotation = track.type == AnimationType::ROTATION;
+        if (!track.keyQuantizedRotation.empty()) { return; }
+        const auto keysCount = track.keyTime.size();
+        if (keysCount > 2) {
+            const auto maxError =
+                track.type == AnimationType::TRANSLATION ? tolerance.translation :
+                rotation ? tolerance.rotation :
+                tolerance.scale;
+            // Error of a key sampled between two other keys
+            const auto getError = [&](const size_t previous, const size_t index, const size_t next) {
+                if (rotation) {
+                    const auto interpolated = track.interpolation == AnimationInterpolation::LINEAR ?
+                        slerp(track.keyRotation[previous], track.keyRotation[next],
+                              (track.keyTime[index] - track.keyTime[previous]) / (track.keyTime[next] - track.keyTime[previous])) :
+                        track.keyRotation[previous];
+                    return 2.0f * acos(std::min(1.0f, abs(dot(normalize(interpolated), normalize(track.keyRotation[index])))));
+                }
+                const auto interpolated = track.interpolation == AnimationInterpolation::LINEAR ?
+                    mix(track.keyValue[previous], track.keyValue[next],
+                        (track.keyTime[index] - track.keyTime[previous]) / (track.keyTime[next] - track.keyTime[previous])) :
+                    track.keyValue[previous];
+                return distance(interpolated, track.keyValue[index]);
+            };
+            // The first and last keys are kept for the duration and the loops,
+            // a key is removed if all the keys since the last kept one can be sampled without it
+            auto kept = vector<size_t>{0};
+            for (auto index = size_t{1}; index < keysCount - 1; index++) {
+                const auto previous = kept.back();
+                auto removable = true;
+                for (auto removed = previous + 1; removed <= index && removable; removed++) {
+                    removable = getError(previous, removed, index + 1) <= maxError;
+                }
+                if (!removable) {
+                    kept.push_back(index);
+                }
+            }
+            kept.push_back(keysCount - 1);
+            for (auto i = 0; i < kept.size(); i++) {
+                track.keyTime[i] = track.keyTime[kept[i]];
+                if (rotation) {
+                    track.keyRotation[i] = track.keyRotation[kept[i]];
+                } else {
+                    track.keyValue[i] = track.keyValue[kept[i]];
+                }
+            }
+            track.keyTime.resize(kept.size());
+            track.keyTime.shrink_to_fit();
+            if (rotation) {
+                track.keyRotation.resize(kept.size());
+            } else {
+                track.keyValue.resize(kept.size());
+                track.keyValue.shrink_to_fit();
+            }
+        }
+        if (rotation) {
+            track.keyQuantizedRotation.resize(track.keyRotation.size());
+            for (auto i = 0; i < track.keyRotation.size(); i++) {
+                track.keyQuantizedRotation[i] = quantize(track.keyRotation[i]);
+            }
+            track.keyRotation.clear();
+            track.keyRotation.shrink_to_fit();
+        }
+    }
+
     Animation::Animation(const string &name): Resource{name} {}
 
     Animation::Animation(const uint32_t tracksCount, const string &name): Resource {name} {
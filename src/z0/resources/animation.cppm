@@ -22,16 +22,44 @@ export namespace z0 {
      */
     class Animation : public Resource {
     public:
+        /**
+         * Rotation quantized with the smallest three method, in 6 bytes : the largest component is dropped
+         * and recomputed from the three others, stored on 15 bits each. The index of the dropped component
+         * is stored in the high bits of the first two values.
+         */
+        struct QuantizedRotation {
+            uint16_t values[3];
+        };
+
         /**
          * An animation track
          */
         struct Track {
-            AnimationType           type;
-            AnimationInterpolation  interpolation{AnimationInterpolation::LINEAR};
-            bool                    enabled{true};
-            float                   duration{0.0f};
-            vector<float>           keyTime;
-            vector<vec3>            keyValue;
+            AnimationType             type;
+            AnimationInterpolation    interpolation{AnimationInterpolation::LINEAR};
+            bool                      enabled{true};
+            float                     duration{0.0f};
+            vector<float>             keyTime;
+            //! Translations or scales, relative to the target for the node tracks and absolute for the joints tracks
+            vector<vec3>              keyValue;
+            //! Index of the animated joint in the Skeleton of the target, -1 if the track animates the target itself
+            int32_t                   joint{-1};
+            //! Rotations, relative to the target rotation for the node tracks and absolute for the joints tracks
+            vector<quat>              keyRotation;
+            //! Rotations of the compressed tracks, used instead of keyRotation
+            vector<QuantizedRotation> keyQuantizedRotation;
+        };
+
+        /**
+         * Maximum errors allowed when compressing a track
+         */
+        struct CompressionTolerance {
+            //! Maximum distance of the translations
+            float translation{0.0001f};
+            //! Maximum angle of the rotations, in radians
+            float rotation{0.0001f};
+            //! Maximum difference of the scales
+            float scale{0.0001f};
         };
 
         /**
@@ -44,8 +72,12 @@ export namespace z0 {
             float          frameTime;
             //! animation type
             AnimationType  type;
-            //! interpolated value
+            //! interpolated translation or scale
             vec3           value;
+            //! animated joint, -1 for the target itself
+            int32_t        joint{-1};
+            //! interpolated rotation
+            quat           rotation{QUATERNION_IDENTITY};
         };
 
         /**
@@ -86,6 +118,33 @@ export namespace z0 {
          */
         [[nodiscard]] TrackKeyValue getInterpolatedValue(uint32_t trackIndex, double currentTimeFromStart, bool reverse=false) const;
 
+        /**
+         * Returns the interpolated value at the given time (in seconds, from start of the animation) for a track.<br>
+         * The key found is kept in `cursor` between two calls, so playing a track forward or backward costs
+         * a constant time instead of a search in the keys.
+         */
+        [[nodiscard]] TrackKeyValue getInterpolatedValue(uint32_t trackIndex,
+                                                         double currentTimeFromStart,
+                                                         bool reverse,
+                                                         uint32_t& cursor) const;
+
+        /**
+         * Compresses a track : the keys that can be interpolated from their neighbours within the tolerance are
+         * removed, reducing the constant tracks to their first and last keys, and the rotations are quantized.
+         * The compressed tracks are decompressed on the fly by getInterpolatedValue().
+         */
+        static void compress(Track& track, const CompressionTolerance& tolerance = {});
+
+        /**
+         * Quantizes a rotation with the smallest three method
+         */
+        [[nodiscard]] static QuantizedRotation quantize(const quat& rotation);
+
+        /**
+         * Restores a quantized rotation
+         */
+        [[nodiscard]] static quat dequantize(const QuantizedRotation& rotation);
+
     private:
         AnimationLoopMode loopMode{AnimationLoopMode::NONE};
         vector<Track> tracks;
@@ -12,6 +12,7 @@ module z0.resources.Cubemap;
 
 import z0.Application;
 import z0.Constants;
+import z0.KTX2;
 import z0.resources.Image;
 import z0.Tools;
 import z0.VirtualFS;
@@ -66,6 +67,12 @@ namespace z0 {
     }
 
     shared_ptr<Cubemap> Cubemap::load(const string &filepath, const ImageFormat imageFormat) {
+        if (filepath.ends_with(".ktx2")) {
+            const auto ktxData = VirtualFS::loadBinary(filepath);
+            const auto ktx = KTX2{ktxData.data(), ktxData.size(), filepath};
+            if (ktx.getFaces() != 6) { die("KTX2 file", filepath, "is not a cubemap"); }
+            return make_shared<VulkanCubemap>(Device::get(), ktx, static_cast<VkFormat>(ktx.getFormat()), filepath);
+        }
         assert(imageFormat == ImageFormat::R8G8B8A8_SRGB);
         uint32_t texWidth, texHeight;
         uint64_t imageSize;
@@ -160,37 +167,90 @@ namespace z0 {
         irradianceCubemap = make_shared<VulkanCubemap>(device,
            IRRADIANCE_MAP_SIZE,
            IRRADIANCE_MAP_SIZE);
-        brdfLut = make_shared<VulkanImage>(device,
-            BRDFLUT_SIZE,
-            BRDFLUT_SIZE,
-            1,
-            VK_FORMAT_R16G16_SFLOAT,
-            1,
-            VK_IMAGE_USAGE_STORAGE_BIT,
-            VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
-            VK_FILTER_LINEAR,
-            VK_FALSE
-        );
+    }
+
+    string EnvironmentCubemap::getCacheName(const string &filename, const ImageFormat imageFormat) {
+        // FNV-1a hash of the file content and of the parameters
+        const auto content = VirtualFS::loadBinary(filename);
+        auto hash = uint64_t{14695981039346656037ull};
+        const auto combine = [&hash](const uint8_t value) {
+            hash ^= value;
+            hash *= 1099511628211ull;
+        };
+        for (const auto c : content) {
+            combine(static_cast<uint8_t>(c));
+        }
+        combine(static_cast<uint8_t>(imageFormat));
+        return std::format("{:016x}", hash);
     }
 
     shared_ptr<EnvironmentCubemap> EnvironmentCubemap::loadFromHDRi(const string &filename, ImageFormat imageFormat) {
         auto& device = Device::get();
         auto envCubemap = make_shared<EnvironmentCubemap>();
+        const auto &vkSpecular = reinterpret_pointer_cast<VulkanCubemap>(envCubemap->specularCubemap);
+        const auto &vkIrradiance = reinterpret_pointer_cast<VulkanCubemap>(envCubemap->irradianceCubemap);
+        const auto iblPipeline = IBLPipeline{device};
+
+        const auto& cacheDir = app().getConfig().iblCacheDir;
+        const auto useCache = !cacheDir.empty();
+        const auto cachePath = app().getConfig().appDir / cacheDir;
+
+        envCubemap->brdfLut = sharedBrdfLut.lock();
+        if (envCubemap->brdfLut == nullptr) {
+            const auto vkBRDF = make_shared<VulkanImage>(device,
+                BRDFLUT_SIZE,
+                BRDFLUT_SIZE,
+                1,
+                VK_FORMAT_R16G16_SFLOAT,
+                1,
+                VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+                VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+                VK_FILTER_LINEAR,
+                VK_FALSE
+            );
+            const auto brdfPath = cachePath / "brdf_lut.zibl";
+            const auto loadBRDF = [&] {
+                return iblPipeline.loadFromCache(brdfPath, vkBRDF->getImage(), VK_FORMAT_R16G16_SFLOAT,
+                                                 BRDFLUT_SIZE, BRDFLUT_SIZE, 1, 1);
+            };
+            if (!(useCache && loadBRDF())) {
+                iblPipeline.computeBRDFLut(vkBRDF);
+                if (useCache) {
+                    iblPipeline.saveToCache(brdfPath, vkBRDF->getImage(), VK_FORMAT_R16G16_SFLOAT,
+                                            BRDFLUT_SIZE, BRDFLUT_SIZE, 1, 1);
+                }
+            }
+            envCubemap->brdfLut = vkBRDF;
+            sharedBrdfLut = vkBRDF;
+        }
+
+        const auto cacheName = useCache ? getCacheName(filename, imageFormat) : "";
+        const auto specularPath = cachePath / (cacheName + "_specular.zibl");
+        const auto irradiancePath = cachePath / (cacheName + "_irradiance.zibl");
+        if (useCache &&
+            iblPipeline.loadFromCache(specularPath, vkSpecular->getImage(), vkSpecular->getFormat(),
+                                      ENVIRONMENT_MAP_SIZE, ENVIRONMENT_MAP_SIZE, ENVIRONMENT_MAP_MIPMAP_LEVELS, 6) &&
+            iblPipeline.loadFromCache(irradiancePath, vkIrradiance->getImage(), vkIrradiance->getFormat(),
+                                      IRRADIANCE_MAP_SIZE, IRRADIANCE_MAP_SIZE, 1, 6)) {
+            return envCubemap;
+        }
+
         const auto unfilteredCubemap = make_shared<VulkanCubemap>(device,
             ENVIRONMENT_MAP_SIZE,
             ENVIRONMENT_MAP_SIZE
         );
-        const auto &vkSpecular = reinterpret_pointer_cast<VulkanCubemap>(envCubemap->specularCubemap);
-        const auto &vkIrradiance = reinterpret_pointer_cast<VulkanCubemap>(envCubemap->irradianceCubemap);
-        const auto &vkBRDF = reinterpret_pointer_cast<VulkanImage>(envCubemap->brdfLut);
-        const auto iblPipeline = IBLPipeline{device};
         iblPipeline.convert(
             reinterpret_pointer_cast<VulkanImage>(
                 Image::load(filename, imageFormat)),
                 unfilteredCubemap,
                 vkSpecular,
-                vkIrradiance,
-                vkBRDF);
+                vkIrradiance);
+        if (useCache) {
+            iblPipeline.saveToCache(specularPath, vkSpecular->getImage(), vkSpecular->getFormat(),
+                                    ENVIRONMENT_MAP_SIZE, ENVIRONMENT_MAP_SIZE, ENVIRONMENT_MAP_MIPMAP_LEVELS, 6);
+            iblPipeline.saveToCache(irradiancePath, vkIrradiance->getImage(), vkIrradiance->getFormat(),
+                                    IRRADIANCE_MAP_SIZE, IRRADIANCE_MAP_SIZE, 1, 6);
+        }
         return envCubemap;
     }
 
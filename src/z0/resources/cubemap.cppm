@@ -61,6 +61,8 @@ export namespace z0 {
          *&emsp;&emsp;&emsp;`top`<br>
          *&emsp;`left  front  right  back`<br>
          *&emsp;&emsp;&emsp;`bottom`<br>
+         * or from a KTX2 cubemap file, uploaded as is with all its precomputed mip levels (BCn or ASTC payloads,
+         * not supercompressed).
          */
         static shared_ptr<Cubemap> load(const string &filepath, ImageFormat imageFormat = ImageFormat::R8G8B8A8_SRGB);
 
@@ -114,7 +116,10 @@ export namespace z0 {
         EnvironmentCubemap(const string &  name = "EnvironmentCubemap");
 
         /**
-          * Loads the cubemap from a single HDRi.
+          * Loads the cubemap from a single HDRi.<br>
+          * The precomputed specular, irradiance and BRDF maps are stored in the ApplicationConfig::iblCacheDir
+          * directory, indexed by the content of the HDRi file, and loaded back from it the next time the same HDRi is used.
+          * The cache files can be shipped with the application assets.
           */
         [[nodiscard]] static shared_ptr<EnvironmentCubemap> loadFromHDRi(const string &filename, ImageFormat imageFormat = ImageFormat::R8G8B8A8_SRGB);
 
@@ -129,6 +134,11 @@ export namespace z0 {
         shared_ptr<Cubemap> irradianceCubemap;
         // 2D LUT for split-sum approximation
         shared_ptr<Image> brdfLut;
+        // The BRDF LUT does not depend on the environment and is shared by all the environment cubemaps
+        static inline weak_ptr<Image> sharedBrdfLut;
+
+        // Returns the cache files name for an HDRi file, computed from the file content
+        [[nodiscard]] static string getCacheName(const string &filename, ImageFormat imageFormat);
     };
 
 }
@@ -20,62 +20,48 @@ import z0.resources.Image;
 namespace z0 {
 
     void Font::getSize(const string &text, float &width, float &height) {
-        width                  = 0;
-        uint32_t max_height    = 0;
-        uint32_t max_descender = 0;
-        for (const auto wc : text) {
-            auto &cchar = getFromCache(wc);
-            width += static_cast<float>(cchar.advance);
-            auto descender = cchar.height - cchar.yBearing;
-            max_height     = std::max(max_height, cchar.height);
-            max_descender  = std::max(max_descender, descender);
+        const auto codepoints = to_u32string(text);
+        width = 0.0f;
+        for (auto i = 0; i < codepoints.size(); i++) {
+            width += getGlyph(codepoints[i]).advance;
+            if (i + 1 < codepoints.size()) {
+                width += getKerning(codepoints[i], codepoints[i + 1]);
+            }
         }
-        height = static_cast<float>(max_height + max_descender);
+        height = codepoints.empty() ? 0.0f : static_cast<float>(this->height);
     }
 
     vector<uint32_t> Font::renderToBitmap(const string &text, float &wwidth, float &hheight) {
-        uint32_t width         = 0;
-        uint32_t max_height    = 0;
-        uint32_t max_descender = 0;
-        for (const auto wc : text) {
-            auto &cchar = getFromCache(wc);
-            width += cchar.advance + cchar.xBearing;
-            const auto descender = cchar.height - cchar.yBearing;
-            max_height           = std::max(max_height, cchar.height);
-            max_descender        = std::max(max_descender, descender);
-        }
-        const uint32_t height = max_height + max_descender;
-
-        auto    bitmap = vector<uint32_t>(width * height, 0);
-        int32_t x      = 0;
-        for (const auto wc : text) {
-            const auto &cchar  = getFromCache(wc);
-            const auto offset = height - cchar.yBearing - max_descender;
-            for (int line = 0; line < cchar.height; line++) {
-                const auto dest = bitmap.data() + (x + cchar.xBearing) + ((line + offset) * width);
-                const auto src  = cchar.bitmap->data() + (line * cchar.width);
-                for (int col = 0; col < cchar.width; col++) {
-                    const auto value = src[col];
-                    if (value != 0) { dest[col] = value; }
+        getSize(text, wwidth, hheight);
+        const auto width  = static_cast<uint32_t>(ceilf(wwidth));
+        const auto height = static_cast<uint32_t>(hheight);
+        wwidth = static_cast<float>(width);
+
+        auto bitmap = vector<uint32_t>(width * height, 0);
+        const auto codepoints = to_u32string(text);
+        auto x = 0.0f;
+        for (auto i = 0; i < codepoints.size(); i++) {
+            const auto &glyph = getGlyph(codepoints[i]);
+            const auto  coverage = renderGlyph(codepoints[i]);
+            const auto  left = static_cast<int32_t>(roundf(x)) + glyph.xOffset;
+            for (auto line = 0; line < glyph.height; line++) {
+                const auto y = glyph.yOffset + line;
+                if (y < 0 || y >= height) { continue; }
+                for (auto col = 0; col < glyph.width; col++) {
+                    const auto dx = left + col;
+                    const uint32_t gray = coverage[line * glyph.width + col];
+                    if (dx < 0 || dx >= width || gray == 0) { continue; }
+                    bitmap[y * width + dx] = (gray << 24) | (gray << 16) | (gray << 8) | gray;
                 }
             }
-            x += cchar.advance;
+            x += glyph.advance;
+            if (i + 1 < codepoints.size()) {
+                x += getKerning(codepoints[i], codepoints[i + 1]);
+            }
         }
-        wwidth  = static_cast<float>(width);
-        hheight = static_cast<float>(height);
         return bitmap;
     }
 
-    Font::CachedCharacter &Font::getFromCache(const char c) {
-        if (characterCache.contains(c)) {
-            return characterCache[c];
-        } else {
-            auto &cchar = characterCache[c];
-            render(cchar, c);
-            return cchar;
-        }
-    }
-
     uint32_t Font::scaleFontSize(const uint32_t baseFontSize) const {
         constexpr int baseWidth  = 1920;
         constexpr int baseHeight = 1080;
@@ -110,35 +96,35 @@ namespace z0 {
         descent = static_cast<int>(descent * scale);
     }
 
-    void Font::render(CachedCharacter &cachedCharacter, const char c) const {
+    const Font::Glyph &Font::getGlyph(const char32_t codepoint) {
+        if (const auto it = glyphCache.find(codepoint); it != glyphCache.end()) {
+            return it->second;
+        }
         int advanceWidth, leftSideBearing;
-        stbtt_GetCodepointHMetrics(&font, c, &advanceWidth, &leftSideBearing);
-        cachedCharacter.advance  = static_cast<int32_t>(advanceWidth * scale);
-        cachedCharacter.xBearing = static_cast<int32_t>(leftSideBearing * scale);
-
-        int width, height;
-        const auto srcBitmap     = stbtt_GetCodepointBitmap(&font, 0, scale, c, &width, &height, 0, 0);
-        cachedCharacter.width    = width;
-        cachedCharacter.height   = this->height;
-        cachedCharacter.yBearing = cachedCharacter.height;
-        cachedCharacter.bitmap   = make_unique<vector<uint32_t>>(cachedCharacter.width * cachedCharacter.height, 0);
-
-        int x1, y1, x2, y2;
-        stbtt_GetCodepointBitmapBox(&font, c, scale, scale, &x1, &y1, &x2, &y2);
-        const auto yOffset = (ascent + y1);
-
-        const auto dstBitmap = cachedCharacter.bitmap->data();
-        for (int y = 0; y < height; ++y) {
-            for (int x = 0; x < width; ++x) {
-                const uint8_t gray = srcBitmap[y * width + x];
-                if (gray != 0) {
-                    dstBitmap[(y + yOffset) * cachedCharacter.width + x] = (gray << 24) | (gray << 16) | (gray << 8)
-                            |
-                            gray;
-                };
-            }
+        stbtt_GetCodepointHMetrics(&font, codepoint, &advanceWidth, &leftSideBearing);
+        int x0, y0, x1, y1;
+        stbtt_GetCodepointBitmapBox(&font, codepoint, scale, scale, &x0, &y0, &x1, &y1);
+        return glyphCache[codepoint] = Glyph{
+            .advance = advanceWidth * scale,
+            .xOffset = x0,
+            .yOffset = ascent + y0,
+            .width   = static_cast<uint32_t>(x1 - x0),
+            .height  = static_cast<uint32_t>(y1 - y0),
+        };
+    }
+
+    float Font::getKerning(const char32_t codepoint, const char32_t nextCodepoint) const {
+        return stbtt_GetCodepointKernAdvance(&font, codepoint, nextCodepoint) * scale;
+    }
+
+    vector<uint8_t> Font::renderGlyph(const char32_t codepoint) const {
+        int x0, y0, x1, y1;
+        stbtt_GetCodepointBitmapBox(&font, codepoint, scale, scale, &x0, &y0, &x1, &y1);
+        auto coverage = vector<uint8_t>((x1 - x0) * (y1 - y0));
+        if (!coverage.empty()) {
+            stbtt_MakeCodepointBitmap(&font, coverage.data(), x1 - x0, y1 - y0, x1 - x0, scale, scale, codepoint);
         }
-        stbtt_FreeBitmap(srcBitmap, nullptr);
+        return coverage;
     }
 
     Font::~Font() {
@@ -17,14 +17,30 @@ import z0.resources.Resource;
 export namespace z0 {
 
     /**
-     * %A font resource to render text in bitmaps.
+     * %A font resource to render UTF-8 text in bitmaps or with glyphs.
      * %A font is a combination of a font file name and a size.
-     * Supports true type font files (cf https://github.com/nothings/stb/blob/master/stb_truetype.h).
+     * Supports true type font files (cf https://github.com/nothings/stb/blob/master/stb_truetype.h), with kerning.
      * The font size is automatically scaled based on the resolution, from a base resolution of 1920x1080
      * (14 is 14 pixels height in this resolution)
      */
     class Font : public Resource {
     public:
+        /**
+         * Metrics of a glyph, in pixels
+         */
+        struct Glyph {
+            //! Horizontal distance from the pen position to the next glyph, without kerning
+            float    advance;
+            //! Horizontal offset of the glyph bitmap from the pen position
+            int32_t  xOffset;
+            //! Vertical offset of the glyph bitmap from the top of the text line
+            int32_t  yOffset;
+            //! Width of the glyph bitmap
+            uint32_t width;
+            //! Height of the glyph bitmap
+            uint32_t height;
+        };
+
         /**
          * Creates a font resource
          * @param path : font file path, relative to the application working directory
@@ -37,12 +53,32 @@ export namespace z0 {
         ~Font() override;
 
         /**
-         * Returns the size (in pixels) for a string.
+         * Returns the size (in pixels) for an UTF-8 string.
          */
         void getSize(const string &text, float &width, float &height);
 
         /**
-         *  Renders a string into an RGBA bitmap (stored in CPU memory).
+         * Returns the metrics of the glyph of a Unicode code point
+         */
+        [[nodiscard]] const Glyph &getGlyph(char32_t codepoint);
+
+        /**
+         * Returns the kerning adjustment, in pixels, to add to the advance of a glyph followed by another glyph
+         */
+        [[nodiscard]] float getKerning(char32_t codepoint, char32_t nextCodepoint) const;
+
+        /**
+         * Renders the 8-bits coverage bitmap of the glyph of a Unicode code point, of Glyph::width * Glyph::height pixels
+         */
+        [[nodiscard]] vector<uint8_t> renderGlyph(char32_t codepoint) const;
+
+        /**
+         * Returns the height in pixels of a line of text
+         */
+        [[nodiscard]] inline auto getLineHeight() const { return static_cast<uint32_t>(height); }
+
+        /**
+         *  Renders an UTF-8 string into an RGBA bitmap (stored in CPU memory).
          *  Glyphs are white with alpha channel mapped to the glyphs geometry
          *   @param text : text to render
          *   @param wwidth : width of the resulting bitmap
@@ -51,6 +87,10 @@ export namespace z0 {
         */
         [[nodiscard]] vector<uint32_t> renderToBitmap(const string &text, float &wwidth, float &hheight);
 
+        /**
+         * Renders an UTF-8 string into a new image. Prefer VectorRenderer::drawText() for changing texts,
+         * which draws the glyphs from a shared atlas without creating an image for each string
+         */
         [[nodiscard]] shared_ptr<Image> renderToImage(const string &text);
 
         /**
@@ -64,19 +104,10 @@ export namespace z0 {
         [[nodiscard]] inline auto getFontSize() const { return size; }
 
     private:
-        // Already rendered characters stored in cache
-        struct CachedCharacter {
-            int32_t                      advance;
-            int32_t                      xBearing;
-            int32_t                      yBearing;
-            uint32_t                     width;
-            uint32_t                     height;
-            unique_ptr<vector<uint32_t>> bitmap;
-        };
-
-        map<char, CachedCharacter> characterCache;
-        const string               path;
-        const uint32_t             size;
+        // Metrics of the already used glyphs
+        unordered_map<char32_t, Glyph> glyphCache;
+        const string                   path;
+        const uint32_t                 size;
 
         static constexpr bool ENABLE_IMAGE_CACHE = true;
         static consteval bool isImageCacheEnabled() {
@@ -84,10 +115,6 @@ export namespace z0 {
         }
         map<string, shared_ptr<Image>> imageCache;
 
-        [[nodiscard]] CachedCharacter &getFromCache(char c);
-
-        void render(CachedCharacter &, char) const;
-
         [[nodiscard]] uint32_t scaleFontSize(uint32_t baseFontSize) const;
 
 #ifdef __STB_INCLUDE_STB_TRUETYPE_H__
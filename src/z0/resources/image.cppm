@@ -42,7 +42,9 @@ export namespace z0 {
 
         /**
          * Load a bitmap from file.<br>
-         * Support JPEG, PNG, DDS and KTX2 formats.
+         * Support JPEG, PNG, DDS and KTX2 formats.<br>
+         * KTX2 files are uploaded as is, with all their precomputed mip levels and in the color space of their format
+         * (`imageFormat` is ignored) : use BCn or ASTC payloads, Basis Universal and supercompressed payloads are not supported.
          */
         static shared_ptr<Image> load(const string &filepath, ImageFormat imageFormat = ImageFormat::R8G8B8A8_SRGB);
 
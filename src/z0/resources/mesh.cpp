@@ -70,20 +70,28 @@ namespace z0 {
 
     bool Mesh::operator==(const Mesh &other) const {
         return vertices == other.vertices &&
+                skinVertices == other.skinVertices &&
                 indices == other.indices &&
                 surfaces == other.surfaces &&
                 materials == other.materials;
     }
 
     void Mesh::optimize() {
+        // The skinning attributes are a second stream of the vertices : both streams are remapped together
+        const auto skinned = isSkinned();
+        assert(!skinned || skinVertices.size() == vertices.size());
         vector<uint32_t> remap(indices.size());
-        const auto newVertexCount = meshopt_generateVertexRemap(
+        const meshopt_Stream streams[] = {
+            {vertices.data(), sizeof(Vertex), sizeof(Vertex)},
+            {skinVertices.data(), sizeof(SkinVertex), sizeof(SkinVertex)},
+        };
+        const auto newVertexCount = meshopt_generateVertexRemapMulti(
             remap.data(),
             indices.data(),
             indices.size(),
-            vertices.data(),
             vertices.size(),
-            sizeof(Vertex));
+            streams,
+            skinned ? 2 : 1);
 
         meshopt_remapIndexBuffer(
            indices.data(),
@@ -100,36 +108,20 @@ namespace z0 {
             remap.data());
 
         DEBUG("Mesh::optimize ", getName(), ", vertices : ", vertices.size(), " -> ", remappedVertices.size());
-        vertices = std::move(remappedVertices);
-
-        // https://github.com/zeux/meshoptimizer/issues/624
-        for (const auto& surface : surfaces) {
-            meshopt_optimizeVertexCache(
-                &indices[surface->firstVertexIndex],
-                &indices[surface->firstVertexIndex],
-                surface->indexCount,
-                vertices.size());
-
-            meshopt_optimizeOverdraw(
-                &indices[surface->firstVertexIndex],
-                &indices[surface->firstVertexIndex],
-                surface->indexCount,
-                &vertices[0].position.x,
+        if (skinned) {
+            auto remappedSkinVertices = vector<SkinVertex>(newVertexCount);
+            meshopt_remapVertexBuffer(
+                remappedSkinVertices.data(),
+                skinVertices.data(),
                 vertices.size(),
-                sizeof(Vertex),
-                1.05f);
-
+                sizeof(SkinVertex),
+                remap.data());
+            skinVertices = std::move(remappedSkinVertices);
         }
-        meshopt_optimizeVertexFetch(
-                vertices.data(),
-                indices.data(),
-                indices.size(),
-                vertices.data(),
-                vertices.size(),
-                sizeof(Vertex));
+        vertices = std::move(remappedVertices);
 
         const auto threshold = app().getConfig().meshSimplifyThreshold;
-        if (surfaces.size() == 1 && threshold < 1.0f) {
+        if (surfaces.size() == 1 && surfaces[0]->lods.empty() && threshold < 1.0f) {
             constexpr float  target_error = 1e-2f;
             float            lod_error    = 0.f;
             const size_t     target_index_count = threshold == 0.0f ? 0 : static_cast<size_t>(indices.size() * threshold);
@@ -149,6 +141,112 @@ namespace z0 {
             indices = lod;
             surfaces[0]->indexCount = indices.size();
         }
+
+        buildLODs(std::clamp(app().getConfig().meshLODCount, 1u, MAX_LODS));
+
+        // https://github.com/zeux/meshoptimizer/issues/624
+        auto optimizeRange = [&](const uint32_t firstIndex, const uint32_t indexCount) {
+            meshopt_optimizeVertexCache(
+                &indices[firstIndex],
+                &indices[firstIndex],
+                indexCount,
+                vertices.size());
+
+            meshopt_optimizeOverdraw(
+                &indices[firstIndex],
+                &indices[firstIndex],
+                indexCount,
+                &vertices[0].position.x,
+                vertices.size(),
+                sizeof(Vertex),
+                1.05f);
+        };
+        lodCount = 1;
+        for (const auto& surface : surfaces) {
+            optimizeRange(surface->firstVertexIndex, surface->indexCount);
+            for (const auto& lod : surface->lods) {
+                optimizeRange(lod.firstIndex, lod.indexCount);
+            }
+            lodCount = std::max(lodCount, static_cast<uint32_t>(surface->lods.size() + 1));
+        }
+        remap.resize(vertices.size());
+        const auto fetchVertexCount = meshopt_optimizeVertexFetchRemap(
+                remap.data(),
+                indices.data(),
+                indices.size(),
+                vertices.size());
+        meshopt_remapIndexBuffer(
+                indices.data(),
+                indices.data(),
+                indices.size(),
+                remap.data());
+        auto fetchVertices = vector<Vertex>(fetchVertexCount);
+        meshopt_remapVertexBuffer(
+                fetchVertices.data(),
+                vertices.data(),
+                vertices.size(),
+                sizeof(Vertex),
+                remap.data());
+        if (skinned) {
+            auto fetchSkinVertices = vector<SkinVertex>(fetchVertexCount);
+            meshopt_remapVertexBuffer(
+                    fetchSkinVertices.data(),
+                    skinVertices.data(),
+                    skinVertices.size(),
+                    sizeof(SkinVertex),
+                    remap.data());
+            skinVertices = std::move(fetchSkinVertices);
+        }
+        vertices = std::move(fetchVertices);
+    }
+
+    void Mesh::buildLODs(const uint32_t count) {
+        // Each level targets half of the triangles of the previous one, with a doubled error : since a level
+        // is used at half the screen size of the previous one, the projected error stays nearly the same
+        constexpr auto lodTargetError = 2e-2f;
+        // Lock the borders of the surfaces to avoid cracks between the simplified surfaces of the same mesh
+        const auto options = surfaces.size() > 1 ? meshopt_SimplifyLockBorder : 0;
+        for (const auto& surface : surfaces) {
+            if (!surface->lods.empty()) { continue; }
+            auto source = vector<uint32_t>(indices.begin() + surface->firstVertexIndex,
+                                           indices.begin() + surface->firstVertexIndex + surface->indexCount);
+            for (auto level = 1u; level < count; level++) {
+                const auto targetIndexCount = (surface->indexCount >> level) / 3 * 3;
+                const auto targetError = lodTargetError * static_cast<float>(1 << (level - 1));
+                auto lod = vector<uint32_t>(source.size());
+                lod.resize(meshopt_simplify(
+                    lod.data(),
+                    source.data(),
+                    source.size(),
+                    &vertices[0].position.x,
+                    vertices.size(),
+                    sizeof(Vertex),
+                    targetIndexCount,
+                    targetError,
+                    options,
+                    nullptr));
+                // The topology (UV seams, locked borders) can stop the simplification early : fall back
+                // to the sloppy simplifier which ignores it
+                if (lod.size() > source.size() * 9 / 10) {
+                    lod.resize(meshopt_simplifySloppy(
+                        lod.data(),
+                        source.data(),
+                        source.size(),
+                        &vertices[0].position.x,
+                        vertices.size(),
+                        sizeof(Vertex),
+                        targetIndexCount,
+                        targetError,
+                        nullptr));
+                }
+                // Nothing left to simplify : the coarsest level of the surface is used for the next levels
+                if (lod.empty() || lod.size() >= source.size()) { break; }
+                DEBUG("Mesh::buildLODs ", getName(), " LOD ", level, " : ", surface->indexCount, " -> ", lod.size());
+                surface->lods.push_back({static_cast<uint32_t>(indices.size()), static_cast<uint32_t>(lod.size())});
+                indices.insert(indices.end(), lod.begin(), lod.end());
+                source = std::move(lod);
+            }
+        }
     }
 
     void Mesh::buildAABB() {
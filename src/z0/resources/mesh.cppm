@@ -15,6 +15,7 @@ import z0.Tools;
 
 import z0.resources.Material;
 import z0.resources.Resource;
+import z0.resources.Skeleton;
 
 export namespace z0 {
 
@@ -36,21 +37,56 @@ export namespace z0 {
         }
     };
 
+    /**
+     * Skinning attributes of a Mesh vertex, stored in a stream parallel to the vertices
+     */
+    struct SkinVertex {
+        //! Indices of the influencing joints in the Skeleton
+        uvec4 joints{0};
+        //! Weights of the influencing joints, summing to 1
+        vec4  weights{0.0f};
+
+        bool operator==(const SkinVertex &other) const = default;
+    };
+
     /**
      * %A Mesh surface, with counterclockwise triangles
      */
     struct Surface {
+        /**
+         * %A simplified level of detail of the surface, stored in the mesh indexes collection
+         */
+        struct LOD {
+            //! Index of the first vertex of the level
+            uint32_t firstIndex{0};
+            //! Number of vertices
+            uint32_t indexCount{0};
+
+            bool operator==(const LOD &other) const = default;
+        };
+
         //! Index of the first vertex of the surface
         uint32_t             firstVertexIndex{0};
         //! Number of vertices
         uint32_t             indexCount{0};
         //! Material
         shared_ptr<Material> material{};
+        //! Simplified levels of detail, from the finest to the coarsest, the level 0 being the surface itself
+        vector<LOD>          lods{};
 
         Surface(uint32_t firstIndex, uint32_t count);
 
+        /**
+         * Returns the indexes range of a level of detail, clamped to the coarsest level of the surface
+         */
+        [[nodiscard]] inline LOD getLOD(const uint32_t lod) const {
+            if (lod == 0 || lods.empty()) { return {firstVertexIndex, indexCount}; }
+            return lods[std::min(lod, static_cast<uint32_t>(lods.size())) - 1];
+        }
+
         inline bool operator==(const Surface &other) const {
-            return firstVertexIndex == other.firstVertexIndex && indexCount == other.indexCount && material == other.material;
+            return firstVertexIndex == other.firstVertexIndex && indexCount == other.indexCount &&
+                   material == other.material && lods == other.lods;
         }
 
         friend inline bool operator==(const shared_ptr<Surface>& a, const shared_ptr<Surface>& b) {
@@ -63,6 +99,11 @@ export namespace z0 {
      */
     class Mesh : public Resource {
     public:
+        /**
+         * Maximum number of levels of detail of a mesh, including the full detail level
+         */
+        static constexpr uint32_t MAX_LODS{5};
+
         /**
          * Creates an empty Mesh
          * @param meshName node name
@@ -123,11 +164,41 @@ export namespace z0 {
          */
         [[nodiscard]] inline const vector<uint32_t> &getIndices() const { return indices; }
 
+        /**
+         * Returns the skinning attributes of the vertices, empty for a non-skinned mesh
+         */
+        [[nodiscard]] inline vector<SkinVertex> &getSkinVertices() { return skinVertices; }
+
+        /**
+         * Returns the skinning attributes of the vertices, empty for a non-skinned mesh
+         */
+        [[nodiscard]] inline const vector<SkinVertex> &getSkinVertices() const { return skinVertices; }
+
+        /**
+         * Returns the skeleton deforming the mesh, or nullptr
+         */
+        [[nodiscard]] inline const auto& getSkeleton() const { return skeleton; }
+
+        /**
+         * Sets the skeleton deforming the mesh, must be called before building the mesh
+         */
+        inline void setSkeleton(const shared_ptr<Skeleton>& skeleton) { this->skeleton = skeleton; }
+
+        /**
+         * Returns true if the mesh have a skeleton and skinning attributes
+         */
+        [[nodiscard]] inline bool isSkinned() const { return skeleton != nullptr && !skinVertices.empty(); }
+
         /**
          * Returns the local space axis aligned bounding box
          */
         [[nodiscard]] inline const AABB &getAABB() const { return localAABB; }
 
+        /**
+         * Returns the number of levels of detail, including the full detail level
+         */
+        [[nodiscard]] inline auto getLODCount() const { return lodCount; }
+
         bool operator==(const Mesh &other) const;
 
         friend inline bool operator==(const shared_ptr<Mesh>& a, const shared_ptr<Mesh>& b) {
@@ -143,14 +214,20 @@ export namespace z0 {
     protected:
         AABB                                localAABB;
         vector<Vertex>                      vertices;
+        vector<SkinVertex>                  skinVertices;
         vector<uint32_t>                    indices;
         vector<shared_ptr<Surface>>         surfaces{};
         unordered_set<shared_ptr<Material>> materials{};
+        uint32_t                            lodCount{1};
+        shared_ptr<Skeleton>                skeleton{nullptr};
 
         void buildAABB();
 
         void optimize();
 
+        // Appends the simplified levels of detail of the surfaces without precomputed levels to the indexes collection
+        void buildLODs(uint32_t count);
+
         explicit Mesh(const string &meshName = "Mesh");
 
         Mesh(const vector<Vertex> &             vertices,
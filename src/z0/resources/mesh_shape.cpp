@@ -56,8 +56,12 @@ namespace z0 {
         const auto & indices = meshInstance->getMesh()->getIndices();
         JPH::IndexedTriangleList triangles;
         triangles.reserve(indices.size()/3);
-        for (int i = 0; i < indices.size(); i += 3) {
-            triangles.push_back({indices[i + 0], indices[i + 1], indices[i + 2]});
+        // Only the full detail level of the surfaces, the simplified levels are stored after them
+        for (const auto &surface : meshInstance->getMesh()->getSurfaces()) {
+            const auto last = surface->firstVertexIndex + surface->indexCount;
+            for (auto i = surface->firstVertexIndex; i < last; i += 3) {
+                triangles.push_back({indices[i + 0], indices[i + 1], indices[i + 2]});
+            }
         }
 
         // const auto tStart = chrono::high_resolution_clock::now();
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2024-2025 Henri Michelon
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+*/
+module;
+#include "z0/libraries.h"
+
+module z0.resources.Prefab;
+
+import z0.Application;
+import z0.Tools;
+
+import z0.nodes.Node;
+
+namespace z0 {
+
+    Prefab::Prefab(const shared_ptr<Node> &root, const string &name):
+        Resource{name},
+        root{root} {
+        assert(root != nullptr);
+        flatten(*root, -1, "");
+    }
+
+    void Prefab::flatten(const Node &node, const int32_t parent, const string &path) {
+        const auto index = static_cast<int32_t>(entries.size());
+        entries.push_back({&node, parent, path});
+        for (const auto &child : node.getChildren()) {
+            flatten(*child, index, path.empty() ? child->getName() : path + "/" + child->getName());
+        }
+    }
+
+    void Prefab::setOverride(const string &path, const string &property, const string &value) {
+        const auto it = ranges::find_if(entries, [&path](const Entry &entry) {
+            return entry.path == path;
+        });
+        if (it == entries.end()) {
+            die("Prefab", name, ": node with path", path, "not found");
+            return;
+        }
+        if (it->overridden == nullptr) {
+            // Copied with its children since some properties (like physics shapes) need them
+            it->overridden = it->node->duplicate();
+            it->overridden->setVisible(it->node->isVisible());
+            for (const auto &group : it->node->getGroups()) {
+                it->overridden->addToGroup(group);
+            }
+        }
+        it->overridden->setProperty(property, value);
+    }
+
+    void Prefab::clearOverrides() {
+        for (auto &entry : entries) {
+            entry.overridden.reset();
+        }
+    }
+
+    shared_ptr<Node> Prefab::instantiateTree() const {
+        vector<shared_ptr<Node>> nodes(entries.size());
+        // Entries are in depth-first order : parents are always instanced before their children,
+        // so each addChild() only have to update the transform of a leaf node
+        for (auto i = 0; i < entries.size(); i++) {
+            const auto &entry = entries[i];
+            const auto &source = entry.source();
+            auto node = source._duplicateInstance();
+            node->_setTransform(source.getTransformLocal());
+            if (!source.isVisible()) {
+                node->setVisible(false);
+            }
+            for (const auto &group : source.getGroups()) {
+                node->addToGroup(group);
+            }
+            if (entry.parent != -1) {
+                nodes[entry.parent]->addChild(node);
+            } else {
+                node->_updateTransform(mat4{1.0f});
+            }
+            nodes[i] = std::move(node);
+        }
+        return nodes.front();
+    }
+
+    vector<shared_ptr<Node>> Prefab::instantiate(const uint32_t count) const {
+        vector<shared_ptr<Node>> instances;
+        instances.reserve(count);
+        for (auto i = 0; i < count; i++) {
+            instances.push_back(instantiateTree());
+        }
+        return instances;
+    }
+
+    vector<shared_ptr<Node>> Prefab::spawn(Node &parent, const vector<mat4> &transforms, const bool async) const {
+        vector<shared_ptr<Node>> instances;
+        instances.reserve(transforms.size());
+        for (const auto &transform : transforms) {
+            auto instance = instantiateTree();
+            instance->_setTransform(transform);
+            instances.push_back(std::move(instance));
+        }
+        // Adds all the instances in the same deferred update
+        app()._lockDeferredUpdate();
+        for (const auto &instance : instances) {
+            parent.addChild(instance, async);
+        }
+        app()._unlockDeferredUpdate();
+        return instances;
+    }
+
+}
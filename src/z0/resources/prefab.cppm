@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2024-2025 Henri Michelon
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+*/
+module;
+#include "z0/libraries.h"
+
+export module z0.resources.Prefab;
+
+import z0.nodes.Node;
+
+import z0.resources.Resource;
+
+export namespace z0 {
+
+    /**
+     * Immutable template of a node tree, used to spawn many instances of the same scene resource.<br>
+     * The template tree is flattened once. Spawning an instance only creates one shallow copy per node with its
+     * transform, visibility and groups : meshes, materials and collision shapes stay shared with the template,
+     * children are linked from the flattened tree instead of being duplicated recursively and no property is parsed.<br>
+     * The overrides are copy-on-write : the first override of a node creates a private copy of the template node,
+     * the overrides are applied once to this copy and the instances are copied from it.<br>
+     * The template node tree must not be added to a scene nor modified after the creation of the prefab.
+     */
+    class Prefab : public Resource {
+    public:
+        /**
+         * Creates a prefab from a node tree
+         * @param root root node of the template tree
+         * @param name resource name
+         */
+        explicit Prefab(const shared_ptr<Node> &root, const string &name = "Prefab");
+
+        /**
+         * Overrides a property for all the future instances. The template itself is never modified :
+         * the property is applied once to a private copy of the template node, used for the next instances.
+         * @param path relative path of the node in the template tree, empty for the root node
+         * @param property property name, as for Node::setProperty()
+         * @param value property value, as for Node::setProperty()
+         */
+        void setOverride(const string &path, const string &property, const string &value);
+
+        /**
+         * Removes all the properties overrides
+         */
+        void clearOverrides();
+
+        /**
+         * Creates a new instance of the template tree, not attached to any parent
+         */
+        template <typename T = Node>
+        [[nodiscard]] inline shared_ptr<T> instantiate() const {
+            return dynamic_pointer_cast<T>(instantiateTree());
+        }
+
+        /**
+         * Creates `count` new instances of the template tree, not attached to any parent
+         */
+        [[nodiscard]] vector<shared_ptr<Node>> instantiate(uint32_t count) const;
+
+        /**
+         * Bulk spawn : creates one instance per local transform and adds them as children of `parent`
+         * @param parent parent node of the new instances
+         * @param transforms local transforms of the new instances, relative to `parent`
+         * @param async add the nodes to the scene in batch mode, see Node::addChild()
+         */
+        vector<shared_ptr<Node>> spawn(Node &parent, const vector<mat4> &transforms, bool async = false) const;
+
+        /**
+         * Returns the template root node
+         */
+        [[nodiscard]] inline const Node &getTemplate() const { return *root; }
+
+        /**
+         * Returns the number of nodes created for each instance
+         */
+        [[nodiscard]] inline auto getNodesCount() const { return entries.size(); }
+
+    private:
+        // One node of the flattened template tree, in depth-first order
+        struct Entry {
+            // Template node
+            const Node*      node;
+            // Index of the parent entry, -1 for the root node
+            int32_t          parent;
+            // Relative path of the node in the template tree
+            string           path;
+            // Copy of the template node with the overrides applied, created by the first override
+            shared_ptr<Node> overridden{nullptr};
+
+            // Node copied for each instance
+            [[nodiscard]] inline const Node& source() const { return overridden ? *overridden : *node; }
+        };
+
+        shared_ptr<const Node> root;
+        vector<Entry>          entries;
+
+        void flatten(const Node &node, int32_t parent, const string &path);
+
+        shared_ptr<Node> instantiateTree() const;
+    };
+
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2024-2025 Henri Michelon
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+*/
+module;
+#include <cassert>
+#include <glm/gtx/quaternion.hpp>
+#include "z0/libraries.h"
+
+module z0.resources.Skeleton;
+
+import z0.Tools;
+
+namespace z0 {
+
+    Skeleton::Skeleton(const vector<Joint>& joints, const mat4& rootTransform, const string& name):
+        Resource{name},
+        joints{joints},
+        rootTransform{rootTransform} {
+        if (joints.size() > MAX_JOINTS) {
+            die("Too many joints in skeleton", name);
+        }
+        // The imported joints can be in any order, the palette is computed parents first
+        auto sorted = vector<bool>(joints.size(), false);
+        while (order.size() < joints.size()) {
+            const auto count = order.size();
+            for (auto index = 0; index < joints.size(); index++) {
+                const auto parent = joints[index].parent;
+                if (!sorted[index] && ((parent == -1) || sorted[parent])) {
+                    sorted[index] = true;
+                    order.push_back(index);
+                }
+            }
+            if (order.size() == count) {
+                die("Cycle in the joints hierarchy of skeleton", name);
+            }
+        }
+    }
+
+    int32_t Skeleton::findJoint(const string& jointName) const {
+        const auto it = ranges::find(joints, jointName, &Joint::name);
+        return it == joints.end() ? -1 : static_cast<int32_t>(std::distance(joints.begin(), it));
+    }
+
+    Skeleton::Pose Skeleton::getRestPose() const {
+        auto pose = Pose(joints.size());
+        for (auto index = 0; index < joints.size(); index++) {
+            pose[index] = joints[index].rest;
+        }
+        return pose;
+    }
+
+    void Skeleton::computePalette(const Pose& pose, vector<mat4>& palette) const {
+        assert(pose.size() == joints.size());
+        palette.resize(joints.size());
+        // Mesh space transforms of the joints, parents first
+        for (const auto index : order) {
+            const auto& transform = pose[index];
+            const auto local = translate(mat4{1.0f}, transform.position) *
+                               toMat4(transform.rotation) *
+                               scale(mat4{1.0f}, transform.scale);
+            const auto parent = joints[index].parent;
+            palette[index] = (parent == -1 ? rootTransform : palette[parent]) * local;
+        }
+        for (auto index = 0; index < joints.size(); index++) {
+            palette[index] = palette[index] * joints[index].inverseBindMatrix;
+        }
+    }
+
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2024-2025 Henri Michelon
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+*/
+module;
+#include <glm/gtx/quaternion.hpp>
+#include "z0/libraries.h"
+
+export module z0.resources.Skeleton;
+
+import z0.Constants;
+
+import z0.resources.Resource;
+
+export namespace z0 {
+
+    /**
+     * Joints hierarchy of a skinned Mesh.<br>
+     * The joints are not nodes of the scene : the pose of each MeshInstance is a collection of joints local
+     * transforms, converted in a palette of skinning matrices used by the GPU to deform the vertices.
+     */
+    class Skeleton : public Resource {
+    public:
+        /**
+         * Maximum number of joints of a skeleton
+         */
+        static constexpr uint32_t MAX_JOINTS{256};
+
+        /**
+         * Local transform of a joint, relative to its parent joint
+         */
+        struct JointTransform {
+            //! Translation
+            vec3 position{0.0f};
+            //! Rotation
+            quat rotation{QUATERNION_IDENTITY};
+            //! Scale
+            vec3 scale{1.0f};
+        };
+
+        /**
+         * Local transforms of all the joints, in the joints order
+         */
+        using Pose = vector<JointTransform>;
+
+        /**
+         * %A joint of the skeleton
+         */
+        struct Joint {
+            //! Name of the joint, the name of the node in the imported scene
+            string         name;
+            //! Index of the parent joint, -1 for the root joints
+            int32_t        parent{-1};
+            //! Transforms the mesh space vertices to the joint space of the bind pose
+            mat4           inverseBindMatrix{1.0f};
+            //! Local transform of the joint when not animated
+            JointTransform rest{};
+        };
+
+        /**
+         * Creates a Skeleton
+         * @param joints Joints, in the order used by the joints indices of the mesh vertices
+         * @param rootTransform Transform of the parent of the root joints, in the mesh space
+         * @param name Resource name
+         */
+        Skeleton(const vector<Joint>& joints, const mat4& rootTransform, const string& name = "Skeleton");
+
+        /**
+         * Returns all the joints
+         */
+        [[nodiscard]] inline const auto& getJoints() const { return joints; }
+
+        /**
+         * Returns the number of joints
+         */
+        [[nodiscard]] inline auto getJointsCount() const { return static_cast<uint32_t>(joints.size()); }
+
+        /**
+         * Returns the transform of the parent of the root joints, in the mesh space
+         */
+        [[nodiscard]] inline const auto& getRootTransform() const { return rootTransform; }
+
+        /**
+         * Returns the index of a joint by its name, or -1
+         */
+        [[nodiscard]] int32_t findJoint(const string& jointName) const;
+
+        /**
+         * Returns the rest pose
+         */
+        [[nodiscard]] Pose getRestPose() const;
+
+        /**
+         * Computes the skinning matrices of a pose, transforming the mesh space vertices of the bind pose
+         * to the mesh space vertices of the pose
+         */
+        void computePalette(const Pose& pose, vector<mat4>& palette) const;
+
+    private:
+        vector<Joint>    joints;
+        mat4             rootTransform;
+        // Joints indices sorted with the parents before their children
+        vector<uint32_t> order;
+    };
+
+}
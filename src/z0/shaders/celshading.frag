@@ -7,6 +7,7 @@
 #version 450
 
 #include "utils.glsl"
+#include "clusters.glsl"
 
 layout (location = 0) in VertexOut fs_in;
 layout (location = 0) out vec4 COLOR;
@@ -72,7 +73,7 @@ void main() {
 
     vec3 normal;
     if (textures.normalTexture.index != -1) {
-        normal = normalize(2.0f * texture(texSampler[textures.normalTexture.index], uvTransform(textures.normalTexture, fs_in.UV)).rgb - 1.0f);
+        normal = normalize(unpackNormal(texture(texSampler[textures.normalTexture.index], uvTransform(textures.normalTexture, fs_in.UV))));
         normal = normalize(fs_in.TBN * normal) * vec3(material.normalScale, material.normalScale, 1.0f);
     } else {
         normal = fs_in.NORMAL;
@@ -95,8 +96,13 @@ void main() {
     }
 
     vec3 diffuseSpecular = vec3(0.0f);
-    for (uint i = 0; i < global.lightsCount; i++) {
-        Light light = lights.light[i];
+    // Directional lights first, then only the omni & spot lights of the fragment's cluster
+    const uint cluster = clusterIndex(gl_FragCoord.xy, -fs_in.CLIPSPACE_Z);
+    const uint lightsCount = global.directionalLightsCount + clusters.count[cluster];
+    for (uint i = 0; i < lightsCount; i++) {
+        Light light = lights.light[i < global.directionalLightsCount ?
+            i :
+            clusters.lightIndex[cluster * MAX_LIGHTS_PER_CLUSTER + i - global.directionalLightsCount]];
         vec3 lightDirection;
         float shadow = 1.0f;
         if (light.type == LIGHT_DIRECTIONAL) {
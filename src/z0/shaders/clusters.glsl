@@ -0,0 +1,24 @@
+/*
+ * Copyright (c) 2024-2025 Henri Michelon
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+*/
+// Clustered forward lighting helpers, cf LightClusters
+
+// View space depth of the near side of a depth slice
+float clusterSliceDepth(const uint slice) {
+    return exp((float(slice) - global.clustersSliceBias) / global.clustersSliceScale);
+}
+
+// Depth slice for a positive view space depth
+uint clusterSlice(const float depth) {
+    return uint(clamp(int(log(depth) * global.clustersSliceScale + global.clustersSliceBias), 0, CLUSTERS_Z - 1));
+}
+
+// Index of the cluster containing a fragment
+uint clusterIndex(const vec2 fragCoord, const float viewDepth) {
+    const uvec2 tile = min(uvec2(fragCoord * vec2(CLUSTERS_X, CLUSTERS_Y) / vec2(global.screenSize)),
+                           uvec2(CLUSTERS_X - 1, CLUSTERS_Y - 1));
+    return tile.x + tile.y * CLUSTERS_X + clusterSlice(viewDepth) * CLUSTERS_X * CLUSTERS_Y;
+}
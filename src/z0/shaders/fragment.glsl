@@ -5,6 +5,7 @@
  * https://opensource.org/licenses/MIT
 */
 #include "utils.glsl"
+#include "clusters.glsl"
 
 float alphaSq;
 
@@ -15,13 +16,18 @@ float alphaSq;
 layout (location = 0) in VertexOut fs_in;
 layout (location = 0) out vec4 COLOR;
 
+// Material features of the shader permutation, all enabled by default.
+// The disabled features are removed when the shader is specialized.
+layout (constant_id = 0) const uint MATERIAL_FEATURES = 0xffffffff;
+#define HAS_FEATURE(feature) ((MATERIAL_FEATURES & (feature)) != 0)
+
 vec4 fragmentColor(vec4 color, bool useColor) {
     Material material = materials.material[pushConstants.materialIndex];
     Texture tex = textures.texture[pushConstants.materialIndex];
     if (!useColor) {
         // Get the color from the material base color factor
         color = material.albedoColor;
-        if (tex.diffuseTexture.index != -1) {
+        if (HAS_FEATURE(FEATURE_ALBEDO_TEXTURE) && (tex.diffuseTexture.index != -1)) {
             // We have a texture : apply the color from the texture
             color *= texture(texSampler[tex.diffuseTexture.index], uvTransform(tex.diffuseTexture, fs_in.UV));
         }
@@ -31,15 +37,15 @@ vec4 fragmentColor(vec4 color, bool useColor) {
 
     // if Transparency::SCISSOR or Transparency::SCISSOR_ALPHA
     // discard the fragment if the alpha value < scissor value of the material
-    if (((material.transparency == TRANSPARENCY_SCISSOR) || (material.transparency == TRANSPARENCY_SCISSOR_ALPHA)) && (color.a < material.alphaScissor)) {
+    if (HAS_FEATURE(FEATURE_ALPHA_SCISSOR) && ((material.transparency == TRANSPARENCY_SCISSOR) || (material.transparency == TRANSPARENCY_SCISSOR_ALPHA)) && (color.a < material.alphaScissor)) {
         discard;
     }
-    const float transparency = (material.transparency == TRANSPARENCY_ALPHA || material.transparency == TRANSPARENCY_SCISSOR_ALPHA) ? color.a : 1.0f;
+    const float transparency = HAS_FEATURE(FEATURE_ALPHA_BLEND) && (material.transparency == TRANSPARENCY_ALPHA || material.transparency == TRANSPARENCY_SCISSOR_ALPHA) ? color.a : 1.0f;
 
     vec3 normal;
-    if (tex.normalTexture.index != -1) {
+    if (HAS_FEATURE(FEATURE_NORMAL_TEXTURE) && (tex.normalTexture.index != -1)) {
         // Get current fragment's normal and transform to world space.
-        normal = normalize(2.0f * texture(texSampler[tex.normalTexture.index], uvTransform(tex.normalTexture, fs_in.UV)).rgb - 1.0f);
+        normal = normalize(unpackNormal(texture(texSampler[tex.normalTexture.index], uvTransform(tex.normalTexture, fs_in.UV))));
         // https://registry.khronos.org/glTF/specs/2.0/glTF-2.0.html#_material_normaltextureinfo_scale
         normal = normalize(fs_in.TBN * normal) * vec3(material.normalScale, material.normalScale, 1.0f);
     } else {
@@ -51,11 +57,11 @@ vec4 fragmentColor(vec4 color, bool useColor) {
     // Material properties
     vec3 diffuse = vec3(0.0f);
     vec3 ambient = color.rgb;
-    if (material.metallicFactor != -1) {
-        float metallic  = tex.metallicTexture.index == -1 ?
+    if (HAS_FEATURE(FEATURE_PBR) && (material.metallicFactor != -1)) {
+        float metallic  = !HAS_FEATURE(FEATURE_METALLIC_TEXTURE) || (tex.metallicTexture.index == -1) ?
             material.metallicFactor :
             material.metallicFactor * texture(texSampler[tex.metallicTexture.index], uvTransform(tex.metallicTexture, fs_in.UV)).b;
-        float roughness = tex.roughnessTexture.index == -1 ?
+        float roughness = !HAS_FEATURE(FEATURE_ROUGHNESS_TEXTURE) || (tex.roughnessTexture.index == -1) ?
             material.roughnessFactor :
             material.roughnessFactor * (texture(texSampler[tex.roughnessTexture.index], uvTransform(tex.roughnessTexture, fs_in.UV)).g);
         // for ndfGGX()
@@ -68,12 +74,17 @@ vec4 fragmentColor(vec4 color, bool useColor) {
         // Specular reflection vector.
         const float cosLo = max(0.0, dot(normal, fs_in.VIEW_DIRECTION));
         // Calculate the diffuse light from the scene's lights
-        for (uint i = 0; i < global.lightsCount; i++) {
-            Light light = lights.light[i];
+        // Directional lights first, then only the omni & spot lights of the fragment's cluster
+        const uint cluster = clusterIndex(gl_FragCoord.xy, -fs_in.CLIPSPACE_Z);
+        const uint lightsCount = global.directionalLightsCount + clusters.count[cluster];
+        for (uint i = 0; i < lightsCount; i++) {
+            Light light = lights.light[i < global.directionalLightsCount ?
+                i :
+                clusters.lightIndex[cluster * MAX_LIGHTS_PER_CLUSTER + i - global.directionalLightsCount]];
             float factor = 1.0f;
             switch (light.type) {
                 case LIGHT_DIRECTIONAL: {
-                    if (light.mapIndex != -1) {
+                    if (HAS_FEATURE(FEATURE_SHADOWS) && (light.mapIndex != -1)) {
                         // We have a cascaded shadow map,
                         // get cascade index maps for the current fragment's view Z position
                         int cascadeIndex = 0;
@@ -114,7 +125,7 @@ vec4 fragmentColor(vec4 color, bool useColor) {
                 }
                 case LIGHT_SPOT: {
                     if (distance(fs_in.GLOBAL_POSITION.xyz, light.position) <= light.range) {
-                        if (light.mapIndex != -1) {
+                        if (HAS_FEATURE(FEATURE_SHADOWS) && (light.mapIndex != -1)) {
                             factor = shadowFactor(light, 0, fs_in.GLOBAL_POSITION);
                         }
                         diffuse += factor * calcPointLight(light, color.rgb, normal, metallic, roughness, fs_in.VIEW_DIRECTION, fs_in.GLOBAL_POSITION.xyz, F0, cosLo, alphaSq, alphaDirectLighting);
@@ -123,7 +134,7 @@ vec4 fragmentColor(vec4 color, bool useColor) {
                 }
                 case LIGHT_OMNI: {
                     if (distance(fs_in.GLOBAL_POSITION.xyz, light.position) <= light.range) {
-                        if (light.mapIndex != -1) {
+                        if (HAS_FEATURE(FEATURE_SHADOWS) && (light.mapIndex != -1)) {
                             factor = shadowFactorCubemap(light, fs_in.GLOBAL_POSITION.xyz);
                         }
                         diffuse += factor * calcPointLight(light, color.rgb, normal, metallic, roughness, fs_in.VIEW_DIRECTION, fs_in.GLOBAL_POSITION.xyz, F0, cosLo, alphaSq, alphaDirectLighting);
@@ -138,7 +149,7 @@ vec4 fragmentColor(vec4 color, bool useColor) {
         }
     }
     vec3 emmissiveColor = material.emissiveFactor;
-    if (tex.emissiveTexture.index != -1) {
+    if (HAS_FEATURE(FEATURE_EMISSIVE_TEXTURE) && (tex.emissiveTexture.index != -1)) {
         emmissiveColor *= toLinear(texture(texSampler[tex.emissiveTexture.index], uvTransform(tex.emissiveTexture, fs_in.UV))).rgb;
     }
     diffuse += emmissiveColor * material.emissiveStrength;// https://github.com/KhronosGroup/glTF/blob/main/extensions/2.0/Khronos/KHR_materials_emissive_strength/README.md
@@ -5,6 +5,7 @@
  * https://opensource.org/licenses/MIT
 */
 #extension GL_EXT_debug_printf: enable
+#extension GL_EXT_nonuniform_qualifier : enable
 
 #define SCENE_SET                  0
 #define BINDING_GLOBAL_BUFFER      0
@@ -20,6 +21,20 @@
 #define BINDING_PBR_BRDF_LUT       10
 #define BINDING_DEPTH_BUFFER       11
 //#define BINDING_NORMAL_BUFFER      12
+#define BINDING_CLUSTERS_BUFFER    13
+#define BINDING_INSTANCES_BUFFER   14
+
+// LightClusters
+#define CLUSTERS_X             16
+#define CLUSTERS_Y             9
+#define CLUSTERS_Z             24
+#define CLUSTERS_COUNT         (CLUSTERS_X * CLUSTERS_Y * CLUSTERS_Z)
+#define MAX_LIGHTS_PER_CLUSTER 64
+
+// The light culling compute shader is the only writer of the clusters buffer
+#ifndef CLUSTERS_BUFFER_ACCESS
+#define CLUSTERS_BUFFER_ACCESS readonly
+#endif
 
 struct VertexOut {
     vec2    UV;
@@ -42,6 +57,17 @@ struct VertexOut {
 #define TRANSPARENCY_SCISSOR       2
 #define TRANSPARENCY_SCISSOR_ALPHA 3
 
+// SceneRenderer::FEATURE_*, material features of a fragment shader permutation
+#define FEATURE_ALBEDO_TEXTURE    0x001
+#define FEATURE_NORMAL_TEXTURE    0x002
+#define FEATURE_PBR               0x004
+#define FEATURE_METALLIC_TEXTURE  0x008
+#define FEATURE_ROUGHNESS_TEXTURE 0x010
+#define FEATURE_EMISSIVE_TEXTURE  0x020
+#define FEATURE_ALPHA_SCISSOR     0x040
+#define FEATURE_ALPHA_BLEND       0x080
+#define FEATURE_SHADOWS           0x100
+
 struct Light {
     // light params
     int     type; // Light::LightType
@@ -92,26 +118,44 @@ layout(set = 0, binding = BINDING_GLOBAL_BUFFER) uniform GlobalUniformBuffer  {
     vec4  ambient;
     bool  ambientIBL;
     ivec2 screenSize;
+    uint  directionalLightsCount; // directional lights are always the first lights of the lights buffer
+    float clustersSliceScale;
+    float clustersSliceBias;
 } global;
 
-layout(set = SCENE_SET, binding = BINDING_MODELS_BUFFER) uniform ModelUniformBuffer  {
-    mat4 model[1000];  // arbitrary value for debug with RenderDoc
+// Indexed by model slot
+layout(set = SCENE_SET, binding = BINDING_MODELS_BUFFER) readonly buffer ModelBuffer  {
+    mat4 model[];
 } models;
 
-layout(set = SCENE_SET, binding = BINDING_MATERIALS_BUFFER) uniform MaterialUniformBuffer  {
-    Material material[200]; // SceneRenderer::MAX_MATERIALS
+// Models slots of the visible instances, indexed by pushConstants.modelIndex + gl_InstanceIndex
+layout(set = SCENE_SET, binding = BINDING_INSTANCES_BUFFER) readonly buffer InstanceBuffer  {
+    uint slot[];
+} instances;
+
+// Indexed by material slot, up to SceneRenderer::MAX_MATERIALS
+layout(set = SCENE_SET, binding = BINDING_MATERIALS_BUFFER) readonly buffer MaterialBuffer  {
+    Material material[];
 } materials;
 
-layout(set = SCENE_SET, binding = BINDING_TEXTURES_BUFFER) uniform TextureUniformBuffer  {
-    Texture texture[200]; // SceneRenderer::MAX_MATERIALS
+// Indexed by material slot, up to SceneRenderer::MAX_MATERIALS
+layout(set = SCENE_SET, binding = BINDING_TEXTURES_BUFFER) readonly buffer TextureBuffer  {
+    Texture texture[];
 } textures;
 
-layout(set = SCENE_SET, binding = BINDING_TEXTURES) uniform sampler2D texSampler[200]; // SceneRenderer::MAX_IMAGES
+// Bindless, partially bound, textures array. Indexed by image slot, up to SceneRenderer::MAX_IMAGES
+layout(set = SCENE_SET, binding = BINDING_TEXTURES) uniform sampler2D texSampler[];
 
-layout(set = SCENE_SET, binding = BINDING_LIGHTS_BUFFER) uniform lightArray {
-    Light light[10]; // arbitrary value for debug with RenderDoc
+layout(set = SCENE_SET, binding = BINDING_LIGHTS_BUFFER) readonly buffer lightArray {
+    Light light[];
 } lights;
 
+// Lights indices for each cluster, MAX_LIGHTS_PER_CLUSTER entries per cluster
+layout(set = SCENE_SET, binding = BINDING_CLUSTERS_BUFFER) CLUSTERS_BUFFER_ACCESS buffer ClustersBuffer {
+    uint count[CLUSTERS_COUNT];
+    uint lightIndex[CLUSTERS_COUNT * MAX_LIGHTS_PER_CLUSTER];
+} clusters;
+
 layout(set = SCENE_SET, binding = BINDING_SHADOW_MAPS) uniform sampler2DArray shadowMaps[10]; // SceneRenderer::MAX_SHADOW_MAPS
 layout(set = SCENE_SET, binding = BINDING_SHADOW_CUBEMAPS) uniform samplerCube shadowMapsCubemap[10];  // SceneRenderer::MAX_SHADOW_MAPS
 
@@ -16,7 +16,7 @@ layout (location = 3) in vec4 tangent;
 layout (location = 0) out vec3 NORMAL;
 
 void main() {
-    mat4 model = models.model[pushConstants.modelIndex + gl_InstanceIndex];
+    mat4 model = models.model[instances.slot[pushConstants.modelIndex + gl_InstanceIndex]];
     NORMAL = normalize(mat3(transpose(inverse(model))) * normal);
     gl_Position = global.projection * global.view * model * vec4(position, 1.0);
 }
@@ -14,7 +14,7 @@ layout (location = 2) in vec2 uv;
 layout (location = 3) in vec4 tangent;
 
 void main() {
-    mat4 model = models.model[pushConstants.modelIndex];
+    mat4 model = models.model[instances.slot[pushConstants.modelIndex]];
     Material material = materials.material[pushConstants.materialIndex];
 
     vec3 scaledPosition = position * vec3(1.0f + material.parameters[1].x);
@@ -25,4 +25,10 @@ vec4 toLinear(const vec4 sRGB) {
     const vec3 higher = pow((sRGB.rgb + vec3(0.055))/vec3(1.055), vec3(2.4));
     const vec3 lower = sRGB.rgb/vec3(12.92);
     return vec4(mix(higher, lower, cutoff), sRGB.a);
-}
\ No newline at end of file
+}
+// Tangent space normal from a normal map texel. Only the X & Y components are used
+// so two channels (BC5) normal maps and RGB normal maps are read the same way
+vec3 unpackNormal(const vec4 texel) {
+    const vec2 xy = 2.0f * texel.rg - 1.0f;
+    return vec3(xy, sqrt(max(1.0f - dot(xy, xy), 0.0f)));
+}
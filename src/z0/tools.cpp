@@ -117,6 +117,52 @@ namespace std {
         return s;
     }
 
+    u32string to_u32string(const string& str) {
+        constexpr char32_t replacement{0xFFFD};
+        auto result = u32string{};
+        result.reserve(str.size());
+        auto i = size_t{0};
+        while (i < str.size()) {
+            const auto c = static_cast<uint8_t>(str[i]);
+            // https://en.wikipedia.org/wiki/UTF-8#Encoding
+            auto length = size_t{0};
+            auto codepoint = char32_t{0};
+            auto minimum = char32_t{0};
+            if (c < 0x80) {
+                result.push_back(c);
+                i += 1;
+                continue;
+            }
+            if ((c & 0xE0) == 0xC0) {
+                length = 2; codepoint = c & 0x1F; minimum = 0x80;
+            } else if ((c & 0xF0) == 0xE0) {
+                length = 3; codepoint = c & 0x0F; minimum = 0x800;
+            } else if ((c & 0xF8) == 0xF0) {
+                length = 4; codepoint = c & 0x07; minimum = 0x10000;
+            } else {
+                // Unexpected continuation byte or invalid leading byte
+                result.push_back(replacement);
+                i += 1;
+                continue;
+            }
+            auto valid = (i + length) <= str.size();
+            for (auto j = size_t{1}; valid && j < length; j++) {
+                const auto continuation = static_cast<uint8_t>(str[i + j]);
+                valid = (continuation & 0xC0) == 0x80;
+                codepoint = (codepoint << 6) | (continuation & 0x3F);
+            }
+            // Rejects the truncated, overlong and surrogates encodings
+            if (!valid || codepoint < minimum || codepoint > 0x10FFFF || (codepoint >= 0xD800 && codepoint <= 0xDFFF)) {
+                result.push_back(replacement);
+                i += 1;
+                continue;
+            }
+            result.push_back(codepoint);
+            i += length;
+        }
+        return result;
+    }
+
     vec3 to_vec3(const string& str) {
         stringstream ss(str);
         vec3 result{};
@@ -135,6 +135,12 @@ export namespace std {
 
     string to_lower(const string &str);
 
+    /**
+     * Helper to decode an UTF-8 string into Unicode code points (std lib code convention).
+     * Invalid sequences are replaced by U+FFFD
+     */
+    u32string to_u32string(const string &str);
+
     /**
      * Helper to convert a vec3 from a string (std lib code convention)
      */
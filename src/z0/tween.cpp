@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2024-2025 Henri Michelon
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+*/
+module;
+#include <glm/gtc/quaternion.hpp>
+#include "z0/libraries.h"
+
+module z0.Tween;
+
+namespace z0 {
+
+    template<typename T>
+    void TweenManager::Pool<T>::update(const float delta,
+                                       const vector<uint32_t>& stamps,
+                                       const uint32_t stamp,
+                                       vector<Tween::Callback>& completed) {
+        const auto count = ids.size();
+        if (count == 0) { return; }
+        active.resize(count);
+        times.resize(count);
+        values.resize(count);
+        // Only the tweens of the processed targets are running this step
+        for (auto i = 0; i < count; i++) {
+            active[i] = (targets[i] == NO_TARGET) || (stamps[targets[i]] == stamp);
+        }
+        for (auto i = 0; i < count; i++) {
+            elapsed[i] += active[i] ? delta : 0.0f;
+            times[i] = std::min(elapsed[i] / durations[i], 1.0f);
+        }
+        for (auto i = 0; i < count; i++) {
+            times[i] = ease(transitions[i], times[i]);
+        }
+        for (auto i = 0; i < count; i++) {
+            values[i] = interpolate(startValues[i], finalValues[i], times[i]);
+        }
+        for (auto i = 0; i < count; i++) {
+            if (active[i]) {
+                (objects[i]->*setters[i])(values[i]);
+            }
+        }
+        // Remove the completed tweens, in reverse order since remove() swaps with the last element
+        for (auto i = count; i-- > 0;) {
+            if (active[i] && (elapsed[i] >= durations[i])) {
+                if (callbacks[i]) {
+                    completed.push_back(std::move(callbacks[i]));
+                }
+                remove(i);
+            }
+        }
+    }
+
+    template<typename T>
+    void TweenManager::Pool<T>::remove(const size_t index) {
+        const auto last = ids.size() - 1;
+        if (index != last) {
+            ids[index]         = ids[last];
+            targets[index]     = targets[last];
+            objects[index]     = objects[last];
+            setters[index]     = setters[last];
+            startValues[index] = startValues[last];
+            finalValues[index] = finalValues[last];
+            durations[index]   = durations[last];
+            elapsed[index]     = elapsed[last];
+            transitions[index] = transitions[last];
+            callbacks[index]   = std::move(callbacks[last]);
+        }
+        ids.pop_back();
+        targets.pop_back();
+        objects.pop_back();
+        setters.pop_back();
+        startValues.pop_back();
+        finalValues.pop_back();
+        durations.pop_back();
+        elapsed.pop_back();
+        transitions.pop_back();
+        callbacks.pop_back();
+    }
+
+    template<typename T>
+    void TweenManager::Pool<T>::removeTarget(const target_t target) {
+        for (auto i = ids.size(); i-- > 0;) {
+            if (targets[i] == target) {
+                remove(i);
+            }
+        }
+    }
+
+    template<typename T>
+    bool TweenManager::Pool<T>::kill(const id_t id) {
+        const auto it = ranges::find(ids, id);
+        if (it == ids.end()) { return false; }
+        remove(distance(ids.begin(), it));
+        return true;
+    }
+
+    void TweenManager::kill(const id_t id) {
+        if (getPool<float>().kill(id)) { return; }
+        if (getPool<vec2>().kill(id)) { return; }
+        if (getPool<vec3>().kill(id)) { return; }
+        if (getPool<vec4>().kill(id)) { return; }
+        getPool<quat>().kill(id);
+    }
+
+    bool TweenManager::isRunning(const id_t id) {
+        const auto contains = [id](const vector<id_t>& ids) {
+            return ranges::find(ids, id) != ids.end();
+        };
+        return contains(getPool<float>().ids) ||
+               contains(getPool<vec2>().ids) ||
+               contains(getPool<vec3>().ids) ||
+               contains(getPool<vec4>().ids) ||
+               contains(getPool<quat>().ids);
+    }
+
+    size_t TweenManager::getCount() {
+        return getPool<float>().ids.size() +
+               getPool<vec2>().ids.size() +
+               getPool<vec3>().ids.size() +
+               getPool<vec4>().ids.size() +
+               getPool<quat>().ids.size();
+    }
+
+    TweenManager::target_t TweenManager::_registerTarget() {
+        if (freeTargets.empty()) {
+            targetsStamps.push_back(0);
+            return static_cast<target_t>(targetsStamps.size() - 1);
+        }
+        const auto target = freeTargets.back();
+        freeTargets.pop_back();
+        targetsStamps[target] = 0;
+        return target;
+    }
+
+    void TweenManager::_releaseTarget(const target_t target) {
+        getPool<float>().removeTarget(target);
+        getPool<vec2>().removeTarget(target);
+        getPool<vec3>().removeTarget(target);
+        getPool<vec4>().removeTarget(target);
+        getPool<quat>().removeTarget(target);
+        freeTargets.push_back(target);
+    }
+
+    void TweenManager::_update(const float delta) {
+        getPool<float>().update(delta, targetsStamps, currentStamp, completedCallbacks);
+        getPool<vec2>().update(delta, targetsStamps, currentStamp, completedCallbacks);
+        getPool<vec3>().update(delta, targetsStamps, currentStamp, completedCallbacks);
+        getPool<vec4>().update(delta, targetsStamps, currentStamp, completedCallbacks);
+        getPool<quat>().update(delta, targetsStamps, currentStamp, completedCallbacks);
+        currentStamp += 1;
+    }
+
+    void TweenManager::_runCallbacks() {
+        if (completedCallbacks.empty()) { return; }
+        // callbacks can create new tweens
+        auto callbacks = std::move(completedCallbacks);
+        completedCallbacks.clear();
+        for (const auto& callback : callbacks) {
+            callback();
+        }
+    }
+
+}
@@ -16,6 +16,35 @@ import z0.Tools;
 
 export namespace z0 {
 
+    /**
+     * Applies the easing curve of a transition type to a normalized time.<br>
+     * Branchless so that it can be used in vectorized loops.
+     */
+    inline float ease(const TransitionType type, const float t) {
+        const auto in    = t * t;
+        const auto out   = t * (2.0f - t);
+        const auto inOut = t < 0.5f ? 2.0f * t * t : 1.0f - 2.0f * (1.0f - t) * (1.0f - t);
+        return type == TransitionType::LINEAR  ? t :
+               type == TransitionType::EASE_IN  ? in :
+               type == TransitionType::EASE_OUT ? out : inOut;
+    }
+
+    /**
+     * Interpolates a tweened value
+     */
+    template<typename T>
+    inline T interpolate(const T& start, const T& final, const float t) {
+        return glm::mix(start, final, t);
+    }
+
+    /**
+     * Interpolates a tweened rotation
+     */
+    template<>
+    inline quat interpolate(const quat& start, const quat& final, const float t) {
+        return glm::slerp(start, final, t);
+    }
+
     /**
      * Base class for all tweeners classes.<br>
      * Tweens are objects that perform a specific animating task, e.g. interpolating a property of an Object. 
@@ -27,7 +56,7 @@ export namespace z0 {
         /**
          * Update the tween.
          * If the Tween have been created manually you need to call update() in your Node::onPhysicsProcess() function.
-         * Do not call it if the Tween have been created with Node::create*Tween().
+         * Do not call it if the Tween have been created with Node::createPropertyTween().
          * * @return `false` if the tween is running
          */
         [[nodiscard]] virtual bool update(float deltaTime) = 0;
@@ -114,7 +143,7 @@ export namespace z0 {
         [[nodiscard]] bool update(const float deltaTime) override {
             elapsedTime += deltaTime;
             float t = std::min(elapsedTime / durationTime, 1.0f); // Normalized time
-            (targetObject->*setter)(lerp(startValue, targetValue, t));
+            (targetObject->*setter)(interpolate(startValue, targetValue, ease(interpolationType, t)));
             running = (t < 1.0);
             if (!running && callback) {
                 callback();
@@ -131,4 +160,131 @@ export namespace z0 {
         Setter setter;
     };
 
-}
\ No newline at end of file
+
+    /**
+     * Central tweens system used by Node::addPropertyTween().<br>
+     * Tweens states are stored in pooled structure-of-arrays, one pool per value type (float, vec2, vec3, vec4 and quat),
+     * and updated in batch once per physics step : times, easing curves and interpolated values are computed in tight
+     * loops before the setters are called.<br>
+     * Tweens attached to a node are only updated when the node is processed (see Node::isProcessed()).
+     */
+    class TweenManager {
+    public:
+        /**
+         * Unique tween identifier
+         */
+        using id_t = uint64_t;
+        static constexpr id_t INVALID_ID = 0;
+
+        /**
+         * Tweens target slot, used to check if the target of a tween is processed
+         */
+        using target_t = uint32_t;
+        static constexpr target_t NO_TARGET = numeric_limits<target_t>::max();
+
+        /**
+         * Creates a Tween to tweens a property of an Object.
+         * @param obj Target Object
+         * @param set Setter to call on the Object
+         * @param initial Initial value
+         * @param final Final value
+         * @param duration Animation duration in seconds
+         * @param ttype Transition type
+         * @param callback Callback called at the end of the animation
+         * @param target Target slot, NO_TARGET for a tween updated whatever the state of the Object
+         */
+        template<typename T>
+        static id_t create(Object* obj,
+                           const typename PropertyTween<T>::Setter set,
+                           const T& initial,
+                           const T& final,
+                           const float duration,
+                           const TransitionType ttype = TransitionType::LINEAR,
+                           const Tween::Callback& callback = nullptr,
+                           const target_t target = NO_TARGET) {
+            auto& pool = getPool<T>();
+            const auto id = nextId++;
+            pool.ids.push_back(id);
+            pool.targets.push_back(target);
+            pool.objects.push_back(obj);
+            pool.setters.push_back(set);
+            pool.startValues.push_back(initial);
+            pool.finalValues.push_back(final);
+            pool.durations.push_back(std::max(duration, numeric_limits<float>::epsilon()));
+            pool.elapsed.push_back(0.0f);
+            pool.transitions.push_back(ttype);
+            pool.callbacks.push_back(callback);
+            return id;
+        }
+
+        /**
+         * Stops and removes a tween, the end callback is not called
+         */
+        static void kill(id_t id);
+
+        /**
+         * Returns `true` if the tween is running
+         */
+        [[nodiscard]] static bool isRunning(id_t id);
+
+        /**
+         * Returns the number of running tweens
+         */
+        [[nodiscard]] static size_t getCount();
+
+    private:
+        template<typename T>
+        struct Pool {
+            vector<id_t>                              ids;
+            vector<target_t>                          targets;
+            vector<Object*>                           objects;
+            vector<typename PropertyTween<T>::Setter> setters;
+            vector<T>                                 startValues;
+            vector<T>                                 finalValues;
+            vector<float>                             durations;
+            vector<float>                             elapsed;
+            vector<TransitionType>                    transitions;
+            vector<Tween::Callback>                   callbacks;
+            // Per-update scratch buffers, kept to avoid reallocations
+            vector<uint8_t>                           active;
+            vector<float>                             times;
+            vector<T>                                 values;
+
+            void update(float delta, const vector<uint32_t>& stamps, uint32_t stamp, vector<Tween::Callback>& completed);
+
+            void remove(size_t index);
+
+            void removeTarget(target_t target);
+
+            bool kill(id_t id);
+        };
+
+        static inline id_t                    nextId{1};
+        static inline uint32_t                currentStamp{1};
+        // Last physics step where each target slot was processed
+        static inline vector<uint32_t>        targetsStamps;
+        static inline vector<target_t>        freeTargets;
+        // End callbacks of the tweens completed during the last update
+        static inline vector<Tween::Callback> completedCallbacks;
+
+        template<typename T>
+        static Pool<T>& getPool() {
+            static_assert(is_same_v<T, float> || is_same_v<T, vec2> || is_same_v<T, vec3> ||
+                          is_same_v<T, vec4> || is_same_v<T, quat>, "Unsupported tween value type");
+            static Pool<T> pool;
+            return pool;
+        }
+
+    public:
+        static target_t _registerTarget();
+
+        static void _releaseTarget(target_t target);
+
+        static inline void _setProcessed(const target_t target) { targetsStamps[target] = currentStamp; }
+
+        static void _update(float delta);
+
+        static void _runCallbacks();
+    };
+
+}
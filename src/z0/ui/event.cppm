@@ -59,6 +59,8 @@ export namespace z0 {
             //static const string OnValueUserChange;
             //! range of a ValueSelect widget changed
             static const string OnRangeChange;
+            //! selected item of a ListView or a TreeView changed
+            static const string OnSelectItem;
             //! item list of a GList widget have changed
             //static const string OnInsertItem;
             //! item list of a GList widget have changed
@@ -146,6 +148,14 @@ export namespace z0 {
             const string text;
         };
 
+        /**
+         * Parameters for Event::OnSelectItem
+         */
+        struct EventSelectItem : Event {
+            //! index of the selected row
+            uint32_t row;
+        };
+
         const Signal::signal Event::OnCreate{"on_create"};
         const Signal::signal Event::OnDestroy{"on_destroy"};
         const Signal::signal Event::OnKeyDown{"on_key_down"};
@@ -167,9 +177,9 @@ export namespace z0 {
         const Signal::signal Event::OnValueChange{"on_value_change"};
         //const Signal::signal Event::OnValueUserChange{"on_value_use_change"};
         const Signal::signal Event::OnRangeChange{"on_range_change"};
+        const Signal::signal Event::OnSelectItem{"on_select_item"};
         /*     const Signal::signal Event::OnInsertItem{"on_insert_item"};
             const Signal::signal Event::OnRemoveItem{"on_remove_item"};
-            const Signal::signal Event::OnSelectItem{"on_select_item"};
          */
     }
 }
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2024-2025 Henri Michelon
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+*/
+module;
+#include "z0/libraries.h"
+
+export module z0.ui.ListModel;
+
+import z0.ui.Text;
+import z0.ui.Widget;
+
+export namespace z0 {
+
+    namespace ui {
+        /**
+         * Data source of a ListView.<br>
+         * The list view only asks for the rows visible in its viewport and reuses the same row widgets when scrolling,
+         * the items are never stored in widgets.
+         */
+        class ListModel {
+        public:
+            virtual ~ListModel() = default;
+
+            /** Returns the number of rows */
+            [[nodiscard]] virtual uint32_t getRowCount() const = 0;
+
+            /** Returns the text of a row, used by the default row widgets */
+            [[nodiscard]] virtual string getRowText(uint32_t index) const = 0;
+
+            /**
+             * Adds the children of a new row widget. The row is already added to the list view.<br>
+             * The default row contains a single Text.
+             */
+            virtual void createRow(Widget &row) const {
+                row.add(make_shared<Text>(""), Widget::LEFT);
+            }
+
+            /** Updates a (recycled) row widget with the data of a row */
+            virtual void bindRow(Widget &row, const uint32_t index) const {
+                static_pointer_cast<Text>(row._getChildren().front())->setText(getRowText(index));
+            }
+        };
+
+        /**
+         * Hierarchical data source of a TreeView.<br>
+         * Nodes are opaque identifiers chosen by the model, only the children of the expanded nodes are queried.
+         */
+        class TreeModel {
+        public:
+            /** Node identifier */
+            using Node = uint64_t;
+
+            /** Invisible root of the tree, parent of the top level nodes */
+            static constexpr Node ROOT{0};
+
+            virtual ~TreeModel() = default;
+
+            /** Returns the number of children of a node */
+            [[nodiscard]] virtual uint32_t getChildCount(Node node) const = 0;
+
+            /** Returns a child of a node */
+            [[nodiscard]] virtual Node getChild(Node parent, uint32_t index) const = 0;
+
+            /** Returns the text of a node */
+            [[nodiscard]] virtual string getText(Node node) const = 0;
+        };
+    }
+}
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2024-2025 Henri Michelon
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+*/
+module;
+#include "z0/libraries.h"
+
+module z0.ui.ListView;
+
+namespace z0 {
+
+    namespace ui {
+
+        ListView::ListView(): Widget(LISTVIEW) {}
+
+        ListView::ListView(const Type T): Widget(T) {}
+
+        void ListView::setResources(const string& RBOX, const string& RSCROLL, const string&) {
+            if (box == nullptr) {
+                box = make_shared<Box>();
+                vscroll = make_shared<VScrollBar>(0.0f, 0.0f);
+                add(vscroll, RIGHT, RSCROLL);
+                add(box, FILL, RBOX);
+                box->setDrawBackground(false);
+                box->setPadding(1);
+                vscroll->connect(Event::OnValueChange,
+                    [this](auto p) { this->onScroll(static_cast<const EventValue *>(p)); });
+            }
+        }
+
+        void ListView::setModel(const shared_ptr<ListModel>& model) {
+            this->model = model;
+            firstRow = 0;
+            selected = NO_SELECTION;
+            refreshRows();
+        }
+
+        void ListView::refreshRows() {
+            if ((box == nullptr) || (model == nullptr)) { return; }
+            if (rowHeight == 0.0f) {
+                float width;
+                getFont().getSize("Ag", width, rowHeight);
+            }
+            rowsCount = model->getRowCount();
+            if ((selected != NO_SELECTION) && (selected >= rowsCount)) {
+                selected = NO_SELECTION;
+            }
+
+            // Only the fully visible rows have a widget, stacked on the top of the box
+            const auto rowSpace = rowHeight + 2 * box->getPadding() + 1;
+            const auto viewportRows = static_cast<uint32_t>(std::max(0.0f, box->getRect().height / rowSpace));
+            while (rows.size() < viewportRows) {
+                const auto index = static_cast<uint32_t>(rows.size());
+                const auto row = make_shared<Panel>();
+                box->add(row, TOP);
+                row->setDrawBackground(false);
+                row->_setSize(box->getRect().width, rowHeight);
+                row->connect(Event::OnMouseDown, [this, index](auto) { this->select(firstRow + index); });
+                model->createRow(*row);
+                rows.push_back(row);
+            }
+            while (rows.size() > viewportRows) {
+                box->remove(rows.back());
+                rows.pop_back();
+            }
+
+            // The maximum of a vertical scroll bar is at the top
+            const auto maxFirstRow = rowsCount > rows.size() ? rowsCount - static_cast<uint32_t>(rows.size()) : 0;
+            firstRow = std::min(firstRow, maxFirstRow);
+            updating = true;
+            vscroll->setMax(static_cast<float>(maxFirstRow));
+            vscroll->setValue(static_cast<float>(maxFirstRow - firstRow));
+            updating = false;
+            bindRows();
+        }
+
+        void ListView::scrollTo(const uint32_t index) {
+            if (index < firstRow) {
+                firstRow = index;
+            } else if (index >= firstRow + rows.size()) {
+                firstRow = index - static_cast<uint32_t>(rows.size()) + 1;
+            } else {
+                return;
+            }
+            refreshRows();
+        }
+
+        void ListView::select(const uint32_t index) {
+            if ((index >= rowsCount) || (index == selected)) { return; }
+            selected = index;
+            bindRows();
+            auto event = EventSelectItem{.row = index};
+            event.source = this;
+            emit(Event::OnSelectItem, &event);
+        }
+
+        void ListView::eventResize() {
+            Widget::eventResize();
+            refreshRows();
+        }
+
+        void ListView::bindRows() const {
+            for (auto i = 0; i < rows.size(); i++) {
+                const auto index = firstRow + i;
+                const auto& row = rows[i];
+                if (index < rowsCount) {
+                    model->bindRow(*row, index);
+                    row->setDrawBackground(index == selected);
+                    row->show(true);
+                } else {
+                    row->show(false);
+                }
+            }
+        }
+
+        void ListView::onScroll(const EventValue* event) {
+            if (updating) { return; }
+            const auto row = static_cast<uint32_t>(std::round(vscroll->getMax() - event->value));
+            if (row == firstRow) { return; }
+            firstRow = row;
+            bindRows();
+        }
+
+    }
+}
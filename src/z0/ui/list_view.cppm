@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2024-2025 Henri Michelon
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+*/
+module;
+#include "z0/libraries.h"
+
+export module z0.ui.ListView;
+
+import z0.ui.Box;
+import z0.ui.Event;
+import z0.ui.ListModel;
+import z0.ui.Panel;
+import z0.ui.ScrollBar;
+import z0.ui.Widget;
+
+export namespace z0 {
+
+    namespace ui {
+        /**
+         * Virtualized list of rows.<br>
+         * Only the row widgets needed to fill the viewport are created, they are recycled and bound to the data of
+         * the ListModel when scrolling, so the cost does not depend on the number of rows.<br>
+         * Emits Event::OnSelectItem when the user selects a row.
+         */
+        class ListView : public Widget {
+        public:
+            /** Selection index when no row is selected */
+            static constexpr uint32_t NO_SELECTION{numeric_limits<uint32_t>::max()};
+
+            ListView();
+
+            void setResources(const string& RBOX, const string& RSCROLL, const string&);
+
+            /** Sets the data source of the rows */
+            void setModel(const shared_ptr<ListModel>& model);
+
+            /** Returns the data source of the rows */
+            [[nodiscard]] inline const auto& getModel() const { return model; }
+
+            /** Reads again the rows count and the visible rows, must be called when the data of the model change */
+            void refreshRows();
+
+            /** Scrolls the list the minimum needed to make a row visible */
+            void scrollTo(uint32_t index);
+
+            /** Returns the index of the first visible row */
+            [[nodiscard]] inline auto getFirstVisibleRow() const { return firstRow; }
+
+            /** Selects a row */
+            void select(uint32_t index);
+
+            /** Returns the index of the selected row or NO_SELECTION */
+            [[nodiscard]] inline auto getSelected() const { return selected; }
+
+        protected:
+            //! Selected row
+            uint32_t selected{NO_SELECTION};
+
+            explicit ListView(Type T);
+
+            void eventResize() override;
+
+            //! Number of row widgets, which is the slot of the row widget given to ListModel::createRow()
+            [[nodiscard]] inline auto getRowWidgetsCount() const { return static_cast<uint32_t>(rows.size()); }
+
+        private:
+            shared_ptr<ListModel>     model;
+            shared_ptr<Box>           box;
+            shared_ptr<VScrollBar>    vscroll;
+            //! Recycled row widgets, from the top of the viewport
+            vector<shared_ptr<Panel>> rows;
+            //! Index of the row displayed by the first row widget
+            uint32_t                  firstRow{0};
+            uint32_t                  rowsCount{0};
+            float                     rowHeight{0.0f};
+            //! Ignores the scroll bar events while updating its range
+            bool                      updating{false};
+
+            void bindRows() const;
+
+            void onScroll(const EventValue* event);
+        };
+    }
+}
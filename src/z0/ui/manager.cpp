@@ -49,6 +49,7 @@ namespace z0 {
                 if (window->isVisible()) { window->eventHide(); }
                 window->eventDestroy();
                 windows.remove(window);
+                if (vectorRenderer) { vectorRenderer->removeLayer(window.get()); }
                 needRedraw = true;
             }
             removedWindows.clear();
@@ -73,6 +74,7 @@ namespace z0 {
                             }
                         }
                         window->eventHide();
+                        if (vectorRenderer) { vectorRenderer->removeLayer(window.get()); }
                     }
                 }
             }
@@ -81,10 +83,18 @@ namespace z0 {
             if (vectorRenderer) {
                 vectorRenderer->beginDraw();
                 for (const auto& window: windows) {
-                    window->draw();
+                    if (!window->isVisible()) { continue; }
+                    // Unchanged windows are composed from their retained geometry, already in GPU memory
+                    if (redrawAll || window->needRedraw || !vectorRenderer->keepLayer(window.get())) {
+                        window->needRedraw = false;
+                        vectorRenderer->beginLayer(window.get());
+                        window->draw();
+                        vectorRenderer->endLayer();
+                    }
                 }
                 vectorRenderer->endDraw();
             }
+            redrawAll = false;
         }
 
         shared_ptr<ui::Window> Manager::add(const shared_ptr<Window> &window) {
@@ -45,7 +45,12 @@ export namespace z0 {
             /**
              * Forces a redraw of all the UI at the start of the next frame
              */
-            inline void refresh() { needRedraw = true; }
+            inline void refresh() { needRedraw = redrawAll = true; }
+
+            /**
+             * Redraws the modified windows at the start of the next frame
+             */
+            inline void _refresh() { needRedraw = true; }
 
             [[nodiscard]] inline VectorRenderer& getRenderer() const { return *vectorRenderer; }
             [[nodiscard]] inline float getResizeDelta() const { return resizeDelta; }
@@ -65,6 +70,8 @@ export namespace z0 {
             shared_ptr<Window>          focusedWindow{nullptr};
             shared_ptr<Window>          resizedWindow{nullptr};
             bool                        needRedraw{false};
+            // Regenerate all the windows instead of only the modified ones
+            bool                        redrawAll{false};
             bool                        enableWindowResizing{true};
             bool                        resizingWindow{false};
             bool                        resizingWindowOriginBorder{false};
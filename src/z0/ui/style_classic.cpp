@@ -120,8 +120,9 @@ namespace z0::ui {
         case Widget::SCROLLBAR:
             static_cast<ScrollBar &>(widget).setResources(",,LOWERED", ",,RAISED");
             break;
+        case Widget::LISTVIEW:
         case Widget::TREEVIEW:
-            static_cast<TreeView &>(widget).setResources(",,LOWERED", "18,18,RAISED", "");
+            static_cast<ListView &>(widget).setResources(",,LOWERED", "18,18,RAISED", "");
             break;
             // XXX
             /*case Widget::UPDOWN:
@@ -16,6 +16,7 @@ import z0.ui.Button;
 import z0.ui.CheckWidget;
 import z0.ui.Frame;
 import z0.ui.Line;
+import z0.ui.ListView;
 import z0.ui.Panel;
 import z0.ui.Rect;
 import z0.ui.Resource;
@@ -24,7 +25,6 @@ import z0.ui.Style;
 import z0.ui.StyleClassicResource;
 import z0.ui.Text;
 import z0.ui.ToggleButton;
-import z0.ui.TreeView;
 import z0.ui.Widget;
 
 import z0.vulkan.VectorRenderer;
@@ -1,6 +1,6 @@
 /*
  * Copyright (c) 2024-2025 Henri Michelon
- * 
+ *
  * This software is released under the MIT License.
  * https://opensource.org/licenses/MIT
 */
@@ -9,72 +9,104 @@ module;
 
 module z0.ui.TreeView;
 
+import z0.ui.Event;
+import z0.ui.Panel;
+import z0.ui.Text;
+
 namespace z0 {
 
     namespace ui {
 
-        TreeView::TreeView(): Widget(TREEVIEW) {}
-
-        void TreeView::setResources(const string& RBOX, const string& RSCROLL, const string&) {
-            if (box == nullptr) {
-                box = make_shared<Box>();
-                vscroll = make_shared<VScrollBar>(0.0f, 0.0f);
-                add(vscroll, RIGHT, RSCROLL);
-                add(box, FILL, RBOX);
-                box->setDrawBackground(false);
-                box->setPadding(1);
-                vscroll->setStep(2);
+        TreeView::TreeView(): ListView(TREEVIEW) {}
+
+        void TreeView::setTreeModel(const shared_ptr<TreeModel>& model) {
+            treeModel = model;
+            expanded.clear();
+            visibleNodes.clear();
+            flatten(TreeModel::ROOT, 0);
+            setModel(make_shared<Rows>(*this));
+        }
+
+        void TreeView::refreshNodes() {
+            if (treeModel == nullptr) { return; }
+            const auto selectedNode = getSelectedNode();
+            visibleNodes.clear();
+            flatten(TreeModel::ROOT, 0);
+            // The selection follows the node
+            selected = NO_SELECTION;
+            if (selectedNode != TreeModel::ROOT) {
+                for (auto i = 0; i < visibleNodes.size(); i++) {
+                    if (visibleNodes[i].node == selectedNode) {
+                        selected = i;
+                        break;
+                    }
+                }
             }
+            refreshRows();
         }
 
-        void TreeView::removeAllItems() {
-            box->removeAll();
-            items.clear();
+        void TreeView::expand(const Node node, const bool state) {
+            if (state == isExpanded(node)) { return; }
+            if (state) {
+                expanded.insert(node);
+            } else {
+                expanded.erase(node);
+            }
+            refreshNodes();
         }
 
-        shared_ptr<TreeView::Item>& TreeView::addItem(shared_ptr<Widget> item) {
-            items.push_back(make_shared<Item>(item));
-            auto& newWidget = items.back();
-            box->add(newWidget, Widget::TOPLEFT);
-            newWidget->handle = make_shared<Text>(" ");
-            newWidget->add(newWidget->handle, Widget::LEFT, treeTabsSize);
-            newWidget->add(item, Widget::LEFT);
-            newWidget->_setSize(1000.0f, item->getHeight());
-            newWidget->setDrawBackground(false);
-            return newWidget;
+        TreeView::Node TreeView::getSelectedNode() const {
+            return selected < visibleNodes.size() ? visibleNodes[selected].node : TreeModel::ROOT;
         }
 
-        shared_ptr<TreeView::Item>& TreeView::addItem(const shared_ptr<Item>& parent, shared_ptr<Widget> item) {
-            parent->children.push_back(make_shared<Item>(item));
-            auto& newWidget = parent->children.back();
-            newWidget->level = parent->level + 1;
-            box->add(newWidget, Widget::TOPLEFT);
-            for (int i = 0; i <= newWidget->level; i++) {
-                if (i == (newWidget->level)) {
-                    newWidget->handle = make_shared<Text>(" ");
-                    newWidget->add(newWidget->handle, Widget::LEFT, treeTabsSize);
-                }
-                else {
-                    newWidget->add(make_shared<Panel>(), Widget::LEFT, treeTabsSize);
+        void TreeView::flatten(const Node node, const uint32_t level) {
+            const auto count = treeModel->getChildCount(node);
+            for (auto i = 0; i < count; i++) {
+                const auto child = treeModel->getChild(node, i);
+                visibleNodes.push_back({child, level});
+                if (expanded.contains(child)) {
+                    flatten(child, level + 1);
                 }
             }
-            parent->handle->setText("-");
-            newWidget->add(item, Widget::LEFT);
-            newWidget->_setSize(1000.0f, item->getHeight());
-            newWidget->setDrawBackground(false);
-            //expand(parent->item);
-            return newWidget;
         }
 
-        void TreeView::expand(const shared_ptr<Widget>& item) const {
-            for (const auto& widget : box->_getChildren()) {
-                if (const auto itemWidget = dynamic_cast<TreeView::Item*>(item.get())) {
-                    if (itemWidget->item == item) {
-                        // log("found");
-                    }
-                }
+        void TreeView::toggle(const uint32_t index) {
+            if (index >= visibleNodes.size()) { return; }
+            const auto node = visibleNodes[index].node;
+            if (treeModel->getChildCount(node) > 0) {
+                expand(node, !isExpanded(node));
             }
         }
 
+        uint32_t TreeView::Rows::getRowCount() const {
+            return static_cast<uint32_t>(view.visibleNodes.size());
+        }
+
+        string TreeView::Rows::getRowText(const uint32_t index) const {
+            return view.treeModel->getText(view.visibleNodes[index].node);
+        }
+
+        void TreeView::Rows::createRow(Widget &row) const {
+            // Slot of the recycled row widget, from the top of the viewport
+            const auto slot = view.getRowWidgetsCount();
+            row.add(make_shared<Panel>(), Widget::LEFT)->setDrawBackground(false);
+            const auto handle = row.add(make_shared<Text>(""), Widget::LEFT);
+            handle->connect(Event::OnMouseDown,
+                [this, slot](auto) { view.toggle(view.getFirstVisibleRow() + slot); });
+            row.add(make_shared<Text>(""), Widget::LEFT);
+        }
+
+        void TreeView::Rows::bindRow(Widget &row, const uint32_t index) const {
+            const auto& [node, level] = view.visibleNodes[index];
+            auto it = row._getChildren().begin();
+            const auto indent = *(it++);
+            const auto handle = static_pointer_cast<Text>(*(it++));
+            const auto label = static_pointer_cast<Text>(*it);
+            indent->_setSize(level * INDENT_SIZE, row.getHeight());
+            handle->setText(view.treeModel->getChildCount(node) == 0 ? " " : view.isExpanded(node) ? "-" : "+");
+            handle->_setSize(HANDLE_SIZE, handle->getHeight());
+            label->setText(getRowText(index));
+        }
+
     }
 }
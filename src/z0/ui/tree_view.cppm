@@ -1,6 +1,6 @@
 /*
  * Copyright (c) 2024-2025 Henri Michelon
- * 
+ *
  * This software is released under the MIT License.
  * https://opensource.org/licenses/MIT
 */
@@ -9,52 +9,75 @@ module;
 
 export module z0.ui.TreeView;
 
-import z0.Application;
-import z0.Constants;
-import z0.Tools;
-
-import z0.ui.Box;
-import z0.ui.Panel;
-import z0.ui.ScrollBar;
-import z0.ui.Text;
+import z0.ui.ListModel;
+import z0.ui.ListView;
 import z0.ui.Widget;
 
 export namespace z0 {
 
     namespace ui {
-        class TreeView : public Widget {
+        /**
+         * Virtualized tree of rows.<br>
+         * The expanded nodes of the TreeModel are flattened in a list of visible nodes displayed by the recycled
+         * rows of a ListView : only the children of the expanded nodes are queried.
+         * Clicking on the handle of a node expands or collapses it.
+         */
+        class TreeView : public ListView {
         public:
-            class Item : public Panel {
-            public:
-                shared_ptr<Widget> item;
-                shared_ptr<Text> handle;
-                list<shared_ptr<Item>> children;
-                int level{0};
-                bool selected{false};
-                bool expanded{false};
-
-                explicit Item(shared_ptr<Widget> _item) : item{_item} {}
-            };
+            using Node = TreeModel::Node;
 
             TreeView();
 
-            void setResources(const string& RBOX, const string& RSCROLL, const string&);
+            /** Sets the data source of the nodes, all the nodes are collapsed */
+            void setTreeModel(const shared_ptr<TreeModel>& model);
 
-            void removeAllItems();
+            /** Reads again the visible nodes, must be called when the data of the model change */
+            void refreshNodes();
 
-            shared_ptr<Item>& addItem(shared_ptr<Widget> item);
+            /** Expands or collapses a node */
+            void expand(Node node, bool state = true);
 
-            shared_ptr<Item>& addItem(const shared_ptr<Item>& parent, shared_ptr<Widget> item);
+            /** Returns true if the children of the node are visible */
+            [[nodiscard]] inline bool isExpanded(const Node node) const { return expanded.contains(node); }
 
-            void expand(const shared_ptr<Widget>& item) const;
+            /** Returns the selected node or TreeModel::ROOT */
+            [[nodiscard]] Node getSelectedNode() const;
 
         private:
-            const string treeTabsSize{"5,5"};
-            float innerHeight;
-            float itemsHeight;
-            list<shared_ptr<Item>> items;
-            shared_ptr<Box> box;
-            shared_ptr<VScrollBar> vscroll;
+            // Horizontal space per level
+            static constexpr float INDENT_SIZE{10.0f};
+            // Width of the expand/collapse handle
+            static constexpr float HANDLE_SIZE{8.0f};
+
+            struct VisibleNode {
+                Node     node;
+                uint32_t level;
+            };
+
+            // Presents the visible nodes as rows to the list view
+            class Rows : public ListModel {
+            public:
+                explicit Rows(TreeView &view) : view{view} {}
+
+                [[nodiscard]] uint32_t getRowCount() const override;
+
+                [[nodiscard]] string getRowText(uint32_t index) const override;
+
+                void createRow(Widget &row) const override;
+
+                void bindRow(Widget &row, uint32_t index) const override;
+
+            private:
+                TreeView &view;
+            };
+
+            shared_ptr<TreeModel> treeModel;
+            set<Node>             expanded;
+            vector<VisibleNode>   visibleNodes;
+
+            void flatten(Node node, uint32_t level);
+
+            void toggle(uint32_t index);
         };
     }
 }
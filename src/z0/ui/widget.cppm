@@ -47,7 +47,9 @@ namespace z0::ui {
             TEXTEDIT,
             //! %A scroll bar. with min, max & pos
             SCROLLBAR,
-            //! Tree of Widget
+            //! Virtualized list of rows
+            LISTVIEW,
+            //! Virtualized tree of rows
             TREEVIEW,
             //! 2D Image
             IMAGE,
@@ -185,7 +185,8 @@ namespace z0::ui {
             emit(Event::OnMouseUp, &event);
             consumed = event.consumed;
         }
-        refresh();
+        // Mouse up events are sent to all the windows, widgets refresh themselves when their state changes
+        if (consumed) { refresh(); }
         return consumed;
     }
 
@@ -211,7 +212,8 @@ namespace z0::ui {
     }
 
     void Window::refresh() const {
-        if (windowManager) { static_cast<Manager*>(windowManager)->refresh(); }
+        needRedraw = true;
+        if (windowManager) { static_cast<Manager*>(windowManager)->_refresh(); }
     }
 
     void Window::setFocusedWidget(const shared_ptr<Widget> &W) {
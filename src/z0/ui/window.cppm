@@ -256,6 +256,8 @@ export namespace z0::ui {
         bool                visibilityChanged{false};
         bool                visible{true};
         bool                visibilityChange{false};
+        // The retained geometry of the window must be regenerated
+        mutable bool        needRedraw{true};
 
     private:
         Rect                rect;
@@ -225,8 +225,9 @@ namespace z0 {
                     JPH::Mat44::sScale(applicationConfig.debugConfig.drawCoordinateSystemScale));
             }
             if (applicationConfig.debugConfig.drawRayCast) {
+                auto lock = lock_guard(frameDataMutex);
                 debugRenderer->drawRayCasts(
-                    rootNode,
+                    nodesByType[Node::RAYCAST],
                     applicationConfig.debugConfig.drawRayCastColor,
                     applicationConfig.debugConfig.drawRayCastCollidingColor);
             }
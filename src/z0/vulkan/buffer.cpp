@@ -28,7 +28,8 @@ namespace z0 {
     Buffer::Buffer(const VkDeviceSize       instanceSize,
                    const uint32_t           instanceCount,
                    const VkBufferUsageFlags usageFlags,
-                   const VkDeviceSize       minOffsetAlignment):
+                   const VkDeviceSize       minOffsetAlignment,
+                   const bool               hostRead):
         allocator{Device::get().getAllocator()} {
         alignmentSize = minOffsetAlignment > 0
                 ? (instanceSize + minOffsetAlignment - 1) & ~(minOffsetAlignment - 1)
@@ -40,8 +41,10 @@ namespace z0 {
                 .usage = usageFlags,
                 .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
         };
+        // Uniform buffers and GPU to CPU readback buffers are read by the host
+        const auto randomAccess = hostRead || (usageFlags & VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
         const VmaAllocationCreateInfo allocInfo = {
-                .flags = static_cast<VmaAllocationCreateFlags>(usageFlags & VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT
+                .flags = static_cast<VmaAllocationCreateFlags>(randomAccess
                 ? VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT
                 : VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT),
                 .usage = VMA_MEMORY_USAGE_AUTO,
@@ -76,27 +79,45 @@ namespace z0 {
     }
 
     VkResult Buffer::map() {
-        return vmaMapMemory(allocator, allocation, &mapped);
+        const auto result = vmaMapMemory(allocator, allocation, &mapped);
+        if (result == VK_SUCCESS) {
+            VkMemoryPropertyFlags memoryProperties;
+            vmaGetAllocationMemoryProperties(allocator, allocation, &memoryProperties);
+            coherent = memoryProperties & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+        }
+        return result;
     }
 
     void Buffer::writeToBuffer(const void *       data,
                                const VkDeviceSize size,
                                const VkDeviceSize offset) const {
-        if (size == VK_WHOLE_SIZE) {
-            vmaCopyMemoryToAllocation(allocator,
-                                      data,
-                                      allocation,
-                                      0,
-                                      bufferSize);
+        const auto writeOffset = size == VK_WHOLE_SIZE ? 0 : offset;
+        const auto writeSize = size == VK_WHOLE_SIZE ? bufferSize : size;
+        if (mapped) {
+            // Persistently mapped buffer : direct copy, only non-coherent memory needs to be flushed
+            memcpy(static_cast<char *>(mapped) + writeOffset, data, writeSize);
+            if (!coherent) {
+                vmaFlushAllocation(allocator, allocation, writeOffset, writeSize);
+            }
         } else {
             vmaCopyMemoryToAllocation(allocator,
                                       data,
                                       allocation,
-                                      offset,
-                                      size);
+                                      writeOffset,
+                                      writeSize);
         }
     }
 
+    void Buffer::readFromBuffer(void *             data,
+                                const VkDeviceSize size,
+                                const VkDeviceSize offset) const {
+        vmaCopyAllocationToMemory(allocator,
+                                  allocation,
+                                  offset,
+                                  data,
+                                  size);
+    }
+
     void Buffer::copyTo(const VkCommandBuffer commandBuffer, const Buffer &dstBuffer, const VkDeviceSize size) const {
         const VkBufferCopy copyRegion {
             .size = size
@@ -18,10 +18,15 @@ export namespace z0 {
      */
     class Buffer {
     public:
+        /*
+         * Creates a buffer in host visible memory.
+         * `hostRead` selects a memory type suited for reading on the CPU, for the GPU to CPU readbacks.
+         */
         Buffer(VkDeviceSize       instanceSize,
                uint32_t           instanceCount,
                VkBufferUsageFlags usageFlags,
-               VkDeviceSize       minOffsetAlignment = 1);
+               VkDeviceSize       minOffsetAlignment = 1,
+               bool               hostRead = false);
 
         Buffer(Buffer &&) = delete;
         Buffer(Buffer &) = delete;
@@ -41,6 +46,10 @@ export namespace z0 {
                            VkDeviceSize size   = VK_WHOLE_SIZE,
                            VkDeviceSize offset = 0) const;
 
+        void readFromBuffer(void *       data,
+                            VkDeviceSize size,
+                            VkDeviceSize offset = 0) const;
+
         void copyTo(VkCommandBuffer commandBuffer, const Buffer &dstBuffer, VkDeviceSize size) const;
 
     private:
@@ -50,6 +59,7 @@ export namespace z0 {
         VkDeviceSize  bufferSize;
         VkDeviceSize  alignmentSize;
         void *        mapped = nullptr;
+        bool          coherent = false;
 
     public:
         Buffer(const Buffer &) = delete;
@@ -42,21 +42,55 @@ namespace z0 {
         return *this;
     }
 
+    DescriptorSetLayout::Builder &DescriptorSetLayout::Builder::setBindingFlags(const uint32_t                 binding,
+                                                                                const VkDescriptorBindingFlags flags) {
+        assert(bindings.count(binding) == 1 && "Layout does not contain specified binding");
+        bindingsFlags[binding] = flags;
+        return *this;
+    }
+
     unique_ptr<DescriptorSetLayout> DescriptorSetLayout::Builder::build() const {
-        return make_unique<DescriptorSetLayout>(device, bindings);
+        return make_unique<DescriptorSetLayout>(device, bindings, bindingsFlags);
     }
 
     DescriptorSetLayout::DescriptorSetLayout(const Device &device,
                                              const unordered_map<uint32_t,
-                                                                 VkDescriptorSetLayoutBinding> &bindings):
+                                                                 VkDescriptorSetLayoutBinding> &bindings,
+                                             const unordered_map<uint32_t,
+                                                                 VkDescriptorBindingFlags> &bindingsFlags):
         device{device},
         bindings{bindings} {
         vector<VkDescriptorSetLayoutBinding> setLayoutBindings{};
+        vector<VkDescriptorBindingFlags> setLayoutBindingsFlags{};
+        auto updateAfterBind{false};
         for (auto kv : bindings) {
             setLayoutBindings.push_back(kv.second);
+            const auto flags = bindingsFlags.contains(kv.first) ? bindingsFlags.at(kv.first) : 0;
+            setLayoutBindingsFlags.push_back(flags);
+            updateAfterBind |= (flags & VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT) != 0;
+            // FNV-1a hash of each binding, summed to not depend on the order of the map
+            auto hash = uint64_t{14695981039346656037ull};
+            for (const auto value : { kv.second.binding,
+                                      static_cast<uint32_t>(kv.second.descriptorType),
+                                      kv.second.descriptorCount,
+                                      static_cast<uint32_t>(kv.second.stageFlags),
+                                      static_cast<uint32_t>(flags) }) {
+                hash ^= value;
+                hash *= 1099511628211ull;
+            }
+            signature += hash;
         }
+        // https://docs.vulkan.org/samples/latest/samples/extensions/descriptor_indexing/README.html
+        const VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{
+                .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,
+                .bindingCount = static_cast<uint32_t>(setLayoutBindingsFlags.size()),
+                .pBindingFlags = setLayoutBindingsFlags.data(),
+        };
         const VkDescriptorSetLayoutCreateInfo descriptorSetLayoutInfo{
                 .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+                .pNext = bindingsFlags.empty() ? nullptr : &bindingFlagsInfo,
+                .flags = static_cast<VkDescriptorSetLayoutCreateFlags>(updateAfterBind ?
+                    VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT : 0),
                 .bindingCount = static_cast<uint32_t>(setLayoutBindings.size()),
                 .pBindings = setLayoutBindings.data(),
         };
@@ -183,6 +217,25 @@ namespace z0 {
         return *this;
     }
 
+    DescriptorWriter &DescriptorWriter::writeImage(const uint32_t               binding,
+                                                   const VkDescriptorImageInfo *imageInfo,
+                                                   const uint32_t               arrayElement,
+                                                   const uint32_t               count) {
+        assert(setLayout.bindings.count(binding) == 1 && "Layout does not contain specified binding");
+        const auto &               bindingDescription = setLayout.bindings[binding];
+        assert((arrayElement + count) <= bindingDescription.descriptorCount && "Array element out of range");
+        const VkWriteDescriptorSet write{
+                .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                .dstBinding = binding,
+                .dstArrayElement = arrayElement,
+                .descriptorCount = count,
+                .descriptorType = bindingDescription.descriptorType,
+                .pImageInfo = imageInfo,
+        };
+        writes.push_back(write);
+        return *this;
+    }
+
     bool DescriptorWriter::build(VkDescriptorSet &set, const bool create) {
         if (create && (!pool.allocateDescriptor(*setLayout.getDescriptorSetLayout(), set)))
             return false;
@@ -29,16 +29,24 @@ export namespace z0 {
                                 uint32_t           count = 1,
                                 const VkSampler*   immutableSampler = VK_NULL_HANDLE);
 
+            /*
+             * Sets the descriptor indexing flags of a binding (partially bound, update after bind, ...)
+             */
+            Builder &setBindingFlags(uint32_t binding, VkDescriptorBindingFlags flags);
+
             unique_ptr<DescriptorSetLayout> build() const;
 
         private:
             const Device &                                        device;
             unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings{};
+            unordered_map<uint32_t, VkDescriptorBindingFlags>     bindingsFlags{};
         };
 
         DescriptorSetLayout(const Device &device,
                             const unordered_map<uint32_t,
-                                                VkDescriptorSetLayoutBinding> &bindings);
+                                                VkDescriptorSetLayoutBinding> &bindings,
+                            const unordered_map<uint32_t,
+                                                VkDescriptorBindingFlags> &bindingsFlags = {});
 
         ~DescriptorSetLayout();
 
@@ -50,10 +58,16 @@ export namespace z0 {
 
         [[nodiscard]] inline auto isValid() const { return descriptorSetLayout != VK_NULL_HANDLE; }
 
+        /*
+         * Hash of the bindings, identical for two layouts created with the same bindings, even in different runs
+         */
+        [[nodiscard]] inline auto getSignature() const { return signature; }
+
     private:
         const Device &                                        device;
         VkDescriptorSetLayout                                 descriptorSetLayout;
         unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings;
+        uint64_t                                              signature{0};
 
         friend class DescriptorWriter;
     };
@@ -120,6 +134,11 @@ export namespace z0 {
 
         DescriptorWriter &writeImage(uint32_t binding, const VkDescriptorImageInfo *imageInfo);
 
+        /*
+         * Writes `count` elements of an array binding starting at `arrayElement`
+         */
+        DescriptorWriter &writeImage(uint32_t binding, const VkDescriptorImageInfo *imageInfo, uint32_t arrayElement, uint32_t count = 1);
+
         [[nodiscard]] bool build(VkDescriptorSet &set, bool create);
 
         void update(const VkDescriptorSet &set);
@@ -29,6 +29,8 @@ import z0.Tools;
 import z0.Window;
 
 import z0.vulkan.Renderer;
+import z0.vulkan.RingBuffer;
+import z0.vulkan.ShaderCache;
 
 namespace z0 {
 
@@ -176,9 +178,19 @@ namespace z0 {
                 .rectangularLines = VK_TRUE,
                 // .smoothLines = VK_TRUE,
             };
+            // Bindless textures for the scene renderer
+            VkPhysicalDeviceDescriptorIndexingFeatures descriptorIndexingFeatures{
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES,
+                .pNext = &lineRasterizationFeatures,
+                .shaderSampledImageArrayNonUniformIndexing = VK_TRUE,
+                .descriptorBindingSampledImageUpdateAfterBind = VK_TRUE,
+                .descriptorBindingUpdateUnusedWhilePending = VK_TRUE,
+                .descriptorBindingPartiallyBound = VK_TRUE,
+                .runtimeDescriptorArray = VK_TRUE,
+            };
             VkPhysicalDeviceSynchronization2FeaturesKHR sync2Features{
                 .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES,
-                .pNext = &lineRasterizationFeatures,
+                .pNext = &descriptorIndexingFeatures,
                 .synchronization2 = VK_TRUE
             };
             VkPhysicalDeviceFeatures2 deviceFeatures2 {
@@ -266,6 +278,21 @@ namespace z0 {
         };
         vmaCreateAllocator(&allocatorInfo, &allocator);
 
+        //////////////////// Create the per-frame uniform data ring buffer
+        const auto& limits = deviceProperties.properties.limits;
+        frameRingBuffer = make_unique<RingBuffer>(
+            applicationConfig.frameDataSize,
+            framesInFlight,
+            std::max(limits.minUniformBufferOffsetAlignment, limits.minStorageBufferOffsetAlignment));
+
+        //////////////////// Create the shaders & pipelines cache
+        shaderCache = make_unique<ShaderCache>(
+            device,
+            physicalDevice,
+            applicationConfig.shaderCacheDir.empty() ?
+                filesystem::path{} :
+                applicationConfig.appDir / applicationConfig.shaderCacheDir);
+
         //////////////////// Create swap chain
         createSwapChain();
 
@@ -322,12 +349,17 @@ namespace z0 {
         renderers.clear();
         for (const auto &renderer : postprocessingRenderers) { renderer->cleanup(); }
         postprocessingRenderers.clear();
+        for (const auto &renderer : prepassRenderers) { renderer->cleanup(); }
+        prepassRenderers.clear();
         for (const auto& data : framesData) {
             vkDestroySemaphore(device, data.renderFinishedSemaphore, nullptr);
             vkDestroySemaphore(device, data.imageAvailableSemaphore, nullptr);
             vkDestroyFence(device, data.inFlightFence, nullptr);
         }
         cleanupSwapChain();
+        frameRingBuffer.reset();
+        shaderCache->save();
+        shaderCache.reset();
         vmaDestroyAllocator(allocator); // If it crashes here check for non deallocated Buffers
         vkDestroyDevice(device, nullptr);
         vkDestroySurfaceKHR(vkInstance, surface, nullptr);
@@ -358,6 +390,8 @@ namespace z0 {
             }
             vkResetFences(device, 1, &data.inFlightFence);
         }
+        // The GPU does not use the transient data of this frame anymore
+        frameRingBuffer->reset(currentFrame);
         {
             // get the next available swap chain image
             auto lock = lock_guard(swapChainMutex);
@@ -449,6 +483,10 @@ namespace z0 {
             }
         };
 
+        // The pre-passes are submitted first and are not threaded : the other renderers read their results
+        for (const auto &prepass : prepassRenderers) {
+            render(prepass);
+        }
         {
             list<jthread> threads;
             for (const auto &renderer : renderers) {
@@ -524,6 +562,14 @@ namespace z0 {
         postprocessingRenderers.remove(renderer);
     }
 
+    void Device::registerPrepass(const shared_ptr<Renderer> &renderer) {
+        prepassRenderers.push_back(renderer);
+    }
+
+    void Device::unRegisterPrepass(const shared_ptr<Renderer> &renderer) {
+        prepassRenderers.remove(renderer);
+    }
+
     VkImageView Device::createImageView(const VkImage            image,
                                         const VkFormat           format,
                                         const VkImageAspectFlags aspectFlags,
@@ -906,6 +952,22 @@ namespace z0 {
         if (!deviceFeatures.geometryShader) {
             return 0;
         }
+        // The bindless textures of the scene renderer need the descriptor indexing features enabled at device creation
+        VkPhysicalDeviceDescriptorIndexingFeatures descriptorIndexingFeatures{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES,
+        };
+        VkPhysicalDeviceFeatures2 deviceFeatures2{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+            .pNext = &descriptorIndexingFeatures,
+        };
+        vkGetPhysicalDeviceFeatures2(vkPhysicalDevice, &deviceFeatures2);
+        if (!descriptorIndexingFeatures.shaderSampledImageArrayNonUniformIndexing ||
+            !descriptorIndexingFeatures.descriptorBindingSampledImageUpdateAfterBind ||
+            !descriptorIndexingFeatures.descriptorBindingUpdateUnusedWhilePending ||
+            !descriptorIndexingFeatures.descriptorBindingPartiallyBound ||
+            !descriptorIndexingFeatures.runtimeDescriptorArray) {
+            return 0;
+        }
 
         bool extensionsSupported = checkDeviceExtensionSupport(vkPhysicalDevice, deviceExtensions);
         bool swapChainAdequate   = false;
@@ -20,6 +20,8 @@ import z0.Window;
 
 import z0.vulkan.Buffer;
 import z0.vulkan.Renderer;
+import z0.vulkan.RingBuffer;
+import z0.vulkan.ShaderCache;
 import z0.vulkan.SubmitQueue;
 
 export namespace z0 {
@@ -73,6 +75,10 @@ export namespace z0 {
 
         [[nodiscard]] inline auto getGraphicsQueue() const { return graphicsQueue; }
 
+        [[nodiscard]] inline auto &getFrameRingBuffer() const { return *frameRingBuffer; }
+
+        [[nodiscard]] inline auto &getShaderCache() const { return *shaderCache; }
+
         void drawFrame(uint32_t currentFrame);
 
         void wait() const;
@@ -87,6 +93,10 @@ export namespace z0 {
 
         void unRegisterPostprocessing(const shared_ptr<Renderer> &renderer);
 
+        void registerPrepass(const shared_ptr<Renderer> &renderer);
+
+        void unRegisterPrepass(const shared_ptr<Renderer> &renderer);
+
         [[nodiscard]] VkImageView createImageView(VkImage            image,
                                                   VkFormat           format,
                                                   VkImageAspectFlags aspectFlags,
@@ -182,6 +192,10 @@ export namespace z0 {
 
         // Threaded queue to submit one time commands
         unique_ptr<SubmitQueue>      submitQueue;
+        // Per-frame transient uniform data of the renderers, recycled when the frame fence is signaled
+        unique_ptr<RingBuffer>       frameRingBuffer;
+        // SPIR-V codes, shader binaries & pipeline cache, saved to disk when the device is destroyed
+        unique_ptr<ShaderCache>      shaderCache;
         // List of current renderers
         list<shared_ptr<Renderer>>   renderers;
         // List of renderers to remove at the start of the next frame
@@ -189,6 +203,8 @@ export namespace z0 {
         mutex                        renderersToRemoveMutex;
         // List of current post-processing renderers
         list<shared_ptr<Renderer>>   postprocessingRenderers;
+        // List of renderers rendered before all the other renderers, producing data used by them
+        list<shared_ptr<Renderer>>   prepassRenderers;
 
         // Total video memory given by the OS (not Vulkan)
         uint64_t                     dedicatedVideoMemory;
@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2024-2025 Henri Michelon
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+*/
+module;
+#include "z0/libraries.h"
+#include "z0/vulkan.h"
+
+module z0.vulkan.GlyphAtlas;
+
+import z0.Log;
+
+import z0.resources.Font;
+import z0.resources.Resource;
+
+import z0.vulkan.Buffer;
+import z0.vulkan.Device;
+import z0.vulkan.Image;
+
+namespace z0 {
+
+    GlyphAtlas::GlyphAtlas(const Device &device):
+        device{device},
+        pixels(INITIAL_SIZE * INITIAL_SIZE, 0),
+        stagingBuffers(device.getFramesInFlight()),
+        stagingSizes(device.getFramesInFlight(), 0) {
+    }
+
+    const GlyphAtlas::Region* GlyphAtlas::getRegion(Font &font, const char32_t codepoint) {
+        const auto key = GlyphKey{font.getId(), codepoint};
+        if (const auto it = entries.find(key); it != entries.end()) {
+            shelves[it->second.shelf].lastUsed = session;
+            return &it->second;
+        }
+        const auto &glyph = font.getGlyph(codepoint);
+        if (glyph.width == 0 || glyph.height == 0) { return nullptr; }
+        const auto shelfIndex = allocate(glyph.width, glyph.height);
+        if (shelfIndex == -1) {
+            WARNING("Glyph atlas full, glyph ", to_string(static_cast<uint32_t>(codepoint)), " not drawn");
+            return nullptr;
+        }
+        auto &shelf = shelves[shelfIndex];
+        const auto region = Region{shelf.x, shelf.y, glyph.width, glyph.height, static_cast<uint32_t>(shelfIndex)};
+        shelf.x += glyph.width + PADDING;
+        shelf.lastUsed = session;
+        shelf.glyphs.push_back(key);
+
+        // Clears the padded cell, an evicted shelf can contain the pixels of bigger glyphs
+        const auto coverage = font.renderGlyph(codepoint);
+        const auto cellWidth = std::min(glyph.width + PADDING, size - region.x);
+        for (auto line = 0; line < shelf.height; line++) {
+            const auto dst = pixels.data() + (region.y + line) * size + region.x;
+            std::fill(dst, dst + cellWidth, 0);
+            if (line >= glyph.height) { continue; }
+            for (auto col = 0; col < glyph.width; col++) {
+                const uint32_t gray = coverage[line * glyph.width + col];
+                dst[col] = (gray << 24) | (gray << 16) | (gray << 8) | gray;
+            }
+        }
+        dirtyMinY = std::min(dirtyMinY, shelf.y);
+        dirtyMaxY = std::max(dirtyMaxY, shelf.y + shelf.height);
+        return &(entries[key] = region);
+    }
+
+    int32_t GlyphAtlas::allocate(const uint32_t width, const uint32_t height) {
+        if (width + PADDING > MAX_SIZE || height + PADDING > MAX_SIZE) { return -1; }
+        // Shelves heights are rounded to limit the number of different heights
+        const auto shelfHeight = (height + PADDING + 3) & ~3u;
+        while (true) {
+            // An existing shelf of a similar height with enough room
+            for (auto i = 0; i < shelves.size(); i++) {
+                const auto &shelf = shelves[i];
+                if (shelf.height >= shelfHeight &&
+                    shelf.height <= shelfHeight + shelfHeight / 4 &&
+                    shelf.x + width + PADDING <= size) {
+                    return i;
+                }
+            }
+            // A new shelf under the last one
+            if (nextShelfY + shelfHeight <= size) {
+                shelves.push_back({.y = nextShelfY, .height = shelfHeight});
+                nextShelfY += shelfHeight;
+                return static_cast<int32_t>(shelves.size() - 1);
+            }
+            if (size >= MAX_SIZE) { break; }
+            grow();
+        }
+        // The smallest high enough shelf not used by the drawing sessions of the frames in flight
+        auto evicted = -1;
+        for (auto i = 0; i < shelves.size(); i++) {
+            const auto &shelf = shelves[i];
+            if (session - shelf.lastUsed >= device.getFramesInFlight() && shelf.height >= shelfHeight &&
+                (evicted == -1 || shelf.height < shelves[evicted].height)) {
+                evicted = i;
+            }
+        }
+        if (evicted != -1) {
+            evict(shelves[evicted]);
+        }
+        return evicted;
+    }
+
+    void GlyphAtlas::grow() {
+        // The glyphs keep their positions in pixels, the new space is on the right and at the bottom
+        const auto newSize = size * 2;
+        auto newPixels = vector<uint32_t>(newSize * newSize, 0);
+        for (auto line = 0; line < size; line++) {
+            std::copy_n(pixels.data() + line * size, size, newPixels.data() + line * newSize);
+        }
+        DEBUG("GlyphAtlas grow ", size, " -> ", newSize);
+        pixels  = std::move(newPixels);
+        size    = newSize;
+        resized = true;
+    }
+
+    void GlyphAtlas::evict(Shelf &shelf) {
+        for (const auto &key : shelf.glyphs) {
+            entries.erase(key);
+        }
+        shelf.glyphs.clear();
+        shelf.x = 0;
+    }
+
+    void GlyphAtlas::upload() {
+        if (!resized) { return; }
+        // The previous image is kept alive by the frames in flight using it
+        image = make_shared<VulkanImage>(device,
+                                         size,
+                                         size,
+                                         1,
+                                         VK_FORMAT_R8G8B8A8_SRGB,
+                                         1,
+                                         0,
+                                         VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+                                         VK_FILTER_LINEAR,
+                                         VK_FALSE);
+        imageInitialized = false;
+        resized = false;
+        dirtyMinY = 0;
+        dirtyMaxY = size;
+    }
+
+    void GlyphAtlas::record(const VkCommandBuffer commandBuffer, const uint32_t currentFrame) {
+        if (image == nullptr || dirtyMinY >= dirtyMaxY) { return; }
+        const auto rows = dirtyMaxY - dirtyMinY;
+        const auto rowsSize = static_cast<VkDeviceSize>(size) * rows * sizeof(uint32_t);
+        if (stagingSizes[currentFrame] < rowsSize) {
+            // The GPU has finished with this frame : the previous staging buffer can be destroyed
+            stagingBuffers[currentFrame] = make_unique<Buffer>(rowsSize, 1, VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
+            if (stagingBuffers[currentFrame]->map() != VK_SUCCESS) { die("Error mapping glyph atlas staging buffer"); }
+            stagingSizes[currentFrame] = rowsSize;
+        }
+        stagingBuffers[currentFrame]->writeToBuffer(pixels.data() + dirtyMinY * size, rowsSize);
+        image->copyFrom(commandBuffer, *stagingBuffers[currentFrame], VkBufferImageCopy{
+            .bufferOffset = 0,
+            .bufferRowLength = 0,
+            .bufferImageHeight = 0,
+            .imageSubresource = {
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .mipLevel = 0,
+                .baseArrayLayer = 0,
+                .layerCount = 1,
+            },
+            .imageOffset = {0, static_cast<int32_t>(dirtyMinY), 0},
+            .imageExtent = {size, rows, 1},
+        }, !imageInitialized);
+        imageInitialized = true;
+        dirtyMinY = numeric_limits<uint32_t>::max();
+        dirtyMaxY = 0;
+    }
+
+}
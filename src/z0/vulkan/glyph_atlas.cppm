@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2024-2025 Henri Michelon
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+*/
+module;
+#include "z0/libraries.h"
+#include "z0/vulkan.h"
+
+export module z0.vulkan.GlyphAtlas;
+
+import z0.resources.Font;
+import z0.resources.Resource;
+
+import z0.vulkan.Buffer;
+import z0.vulkan.Device;
+import z0.vulkan.Image;
+
+export namespace z0 {
+
+    /*
+     * Dynamically packed atlas of the glyphs of all the fonts drawn by the vector renderer.
+     * Glyphs are rasterized on first use and packed on shelves of similar heights.
+     * The atlas doubles its size up to MAX_SIZE when full, then evicts the shelves whose glyphs were not used
+     * during the last framesInFlight drawing sessions, the frames in flight can still sample the older sessions.
+     * Only the modified rows are uploaded to the GPU, by the command buffer of the next frame.
+     */
+    class GlyphAtlas {
+    public:
+        // Position of a glyph in the atlas, in pixels
+        struct Region {
+            uint32_t x;
+            uint32_t y;
+            uint32_t width;
+            uint32_t height;
+            // Shelf containing the glyph, see keep()
+            uint32_t shelf;
+        };
+
+        // Initial width & height in pixels
+        static constexpr uint32_t INITIAL_SIZE{512};
+        // Maximum width & height in pixels
+        static constexpr uint32_t MAX_SIZE{2048};
+
+        explicit GlyphAtlas(const Device &device);
+
+        // Starts a new drawing session : the glyphs unused by the last framesInFlight sessions can be evicted
+        inline void beginSession() { session += 1; }
+
+        // Protects the glyphs of a shelf from the eviction during the current session, for retained geometry
+        inline void keep(const uint32_t shelf) { shelves.at(shelf).lastUsed = session; }
+
+        // Returns the region of a glyph, rasterizing and packing it if needed.
+        // Returns nullptr for empty glyphs or when no shelf can be evicted.
+        [[nodiscard]] const Region* getRegion(Font &font, char32_t codepoint);
+
+        // Recreates the image after a growth, the new image content is copied by the next record()
+        void upload();
+
+        // Records the copy of the modified rows in the command buffer of a frame, before the frame samples the atlas.
+        // The copy is ordered after the previous frames sampling the atlas by its barriers on the graphics queue.
+        void record(VkCommandBuffer commandBuffer, uint32_t currentFrame);
+
+        [[nodiscard]] inline const auto& getImage() const { return image; }
+
+        [[nodiscard]] inline auto getSize() const { return size; }
+
+    private:
+        // Space between the glyphs, to avoid sampling the neighbours with the linear filtering
+        static constexpr uint32_t PADDING{1};
+
+        using GlyphKey = pair<Resource::id_t, char32_t>;
+
+        struct Shelf {
+            uint32_t         y;
+            uint32_t         height;
+            // Horizontal allocation head
+            uint32_t         x{0};
+            // Last drawing session using one of the glyphs of the shelf
+            uint64_t         lastUsed{0};
+            vector<GlyphKey> glyphs{};
+        };
+
+        const Device &          device;
+        uint32_t                size{INITIAL_SIZE};
+        // RGBA copy of the atlas in CPU memory, glyphs are white with the coverage in all the channels
+        vector<uint32_t>        pixels;
+        vector<Shelf>           shelves;
+        map<GlyphKey, Region>   entries;
+        // Top of the free space under the last shelf
+        uint32_t                nextShelfY{0};
+        uint64_t                session{1};
+        // Modified rows since the last upload
+        uint32_t                dirtyMinY{numeric_limits<uint32_t>::max()};
+        uint32_t                dirtyMaxY{0};
+        // The image must be recreated with the new size
+        bool                    resized{true};
+        // The content of the image is undefined until the first copy
+        bool                    imageInitialized{false};
+        shared_ptr<VulkanImage> image;
+        // One staging buffer per frame in flight, reused when the fence of the frame has been waited for
+        vector<unique_ptr<Buffer>> stagingBuffers;
+        vector<VkDeviceSize>       stagingSizes;
+
+        // Finds or makes room for a glyph, returns the index of the shelf or -1
+        int32_t allocate(uint32_t width, uint32_t height);
+
+        void grow();
+
+        void evict(Shelf &shelf);
+
+    public:
+        GlyphAtlas(const GlyphAtlas &) = delete;
+        GlyphAtlas &operator=(const GlyphAtlas &) = delete;
+    };
+
+}
@@ -12,16 +12,18 @@ module;
 module z0.vulkan.IBLPipeline;
 
 import z0.Constants;
+import z0.Log;
 import z0.Tools;
-import z0.VirtualFS;
 
 import z0.resources.Cubemap;
 import z0.resources.Image;
 
+import z0.vulkan.Buffer;
 import z0.vulkan.Descriptors;
 import z0.vulkan.Device;
 import z0.vulkan.Cubemap;
 import z0.vulkan.Image;
+import z0.vulkan.ShaderCache;
 
 namespace z0 {
 
@@ -71,12 +73,11 @@ namespace z0 {
     void IBLPipeline::convert(const shared_ptr<VulkanImage>&    hdrFile,
                               const shared_ptr<VulkanCubemap>&  unfilteredCubemap,
                               const shared_ptr<VulkanCubemap>&  filteredCubemap,
-                              const shared_ptr<VulkanCubemap>&  irradianceCubemap,
-                              const shared_ptr<VulkanImage>&    brdfLut) const {
+                              const shared_ptr<VulkanCubemap>&  irradianceCubemap) const {
 
         const auto commandPool = device.createCommandPool(false, true);
         {
-            const auto shaderModule1 = createShaderModule( VirtualFS::loadShader("equirect2cube.comp"));
+            const auto shaderModule1 = createShaderModule(device.getShaderCache().getSpirv("equirect2cube.comp"));
             const auto pipeline1 = createPipeline(shaderModule1);
             auto descriptorSet1 = VkDescriptorSet{VK_NULL_HANDLE};
             if (!descriptorPool->allocateDescriptor(*descriptorSetLayout->getDescriptorSetLayout(), descriptorSet1)) {
@@ -116,7 +117,7 @@ namespace z0 {
 
         {
             const auto commandBuffer = device.beginComputeCommandBuffer(commandPool);
-            const auto shaderModule2 = createShaderModule(VirtualFS::loadShader("specular_map.comp"));
+            const auto shaderModule2 = createShaderModule(device.getShaderCache().getSpirv("specular_map.comp"));
             const auto pipeline2 = createPipeline(shaderModule2, &specializationInfo);
             // Copy base mipmap level into destination environment map.
             {
@@ -212,7 +213,7 @@ namespace z0 {
         }
 
         {
-            const auto shaderModule3 = createShaderModule(VirtualFS::loadShader("irradiance_map.comp"));
+            const auto shaderModule3 = createShaderModule(device.getShaderCache().getSpirv("irradiance_map.comp"));
             const auto pipeline3 = createPipeline(shaderModule3);
             auto descriptorSet3 = VkDescriptorSet{VK_NULL_HANDLE};
             if (!descriptorPool->allocateDescriptor(*descriptorSetLayout->getDescriptorSetLayout(), descriptorSet3)) {
@@ -256,9 +257,13 @@ namespace z0 {
             device.endComputeCommandBuffer(commandPool, commandBuffer);
             vkDestroyPipeline(device.getDevice(), pipeline3, nullptr);
         }
+        vkDestroyCommandPool(device.getDevice(), commandPool, VK_NULL_HANDLE);
+    }
 
+    void IBLPipeline::computeBRDFLut(const shared_ptr<VulkanImage>& brdfLut) const {
+        const auto commandPool = device.createCommandPool(false, true);
         {
-            const auto shaderModule4 = createShaderModule(VirtualFS::loadShader("brdf.comp"));
+            const auto shaderModule4 = createShaderModule(device.getShaderCache().getSpirv("brdf.comp"));
             const auto pipeline4 = createPipeline(shaderModule4);
             auto descriptorSet4 = VkDescriptorSet{VK_NULL_HANDLE};
             if (!descriptorPool->allocateDescriptor(*descriptorSetLayout->getDescriptorSetLayout(), descriptorSet4)) {
@@ -267,7 +272,7 @@ namespace z0 {
 
             const auto outputInfo4 = VkDescriptorImageInfo{ VK_NULL_HANDLE, brdfLut->getImageView(), VK_IMAGE_LAYOUT_GENERAL };
             DescriptorWriter(*descriptorSetLayout, *descriptorPool)
-                // input texture already set in preComputeIrradiance()
+                // no input texture
                 .writeImage(BINDING_OUTPUT_TEXTURE, &outputInfo4)
                 .update(descriptorSet4);
 
@@ -301,6 +306,196 @@ namespace z0 {
             vkDestroyPipeline(device.getDevice(), pipeline4, nullptr);
         }
         vkDestroyCommandPool(device.getDevice(), commandPool, VK_NULL_HANDLE);
+    }
+
+    uint32_t IBLPipeline::getPixelSize(const VkFormat format) {
+        switch (format) {
+        case VK_FORMAT_R16G16B16A16_SFLOAT:
+            return 8;
+        case VK_FORMAT_R16G16_SFLOAT:
+            return 4;
+        default:
+            die("Unsupported image format for the IBL cache");
+            return 0;
+        }
+    }
+
+    vector<VkBufferImageCopy> IBLPipeline::getCopyRegions(const uint32_t width,
+                                                          const uint32_t height,
+                                                          const uint32_t levels,
+                                                          const uint32_t layers,
+                                                          const uint32_t pixelSize,
+                                                          uint64_t&      dataSize) {
+        auto regions = vector<VkBufferImageCopy>{};
+        dataSize = 0;
+        for (auto level = 0; level < levels; level++) {
+            const auto levelWidth = std::max(1u, width >> level);
+            const auto levelHeight = std::max(1u, height >> level);
+            regions.push_back({
+                .bufferOffset = dataSize,
+                .bufferRowLength = 0, // Tightly packed
+                .bufferImageHeight = 0, // Tightly packed
+                .imageSubresource = {
+                    .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                    .mipLevel = static_cast<uint32_t>(level),
+                    .baseArrayLayer = 0,
+                    .layerCount = layers,
+                },
+                .imageOffset = {0, 0, 0},
+                .imageExtent = {levelWidth, levelHeight, 1},
+            });
+            dataSize += static_cast<uint64_t>(levelWidth) * levelHeight * layers * pixelSize;
+        }
+        return regions;
+    }
+
+    void IBLPipeline::saveToCache(const filesystem::path& filepath,
+                                  const VkImage           image,
+                                  const VkFormat          format,
+                                  const uint32_t          width,
+                                  const uint32_t          height,
+                                  const uint32_t          levels,
+                                  const uint32_t          layers) const {
+        const auto pixelSize = getPixelSize(format);
+        auto dataSize = uint64_t{0};
+        const auto regions = getCopyRegions(width, height, levels, layers, pixelSize, dataSize);
+        const auto stagingBuffer = Buffer{dataSize, 1, VK_BUFFER_USAGE_TRANSFER_DST_BIT, 1, true};
+
+        // GPU to CPU copy
+        const auto commandPool = device.createCommandPool(false, true);
+        const auto commandBuffer = device.beginComputeCommandBuffer(commandPool);
+        pipelineBarrier(commandBuffer,
+            VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+            {
+                imageMemoryBarrier(image,
+                    0, VK_ACCESS_TRANSFER_READ_BIT,
+                    VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL)
+        });
+        vkCmdCopyImageToBuffer(commandBuffer,
+            image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            stagingBuffer.getBuffer(),
+            static_cast<uint32_t>(regions.size()), regions.data());
+        pipelineBarrier(commandBuffer,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+            {
+                imageMemoryBarrier(image,
+                    VK_ACCESS_TRANSFER_READ_BIT, 0,
+                    VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
+        });
+        // Make the staging buffer visible to the host
+        constexpr auto hostBarrier = VkMemoryBarrier {
+            .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+            .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_HOST_READ_BIT,
+        };
+        vkCmdPipelineBarrier(commandBuffer,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+            0,
+            1, &hostBarrier,
+            0, nullptr,
+            0, nullptr);
+        device.endComputeCommandBuffer(commandPool, commandBuffer);
+        vkDestroyCommandPool(device.getDevice(), commandPool, VK_NULL_HANDLE);
+
+        auto data = vector<char>(dataSize);
+        stagingBuffer.readFromBuffer(data.data(), dataSize);
 
+        // Write into a temporary file first so an interrupted write never leaves a truncated cache file
+        auto error = error_code{};
+        filesystem::create_directories(filepath.parent_path(), error);
+        auto tempPath = filepath;
+        tempPath += ".tmp";
+        {
+            auto file = ofstream{tempPath, ios::binary};
+            if (!file.is_open()) {
+                WARNING("Cannot write IBL cache file ", tempPath.string());
+                return;
+            }
+            const auto header = CacheHeader {
+                .format = static_cast<uint32_t>(format),
+                .width = width,
+                .height = height,
+                .levels = levels,
+                .layers = layers,
+                .pixelSize = pixelSize,
+                .dataSize = dataSize,
+            };
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(data.data(), dataSize);
+        }
+        filesystem::rename(tempPath, filepath, error);
+        if (error) {
+            WARNING("Cannot write IBL cache file ", filepath.string());
+        }
     }
+
+    bool IBLPipeline::loadFromCache(const filesystem::path& filepath,
+                                    const VkImage           image,
+                                    const VkFormat          format,
+                                    const uint32_t          width,
+                                    const uint32_t          height,
+                                    const uint32_t          levels,
+                                    const uint32_t          layers) const {
+        auto file = ifstream{filepath, ios::binary};
+        if (!file.is_open()) { return false; }
+        const auto pixelSize = getPixelSize(format);
+        auto dataSize = uint64_t{0};
+        const auto regions = getCopyRegions(width, height, levels, layers, pixelSize, dataSize);
+
+        // Only use cache files made for the same image
+        const auto expected = CacheHeader {
+            .format = static_cast<uint32_t>(format),
+            .width = width,
+            .height = height,
+            .levels = levels,
+            .layers = layers,
+            .pixelSize = pixelSize,
+            .dataSize = dataSize,
+        };
+        auto header = CacheHeader{};
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if (!file ||
+            header.magic != expected.magic ||
+            header.version != expected.version ||
+            header.format != expected.format ||
+            header.width != expected.width ||
+            header.height != expected.height ||
+            header.levels != expected.levels ||
+            header.layers != expected.layers ||
+            header.pixelSize != expected.pixelSize ||
+            header.dataSize != expected.dataSize) {
+            return false;
+        }
+        auto data = vector<char>(dataSize);
+        file.read(data.data(), dataSize);
+        if (!file) { return false; }
+
+        // CPU to GPU copy
+        const auto stagingBuffer = Buffer{dataSize, 1, VK_BUFFER_USAGE_TRANSFER_SRC_BIT};
+        stagingBuffer.writeToBuffer(data.data(), dataSize);
+        const auto commandPool = device.createCommandPool(false, true);
+        const auto commandBuffer = device.beginComputeCommandBuffer(commandPool);
+        pipelineBarrier(commandBuffer,
+            VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+            {
+                imageMemoryBarrier(image,
+                    0, VK_ACCESS_TRANSFER_WRITE_BIT,
+                    VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL)
+        });
+        vkCmdCopyBufferToImage(commandBuffer,
+            stagingBuffer.getBuffer(),
+            image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            static_cast<uint32_t>(regions.size()), regions.data());
+        pipelineBarrier(commandBuffer,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+            {
+                imageMemoryBarrier(image,
+                    VK_ACCESS_TRANSFER_WRITE_BIT, 0,
+                    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
+        });
+        device.endComputeCommandBuffer(commandPool, commandBuffer);
+        vkDestroyCommandPool(device.getDevice(), commandPool, VK_NULL_HANDLE);
+        return true;
+    }
+
 } // namespace z0
@@ -23,6 +23,7 @@ export namespace z0 {
 
     /*
      * Pipeline to converts equirectangular projection texture into a cubemap.
+     * The results can be saved to and loaded from disk cache files to avoid the compute passes.
      */
     class IBLPipeline : public ComputePipeline {
     public:
@@ -32,10 +33,43 @@ export namespace z0 {
         void convert(const shared_ptr<VulkanImage>&    hdrFile,
                      const shared_ptr<VulkanCubemap>&  unfilteredCubemap,
                      const shared_ptr<VulkanCubemap>&  filteredCubemap,
-                     const shared_ptr<VulkanCubemap>&  irradianceCubemap,
-                     const shared_ptr<VulkanImage>&    brdfLut) const;
+                     const shared_ptr<VulkanCubemap>&  irradianceCubemap) const;
+
+        // Computes the BRDF 2D LUT, does not depend on the environment
+        void computeBRDFLut(const shared_ptr<VulkanImage>& brdfLut) const;
+
+        // Copies all the mip levels and layers of an image, in the SHADER_READ_ONLY layout, into a cache file
+        void saveToCache(const filesystem::path& filepath,
+                         VkImage                 image,
+                         VkFormat                format,
+                         uint32_t                width,
+                         uint32_t                height,
+                         uint32_t                levels,
+                         uint32_t                layers) const;
+
+        // Loads all the mip levels and layers of an image from a cache file and leave the image in the SHADER_READ_ONLY layout.
+        // Returns false if the file does not exist or does not match the image
+        bool loadFromCache(const filesystem::path& filepath,
+                           VkImage                 image,
+                           VkFormat                format,
+                           uint32_t                width,
+                           uint32_t                height,
+                           uint32_t                levels,
+                           uint32_t                layers) const;
 
     private:
+        struct CacheHeader {
+            array<char, 4> magic{'Z', 'I', 'B', 'L'};
+            uint32_t       version{1};
+            uint32_t       format;
+            uint32_t       width;
+            uint32_t       height;
+            uint32_t       levels;
+            uint32_t       layers;
+            uint32_t       pixelSize;
+            uint64_t       dataSize;
+        };
+
         struct SpecularFilterPushConstants {
             alignas(4) uint32_t level;
             alignas(4) float roughness;
@@ -49,6 +83,16 @@ export namespace z0 {
         static constexpr auto BINDING_OUTPUT_TEXTURE{1};
         static constexpr auto BINDING_OUTPUT_MIPMAPS{2};
 
+        static uint32_t getPixelSize(VkFormat format);
+
+        // One copy region per mip level, the layers of a mip level are tightly packed
+        static vector<VkBufferImageCopy> getCopyRegions(uint32_t width,
+                                                        uint32_t height,
+                                                        uint32_t levels,
+                                                        uint32_t layers,
+                                                        uint32_t pixelSize,
+                                                        uint64_t& dataSize);
+
         static constexpr auto specializationMap = VkSpecializationMapEntry { 0, 0, sizeof(uint32_t) };
         static inline uint32_t specializationData[]{ static_cast<uint32_t>(EnvironmentCubemap::ENVIRONMENT_MAP_MIPMAP_LEVELS - 1) };
         static constexpr auto specializationInfo = VkSpecializationInfo{ 1, &specializationMap, sizeof(specializationData), specializationData };
@@ -12,6 +12,7 @@ module z0.vulkan.ComputePipeline;
 import z0.Tools;
 
 import z0.vulkan.Device;
+import z0.vulkan.ShaderCache;
 
 namespace z0 {
 
@@ -34,7 +35,7 @@ namespace z0 {
             .layout = pipelineLayout,
         };
         auto pipeline = VkPipeline{VK_NULL_HANDLE};
-        if(vkCreateComputePipelines(device.getDevice(), VK_NULL_HANDLE, 1, &createInfo, nullptr, &pipeline) != VK_SUCCESS)
+        if(vkCreateComputePipelines(device.getDevice(), device.getShaderCache().getPipelineCache(), 1, &createInfo, nullptr, &pipeline) != VK_SUCCESS)
             die("Failed to create compute pipeline");
         vkDestroyShaderModule(device.getDevice(), shader, nullptr);
         return pipeline;
@@ -31,6 +31,7 @@ import z0.vulkan.ColorFrameBufferHDR;
 import z0.vulkan.DepthFrameBuffer;
 import z0.vulkan.Descriptors;
 import z0.vulkan.Device;
+import z0.vulkan.VertexRingBuffer;
 
 namespace z0 {
 
@@ -62,19 +63,13 @@ namespace z0 {
                VK_FORMAT_R32G32B32A32_SFLOAT,
                offsetof(Vertex, color)
         });
-        commandPool = device.createCommandPool();
+        vertexBuffer = make_unique<VertexRingBuffer>(VERTEX_BUFFER_SIZE, device.getFramesInFlight());
         createOrUpdateResources();
         Initialize();
     }
 
     void DebugRenderer::cleanup() {
-        vkDestroyCommandPool(device.getDevice(), commandPool, nullptr);
-        ranges::for_each(frameData, [](FrameData& frame) {
-            frame.globalBuffer.reset();
-        });
         vertexBuffer.reset();
-        stagingBuffer.reset();
-        oldBuffers.clear();
         Renderpass::cleanup();
     }
 
@@ -84,8 +79,9 @@ namespace z0 {
         SetCameraPos(JPH::Vec3(cameraPosition.x, cameraPosition.y, cameraPosition.z));
     }
 
-    void DebugRenderer::drawRayCasts(const shared_ptr<Node>& scene, const vec4 color, const vec4 collidingColor) {
-        for(const auto& raycast : scene->findAllChildren<RayCast>(true)) {
+    void DebugRenderer::drawRayCasts(const unordered_set<shared_ptr<Node>>& raycasts, const vec4 color, const vec4 collidingColor) {
+        for(const auto& node : raycasts) {
+            const auto raycast = static_pointer_cast<RayCast>(node);
             drawLine(
                 raycast->getPositionGlobal(),
                 raycast->isColliding() ? raycast->getCollisionPoint() : raycast->toGlobal(raycast->getTarget()),
@@ -96,21 +92,21 @@ namespace z0 {
     void DebugRenderer::drawLine(const vec3 from, const vec3 to, const vec4 color) {
         linesVertices.push_back( {from, color });
         linesVertices.push_back( {to, color });
-        vertexBufferDirty = true;
+        verticesVersion += 1;
     }
 
     void DebugRenderer::drawTriangle(const vec3 v1, const vec3 v2, const vec3 v3, const vec4 color) {
         triangleVertices.push_back( {v1, color });
         triangleVertices.push_back( {v2, color });
         triangleVertices.push_back( {v3, color });
-        vertexBufferDirty = true;
+        verticesVersion += 1;
     }
 
     void DebugRenderer::DrawLine(JPH::RVec3Arg inFrom, JPH::RVec3Arg inTo, const JPH::ColorArg inColor) {
         const auto color = vec4{inColor.r, inColor.g, inColor.b, inColor.a} / 255.0f;
         linesVertices.push_back( {{ inFrom.GetX(), inFrom.GetY(), inFrom.GetZ() }, color });
         linesVertices.push_back( {{ inTo.GetX(), inTo.GetY(), inTo.GetZ() }, color});
-        vertexBufferDirty = true;
+        verticesVersion += 1;
     }
 
     void DebugRenderer::DrawTriangle(JPH::RVec3Arg inV1, JPH::RVec3Arg inV2, JPH::RVec3Arg inV3, JPH::ColorArg inColor, JPH::DebugRenderer::ECastShadow inCastShadow) {
@@ -118,56 +114,31 @@ namespace z0 {
         triangleVertices.push_back( {{ inV1.GetX(), inV1.GetY(), inV1.GetZ() }, color });
         triangleVertices.push_back( {{ inV2.GetX(), inV2.GetY(), inV2.GetZ() }, color});
         triangleVertices.push_back( {{ inV3.GetX(), inV3.GetY(), inV3.GetZ() }, color});
-        vertexBufferDirty = true;
+        verticesVersion += 1;
     }
 
     void DebugRenderer::update(const uint32_t currentFrame) {
-        const auto& frame = frameData[currentFrame];
+        auto& frame = frameData[currentFrame];
         if (!frame.currentCamera || !app().getDisplayDebug()) { return; }
-        // Destroy the previous buffer when we are sure they aren't used by another frame
-        oldBuffers.clear();
-        if (!linesVertices.empty() || !triangleVertices.empty()) {
-            // Resize the buffers only if needed by recreating them
-            if ((vertexBuffer == VK_NULL_HANDLE) || (vertexCount != (linesVertices.size() + triangleVertices.size()))) {
-                // Put the current buffers in the recycle bin since they are currently used
-                // and can't be destroyed now
-                oldBuffers.push_back(stagingBuffer);
-                oldBuffers.push_back(vertexBuffer);
-                // Allocate new buffers to change size
-                vertexCount      = linesVertices.size() + triangleVertices.size();
-                vertexBufferSize = VERTEX_BUFFER_SIZE * vertexCount;
-                stagingBuffer    = make_shared<Buffer>(
-                        VERTEX_BUFFER_SIZE,
-                        vertexCount,
-                        VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
-                vertexBuffer = make_shared<Buffer>(
-                        VERTEX_BUFFER_SIZE,
-                        vertexCount,
-                        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT);
-            }
-            if (vertexBufferDirty) {
-                // Push new vertices data to GPU memory
-                if (!linesVertices.empty()) {
-                    stagingBuffer->writeToBuffer(linesVertices.data(), linesVertices.size() * sizeof(Vertex));
-                }
-                if (!triangleVertices.empty()) {
-                    stagingBuffer->writeToBuffer(triangleVertices.data(), triangleVertices.size() * sizeof(Vertex), linesVertices.size() * sizeof(Vertex));
-                }
-                const auto commandBuffer = device.beginOneTimeCommandBuffer();
-                stagingBuffer->copyTo(commandBuffer.commandBuffer, *(vertexBuffer), vertexBufferSize);
-                device.endOneTimeCommandBuffer(commandBuffer);
-                vertexBufferDirty = false;
-            }
+        // The GPU has finished with this frame : its vertex buffer can be written or grown in place
+        if (frame.verticesVersion != verticesVersion) {
+            frame.linesCount = linesVertices.size();
+            frame.trianglesCount = triangleVertices.size();
+            vertexBuffer->reserve(currentFrame, frame.linesCount + frame.trianglesCount);
+            vertexBuffer->write(currentFrame, linesVertices.data(), frame.linesCount);
+            vertexBuffer->write(currentFrame, triangleVertices.data(), frame.trianglesCount, frame.linesCount);
+            frame.verticesVersion = verticesVersion;
         }
         const auto globalUbo = GlobalBuffer {
             .projection = frame.currentCamera->getProjection(),
             .view       = frame.currentCamera->getView(),
         };
-        writeUniformBuffer(frame.globalBuffer, &globalUbo);
+        frame.globalBufferOffset = writeFrameData(currentFrame, &globalUbo, GLOBAL_BUFFER_SIZE);
     }
 
     void DebugRenderer::drawFrame(const uint32_t currentFrame, const bool isLast) {
-        if ((!frameData[currentFrame].currentCamera) || !app().getDisplayDebug() || (vertexCount == 0)) {
+        const auto& frame = frameData[currentFrame];
+        if ((!frame.currentCamera) || !app().getDisplayDebug() || (frame.linesCount + frame.trianglesCount == 0)) {
             return;
         }
         beginRendering(currentFrame);
@@ -184,17 +155,17 @@ namespace z0 {
         vkCmdSetDepthWriteEnable(commandBuffer, useDepthTest);
         vkCmdSetCullMode(commandBuffer, VK_CULL_MODE_NONE);
         vkCmdSetLineWidth(commandBuffer, 1);
-        const VkBuffer buffers[] = {vertexBuffer->getBuffer()};
+        const VkBuffer buffers[] = {vertexBuffer->getBuffer(currentFrame)->getBuffer()};
         constexpr VkDeviceSize vertexOffsets[] = {0};
         vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers, vertexOffsets);
-        bindDescriptorSets(commandBuffer, currentFrame);
-        if (!linesVertices.empty()) {
+        bindDescriptorSets(commandBuffer, currentFrame, 1, &frame.globalBufferOffset);
+        if (frame.linesCount > 0) {
             vkCmdSetPrimitiveTopology(commandBuffer, VK_PRIMITIVE_TOPOLOGY_LINE_LIST);
-            vkCmdDraw(commandBuffer, linesVertices.size(), 1, 0, 0);
+            vkCmdDraw(commandBuffer, frame.linesCount, 1, 0, 0);
         }
-        if (!triangleVertices.empty()) {
+        if (frame.trianglesCount > 0) {
             vkCmdSetPrimitiveTopology(commandBuffer, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
-            vkCmdDraw(commandBuffer, triangleVertices.size(), 1, linesVertices.size(), 0);
+            vkCmdDraw(commandBuffer, frame.trianglesCount, 1, frame.linesCount, 0);
         }
         endRendering(currentFrame, isLast);
     }
@@ -263,6 +234,7 @@ namespace z0 {
         NextFrame();
         linesVertices.clear();
         triangleVertices.clear();
+        verticesVersion += 1;
     }
 
     void DebugRenderer::loadShaders() {
@@ -274,21 +246,18 @@ namespace z0 {
         descriptorPool =
                 DescriptorPool::Builder(device)
                         .setMaxSets(device.getFramesInFlight())
-                        .addPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1 * device.getFramesInFlight())
+                        .addPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1 * device.getFramesInFlight())
                         .build();
         setLayout = DescriptorSetLayout::Builder(device)
                         .addBinding(0,
-                                    VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+                                    VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
                                     VK_SHADER_STAGE_VERTEX_BIT)
                         .build();
-        for (auto i = 0; i < device.getFramesInFlight(); i++) {
-            frameData[i].globalBuffer = createUniformBuffer(GLOBAL_BUFFER_SIZE);
-        }
     }
 
     void DebugRenderer::createOrUpdateDescriptorSet(const bool create) {
         for (auto frameIndex = 0; frameIndex < device.getFramesInFlight(); frameIndex++) {
-            auto globalBufferInfo = frameData.at(frameIndex).globalBuffer->descriptorInfo(GLOBAL_BUFFER_SIZE);
+            auto globalBufferInfo = frameDataInfo(GLOBAL_BUFFER_SIZE);
             auto writer = DescriptorWriter(*setLayout, *descriptorPool)
                             .writeBuffer(0, &globalBufferInfo);
             if (!writer.build(descriptorSet.at(frameIndex), create))
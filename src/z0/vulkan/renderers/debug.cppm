@@ -33,6 +33,7 @@ import z0.vulkan.ColorFrameBufferHDR;
 import z0.vulkan.DepthFrameBuffer;
 import z0.vulkan.Renderer;
 import z0.vulkan.Renderpass;
+import z0.vulkan.VertexRingBuffer;
 
 namespace z0 {
 
@@ -47,7 +48,7 @@ namespace z0 {
 
         void activateCamera(const shared_ptr<Camera> &camera, uint32_t currentFrame);
 
-        void drawRayCasts(const shared_ptr<Node>& scene, vec4 color, vec4 collidingColor);
+        void drawRayCasts(const unordered_set<shared_ptr<Node>>& raycasts, vec4 color, vec4 collidingColor);
 
         void drawLine(vec3 from, vec3 to, vec4 color);
 
@@ -87,32 +88,29 @@ namespace z0 {
             shared_ptr<Camera>                 currentCamera;
             shared_ptr<ColorFrameBufferHDR>    colorFrameBufferHdr;
             shared_ptr<DepthFrameBuffer>       depthFrameBuffer;
-            unique_ptr<Buffer>                 globalBuffer;
+            // Offset of the global uniform buffer in the device frame ring buffer
+            uint32_t                           globalBufferOffset{0};
+            // Vertices version written in the vertex buffer of the frame
+            uint64_t                           verticesVersion{0};
+            // Number of vertices for lines in the vertex buffer of the frame
+            uint32_t                           linesCount{0};
+            // Number of vertices for triangles in the vertex buffer of the frame, after the lines
+            uint32_t                           trianglesCount{0};
         };
         vector<FrameData> frameData;
 
         // Use depth testing
         bool useDepthTest{false};
-        // Vertex buffer need to be re-uploaded to GPU
-        bool vertexBufferDirty = true;
+        // Incremented each time the vertices change, the vertex buffer of a frame is rewritten when outdated
+        uint64_t verticesVersion{1};
         // All the vertices for lines
         vector<Vertex> linesVertices;
         // All the vertices for triangles
         vector<Vertex> triangleVertices;
-        // Number of vertices for the currently allocated VkBuffers, used to check if we need to resize the buffers
-        uint32_t vertexCount{0};
-        // Current VkBuffer memory size
-        VkDeviceSize vertexBufferSize{0};
-        // Staging vertex buffer used when updating GPU memory
-        shared_ptr<Buffer> stagingBuffer{VK_NULL_HANDLE};
-        // Vertex buffer in GPU memory
-        shared_ptr<Buffer> vertexBuffer{VK_NULL_HANDLE};
-        // Used when we need to postpone the buffers destruction when they are in use by another frame in flight
-        list<shared_ptr<Buffer>> oldBuffers;
+        // Per-frame host visible vertex buffers, written without staging copy nor queue wait
+        unique_ptr<VertexRingBuffer> vertexBuffer;
         // For vkCmdSetVertexInputEXT
         vector<VkVertexInputAttributeDescription2EXT> attributeDescriptions{};
-        // To upload vertices to GPU
-        VkCommandPool commandPool;
 
         void update(uint32_t currentFrame) override;
 
@@ -0,0 +1,314 @@
+/*
+ * Copyright (c) 2024-2025 Henri Michelon
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+*/
+module;
+#include "z0/vulkan.h"
+#include "z0/libraries.h"
+
+module z0.vulkan.DepthPyramidRenderer;
+
+import z0.OcclusionCulling;
+import z0.Tools;
+
+import z0.vulkan.Buffer;
+import z0.vulkan.DepthFrameBuffer;
+import z0.vulkan.Descriptors;
+import z0.vulkan.Device;
+
+namespace z0 {
+
+    DepthPyramidRenderer::DepthPyramidRenderer(Device &device, const vector<shared_ptr<DepthFrameBuffer>>& depthFrameBuffers):
+        Renderpass{device, VkClearValue{}},
+        depthFrameBuffers{depthFrameBuffers} {
+        frameData.resize(device.getFramesInFlight());
+        // Nearest sampling : the shader reads the exact texels of the previous level
+        constexpr VkSamplerCreateInfo samplerCreateInfo{
+            .sType         = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
+            .magFilter     = VK_FILTER_NEAREST,
+            .minFilter     = VK_FILTER_NEAREST,
+            .mipmapMode    = VK_SAMPLER_MIPMAP_MODE_NEAREST,
+            .addressModeU  = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+            .addressModeV  = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+            .addressModeW  = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+            .mipLodBias    = 0.0f,
+            .maxAnisotropy = 1.0f,
+            .minLod        = 0.0f,
+            .maxLod        = 0.0f,
+            .borderColor   = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE};
+        if (vkCreateSampler(vkDevice, &samplerCreateInfo, nullptr, &sampler) != VK_SUCCESS) {
+            die("failed to create depth pyramid sampler!");
+        }
+        createImagesResources();
+        createOrUpdateResources();
+    }
+
+    void DepthPyramidRenderer::cleanup() {
+        cleanupImagesResources();
+        if (sampler != VK_NULL_HANDLE) {
+            vkDestroySampler(vkDevice, sampler, nullptr);
+            sampler = VK_NULL_HANDLE;
+        }
+        depthPyramidShader.reset();
+        Renderpass::cleanup();
+    }
+
+    void DepthPyramidRenderer::cleanupImagesResources() {
+        for (auto& frame : frameData) {
+            for (const auto& view : frame.levelsViews) {
+                vkDestroyImageView(vkDevice, view, nullptr);
+            }
+            frame.levelsViews.clear();
+            frame.levelsDescriptorSets.clear();
+            if (frame.image != VK_NULL_HANDLE) {
+                vkDestroyImage(vkDevice, frame.image, nullptr);
+                vkFreeMemory(vkDevice, frame.imageMemory, nullptr);
+                frame.image = VK_NULL_HANDLE;
+                frame.imageMemory = VK_NULL_HANDLE;
+            }
+            frame.readbackBuffer.reset();
+            frame.recorded = false;
+        }
+    }
+
+    void DepthPyramidRenderer::createImagesResources() {
+        // The first level is half the size of the depth buffer, each next level is half the size of the previous one
+        const auto& extent = device.getSwapChainExtent();
+        auto width = std::max((extent.width + 1) / 2, 1u);
+        auto height = std::max((extent.height + 1) / 2, 1u);
+        levels.clear();
+        while (levels.size() < MAX_LEVELS) {
+            levels.push_back({width, height, 0});
+            if ((width == 1) && (height == 1)) { break; }
+            width = std::max((width + 1) / 2, 1u);
+            height = std::max((height + 1) / 2, 1u);
+        }
+        // Only the coarsest levels are read back, small boxes are not worth the copy of the finest ones
+        firstReadbackLevel = 0;
+        while ((firstReadbackLevel < (levels.size() - 1)) &&
+               (std::max(levels[firstReadbackLevel].width, levels[firstReadbackLevel].height) > READBACK_MAX_SIZE)) {
+            firstReadbackLevel += 1;
+        }
+        readbackLevels.clear();
+        size_t offset{0};
+        for (auto level = firstReadbackLevel; level < levels.size(); level++) {
+            readbackLevels.push_back({levels[level].width, levels[level].height, offset});
+            offset += levels[level].width * levels[level].height;
+        }
+
+        for (auto& frame : frameData) {
+            device.createImage(levels.front().width,
+                               levels.front().height,
+                               levels.size(),
+                               VK_SAMPLE_COUNT_1_BIT,
+                               FORMAT,
+                               VK_IMAGE_TILING_OPTIMAL,
+                               VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+                               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                               frame.image,
+                               frame.imageMemory);
+            for (auto level = 0; level < levels.size(); level++) {
+                frame.levelsViews.push_back(device.createImageView(frame.image,
+                                                                   FORMAT,
+                                                                   VK_IMAGE_ASPECT_COLOR_BIT,
+                                                                   1,
+                                                                   VK_IMAGE_VIEW_TYPE_2D,
+                                                                   0,
+                                                                   1,
+                                                                   level));
+            }
+            frame.readbackBuffer = make_unique<Buffer>(
+                sizeof(float),
+                offset,
+                VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                1,
+                true);
+        }
+
+        // The descriptor sets reference the images views, they are all allocated again
+        if (descriptorPool != nullptr) {
+            descriptorPool->resetPool();
+            createOrUpdateDescriptorSet(true);
+        }
+    }
+
+    void DepthPyramidRenderer::loadShaders() {
+        depthPyramidShader = createShader("depth_pyramid.comp", VK_SHADER_STAGE_COMPUTE_BIT, 0);
+    }
+
+    void DepthPyramidRenderer::createDescriptorSetLayout() {
+        const auto count = device.getFramesInFlight() * MAX_LEVELS;
+        descriptorPool = DescriptorPool::Builder(device)
+                .setMaxSets(count)
+                .addPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, count)
+                .addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, count)
+                .build();
+        setLayout = DescriptorSetLayout::Builder(device)
+                .addBinding(0,
+                            VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                            VK_SHADER_STAGE_COMPUTE_BIT)
+                .addBinding(1,
+                            VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+                            VK_SHADER_STAGE_COMPUTE_BIT)
+                .build();
+    }
+
+    void DepthPyramidRenderer::createOrUpdateDescriptorSet(const bool create) {
+        if (!create) { return; }
+        for (auto i = 0; i < device.getFramesInFlight(); i++) {
+            auto& frame = frameData[i];
+            frame.levelsDescriptorSets.resize(levels.size());
+            for (auto level = 0; level < levels.size(); level++) {
+                // The first level reads the depth buffer, the others read the previous level
+                const auto inputInfo = level == 0 ?
+                    VkDescriptorImageInfo{
+                        .sampler     = sampler,
+                        .imageView   = depthFrameBuffers[i]->getImageView(),
+                        .imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
+                    } :
+                    VkDescriptorImageInfo{
+                        .sampler     = sampler,
+                        .imageView   = frame.levelsViews[level - 1],
+                        .imageLayout = VK_IMAGE_LAYOUT_GENERAL,
+                    };
+                const auto outputInfo = VkDescriptorImageInfo{
+                    .sampler     = VK_NULL_HANDLE,
+                    .imageView   = frame.levelsViews[level],
+                    .imageLayout = VK_IMAGE_LAYOUT_GENERAL,
+                };
+                auto writer = DescriptorWriter(*setLayout, *descriptorPool)
+                    .writeImage(0, &inputInfo)
+                    .writeImage(1, &outputInfo);
+                if (!writer.build(frame.levelsDescriptorSets[level], true)) {
+                    die("Cannot allocate depth pyramid descriptor set");
+                }
+            }
+        }
+    }
+
+    void DepthPyramidRenderer::recordCommands(const VkCommandBuffer commandBuffer,
+                                              const uint32_t        currentFrame,
+                                              const mat4&           viewProjection) {
+        auto& frame = frameData[currentFrame];
+        // The depth pre-pass must be resolved before the first level is built
+        const VkMemoryBarrier depthBarrier{
+            .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+            .srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
+        };
+        vkCmdPipelineBarrier(commandBuffer,
+                             VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0,
+                             1, &depthBarrier,
+                             0, nullptr,
+                             0, nullptr);
+        Device::transitionImageLayout(commandBuffer,
+                                      frame.image,
+                                      VK_IMAGE_LAYOUT_UNDEFINED,
+                                      VK_IMAGE_LAYOUT_GENERAL,
+                                      0,
+                                      VK_ACCESS_SHADER_WRITE_BIT,
+                                      VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                                      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                      VK_IMAGE_ASPECT_COLOR_BIT,
+                                      levels.size());
+
+        vkCmdBindShadersEXT(commandBuffer, 1, depthPyramidShader->getStage(), depthPyramidShader->getShader());
+        // Each level must be written before being read to build the next one
+        const VkMemoryBarrier levelBarrier{
+            .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+            .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
+        };
+        for (auto level = 0; level < levels.size(); level++) {
+            vkCmdBindDescriptorSets(commandBuffer,
+                                    VK_PIPELINE_BIND_POINT_COMPUTE,
+                                    pipelineLayout,
+                                    0,
+                                    1,
+                                    &frame.levelsDescriptorSets[level],
+                                    0,
+                                    nullptr);
+            vkCmdDispatch(commandBuffer,
+                          (levels[level].width + WORK_GROUP_SIZE - 1) / WORK_GROUP_SIZE,
+                          (levels[level].height + WORK_GROUP_SIZE - 1) / WORK_GROUP_SIZE,
+                          1);
+            vkCmdPipelineBarrier(commandBuffer,
+                                 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                 0,
+                                 1, &levelBarrier,
+                                 0, nullptr,
+                                 0, nullptr);
+        }
+
+        // Copy of the coarsest levels for the CPU occlusion culling.
+        // The depth buffer is resolved again by the next passes, they must wait for the end of the first level.
+        const VkMemoryBarrier copyBarrier{
+            .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+            .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
+        };
+        vkCmdPipelineBarrier(commandBuffer,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT |
+                             VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT |
+                             VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                             0,
+                             1, &copyBarrier,
+                             0, nullptr,
+                             0, nullptr);
+        vector<VkBufferImageCopy> regions;
+        for (auto i = 0; i < readbackLevels.size(); i++) {
+            regions.push_back({
+                .bufferOffset      = readbackLevels[i].offset * sizeof(float),
+                .bufferRowLength   = 0,
+                .bufferImageHeight = 0,
+                .imageSubresource  = {
+                    .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+                    .mipLevel       = static_cast<uint32_t>(firstReadbackLevel + i),
+                    .baseArrayLayer = 0,
+                    .layerCount     = 1,
+                },
+                .imageOffset       = {0, 0, 0},
+                .imageExtent       = {readbackLevels[i].width, readbackLevels[i].height, 1},
+            });
+        }
+        vkCmdCopyImageToBuffer(commandBuffer,
+                               frame.image,
+                               VK_IMAGE_LAYOUT_GENERAL,
+                               frame.readbackBuffer->getBuffer(),
+                               regions.size(),
+                               regions.data());
+        const VkMemoryBarrier hostBarrier{
+            .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+            .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_HOST_READ_BIT,
+        };
+        vkCmdPipelineBarrier(commandBuffer,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_HOST_BIT,
+                             0,
+                             1, &hostBarrier,
+                             0, nullptr,
+                             0, nullptr);
+        frame.viewProjection = viewProjection;
+        frame.recorded = true;
+    }
+
+    void DepthPyramidRenderer::readback(const uint32_t currentFrame, OcclusionCulling& occlusionCulling) {
+        const auto& frame = frameData[currentFrame];
+        if (!frame.recorded) {
+            occlusionCulling.reset();
+            return;
+        }
+        occlusionCulling.setDepthPyramid(frame.viewProjection, readbackLevels);
+        const auto& last = readbackLevels.back();
+        frame.readbackBuffer->readFromBuffer(occlusionCulling.getDepthData(),
+                                             (last.offset + last.width * last.height) * sizeof(float));
+    }
+
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2024-2025 Henri Michelon
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+*/
+module;
+#include "z0/vulkan.h"
+#include "z0/libraries.h"
+
+export module z0.vulkan.DepthPyramidRenderer;
+
+import z0.OcclusionCulling;
+
+import z0.vulkan.Buffer;
+import z0.vulkan.DepthFrameBuffer;
+import z0.vulkan.Descriptors;
+import z0.vulkan.Device;
+import z0.vulkan.Renderpass;
+import z0.vulkan.Shader;
+
+export namespace z0 {
+
+    /*
+     * Builds the hierarchical-Z depth pyramid from the resolved depth pre-pass buffer
+     * and copies its coarsest levels to a host visible buffer for the CPU occlusion culling.
+     * Sub pass of the scene renderer, recorded in the scene renderer command buffer.
+     */
+    class DepthPyramidRenderer : public Renderpass {
+    public:
+        DepthPyramidRenderer(Device &device, const vector<shared_ptr<DepthFrameBuffer>>& depthFrameBuffers);
+
+        void cleanup() override;
+
+        void cleanupImagesResources();
+
+        void createImagesResources();
+
+        /*
+         * Builds the pyramid from the depth pre-pass and copies it for the read back
+         */
+        void recordCommands(VkCommandBuffer commandBuffer, uint32_t currentFrame, const mat4& viewProjection);
+
+        /*
+         * Gives the pyramid built the last time this frame in flight was rendered to the occlusion culling.
+         * Must be called after the frame in flight fence wait.
+         */
+        void readback(uint32_t currentFrame, OcclusionCulling& occlusionCulling);
+
+        void loadShaders() override;
+
+        void createDescriptorSetLayout() override;
+
+        void createOrUpdateDescriptorSet(bool create) override;
+
+    private:
+        // Maximum number of levels : for up to 2^16 pixels wide depth buffers
+        static constexpr uint32_t MAX_LEVELS{16};
+        // Maximum size of the finest level read back by the CPU
+        static constexpr uint32_t READBACK_MAX_SIZE{256};
+        // Work group size of depth_pyramid.comp
+        static constexpr uint32_t WORK_GROUP_SIZE{8};
+        static constexpr auto     FORMAT{VK_FORMAT_R32_SFLOAT};
+
+        struct FrameData {
+            VkImage                 image{VK_NULL_HANDLE};
+            VkDeviceMemory          imageMemory{VK_NULL_HANDLE};
+            // One view & one descriptor set per level
+            vector<VkImageView>     levelsViews;
+            vector<VkDescriptorSet> levelsDescriptorSets;
+            // Host visible copy of the levels read back by the CPU
+            unique_ptr<Buffer>      readbackBuffer;
+            // Camera used to render the depth pre-pass
+            mat4                    viewProjection{1.0f};
+            // `true` if the pyramid has been built since the last images (re)creation
+            bool                    recorded{false};
+        };
+
+        const vector<shared_ptr<DepthFrameBuffer>>& depthFrameBuffers;
+        vector<FrameData>                           frameData;
+        // Size of all the levels, from the finest to the coarsest
+        vector<OcclusionCulling::Level>             levels;
+        // Index of the first level read back by the CPU
+        uint32_t                                    firstReadbackLevel{0};
+        // Levels read back by the CPU, with their offsets in the read back buffer
+        vector<OcclusionCulling::Level>             readbackLevels;
+        VkSampler                                   sampler{VK_NULL_HANDLE};
+        unique_ptr<Shader>                          depthPyramidShader;
+    };
+
+}
@@ -88,7 +88,7 @@ import z0.vulkan.Mesh;
     void ModelsRenderer::cleanup() {
         for(auto& frame: frameData) {
             frame.depthFrameBuffer->cleanupImagesResources();
-            frame.modelUniformBuffer.reset();
+            frame.modelsBuffer.reset();
         }
         cleanupImagesResources();
         Renderpass::cleanup();
@@ -54,9 +54,9 @@ export namespace z0 {
             // All the models of the scene
             list<shared_ptr<MeshInstance>> models{};
             bool modelsDirty{false};
-            // Data for all the models of the scene, one buffer for all the models
+            // Data for all the models of the scene, one buffer for all the models, indexed by stable per-instance slots
             // https://docs.vulkan.org/samples/latest/samples/performance/descriptor_management/README.html
-            unique_ptr<Buffer> modelUniformBuffer;
+            unique_ptr<Buffer> modelsBuffer;
             // Depth testing multi sampled off-screen buffer
             shared_ptr<DepthFrameBuffer> depthFrameBuffer;
             // Current viewport to reset the viewport size if removed from the scene tree
@@ -42,7 +42,7 @@ namespace z0 {
         normalColorAttachment{normalColorAttachment},
         diffuseColorAttachment{diffuseColorAttachment} {
         outputColorAttachment.resize(device.getFramesInFlight());
-        globalBuffer.resize(device.getFramesInFlight());
+        globalBufferOffset.resize(device.getFramesInFlight());
         createImagesResources();
         createOrUpdateResources(true, &pushConstantRange, 1);
     }
@@ -53,7 +53,6 @@ namespace z0 {
     }
 
     void PostprocessingRenderer::cleanup() {
-        globalBuffer.clear();
         cleanupImagesResources();
         Renderpass::cleanup();
     }
@@ -65,7 +64,7 @@ namespace z0 {
 
     void PostprocessingRenderer::update(const uint32_t currentFrame) {
         if (globalBufferData != nullptr) {
-            writeUniformBuffer(globalBuffer[currentFrame], globalBufferData);
+            globalBufferOffset[currentFrame] = writeFrameData(currentFrame, globalBufferData, globalBufferSize);
         }
     }
 
@@ -78,7 +77,7 @@ namespace z0 {
         vkCmdSetDepthTestEnable(commandBuffer, VK_FALSE);
         vkCmdSetVertexInputEXT(commandBuffer, 0, nullptr, 0, nullptr);
         vkCmdSetCullMode(commandBuffer, VK_CULL_MODE_NONE);
-        bindDescriptorSets(commandBuffer, currentFrame);
+        bindDescriptorSets(commandBuffer, currentFrame, 1, &globalBufferOffset[currentFrame]);
         const auto pushConstants = PushConstants {
             .texelSize = 1.0f / vec2{device.getSwapChainExtent().width, device.getSwapChainExtent().height},
         };
@@ -97,14 +96,14 @@ namespace z0 {
         descriptorPool = DescriptorPool::Builder(device)
                                  .setMaxSets(device.getFramesInFlight())
                                  .addPoolSize(
-                                     VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+                                     VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
                                      device.getFramesInFlight())
                                  .addPoolSize(
                                      VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
                                      device.getFramesInFlight() * (BINDING_DIFFUSE_COLOR + 1))
                                  .build();
         setLayout = DescriptorSetLayout::Builder(device)
-                            .addBinding(BINDING_GLOBAL_BUFFER, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT)
+                            .addBinding(BINDING_GLOBAL_BUFFER, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, VK_SHADER_STAGE_FRAGMENT_BIT)
                             .addBinding(BINDING_INPUT_COLOR, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT, 1)
                             .addBinding(BINDING_DEPTH_BUFFER, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT, 1)
                             .addBinding(BINDING_NORMAL_COLOR, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT, 1)
@@ -113,14 +112,11 @@ namespace z0 {
         if (blankImage == nullptr) {
             blankImage = reinterpret_pointer_cast<VulkanImage>(Image::createBlankImage(device));
         }
-        for (auto i = 0; i < device.getFramesInFlight(); i++) {
-            globalBuffer[i] = createUniformBuffer(globalBufferSize);
-        }
     }
 
     void PostprocessingRenderer::createOrUpdateDescriptorSet(const bool create) {
         for (auto i = 0; i < device.getFramesInFlight(); i++) {
-            auto globalBufferInfo = globalBuffer[i]->descriptorInfo(globalBufferSize);
+            auto globalBufferInfo = frameDataInfo(globalBufferSize);
             auto imageInfo = inputColorAttachment[i]->imageInfo();
             auto depthInfo = depthAttachment.empty() ?
                 blankImage->getImageInfo() :
@@ -80,7 +80,8 @@ export namespace z0 {
 
         const string                                  fragShaderName;
         uint32_t                                      globalBufferSize{1};
-        vector<unique_ptr<Buffer>>                    globalBuffer;
+        // Offsets of the global uniform buffer in the device frame ring buffer
+        vector<uint32_t>                              globalBufferOffset;
         void*                                         globalBufferData{nullptr};
         vector<shared_ptr<ColorFrameBufferHDR>>       outputColorAttachment;
         vector<shared_ptr<ColorFrameBufferHDR>>       inputColorAttachment;
@@ -12,12 +12,13 @@ module z0.vulkan.Renderpass;
 
 import z0.Tools;
 import z0.Constants;
-import z0.VirtualFS;
 
 import z0.vulkan.Buffer;
 import z0.vulkan.Device;
 import z0.vulkan.Descriptors;
+import z0.vulkan.RingBuffer;
 import z0.vulkan.Shader;
+import z0.vulkan.ShaderCache;
 
 namespace z0 {
 
@@ -81,6 +82,16 @@ namespace z0 {
         buffer->writeToBuffer(data);
     }
 
+    uint32_t Renderpass::writeFrameData(const uint32_t     currentFrame,
+                                        const void *       data,
+                                        const VkDeviceSize size) const {
+        return device.getFrameRingBuffer().write(currentFrame, data, size);
+    }
+
+    VkDescriptorBufferInfo Renderpass::frameDataInfo(const VkDeviceSize size, const VkDeviceSize offset) const {
+        return device.getFrameRingBuffer().descriptorInfo(size, offset);
+    }
+
     void Renderpass::createOrUpdateResources(const bool descriptorsAndPushConstants, const VkPushConstantRange* pushConstantRange, const uint32_t pushConstantSize) {
         if (!descriptorsAndPushConstants && pipelineLayout == VK_NULL_HANDLE && (pushConstantRange != nullptr)) {
             createPipelineLayout(pushConstantRange, pushConstantSize);
@@ -111,6 +122,18 @@ namespace z0 {
         return std::move(buffer);
     }
 
+    unique_ptr<Buffer> Renderpass::createStorageBuffer(const VkDeviceSize size,
+                                                       const uint32_t     count) const {
+        auto buffer = make_unique<Buffer>(
+                size,
+                count,
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                device.getDeviceProperties().limits.minStorageBufferOffsetAlignment
+                );
+        if (buffer->map() != VK_SUCCESS) { die("Error mapping SSBO to GPU memory"); }
+        return std::move(buffer);
+    }
+
     void Renderpass::bindDescriptorSets(const VkCommandBuffer commandBuffer,
                                         const uint32_t        currentFrame,
                                         const uint32_t        count,
@@ -142,8 +165,9 @@ namespace z0 {
 
     unique_ptr<Shader> Renderpass::createShader(const string &              filename,
                                                 const VkShaderStageFlagBits stage,
-                                                const VkShaderStageFlags    next_stage) {
-        auto code = VirtualFS::loadShader(filename);
+                                                const VkShaderStageFlags    next_stage,
+                                                const VkSpecializationInfo* specializationInfo) {
+        const auto& code = device.getShaderCache().getSpirv(filename);
         auto shader = make_unique<Shader>(
                 device,
                 stage,
@@ -151,7 +175,8 @@ namespace z0 {
                 filename,
                 code,
                 setLayout != nullptr && setLayout->isValid() ? setLayout->getDescriptorSetLayout() : nullptr,
-                pushConstantRange);
+                pushConstantRange,
+                specializationInfo);
         buildShader(*shader);
         return shader;
     }
@@ -174,12 +199,12 @@ namespace z0 {
 
     void Renderpass::buildShader(Shader &shader) const {
         // https://docs.vulkan.org/samples/latest/samples/extensions/shader_object/README.html
-        VkShaderEXT                 shaderEXT;
+        // The shaders re-created with the same code & layout, when resizing or restarting, use the cached binaries
         const VkShaderCreateInfoEXT shaderCreateInfo = shader.getShaderCreateInfo();
-        if (vkCreateShadersEXT(vkDevice, 1, &shaderCreateInfo, nullptr, &shaderEXT) != VK_SUCCESS) {
-            die("vkCreateShadersEXT failed");
-        }
-        shader.setShader(shaderEXT);
+        shader.setShader(device.getShaderCache().createShader(
+            shader.getName(),
+            shaderCreateInfo,
+            setLayout != nullptr && setLayout->isValid() ? setLayout->getSignature() : 0));
     }
 
 }
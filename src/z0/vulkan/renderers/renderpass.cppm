@@ -57,17 +57,27 @@ export namespace z0 {
 
         static void writeUniformBuffer(const unique_ptr<Buffer> &buffer, const void *data);
 
+        // Writes transient data in the device frame ring buffer, returns the offset to use with bindDescriptorSets()
+        uint32_t writeFrameData(uint32_t currentFrame, const void *data, VkDeviceSize size) const;
+
+        // Descriptor for a VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC binding in the device frame ring buffer,
+        // or for a VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER binding at the offset returned by writeFrameData()
+        VkDescriptorBufferInfo frameDataInfo(VkDeviceSize size, VkDeviceSize offset = 0) const;
+
         void createOrUpdateResources(bool descriptorsAndPushConstants = false, const VkPushConstantRange* = nullptr, uint32_t pushConstantSize = 0);
 
         unique_ptr<Buffer> createUniformBuffer(VkDeviceSize size, uint32_t count = 1) const;
 
+        unique_ptr<Buffer> createStorageBuffer(VkDeviceSize size, uint32_t count = 1) const;
+
         void bindDescriptorSets(VkCommandBuffer commandBuffer, uint32_t currentFrame, uint32_t count = 0,
                                 const uint32_t *offsets = nullptr) const;
 
         void bindShaders(VkCommandBuffer commandBuffer) const;
 
         unique_ptr<Shader> createShader(const string &filename, VkShaderStageFlagBits stage,
-                                        VkShaderStageFlags next_stage);
+                                        VkShaderStageFlags next_stage,
+                                        const VkSpecializationInfo* specializationInfo = nullptr);
 
         virtual void loadShaders() = 0;
 
@@ -18,6 +18,8 @@ import z0.Constants;
 import z0.Log;
 import z0.Tools;
 import z0.FrustumCulling;
+import z0.LightClusters;
+import z0.OcclusionCulling;
 
 import z0.nodes.Node;
 import z0.nodes.MeshInstance;
@@ -29,6 +31,7 @@ import z0.nodes.SpotLight;
 import z0.nodes.Skybox;
 
 import z0.resources.Material;
+import z0.resources.Mesh;
 import z0.resources.Resource;
 import z0.resources.Image;
 import z0.resources.Cubemap;
@@ -37,6 +40,7 @@ import z0.vulkan.Buffer;
 import z0.vulkan.ColorFrameBuffer;
 import z0.vulkan.ColorFrameBufferHDR;
 import z0.vulkan.DepthFrameBuffer;
+import z0.vulkan.DepthPyramidRenderer;
 import z0.vulkan.Descriptors;
 import z0.vulkan.Device;
 import z0.vulkan.FrameBuffer;
@@ -61,7 +65,10 @@ namespace z0 {
         ModelsRenderer{device, clearColor},
         enableDiffusePrepass{enableDiffusePrepass},
         enableNormalPrepass{enableNormalPrepass},
-        enableDepthPrepass{enableDepthPrepass} {
+        enableDepthPrepass{enableDepthPrepass},
+        gpuLightsCulling{app().getConfig().gpuLightsCulling},
+        meshLODScreenSize{app().getConfig().meshLODScreenSize},
+        meshLODHysteresis{app().getConfig().meshLODHysteresis} {
         frameData.resize(device.getFramesInFlight());
         colorFrameBufferHdr.resize(device.getFramesInFlight());
         resolvedDepthFrameBuffer.resize(device.getFramesInFlight());
@@ -70,9 +77,17 @@ namespace z0 {
         normalFrameBuffer.resize(device.getFramesInFlight());
         resolvedNormalFrameBuffer.resize(device.getFramesInFlight());
         createImagesResources();
+        if (enableDepthPrepass && app().getConfig().occlusionCulling) {
+            depthPyramidRenderer = make_unique<DepthPyramidRenderer>(device, resolvedDepthFrameBuffer);
+        }
         ranges::for_each(frameData, [&device](FrameData& frame) {
             frame.colorFrameBufferMultisampled = make_unique<ColorFrameBuffer>(device, true);
         });
+        if (!gpuLightsCulling) {
+            clustersGrid = make_unique<LightClusters::Grid>();
+        }
+        skinningRenderer = make_shared<SkinningRenderer>(device);
+        device.registerPrepass(skinningRenderer);
         createOrUpdateResources(true, &pushConstantRange, 1);
     }
 
@@ -80,10 +95,10 @@ namespace z0 {
         blankImage.reset();
         blankCubemap.reset();
         ranges::for_each(frameData, [](FrameData& frame) {
-            frame.globalBuffer.reset();
             frame.materialShaders.clear();
             frame.materialsBuffer.reset();
             frame.lightBuffer.reset();
+            frame.clustersBuffer.reset();
             if (frame.skyboxRenderer != nullptr)
                 frame.skyboxRenderer->cleanup();
             frame.opaquesModels.clear();
@@ -94,6 +109,17 @@ namespace z0 {
             pair.second->cleanup();
         }
         shadowMapRenderers.clear();
+        if (skinningRenderer != nullptr) {
+            device.unRegisterPrepass(skinningRenderer);
+            skinningRenderer->cleanup();
+            skinningRenderer.reset();
+        }
+        lightClustersShader.reset();
+        fragShaderPermutations.clear();
+        if (depthPyramidRenderer != nullptr) {
+            depthPyramidRenderer->cleanup();
+            depthPyramidRenderer.reset();
+        }
         ModelsRenderer::cleanup();
     }
 
@@ -110,7 +136,13 @@ namespace z0 {
             }
         }
         if (const auto& light = dynamic_pointer_cast<Light>(node)) {
-            frameData[currentFrame].lights.push_back(light);
+            // Directional lights are not clustered and are always the first lights of the lights buffer
+            auto& lights = frameData[currentFrame].lights;
+            if (light->getLightType() == Light::LIGHT_DIRECTIONAL) {
+                lights.insert(lights.begin(), light);
+            } else {
+                lights.push_back(light);
+            }
             descriptorSetNeedUpdate = true;
             enableLightShadowCasting(light);
         }
@@ -136,7 +168,6 @@ namespace z0 {
         for (const auto &material : app().getOutlineMaterials().getAll()) {
             if (!frameData[currentFrame].materialsIndices.contains(material->getId())) {
                 addMaterial(material, currentFrame);
-                descriptorSetNeedUpdate = true;
             }
         }
     }
@@ -145,7 +176,11 @@ namespace z0 {
         auto& frame = frameData[currentFrame];
         // Force material data to be written to GPU memory
         material->_setDirty();
-        frame.materialsIndices[material->getId()] = static_cast<int32_t>(frame.materials.size());
+        const auto slot = frame.materialsSlots.allocate(MAX_MATERIALS);
+        if (slot == -1) {
+            die("Maximum materials count reached for the scene renderer");
+        }
+        frame.materialsIndices[material->getId()] = slot;
         frame.materials.push_back(material);
         frame.materialsRefCounter[material->getId()]++;
         DEBUG("SceneRenderer::addMaterial ", material->getName());
@@ -175,16 +210,11 @@ namespace z0 {
                         frame.materialShaders.erase(shaderMaterial->getFragFileName());
                     }
                 }
-                // Remove the material from the scene
+                // Remove the material from the scene, the other materials keep their slots
                 frame.materials.remove(material);
-                // Rebuild the material index
-                frame.materialsIndices.clear();
-                uint32_t materialIndex = 0;
-                for (const auto &mat : frame.materials) {
-                    frame.materialsIndices[mat->getId()] = static_cast<int32_t>(materialIndex);
-                    materialIndex += 1;
-                }
-                frame.materialsDirty = true;
+                frame.materialsSlots.release(frame.materialsIndices.at(material->getId()));
+                frame.materialsIndices.erase(material->getId());
+                frame.materialsFeatures.erase(material->getId());
                 DEBUG("SceneRenderer::removeMaterial ", material->getName());
             }
         }
@@ -211,10 +241,20 @@ namespace z0 {
     }
 
     void SceneRenderer::addingModel(const shared_ptr<MeshInstance>& meshInstance, const uint32_t currentFrame) {
-        const auto & frame = frameData[currentFrame];
+        auto& frame = frameData[currentFrame];
         ModelsRenderer::frameData[currentFrame].models.sort([](const shared_ptr<MeshInstance>&a, const shared_ptr<MeshInstance>&b) {
             return *a < *b;
         });
+        const auto slot = frame.modelsSlots.allocate(numeric_limits<int32_t>::max());
+        frame.modelsIndices[meshInstance.get()] = slot;
+        if (slot >= frame.modelsVersions.size()) {
+            frame.modelsVersions.resize(slot + 1);
+        }
+        // Force the transform to be written to GPU memory
+        frame.modelsVersions[slot] = NO_TRANSFORM_VERSION;
+        if (meshInstance->isSkinned()) {
+            skinningRenderer->addModel(meshInstance, currentFrame);
+        }
         for (const auto &material : meshInstance->getMesh()->_getMaterials()) {
             if (frame.materialsRefCounter.contains(material->getId())) {
                 frameData[currentFrame].materialsRefCounter[material->getId()]++;
@@ -248,8 +288,15 @@ namespace z0 {
            removeMaterial(material, currentFrame);
         }
         auto& frame = frameData[currentFrame];
+        if (frame.modelsIndices.contains(meshInstance.get())) {
+            frame.modelsSlots.release(frame.modelsIndices.at(meshInstance.get()));
+            frame.modelsIndices.erase(meshInstance.get());
+        }
         frame.opaquesModels.erase(meshInstance->getMesh()->getId());
         frame.transparentModels.erase(meshInstance->getMesh()->getId());
+        if (meshInstance->isSkinned()) {
+            skinningRenderer->removeModel(meshInstance, currentFrame);
+        }
         DEBUG("SceneRenderer::removingModel ", meshInstance->getName());
     }
 
@@ -295,11 +342,18 @@ namespace z0 {
             .screenSize      = vec2{device.getSwapChainExtent().width, device.getSwapChainExtent().height},
         };
 
+        lightClusters.setProjection(currentCamera->getProjection(), currentCamera->getNearDistance(), currentCamera->getFarDistance());
+        globalUbo.clustersSliceScale = lightClusters.getSliceScale();
+        globalUbo.clustersSliceBias = lightClusters.getSliceBias();
+        auto lightSpheres = vector<LightClusters::LightSphere>{};
         if (frame.lights.size() > 0) {
             auto lightsArray = vector<LightBuffer>(frame.lights.size());
             auto lightIndex = 0;
             for (const auto& light : frame.lights) {
                 if (!light->isVisible()) { continue; }
+                if (light->getLightType() == Light::LIGHT_DIRECTIONAL) {
+                    globalUbo.directionalLightsCount += 1;
+                }
                 lightsArray[lightIndex].type      = light->getLightType();
                 lightsArray[lightIndex].position  = light->getPositionGlobal();
                 lightsArray[lightIndex].color     = light->getColorAndIntensity();
@@ -319,6 +373,7 @@ namespace z0 {
                     case Light::LIGHT_OMNI: {
                         const auto& omniLight = reinterpret_pointer_cast<OmniLight>(light);
                         lightsArray[lightIndex].range  = omniLight->getRange();
+                        lightSpheres.push_back({lightsArray[lightIndex].position, lightsArray[lightIndex].range});
                         break;
                     }
                     default:
@@ -354,28 +409,51 @@ namespace z0 {
                 }
                 lightIndex += 1;
             }
-            writeUniformBuffer(frame.lightBuffer, lightsArray.data());
+            if (lightIndex > 0) {
+                frame.lightBuffer->writeToBuffer(lightsArray.data(), LIGHT_BUFFER_SIZE * lightIndex);
+            }
             globalUbo.lightsCount = lightIndex;
         }
-        writeUniformBuffer(frame.globalBuffer, &globalUbo);
+        if (!gpuLightsCulling) {
+            lightClusters.bin(currentCamera->getView(), lightSpheres, globalUbo.directionalLightsCount, *clustersGrid);
+            writeUniformBuffer(frame.clustersBuffer, clustersGrid.get());
+        }
+        frame.globalBufferOffset = writeFrameData(currentFrame, &globalUbo, GLOBAL_BUFFER_SIZE);
+        // The GPU has finished with this frame : the global UBO binding can be moved to the new offset
+        const auto globalBufferInfo = frameDataInfo(GLOBAL_BUFFER_SIZE, frame.globalBufferOffset);
+        DescriptorWriter(*setLayout, *descriptorPool)
+            .writeBuffer(BINDING_GLOBAL_BUFFER, &globalBufferInfo)
+            .update(descriptorSet.at(currentFrame));
 
         frame.drawOutlines = false;
         frame.meshesIndices.clear();
         frame.opaquesModels.clear();
         frame.transparentModels.clear();
-        if (ModelsRenderer::frameData[currentFrame].modelsDirty) {
-            frame.modelUBOArray = make_unique<ModelBuffer[]>(models.size());
+        frame.instances.clear();
+        frame.dirtyModels.clear();
+        if (depthPyramidRenderer != nullptr) {
+            depthPyramidRenderer->readback(currentFrame, occlusionCulling);
         }
-        uint32_t modelIndex = 0;
+        const auto cameraPosition = currentCamera->getPositionGlobal();
+        const auto projectionScale = currentCamera->getProjection()[1][1];
         for (const auto &meshInstance : models) {
-            if (meshInstance->isVisible() && frame.cameraFrustum.isOnFrustum(meshInstance)) {
+            const auto slot = frame.modelsIndices.at(meshInstance.get());
+            // Selected for all the models, including the ones outside the camera frustum that can cast shadows
+            meshInstance->_setLOD(selectLOD(*meshInstance, cameraPosition, projectionScale));
+            // Only the transforms modified since the last upload in this frame-in-flight buffer are written
+            if (frame.modelsVersions[slot] != meshInstance->_getTransformVersion()) {
+                frame.modelsVersions[slot] = meshInstance->_getTransformVersion();
+                frame.dirtyModels.push_back({slot, meshInstance.get()});
+            }
+            if (meshInstance->isVisible() &&
+                frame.cameraFrustum.isOnFrustum(meshInstance) &&
+                !occlusionCulling.isOccluded(meshInstance->getAABB())) {
                 const auto meshId = meshInstance->getMesh()->getId();
                 if (!frame.meshesIndices.contains(meshId)) {
-                    frame.meshesIndices[meshId] = modelIndex;
+                    frame.meshesIndices[meshId] = frame.instances.size();
                 }
                 frame.drawOutlines |= meshInstance->isOutlined();
-                frame.modelUBOArray[modelIndex].matrix = meshInstance->getTransformGlobal();
-                modelIndex += 1;
+                frame.instances.push_back(slot);
 
                 auto transparent{false};
                 if (enableDepthPrepass && meshInstance->isValid()) {
@@ -393,15 +471,14 @@ namespace z0 {
                 }
             }
         }
-        ModelsRenderer::frameData[currentFrame].modelUniformBuffer->writeToBuffer(
-                   frame.modelUBOArray.get(),
-                   MODEL_BUFFER_SIZE * modelIndex);
+        uploadModels(currentFrame);
+        frame.instancesBuffer->writeToBuffer(frame.instances.data(), INSTANCE_BUFFER_SIZE * frame.instances.size());
         ModelsRenderer::frameData[currentFrame].modelsDirty = false;
 
         // Update in GPU memory only the materials modified since the last frame
-        uint32_t materialIndex = 0;
         for (const auto& material : frame.materials) {
-            if (frame.materialsDirty || material->_isDirty()) {
+            if (material->_isDirty()) {
+                const auto materialIndex = frame.materialsIndices.at(material->getId());
                 auto materialUBO = MaterialBuffer{
                     .transparency = static_cast<int>(material->getTransparency()),
                     .alphaScissor = material->getAlphaScissor()
@@ -425,6 +502,7 @@ namespace z0 {
                     convert(textureUBO.metallicTexture, standardMaterial->getMetallicTexture());
                     convert(textureUBO.roughnessTexture, standardMaterial->getRoughnessTexture());
                     convert(textureUBO.emissiveTexture, standardMaterial->getEmissiveTexture());
+                    frame.materialsFeatures[material->getId()] = getMaterialFeatures(*standardMaterial);
                     frame.texturesBuffer->writeToBuffer(
                         &textureUBO,
                         TEXTURE_BUFFER_SIZE,
@@ -440,9 +518,23 @@ namespace z0 {
                     MATERIAL_BUFFER_SIZE * materialIndex);
                 material->_clearDirty();
             }
-            materialIndex++;
         }
-        frame.materialsDirty = false;
+
+        // Specialize the scene fragment shader for the features of the materials not yet drawn
+        const auto shadows = shadowMapRenderers.empty() ? 0 : FEATURE_SHADOWS;
+        for (const auto& features : frame.materialsFeatures | views::values) {
+            const auto permutation = features | shadows;
+            if (!fragShaderPermutations.contains(permutation)) {
+                static constexpr auto specializationMap = VkSpecializationMapEntry{ 0, 0, sizeof(uint32_t) };
+                const auto specializationInfo = VkSpecializationInfo{ 1, &specializationMap, sizeof(permutation), &permutation };
+                fragShaderPermutations[permutation] = createShader(
+                    app().getConfig().sceneFragmentShader + ".frag",
+                    VK_SHADER_STAGE_FRAGMENT_BIT,
+                    0,
+                    &specializationInfo);
+                DEBUG("SceneRenderer : fragment shader permutation ", to_string(permutation));
+            }
+        }
     }
 
     void SceneRenderer::drawFrame(const uint32_t currentFrame, const bool isLast) {
@@ -461,6 +553,9 @@ namespace z0 {
             }
             return;
         }
+        if (gpuLightsCulling && !ModelsRenderer::frameData[currentFrame].models.empty()) {
+            cullLights(currentFrame);
+        }
         beginRendering(currentFrame);
         setInitialState(commandBuffer, currentFrame);
         const auto& frame = frameData[currentFrame];
@@ -491,37 +586,205 @@ namespace z0 {
         endRendering(currentFrame, isLast);
     }
 
+    uint32_t SceneRenderer::getMaterialFeatures(const StandardMaterial& material) {
+        auto features = uint32_t{0};
+        if (material.getAlbedoTexture().texture != nullptr) { features |= FEATURE_ALBEDO_TEXTURE; }
+        if (material.getNormalTexture().texture != nullptr) { features |= FEATURE_NORMAL_TEXTURE; }
+        if (material.getEmissiveTexture().texture != nullptr) { features |= FEATURE_EMISSIVE_TEXTURE; }
+        if (material.getMetallicFactor() != -1.0f) {
+            features |= FEATURE_PBR;
+            if (material.getMetallicTexture().texture != nullptr) { features |= FEATURE_METALLIC_TEXTURE; }
+            if (material.getRoughnessTexture().texture != nullptr) { features |= FEATURE_ROUGHNESS_TEXTURE; }
+        }
+        const auto transparency = material.getTransparency();
+        if (transparency == Transparency::SCISSOR || transparency == Transparency::SCISSOR_ALPHA) {
+            features |= FEATURE_ALPHA_SCISSOR;
+        }
+        if (transparency == Transparency::ALPHA || transparency == Transparency::SCISSOR_ALPHA) {
+            features |= FEATURE_ALPHA_BLEND;
+        }
+        return features;
+    }
+
+    uint32_t SceneRenderer::getFragShaderPermutation(const FrameData& frame, const Material& material) const {
+        // The shaders materials and the materials not yet uploaded use the unspecialized shader
+        if (!frame.materialsFeatures.contains(material.getId())) { return FEATURES_ALL; }
+        // The shadows depend on the lights of the scene, not on the material
+        return frame.materialsFeatures.at(material.getId()) | (shadowMapRenderers.empty() ? 0 : FEATURE_SHADOWS);
+    }
+
+    void SceneRenderer::uploadModels(const uint32_t currentFrame) {
+        auto& frame = frameData[currentFrame];
+        if (frame.dirtyModels.empty()) { return; }
+        const auto& modelsBuffer = ModelsRenderer::frameData[currentFrame].modelsBuffer;
+        // Scatter copy : sort the modified models by slot and write each run of contiguous slots with only one copy
+        ranges::sort(frame.dirtyModels, {}, &pair<int32_t, const MeshInstance*>::first);
+        frame.dirtyModelsData.resize(frame.dirtyModels.size());
+        for (auto i = 0; i < frame.dirtyModels.size(); i++) {
+            frame.dirtyModelsData[i].matrix = frame.dirtyModels[i].second->getTransformGlobal();
+        }
+        auto first = 0;
+        while (first < frame.dirtyModels.size()) {
+            auto last = first + 1;
+            while ((last < frame.dirtyModels.size()) &&
+                   (frame.dirtyModels[last].first == (frame.dirtyModels[last - 1].first + 1))) {
+                last += 1;
+            }
+            modelsBuffer->writeToBuffer(
+                &frame.dirtyModelsData[first],
+                MODEL_BUFFER_SIZE * (last - first),
+                MODEL_BUFFER_SIZE * frame.dirtyModels[first].first);
+            first = last;
+        }
+    }
+
+    uint32_t SceneRenderer::selectLOD(const MeshInstance& meshInstance, const vec3& cameraPosition, const float projectionScale) const {
+        if (!meshInstance.isValid()) { return 0; }
+        const auto lodCount = meshInstance.getMesh()->getLODCount();
+        if (lodCount == 1) { return 0; }
+        // Fraction of the screen height covered by the bounding sphere of the world space AABB
+        const auto& aabb = meshInstance.getAABB();
+        const auto radius = length(aabb.max - aabb.min) * 0.5f;
+        const auto distance = length((aabb.min + aabb.max) * 0.5f - cameraPosition);
+        const auto screenSize = radius * projectionScale / std::max(distance, numeric_limits<float>::epsilon());
+        // The level N > 0 is used under meshLODScreenSize / 2^(N-1)
+        const auto threshold = [this](const uint32_t level) {
+            return meshLODScreenSize / static_cast<float>(1 << (level - 1));
+        };
+        // Only leave the current level when the screen size is clearly outside its range
+        auto lod = std::min(meshInstance._getLOD(), lodCount - 1);
+        while (lod > 0 && screenSize > threshold(lod) * (1.0f + meshLODHysteresis)) {
+            lod -= 1;
+        }
+        while (lod < (lodCount - 1) && screenSize < threshold(lod + 1) * (1.0f - meshLODHysteresis)) {
+            lod += 1;
+        }
+        return lod;
+    }
+
+    void SceneRenderer::bindMesh(const VkCommandBuffer commandBuffer,
+                                 const uint32_t currentFrame,
+                                 const MeshInstance& meshInstance) const {
+        const auto &mesh = reinterpret_pointer_cast<VulkanMesh>(meshInstance.getMesh());
+        if (meshInstance.isSkinned()) {
+            mesh->bind(commandBuffer, skinningRenderer->getVertexBuffer(currentFrame));
+        } else {
+            mesh->bind(commandBuffer);
+        }
+    }
+
+    void SceneRenderer::drawSurface(const VkCommandBuffer commandBuffer,
+                                    const uint32_t currentFrame,
+                                    const Surface& surface,
+                                    const list<shared_ptr<MeshInstance>> &instances) const {
+        auto draw = [&](const uint32_t lod, const uint32_t firstInstance, const uint32_t instanceCount, const int32_t vertexOffset) {
+            const auto range = surface.getLOD(lod);
+            vkCmdDrawIndexed(commandBuffer,
+                range.indexCount,
+                instanceCount,
+                range.firstIndex,
+                vertexOffset,
+                firstInstance);
+        };
+        // The instances are stored by mesh in the visible instances buffer, in the same order as the list
+        auto firstInstance = uint32_t{0};
+        if (instances.front()->isSkinned()) {
+            for (const auto &meshInstance : instances) {
+                draw(meshInstance->_getLOD(),
+                     firstInstance,
+                     1,
+                     skinningRenderer->getVertexOffset(*meshInstance, currentFrame));
+                firstInstance += 1;
+            }
+            return;
+        }
+        auto instanceCount = uint32_t{0};
+        auto lod = uint32_t{0};
+        for (const auto &meshInstance : instances) {
+            const auto instanceLOD = meshInstance->_getLOD();
+            if (instanceCount > 0 && instanceLOD != lod) {
+                draw(lod, firstInstance, instanceCount, 0);
+                firstInstance += instanceCount;
+                instanceCount = 0;
+            }
+            lod = instanceLOD;
+            instanceCount += 1;
+        }
+        if (instanceCount > 0) {
+            draw(lod, firstInstance, instanceCount, 0);
+        }
+    }
+
+    void SceneRenderer::cullLights(const uint32_t currentFrame) {
+        const auto& commandBuffer = commandBuffers[currentFrame];
+        vkCmdBindShadersEXT(commandBuffer, 1, lightClustersShader->getStage(), lightClustersShader->getShader());
+        vkCmdBindDescriptorSets(commandBuffer,
+                                VK_PIPELINE_BIND_POINT_COMPUTE,
+                                pipelineLayout,
+                                0,
+                                1,
+                                &descriptorSet[currentFrame],
+                                0,
+                                nullptr);
+        // One invocation per cluster, one work group per depth slice
+        vkCmdDispatch(commandBuffer, 1, 1, LightClusters::CLUSTERS_Z);
+        // The lights lists must be written before being read by the fragment shaders
+        const VkMemoryBarrier barrier{
+            .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+            .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
+        };
+        vkCmdPipelineBarrier(commandBuffer,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                             0,
+                             1, &barrier,
+                             0, nullptr,
+                             0, nullptr);
+    }
+
     void SceneRenderer::createDescriptorSetLayout() {
         descriptorPool =
                 DescriptorPool::Builder(device)
                         .setMaxSets(device.getFramesInFlight())
-                        // global, models, materials+textures, shadow maps & lights UBOs
-                        .addPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 6 * device.getFramesInFlight())
+                        // global UBO
+                        .addPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, device.getFramesInFlight())
+                        // models, instances, materials, textures, lights & clusters SSBOs
+                        .addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 6 * device.getFramesInFlight())
                         // textures, shadow maps, shadow cubemap & PBR*3
                         .addPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
                             device.getFramesInFlight() * (MAX_IMAGES + MAX_SHADOW_MAPS * 2 + 4))
+                        // for the bindless textures array
+                        .setPoolFlags(VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT)
                         .build();
 
         setLayout = DescriptorSetLayout::Builder(device)
                             .addBinding(BINDING_GLOBAL_BUFFER,
                                         VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-                                        VK_SHADER_STAGE_ALL_GRAPHICS)
+                                        VK_SHADER_STAGE_ALL_GRAPHICS | VK_SHADER_STAGE_COMPUTE_BIT)
                             .addBinding(BINDING_MODELS_BUFFER,
-                                        VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+                                        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                                        VK_SHADER_STAGE_VERTEX_BIT)
+                            .addBinding(BINDING_INSTANCES_BUFFER,
+                                        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
                                         VK_SHADER_STAGE_VERTEX_BIT)
                             .addBinding(BINDING_MATERIALS_BUFFER,
-                                        VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+                                        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
                                         VK_SHADER_STAGE_ALL_GRAPHICS)
                             .addBinding(BINDING_TEXTURES_BUFFER,
-                                        VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+                                        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
                                         VK_SHADER_STAGE_FRAGMENT_BIT)
                             .addBinding(BINDING_TEXTURES,
                                         VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
                                         VK_SHADER_STAGE_FRAGMENT_BIT,
                                         MAX_IMAGES)
+                            .setBindingFlags(BINDING_TEXTURES,
+                                        VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+                                        VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+                                        VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT)
                             .addBinding(BINDING_LIGHTS_BUFFER,
-                                        VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-                                        VK_SHADER_STAGE_FRAGMENT_BIT)
+                                        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                                        VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT)
                             .addBinding(BINDING_SHADOW_MAPS,
                                         VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
                                         VK_SHADER_STAGE_FRAGMENT_BIT,
@@ -545,6 +808,9 @@ namespace z0 {
                             // .addBinding(BINDING_NORMAL_BUFFER,
                                         // VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
                                         // VK_SHADER_STAGE_FRAGMENT_BIT)
+                            .addBinding(BINDING_CLUSTERS_BUFFER,
+                                        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                                        VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT)
                             .build();
 
         // Create an in-memory default blank images
@@ -555,7 +821,7 @@ namespace z0 {
         }
 
         for (auto i = 0; i < device.getFramesInFlight(); i++) {
-            frameData[i].globalBuffer = createUniformBuffer(GLOBAL_BUFFER_SIZE);
+            frameData[i].clustersBuffer = createStorageBuffer(CLUSTERS_BUFFER_SIZE);
         }
     }
 
@@ -563,17 +829,22 @@ namespace z0 {
         //auto lock = lock_guard(descriptorSetMutex);
         for (auto frameIndex = 0; frameIndex < device.getFramesInFlight(); frameIndex++) {
             auto& frame = frameData[frameIndex];
-            if (!ModelsRenderer::frameData[frameIndex].models.empty() && (frame.modelBufferCount != ModelsRenderer::frameData[frameIndex].models.size())) {
-                frame.modelBufferCount = ModelsRenderer::frameData[frameIndex].models.size();
-                ModelsRenderer::frameData[frameIndex].modelUniformBuffer = createUniformBuffer(MODEL_BUFFER_SIZE * frame.modelBufferCount);
+            // The models buffer only grows since the models keep their slots
+            const auto modelsSlotsCount = std::max(static_cast<uint32_t>(frame.modelsSlots.next), 1u);
+            if (frame.modelBufferCount < modelsSlotsCount) {
+                frame.modelBufferCount = std::max(modelsSlotsCount, frame.modelBufferCount * 2);
+                ModelsRenderer::frameData[frameIndex].modelsBuffer = createStorageBuffer(MODEL_BUFFER_SIZE * frame.modelBufferCount);
+                // New buffer : all the transforms must be uploaded again
+                ranges::fill(frame.modelsVersions, NO_TRANSFORM_VERSION);
             }
-            if (frame.modelBufferCount == 0) {
-                frame.modelBufferCount = 1;
-                ModelsRenderer::frameData[frameIndex].modelUniformBuffer = createUniformBuffer(MODEL_BUFFER_SIZE);
+            const auto instancesCount = std::max(static_cast<uint32_t>(ModelsRenderer::frameData[frameIndex].models.size()), 1u);
+            if (frame.instancesBufferCount < instancesCount) {
+                frame.instancesBufferCount = std::max(instancesCount, frame.instancesBufferCount * 2);
+                frame.instancesBuffer = createStorageBuffer(INSTANCE_BUFFER_SIZE * frame.instancesBufferCount);
             }
             if (frame.materialsBuffer == nullptr) {
-                frame.materialsBuffer = createUniformBuffer(MATERIAL_BUFFER_SIZE * MAX_MATERIALS);
-                frame.texturesBuffer = createUniformBuffer(TEXTURE_BUFFER_SIZE * MAX_MATERIALS);
+                frame.materialsBuffer = createStorageBuffer(MATERIAL_BUFFER_SIZE * MAX_MATERIALS);
+                frame.texturesBuffer = createStorageBuffer(TEXTURE_BUFFER_SIZE * MAX_MATERIALS);
                 // Initialize all materials & textures buffers in GPU memory
                 auto materialUBOArray = make_unique<MaterialBuffer[]>(MAX_MATERIALS);
                 writeUniformBuffer(frame.materialsBuffer, materialUBOArray.get());
@@ -581,29 +852,21 @@ namespace z0 {
                 writeUniformBuffer(frame.texturesBuffer, textureUBOArray.get());
             }
 
-            if ((!frame.lights.empty()) && (frame.lightBufferCount != frame.lights.size())) {
-                frame.lightBufferCount = frame.lights.size();
-                frame.lightBuffer = createUniformBuffer(LIGHT_BUFFER_SIZE * frame.lightBufferCount);
+            // The lights buffer only grows, to avoid recreating it when lights are added and removed
+            if (frame.lightBufferCount < frame.lights.size()) {
+                frame.lightBufferCount = std::max(static_cast<uint32_t>(frame.lights.size()), frame.lightBufferCount * 2);
+                frame.lightBuffer = createStorageBuffer(LIGHT_BUFFER_SIZE * frame.lightBufferCount);
             }
             if (frame.lightBufferCount == 0) {
                 frame.lightBufferCount = 1;
-                frame.lightBuffer = createUniformBuffer(LIGHT_BUFFER_SIZE);
-            }
-
-            uint32_t imageIndex = 0;
-            for (const auto &image : frame.images) {
-                frame.imagesInfo[imageIndex] = image->getImageInfo();
-                imageIndex += 1;
-            }
-            for (auto j = imageIndex; j < frame.imagesInfo.size(); j++) {
-                frame.imagesInfo[j] = blankImage->getImageInfo();
+                frame.lightBuffer = createStorageBuffer(LIGHT_BUFFER_SIZE);
             }
 
             for (auto j = 0; j < frame.shadowMapsInfo.size(); j++) {
                 frame.shadowMapsInfo[j] = blankImageArray->getImageInfo();
                 frame.shadowMapsCubemapInfo[j] = blankCubemap->getImageInfo();
             }
-            imageIndex = 0;
+            uint32_t imageIndex = 0;
             for (const auto &pair : shadowMapRenderers) {
                 const auto &shadowMap = pair.second->getShadowMap(frameIndex);
                 shadowMap->_setBufferIndex(imageIndex);
@@ -620,13 +883,15 @@ namespace z0 {
                 imageIndex += 1;
             }
 
-            auto globalBufferInfo     = frame.globalBuffer->descriptorInfo(GLOBAL_BUFFER_SIZE);
-            auto modelBufferInfo      = ModelsRenderer::frameData[frameIndex].modelUniformBuffer->descriptorInfo(
+            auto globalBufferInfo     = frameDataInfo(GLOBAL_BUFFER_SIZE, frame.globalBufferOffset);
+            auto modelBufferInfo      = ModelsRenderer::frameData[frameIndex].modelsBuffer->descriptorInfo(
                  MODEL_BUFFER_SIZE *
                  frame.modelBufferCount);
+            auto instancesBufferInfo  = frame.instancesBuffer->descriptorInfo(INSTANCE_BUFFER_SIZE * frame.instancesBufferCount);
             auto materialBufferInfo   = frame.materialsBuffer->descriptorInfo(MATERIAL_BUFFER_SIZE * MAX_MATERIALS);
             auto textureBufferInfo    = frame.texturesBuffer->descriptorInfo(TEXTURE_BUFFER_SIZE * MAX_MATERIALS);
             auto pointLightBufferInfo = frame.lightBuffer->descriptorInfo(LIGHT_BUFFER_SIZE * frame.lightBufferCount);
+            auto clustersBufferInfo   = frame.clustersBuffer->descriptorInfo(CLUSTERS_BUFFER_SIZE);
 
             VkDescriptorImageInfo specularInfo;
             VkDescriptorImageInfo irradianceInfo;
@@ -652,17 +917,27 @@ namespace z0 {
             auto writer = DescriptorWriter(*setLayout, *descriptorPool)
                 .writeBuffer(BINDING_GLOBAL_BUFFER, &globalBufferInfo)
                 .writeBuffer(BINDING_MODELS_BUFFER, &modelBufferInfo)
+                .writeBuffer(BINDING_INSTANCES_BUFFER, &instancesBufferInfo)
                 .writeBuffer(BINDING_MATERIALS_BUFFER, &materialBufferInfo)
                 .writeBuffer(BINDING_TEXTURES_BUFFER, &textureBufferInfo)
                 .writeBuffer(BINDING_LIGHTS_BUFFER, &pointLightBufferInfo)
-                .writeImage(BINDING_TEXTURES, frame.imagesInfo.data())
                 .writeImage(BINDING_SHADOW_MAPS, frame.shadowMapsInfo.data())
                 .writeImage(BINDING_SHADOW_CUBEMAPS, frame.shadowMapsCubemapInfo.data())
                 .writeImage(BINDING_PBR_ENV_MAP, &specularInfo)
                 .writeImage(BINDING_PBR_IRRADIANCE_MAP, &irradianceInfo)
                 .writeImage(BINDING_PBR_BRDF_LUT, &brdfInfo)
-                .writeImage(BINDING_DEPTH_BUFFER, &frame.depthBufferInfo);
+                .writeImage(BINDING_DEPTH_BUFFER, &frame.depthBufferInfo)
                 // .writeImage(BINDING_NORMAL_BUFFER, &frame.normalBufferInfo);
+                .writeBuffer(BINDING_CLUSTERS_BUFFER, &clustersBufferInfo);
+            // The bindless textures array is partially bound and only written when an image is added or removed
+            auto imagesInfo = vector<VkDescriptorImageInfo>{};
+            if (create) {
+                imagesInfo.reserve(frame.images.size());
+                for (const auto &image : frame.images) {
+                    imagesInfo.push_back(image->getImageInfo());
+                    writer.writeImage(BINDING_TEXTURES, &imagesInfo.back(), frame.imagesIndices.at(image->getId()));
+                }
+            }
             if (!writer.build(descriptorSet.at(frameIndex), create))
                 die("Cannot allocate descriptor set for scene renderer");
         }
@@ -682,6 +957,11 @@ namespace z0 {
             app().getConfig().sceneFragmentShader + ".frag",
             VK_SHADER_STAGE_FRAGMENT_BIT,
             0);
+        // The permutations are specialized again on demand with the new layout
+        fragShaderPermutations.clear();
+        if (gpuLightsCulling) {
+            lightClustersShader = createShader("light_clusters.comp", VK_SHADER_STAGE_COMPUTE_BIT, 0);
+        }
         if (enableDepthPrepass) {
             depthPrepassVertShader = createShader("depth_prepass.vert", VK_SHADER_STAGE_VERTEX_BIT, 0);
         }
@@ -740,6 +1020,9 @@ namespace z0 {
             colorFrameBufferHdr[i]->cleanupImagesResources();
             frameData[i].colorFrameBufferMultisampled->cleanupImagesResources();
         }
+        if (depthPyramidRenderer != nullptr) {
+            depthPyramidRenderer->cleanupImagesResources();
+        }
     }
 
     void SceneRenderer::recreateImagesResources() {
@@ -759,10 +1042,19 @@ namespace z0 {
                 resolvedDiffuseFrameBuffer[i]->cleanupImagesResources();
             }
         }
+        if (depthPyramidRenderer != nullptr) {
+            depthPyramidRenderer->createImagesResources();
+        }
     }
 
     void SceneRenderer::beginRendering(const uint32_t currentFrame) {
         if (enableDepthPrepass) { depthPrepass(currentFrame, frameData[currentFrame].opaquesModels); }
+        if (depthPyramidRenderer != nullptr) {
+            const auto& camera = ModelsRenderer::frameData[currentFrame].currentCamera;
+            depthPyramidRenderer->recordCommands(commandBuffers[currentFrame],
+                                                 currentFrame,
+                                                 camera->getProjection() * camera->getView());
+        }
         if (enableNormalPrepass) { normalPrepass(currentFrame, frameData[currentFrame].opaquesModels); }
         if (enableDiffusePrepass) { diffusePrepass(currentFrame, frameData[currentFrame].opaquesModels); }
         const auto& commandBuffer = commandBuffers[currentFrame];
@@ -845,99 +1137,155 @@ namespace z0 {
     }
 
     void SceneRenderer::addImage(const shared_ptr<Image> &image, const uint32_t currentFrame) {
+        auto& frame = frameData[currentFrame];
         const auto& vkImage = reinterpret_pointer_cast<VulkanImage>(image);
-        frameData[currentFrame].imagesRefCounter[vkImage->getId()]++;
-        if (ranges::find(frameData[currentFrame].images, vkImage) != frameData[currentFrame].images.end()) {
+        frame.imagesRefCounter[vkImage->getId()]++;
+        if (frame.imagesIndices.contains(vkImage->getId())) {
             return;
         }
-        if (frameData[currentFrame].images.size() == MAX_IMAGES) {
+        const auto slot = frame.imagesSlots.allocate(MAX_IMAGES);
+        if (slot == -1) {
             die("Maximum images count reached for the scene renderer");
         }
-        frameData[currentFrame].imagesIndices[vkImage->getId()] = static_cast<int32_t>(frameData[currentFrame].images.size());
-        frameData[currentFrame].images.push_back(vkImage);
+        frame.imagesIndices[vkImage->getId()] = slot;
+        frame.images.push_back(vkImage);
+        writeImageSlot(currentFrame, slot, vkImage->getImageInfo());
         DEBUG("SceneRenderer::addImage ", vkImage->getName(), to_string(vkImage->getWidth()), "x", to_string(vkImage->getHeight()));
     }
 
     void SceneRenderer::removeImage(const shared_ptr<Image> &image, const uint32_t currentFrame) {
         const auto& vkImage = reinterpret_pointer_cast<VulkanImage>(image);
-        if (ranges::find(frameData[currentFrame].images, vkImage) != frameData[currentFrame].images.end()) {
-            if (--frameData[currentFrame].imagesRefCounter[vkImage->getId()] == 0) {
-                frameData[currentFrame].imagesRefCounter.erase(vkImage->getId());
-                frameData[currentFrame].images.remove(vkImage);
-                // Rebuild the image index
-                frameData[currentFrame].imagesIndices.clear();
-                uint32_t imageIndex = 0;
-                for (const auto &img : frameData[currentFrame].images) {
-                    frameData[currentFrame].imagesIndices[img->getId()] = static_cast<int32_t>(imageIndex);
-                    imageIndex += 1;
-                }
+        auto& frame = frameData[currentFrame];
+        if (frame.imagesIndices.contains(vkImage->getId())) {
+            if (--frame.imagesRefCounter[vkImage->getId()] == 0) {
+                frame.imagesRefCounter.erase(vkImage->getId());
+                frame.images.remove(vkImage);
+                // The slot no longer references the image, the other images keep their slots
+                const auto slot = frame.imagesIndices.at(vkImage->getId());
+                writeImageSlot(currentFrame, slot, blankImage->getImageInfo());
+                frame.imagesSlots.release(slot);
+                frame.imagesIndices.erase(vkImage->getId());
             }
             DEBUG("SceneRenderer::removeImage ", vkImage->getName(), to_string(vkImage->getWidth()), "x", to_string(vkImage->getHeight()));
         }
     }
 
+    void SceneRenderer::writeImageSlot(const uint32_t currentFrame, const int32_t slot, const VkDescriptorImageInfo& imageInfo) {
+        // Update after bind : no need to rewrite the whole descriptor set
+        DescriptorWriter(*setLayout, *descriptorPool)
+            .writeImage(BINDING_TEXTURES, &imageInfo, slot)
+            .update(descriptorSet.at(currentFrame));
+    }
+
     void SceneRenderer::drawModels(const uint32_t currentFrame,
                                    const map<Resource::id_t, list<shared_ptr<MeshInstance>>> &modelsToDraw,
                                    const bool withShaderMaterials) {
         const auto& commandBuffer = commandBuffers[currentFrame];
         auto &frame = frameData[currentFrame];
-        auto shadersChanged = false;
+        // One draw per surface, grouped by fragment shader permutation to limit the shaders binds
+        struct Draw {
+            uint32_t                                permutation;
+            Resource::id_t                          meshId;
+            const list<shared_ptr<MeshInstance>>*   instances;
+            const shared_ptr<Surface>*              surface;
+        };
+        auto draws = vector<Draw>{};
+        for (const auto &modelByMesh : modelsToDraw) {
+            const auto &mesh = reinterpret_pointer_cast<VulkanMesh>(modelByMesh.second.front()->getMesh());
+            for (const auto &surface : mesh->getSurfaces()) {
+                draws.push_back({
+                    .permutation = withShaderMaterials ?
+                        getFragShaderPermutation(frame, *surface->material) :
+                        FEATURES_ALL,
+                    .meshId = modelByMesh.first,
+                    .instances = &modelByMesh.second,
+                    .surface = &surface,
+                });
+            }
+        }
+        // Keep the meshes order inside a permutation
+        if (withShaderMaterials) {
+            ranges::stable_sort(draws, {}, &Draw::permutation);
+        }
+
+        // The unspecialized fragment shader is bound before and after the draws,
+        // no permutation is bound when using the fragment shader of a shader material
+        auto boundPermutation = optional<uint32_t>{FEATURES_ALL};
+        auto vertShaderChanged = false;
+        const auto bindFragShader = [&](const uint32_t permutation) {
+            const auto& shader = fragShaderPermutations.contains(permutation) ?
+                fragShaderPermutations.at(permutation) :
+                fragShader;
+            vkCmdBindShadersEXT(commandBuffer, 1, shader->getStage(), shader->getShader());
+            boundPermutation = permutation;
+        };
         shared_ptr<Material> previousMaterial{};
         auto previousCullMode{CullMode::DISABLED};
         vkCmdSetCullMode(commandBuffer, VK_CULL_MODE_NONE);
 
-        for (const auto &modelByMesh : modelsToDraw) {
-            const auto &modelIndex = frame.meshesIndices[modelByMesh.first];
-            const auto &mesh = reinterpret_pointer_cast<VulkanMesh>(modelByMesh.second.front()->getMesh());
-            mesh->bind(commandBuffer);
-            for (const auto &surface : mesh->getSurfaces()) {
-                if (previousMaterial != surface->material) {
-                    previousMaterial = surface->material;
-                    if (withShaderMaterials) {
-                        if (const auto shaderMaterial = dynamic_cast<ShaderMaterial *>(surface->material.get())) {
-                            if (!shaderMaterial->getFragFileName().empty()) {
-                                Shader *material = frame.materialShaders[shaderMaterial->getFragFileName()].get();
-                                vkCmdBindShadersEXT(commandBuffer, 1, material->getStage(), material->getShader());
-                                shadersChanged = true;
-                            }
-                            if (!shaderMaterial->getVertFileName().empty()) {
-                                Shader *material = frame.materialShaders[shaderMaterial->getVertFileName()].get();
-                                vkCmdBindShadersEXT(commandBuffer, 1, material->getStage(), material->getShader());
-                                shadersChanged = true;
-                            }
-                        } else if (shadersChanged) {
+        const list<shared_ptr<MeshInstance>>* previousInstances{nullptr};
+        for (const auto &draw : draws) {
+            const auto &surface = *draw.surface;
+            const auto &modelIndex = frame.meshesIndices[draw.meshId];
+            if (previousInstances != draw.instances) {
+                previousInstances = draw.instances;
+                bindMesh(commandBuffer, currentFrame, *draw.instances->front());
+            }
+            if (previousMaterial != surface->material) {
+                previousMaterial = surface->material;
+                if (withShaderMaterials) {
+                    if (const auto shaderMaterial = dynamic_cast<ShaderMaterial *>(surface->material.get())) {
+                        if (!shaderMaterial->getFragFileName().empty()) {
+                            Shader *material = frame.materialShaders[shaderMaterial->getFragFileName()].get();
+                            vkCmdBindShadersEXT(commandBuffer, 1, material->getStage(), material->getShader());
+                            boundPermutation.reset();
+                        } else if (boundPermutation != FEATURES_ALL) {
+                            bindFragShader(FEATURES_ALL);
+                        }
+                        if (!shaderMaterial->getVertFileName().empty()) {
+                            Shader *material = frame.materialShaders[shaderMaterial->getVertFileName()].get();
+                            vkCmdBindShadersEXT(commandBuffer, 1, material->getStage(), material->getShader());
+                            vertShaderChanged = true;
+                        }
+                    } else {
+                        if (vertShaderChanged) {
                             vkCmdBindShadersEXT(commandBuffer, 1, vertShader->getStage(), vertShader->getShader());
-                            vkCmdBindShadersEXT(commandBuffer, 1, fragShader->getStage(), fragShader->getShader());
-                            shadersChanged = false;
+                            vertShaderChanged = false;
+                        }
+                        if (boundPermutation != draw.permutation) {
+                            bindFragShader(draw.permutation);
                         }
                     }
+                }
 
-                    const auto cullMode = surface->material->getCullMode();
-                    if (previousCullMode != cullMode) {
-                        previousCullMode = cullMode;
-                        vkCmdSetCullMode(commandBuffer,
-                                         cullMode == CullMode::DISABLED ? VK_CULL_MODE_NONE
-                                                 : cullMode == CullMode::BACK
-                                                 ? VK_CULL_MODE_BACK_BIT
-                                                 : VK_CULL_MODE_FRONT_BIT);
-                    }
+                const auto cullMode = surface->material->getCullMode();
+                if (previousCullMode != cullMode) {
+                    previousCullMode = cullMode;
+                    vkCmdSetCullMode(commandBuffer,
+                                     cullMode == CullMode::DISABLED ? VK_CULL_MODE_NONE
+                                             : cullMode == CullMode::BACK
+                                             ? VK_CULL_MODE_BACK_BIT
+                                             : VK_CULL_MODE_FRONT_BIT);
                 }
-                auto pushConstants = PushConstants {
-                    .modelIndex = static_cast<int>(modelIndex),
-                    .materialIndex = frame.materialsIndices[surface->material->getId()]
-                };
-                vkCmdPushConstants(commandBuffer,
-                    pipelineLayout,
-                    VK_SHADER_STAGE_ALL_GRAPHICS,
-                    0,
-                    PUSHCONSTANTS_SIZE,
-                    &pushConstants);
-                vkCmdDrawIndexed(commandBuffer,
-                    surface->indexCount,
-                    modelByMesh.second.size(),
-                    surface->firstVertexIndex,
-                    0,
-                    0);
+            }
+            auto pushConstants = PushConstants {
+                .modelIndex = static_cast<int>(modelIndex),
+                .materialIndex = frame.materialsIndices[surface->material->getId()]
+            };
+            vkCmdPushConstants(commandBuffer,
+                pipelineLayout,
+                VK_SHADER_STAGE_ALL_GRAPHICS,
+                0,
+                PUSHCONSTANTS_SIZE,
+                &pushConstants);
+            drawSurface(commandBuffer, currentFrame, *surface, *draw.instances);
+        }
+        if (withShaderMaterials) {
+            if (vertShaderChanged) {
+                vkCmdBindShadersEXT(commandBuffer, 1, vertShader->getStage(), vertShader->getShader());
+            }
+            if (boundPermutation != FEATURES_ALL) {
+                bindFragShader(FEATURES_ALL);
             }
         }
     }
@@ -953,7 +1301,7 @@ namespace z0 {
         for (const auto &modelByMesh : modelsToDraw) {
             auto modelIndex = frame.meshesIndices[modelByMesh.first];
             const auto &mesh = reinterpret_pointer_cast<VulkanMesh>(modelByMesh.second.front()->getMesh());
-            mesh->bind(commandBuffer);
+            bindMesh(commandBuffer, currentFrame, *modelByMesh.second.front());
             for (const auto &meshInstance : modelByMesh.second) {
                 if (meshInstance->isOutlined()) {
 
@@ -983,12 +1331,15 @@ namespace z0 {
                         PUSHCONSTANTS_SIZE,
                         &pushConstants);
 
+                    const auto vertexOffset = meshInstance->isSkinned() ?
+                        skinningRenderer->getVertexOffset(*meshInstance, currentFrame) : 0;
                     for (const auto &surface : mesh->getSurfaces()) {
+                        const auto range = surface->getLOD(meshInstance->_getLOD());
                         vkCmdDrawIndexed(commandBuffer,
-                           surface->indexCount,
+                           range.indexCount,
                            1,
-                           surface->firstVertexIndex,
-                           0,
+                           range.firstIndex,
+                           vertexOffset,
                            0);
                     }
                 }
@@ -1071,7 +1422,7 @@ namespace z0 {
     void SceneRenderer::enableLightShadowCasting(const shared_ptr<Light>&light) {
         if (enableShadowMapRenders) {
             if (light->getCastShadows() && !shadowMapRenderers.contains(light) && (shadowMapRenderers.size() < MAX_SHADOW_MAPS)) {
-                const auto shadowMapRenderer = make_shared<ShadowMapRenderer>(device, light);
+                const auto shadowMapRenderer = make_shared<ShadowMapRenderer>(device, light, skinningRenderer);
                 for(auto i = 0; i < device.getFramesInFlight(); i++) {
                     shadowMapRenderer->activateCamera(ModelsRenderer::frameData.at(0).currentCamera, i);
                 }
@@ -1278,7 +1629,7 @@ namespace z0 {
                 }
                 const auto &modelIndex = frame.meshesIndices[modelByMesh.first];
                 const auto &mesh = reinterpret_pointer_cast<VulkanMesh>(modelByMesh.second.front()->getMesh());
-                mesh->bind(commandBuffer);
+                bindMesh(commandBuffer, currentFrame, *modelByMesh.second.front());
                 auto pushConstants = PushConstants {
                     .modelIndex = static_cast<int>(modelIndex),
                     .materialIndex = 0
@@ -1299,12 +1650,7 @@ namespace z0 {
                                      ? VK_CULL_MODE_BACK_BIT
                                      : VK_CULL_MODE_FRONT_BIT);
                     }
-                    vkCmdDrawIndexed(commandBuffer,
-                       surface->indexCount,
-                       modelByMesh.second.size(),
-                       surface->firstVertexIndex,
-                       0,
-                       0);
+                    drawSurface(commandBuffer, currentFrame, *surface, modelByMesh.second);
                 }
             }
         }
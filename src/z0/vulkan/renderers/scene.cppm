@@ -12,6 +12,8 @@ export module z0.vulkan.SceneRenderer;
 
 import z0.Constants;
 import z0.FrustumCulling;
+import z0.LightClusters;
+import z0.OcclusionCulling;
 
 import z0.nodes.Camera;
 import z0.nodes.Node;
@@ -24,6 +26,7 @@ import z0.nodes.SpotLight;
 import z0.nodes.Skybox;
 
 import z0.resources.Material;
+import z0.resources.Mesh;
 import z0.resources.Resource;
 import z0.resources.Image;
 import z0.resources.Cubemap;
@@ -32,6 +35,7 @@ import z0.vulkan.Buffer;
 import z0.vulkan.ColorFrameBuffer;
 import z0.vulkan.ColorFrameBufferHDR;
 import z0.vulkan.DebugRenderer;
+import z0.vulkan.DepthPyramidRenderer;
 import z0.vulkan.DepthFrameBuffer;
 import z0.vulkan.DiffuseFrameBuffer;
 import z0.vulkan.Device;
@@ -42,6 +46,7 @@ import z0.vulkan.Shader;
 import z0.vulkan.ShadowMapFrameBuffer;
 import z0.vulkan.ShadowMapRenderer;
 import z0.vulkan.SampledFrameBuffer;
+import z0.vulkan.SkinningRenderer;
 import z0.vulkan.SkyboxRenderer;
 import z0.vulkan.Cubemap;
 import z0.vulkan.Image;
@@ -100,6 +105,9 @@ namespace z0 {
             alignas(16) vec4    ambient; // RGB + Intensity;
             alignas(4) uint32_t ambientIBL; // Only if HDRi skybox
             alignas(8) ivec2   screenSize{0};
+            alignas(4) uint32_t directionalLightsCount{0}; // Directional lights are the first lights of the lights buffer
+            alignas(4) float    clustersSliceScale;
+            alignas(4) float    clustersSliceBias;
         };
         static constexpr auto GLOBAL_BUFFER_SIZE = sizeof(GlobalBuffer);
 
@@ -121,6 +129,8 @@ namespace z0 {
             BINDING_PBR_BRDF_LUT       = 10,
             BINDING_DEPTH_BUFFER       = 11,
             // BINDING_NORMAL_BUFFER      = 12,
+            BINDING_CLUSTERS_BUFFER    = 13,
+            BINDING_INSTANCES_BUFFER   = 14,
         };
 
         struct MaterialBuffer {
@@ -135,7 +145,7 @@ namespace z0 {
             alignas(16) vec4 parameters[ShaderMaterial::MAX_PARAMETERS];
         };
 
-        // Material & Texture infos are split in two buffers because of the 64kb buffer limit on some GPU/drivers
+        // Material & Texture infos are stored in two storage buffers indexed by the same material slot
         struct TextureInfo {
             alignas(4) int32_t  index{-1};
             alignas(16) mat3x4  transform{1.0f};
@@ -177,11 +187,11 @@ namespace z0 {
         };
 
         // Maximum number of materials supported by this renderer
-        static constexpr vector<Resource::id_t>::size_type MAX_MATERIALS{200};
+        static constexpr uint32_t MAX_MATERIALS{4096};
         // Maximum number of shadow maps supported by this renderer
         static constexpr uint32_t MAX_SHADOW_MAPS{10};
-        // Maximum number of images supported by this renderer
-        static constexpr uint32_t MAX_IMAGES{200};
+        // Maximum number of images supported by this renderer (size of the bindless textures array)
+        static constexpr uint32_t MAX_IMAGES{4096};
         // Constant depth bias factor (always applied)
         static constexpr float depthBiasConstant = 0.0f;
         // Slope depth bias factor, applied depending on polygon's slope
@@ -189,12 +199,49 @@ namespace z0 {
 
         // Size of each model matrix buffer
         static constexpr VkDeviceSize MODEL_BUFFER_SIZE{sizeof(ModelBuffer)};
+        // Size of each entry of the visible instances buffer
+        static constexpr VkDeviceSize INSTANCE_BUFFER_SIZE{sizeof(uint32_t)};
+        // Uploaded transform version of a model slot never written
+        static constexpr uint32_t NO_TRANSFORM_VERSION{numeric_limits<uint32_t>::max()};
         // Size of each material buffer
         static constexpr VkDeviceSize MATERIAL_BUFFER_SIZE{sizeof(MaterialBuffer)};
         // Size of each material textures buffer
         static constexpr VkDeviceSize TEXTURE_BUFFER_SIZE{sizeof(TextureBuffer)};
         // Size of the point light uniform buffers
         static constexpr VkDeviceSize LIGHT_BUFFER_SIZE{sizeof(LightBuffer)};
+        // Size of the clusters lights lists buffer
+        static constexpr VkDeviceSize CLUSTERS_BUFFER_SIZE{sizeof(LightClusters::Grid)};
+
+        // Material features of the scene fragment shader permutations, FEATURE_* in input_datas.glsl
+        static constexpr uint32_t FEATURE_ALBEDO_TEXTURE{0x001};
+        static constexpr uint32_t FEATURE_NORMAL_TEXTURE{0x002};
+        static constexpr uint32_t FEATURE_PBR{0x004};
+        static constexpr uint32_t FEATURE_METALLIC_TEXTURE{0x008};
+        static constexpr uint32_t FEATURE_ROUGHNESS_TEXTURE{0x010};
+        static constexpr uint32_t FEATURE_EMISSIVE_TEXTURE{0x020};
+        static constexpr uint32_t FEATURE_ALPHA_SCISSOR{0x040};
+        static constexpr uint32_t FEATURE_ALPHA_BLEND{0x080};
+        static constexpr uint32_t FEATURE_SHADOWS{0x100};
+        // Features of the unspecialized fragment shader
+        static constexpr uint32_t FEATURES_ALL{0xffffffff};
+
+        // Stable slots allocator for the models, materials & textures arrays
+        struct Slots {
+            int32_t         next{0};
+            vector<int32_t> free{};
+
+            // Returns a free slot or -1 if all the `max` slots are used
+            inline int32_t allocate(const uint32_t max) {
+                if (!free.empty()) {
+                    const auto slot = free.back();
+                    free.pop_back();
+                    return slot;
+                }
+                return next < static_cast<int32_t>(max) ? next++ : -1;
+            }
+
+            inline void release(const int32_t slot) { free.push_back(slot); }
+        };
 
         struct FrameData {
             // Indices of each model data in the models uniform buffer
@@ -203,19 +250,36 @@ namespace z0 {
             map<Resource::id_t, list<shared_ptr<MeshInstance>>> opaquesModels{};
             // All transparent models
             map<Resource::id_t, list<shared_ptr<MeshInstance>>> transparentModels{};
-            // Currently allocated model uniform buffer count
+            // Currently allocated model buffer slots count
             uint32_t modelBufferCount{0};
             bool drawOutlines{false};
-            unique_ptr<ModelBuffer[]> modelUBOArray;
+            // Slot of each model in the models buffer, stable for the lifetime of the model in the scene
+            unordered_map<const MeshInstance*, int32_t> modelsIndices{};
+            // Models slots allocator
+            Slots modelsSlots;
+            // Transform version of each model slot at the last upload in this frame-in-flight models buffer
+            vector<uint32_t> modelsVersions;
+            // Models modified since the last upload
+            vector<pair<int32_t, const MeshInstance*>> dirtyModels;
+            // Transforms of the modified models, in slots order, written in the models buffer by contiguous runs
+            vector<ModelBuffer> dirtyModelsData;
+            // Models slots of the visible instances, grouped by mesh, indexed by PushConstants::modelIndex + instance index
+            vector<uint32_t> instances;
+            // Visible instances in GPU memory
+            unique_ptr<Buffer> instancesBuffer;
+            // Currently allocated visible instances buffer count
+            uint32_t instancesBufferCount{0};
 
             // All materials used in the scene, used to update the buffer in GPU memory
             list<shared_ptr<Material>> materials;
-            // Rebuild the entier material buffer ?
-            bool materialsDirty{false};
             // Material reference counter
             map<Resource::id_t, uint32_t> materialsRefCounter;
-            // Indices of each material & texture in the buffers
+            // Slots of each material & texture in the buffers
             map<Resource::id_t, int32_t> materialsIndices{};
+            // Fragment shader features of each standard material
+            map<Resource::id_t, uint32_t> materialsFeatures{};
+            // Materials slots allocator
+            Slots materialsSlots;
             // Data for all the materials of the scene, one buffer for all the materials
             unique_ptr<Buffer> materialsBuffer;
             // Data for all the materials textures of the scene, one buffer for all the textures
@@ -234,12 +298,12 @@ namespace z0 {
             map<string, unique_ptr<Shader>> materialShaders;
             // All the images used in the scene
             list<shared_ptr<VulkanImage>> images;
-            // Indices of each images in the descriptor binding
+            // Slots of each images in the bindless textures array
             map<Resource::id_t, int32_t> imagesIndices{};
+            // Images slots allocator
+            Slots imagesSlots;
             // Images reference counter
             map<Resource::id_t, uint32_t> imagesRefCounter;
-            // Images infos for descriptor sets, pre-filled with blank images
-            array<VkDescriptorImageInfo, MAX_IMAGES> imagesInfo;
             // For rendering an optional skybox
             unique_ptr<SkyboxRenderer> skyboxRenderer{nullptr};
             // Environment parameters for the current scene
@@ -247,16 +311,19 @@ namespace z0 {
 
             // All lights
             vector<shared_ptr<Light>> lights;
-            // Lights & shadow maps UBO
+            // Lights & shadow maps SSBO
             unique_ptr<Buffer> lightBuffer;
-            // Currently allocated point light uniform buffer count
+            // Currently allocated lights count in the lights SSBO
             uint32_t lightBufferCount{0};
+            // Lights lists of the clusters, written by the light culling compute shader or by the CPU
+            unique_ptr<Buffer> clustersBuffer;
 
             // Offscreen frame buffers attachments
             unique_ptr<ColorFrameBuffer> colorFrameBufferMultisampled;
 
-            // Global UBO in GPU memory
-            unique_ptr<Buffer> globalBuffer;
+            // Offset of the global UBO in the device frame ring buffer.
+            // Not a dynamic offset : the set layout, with the update-after-bind textures array, can't have dynamic buffers
+            uint32_t globalBufferOffset{0};
 
             // Current camera frustum
             Frustum cameraFrustum;
@@ -271,8 +338,26 @@ namespace z0 {
         bool enableNormalPrepass;
         // Enable the diffuse color pre-pass
         bool enableDiffusePrepass;
+        // Bin the lights into the clusters on the GPU
+        bool gpuLightsCulling;
+        // Screen size under which the first simplified level of detail of the meshes is used
+        float meshLODScreenSize;
+        // Relative margin around the levels of detail screen sizes
+        float meshLODHysteresis;
+        // Clusters of the current camera frustum
+        LightClusters lightClusters;
+        // CPU side clusters lights lists, when not using the GPU lights culling
+        unique_ptr<LightClusters::Grid> clustersGrid;
+        // Compute shader for the lights culling
+        unique_ptr<Shader> lightClustersShader;
+        // Builds the depth pyramid after the depth pre-pass, when using the occlusion culling
+        unique_ptr<DepthPyramidRenderer> depthPyramidRenderer;
+        // Occlusion test against the depth pyramid of the previous frames
+        OcclusionCulling occlusionCulling;
         // One renderer per shadow map
         map<shared_ptr<Light>, shared_ptr<ShadowMapRenderer>> shadowMapRenderers;
+        // Deforms the skinned models before all the passes
+        shared_ptr<SkinningRenderer> skinningRenderer;
         // Default blank image (for textures & optional frame buffers)
         shared_ptr<VulkanImage> blankImage{nullptr};
         // Default blank image (for shadow mapping)
@@ -289,6 +374,8 @@ namespace z0 {
         unique_ptr<Shader> diffusePrepassVertShader;
         // Fragment shader for the diffuse pre-pass
         unique_ptr<Shader> diffusePrepassFragShader;
+        // Scene fragment shader specialized for each set of material features in use
+        map<uint32_t, unique_ptr<Shader>> fragShaderPermutations;
         // destination frame buffer
         vector<shared_ptr<ColorFrameBufferHDR>> colorFrameBufferHdr;
         // resolved depth buffer destination frame buffer
@@ -320,6 +407,8 @@ namespace z0 {
 
         void beginRendering( uint32_t currentFrame);
 
+        void cullLights(uint32_t currentFrame);
+
         void endRendering(uint32_t currentFrame, bool isLast);
 
         void addMaterial(const shared_ptr<Material> &material, uint32_t currentFrame);
@@ -330,6 +419,26 @@ namespace z0 {
 
         void removeImage(const shared_ptr<Image> &image, uint32_t currentFrame);
 
+        void writeImageSlot(uint32_t currentFrame, int32_t slot, const VkDescriptorImageInfo& imageInfo);
+
+        void uploadModels(uint32_t currentFrame);
+
+        // Returns the features of the scene fragment shader used by a standard material
+        [[nodiscard]] static uint32_t getMaterialFeatures(const StandardMaterial& material);
+
+        // Returns the fragment shader permutation of a surface material, FEATURES_ALL if the material is not a standard material
+        [[nodiscard]] uint32_t getFragShaderPermutation(const FrameData& frame, const Material& material) const;
+
+        // Selects the level of detail of a model from the projected size of its bounding sphere
+        [[nodiscard]] uint32_t selectLOD(const MeshInstance& meshInstance, const vec3& cameraPosition, float projectionScale) const;
+
+        // Binds the vertices of a mesh, or the skinned vertices of all the instances for a skinned mesh
+        void bindMesh(VkCommandBuffer commandBuffer, uint32_t currentFrame, const MeshInstance& meshInstance) const;
+
+        // Draws a surface for all the instances of a mesh, with one instanced draw for each run of consecutive instances sharing the same level of detail.
+        // The instances of a skinned mesh are drawn one by one, each one with its own skinned vertices.
+        void drawSurface(VkCommandBuffer commandBuffer, uint32_t currentFrame, const Surface& surface, const list<shared_ptr<MeshInstance>> &instances) const;
+
         void drawModels(uint32_t currentFrame, const map<Resource::id_t, list<shared_ptr<MeshInstance>>> &modelsToDraw, bool withShaderMaterials);
 
         void drawOutlines(uint32_t currentFrame, const map<Resource::id_t, list<shared_ptr<MeshInstance>>> &modelsToDraw);
@@ -12,6 +12,7 @@ module;
 
 module z0.vulkan.ShadowMapRenderer;
 
+import z0.Application;
 import z0.Constants;
 import z0.FrustumCulling;
 import z0.Tools;
@@ -33,14 +34,19 @@ import z0.vulkan.Device;
 import z0.vulkan.Renderer;
 import z0.vulkan.Renderpass;
 import z0.vulkan.ShadowMapFrameBuffer;
+import z0.vulkan.SkinningRenderer;
 import z0.vulkan.Mesh;
 
 namespace z0 {
 
-    ShadowMapRenderer::ShadowMapRenderer(Device &device, const shared_ptr<Light>&light) :
+    ShadowMapRenderer::ShadowMapRenderer(Device &device,
+                                         const shared_ptr<Light>&light,
+                                         const shared_ptr<SkinningRenderer>& skinningRenderer) :
         Renderpass{device, WINDOW_CLEAR_COLOR},
         Renderer{true},
-        light{light} {
+        light{light},
+        skinningRenderer{skinningRenderer},
+        shadowLODBias{app().getConfig().shadowLODBias} {
         frameData.resize(device.getFramesInFlight());
         for (auto& frame : frameData) {
             frame.shadowMap = make_shared<ShadowMapFrameBuffer>(device, isCascaded(), isCubemap());
@@ -71,6 +77,8 @@ namespace z0 {
         ranges::for_each(frameData, [&meshes](FrameData& frame) {
             frame.models = meshes;
             frame.models.sort([](const shared_ptr<MeshInstance>&a, const shared_ptr<MeshInstance>&b) { return *a < *b; });
+            // New casters list : the cached shadow maps must be rendered again
+            frame.rendered = false;
         });
         createOrUpdateResources(true, &pushConstantRange, 1);
     }
@@ -78,7 +86,6 @@ namespace z0 {
     void ShadowMapRenderer::cleanup() {
         cleanupImagesResources();
         for (auto& frame : frameData) {
-            frame.globalBuffer.reset();
             frame.shadowMap.reset();
         }
         Renderpass::cleanup();
@@ -300,7 +307,46 @@ namespace z0 {
         for(auto i = 0; i < 6; i++) {
             globalUBO.lightSpace[i] = data.lightSpace[i];
         }
-        writeUniformBuffer(data.globalBuffer, &globalUBO);
+        data.globalBufferOffset = writeFrameData(currentFrame, &globalUBO, sizeof(GlobalBuffer));
+        // update() and drawFrame() share the same early return conditions : the shadow map is rendered if not up-to-date.
+        // The cascades follow the camera and are rendered every frame.
+        if (isCascaded()) {
+            data.upToDate = false;
+            return;
+        }
+        const auto changed = updateRenderedState(data);
+        data.upToDate = data.rendered && !changed;
+        data.rendered = true;
+    }
+
+    bool ShadowMapRenderer::updateRenderedState(FrameData& data) const {
+        auto changed = false;
+        const auto passCount = isCubemap() ? 6 : data.cascadesCount;
+        for (auto passIndex = 0; passIndex < passCount; passIndex++) {
+            if (data.lightSpace[passIndex] != data.renderedLightSpace[passIndex]) {
+                data.renderedLightSpace[passIndex] = data.lightSpace[passIndex];
+                changed = true;
+            }
+        }
+        auto casterIndex = 0;
+        for (const auto &meshInstance : data.models) {
+            if (!meshInstance->isVisible() || !meshInstance->isCastShadows()) { continue; }
+            const auto caster = tuple<const MeshInstance*, uint32_t, uint32_t>{
+                meshInstance.get(), meshInstance->_getTransformVersion(), meshInstance->_getLOD()};
+            if (casterIndex == data.renderedCasters.size()) {
+                data.renderedCasters.push_back(caster);
+                changed = true;
+            } else if (data.renderedCasters[casterIndex] != caster) {
+                data.renderedCasters[casterIndex] = caster;
+                changed = true;
+            }
+            casterIndex += 1;
+        }
+        if (casterIndex != data.renderedCasters.size()) {
+            data.renderedCasters.resize(casterIndex);
+            changed = true;
+        }
+        return changed;
     }
 
     vector<VkCommandBuffer> ShadowMapRenderer::getCommandBuffers(const uint32_t currentFrame) const {
@@ -317,6 +363,8 @@ namespace z0 {
     void ShadowMapRenderer::drawFrame(const uint32_t currentFrame, const bool isLast) {
         const auto& data = frameData[currentFrame];
         if (!light->isVisible() || !data.currentCamera || data.models.empty()) { return; }
+        // Nothing moved : the shadow map rendered for this frame the last time is still valid
+        if (data.upToDate) { return; }
 
         auto render = [this, &data, currentFrame](const int passIndex) {
             vector<shared_ptr<MeshInstance>> meshes;
@@ -376,7 +424,7 @@ namespace z0 {
                 vkCmdSetDepthBias(commandBuffer, depthBiasConstant, 0.0f, depthBiasSlope);
                 vkCmdSetCullMode(commandBuffer, VK_CULL_MODE_NONE);
 
-                bindDescriptorSets(commandBuffer, currentFrame);
+                bindDescriptorSets(commandBuffer, currentFrame, 1, &data.globalBufferOffset);
 
                 pushConstants.lightSpaceIndex = passIndex;
                 auto modelIndex = 0;
@@ -384,6 +432,11 @@ namespace z0 {
                 for (const auto &meshInstance : meshes) {
                     const auto& mesh = reinterpret_pointer_cast<VulkanMesh>(meshInstance->getMesh());
                     pushConstants.model = meshInstance->getTransformGlobal();
+                    // Surface::getLOD() clamps the biased level to the coarsest level of each surface
+                    const auto lod = meshInstance->_getLOD() + shadowLODBias;
+                    // The skinned vertices of all the instances share the same buffer
+                    const auto skinned = meshInstance->isSkinned();
+                    const auto vertexOffset = skinned ? skinningRenderer->getVertexOffset(*meshInstance, currentFrame) : 0;
                     for (const auto &surface : mesh->getSurfaces()) {
                         pushConstants.transparency = static_cast<uint32_t>(surface->material->getTransparency());
                         vkCmdPushConstants(
@@ -394,13 +447,18 @@ namespace z0 {
                             PUSHCONSTANTS_SIZE,
                             &pushConstants);
                         if (lastMeshId != mesh->getId()) {
-                            mesh->bind(commandBuffer);
+                            if (skinned) {
+                                mesh->bind(commandBuffer, skinningRenderer->getVertexBuffer(currentFrame));
+                            } else {
+                                mesh->bind(commandBuffer);
+                            }
                         }
+                        const auto range = surface->getLOD(lod);
                         vkCmdDrawIndexed(commandBuffer,
-                           surface->indexCount,
+                           range.indexCount,
                            1,
-                           surface->firstVertexIndex,
-                           0,
+                           range.firstIndex,
+                           vertexOffset,
                            0);
                         lastMeshId = mesh->getId();
                     }
@@ -463,10 +521,12 @@ namespace z0 {
     }
 
     void ShadowMapRenderer::cleanupImagesResources() {
-        ranges::for_each(frameData, [](const FrameData & frame) {
+        ranges::for_each(frameData, [](FrameData & frame) {
             if (frame.shadowMap != nullptr) {
                 frame.shadowMap->cleanupImagesResources();
             }
+            frame.rendered = false;
+            frame.upToDate = false;
         });
     }
 
@@ -475,24 +535,20 @@ namespace z0 {
                 DescriptorPool::Builder(device)
                         .setMaxSets(device.getFramesInFlight())
                         // global UBO
-                        .addPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, device.getFramesInFlight())
+                        .addPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, device.getFramesInFlight())
                         .build();
 
         setLayout = DescriptorSetLayout::Builder(device)
                             .addBinding(0,
                                         // global UBO
-                                        VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+                                        VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
                                         VK_SHADER_STAGE_ALL_GRAPHICS)
                             .build();
-
-        for (auto i = 0; i < device.getFramesInFlight(); i++) {
-            frameData.at(i).globalBuffer = createUniformBuffer(sizeof(GlobalBuffer));
-        }
     }
 
     void ShadowMapRenderer::createOrUpdateDescriptorSet(const bool create) {
         for (auto frameIndex = 0; frameIndex < device.getFramesInFlight(); frameIndex++) {
-            auto globalBufferInfo  = frameData.at(frameIndex).globalBuffer->descriptorInfo(sizeof(GlobalBuffer));
+            auto globalBufferInfo  = frameDataInfo(sizeof(GlobalBuffer));
             auto writer            = DescriptorWriter(*setLayout, *descriptorPool)
                 .writeBuffer(0, &globalBufferInfo);
             if (!writer.build(descriptorSet.at(frameIndex), create)) {
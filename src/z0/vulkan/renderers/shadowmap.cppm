@@ -29,15 +29,19 @@ import z0.vulkan.Device;
 import z0.vulkan.Renderer;
 import z0.vulkan.Renderpass;
 import z0.vulkan.ShadowMapFrameBuffer;
+import z0.vulkan.SkinningRenderer;
 
 export namespace z0 {
 
     /*
-     * Shadow map renderer, one per light
+     * Shadow map renderer, one per light.
+     * The shadow maps of the spot & omni lights are not rendered again while neither the light nor any
+     * of the visible shadow casters moved. When one caster moves, all the casters are rendered again.
+     * The cascaded shadow maps of the directional lights follow the camera and are rendered every frame.
      */
     class ShadowMapRenderer : public Renderpass, public Renderer {
     public:
-        ShadowMapRenderer(Device &device, const shared_ptr<Light>&light);
+        ShadowMapRenderer(Device &device, const shared_ptr<Light>&light, const shared_ptr<SkinningRenderer>& skinningRenderer);
 
         void loadScene(const list<shared_ptr<MeshInstance>> &meshes);
 
@@ -119,18 +123,34 @@ export namespace z0 {
             mat4 previousProjection{1.0f};
             // For cascaded shadow map, the last computed cascade split depth for each cascade
             float splitDepth[ShadowMapFrameBuffer::CASCADED_SHADOWMAP_MAX_LAYERS];
-            // Global UBO in GPU memory
-            unique_ptr<Buffer> globalBuffer;
+            // Offset of the global UBO in the device frame ring buffer
+            uint32_t globalBufferOffset{0};
+            // Light spaces used for the last rendering of the shadow map
+            mat4 renderedLightSpace[6];
+            // Shadow casters of the last rendering of the shadow map, with their transform version and level of detail
+            vector<tuple<const MeshInstance*, uint32_t, uint32_t>> renderedCasters;
+            // The shadow map have been rendered at least once since the creation of the image
+            bool rendered{false};
+            // The shadow map content is still valid and does not need to be rendered this frame
+            bool upToDate{false};
         };
         vector<FrameData> frameData;
 
         // The light we render the shadow map for
         const shared_ptr<Light> light;
+        // Skinned vertices of the skinned shadow casters
+        const shared_ptr<SkinningRenderer> skinningRenderer;
+        // Number of levels of detail added to the level selected for the camera
+        const uint32_t shadowLODBias;
 
         void update(uint32_t currentFrame) override;
 
         void drawFrame(uint32_t currentFrame, bool isLast) override;
 
+        // Returns true if the light or one of the shadow casters changed since the last rendering of the shadow map.
+        // Only used for the spot & omni lights.
+        bool updateRenderedState(FrameData& data) const;
+
         void loadShaders() override;
 
         void cleanupImagesResources() override;
@@ -0,0 +1,238 @@
+/*
+ * Copyright (c) 2024-2025 Henri Michelon
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+*/
+module;
+#include "z0/vulkan.h"
+#include "z0/libraries.h"
+
+module z0.vulkan.SkinningRenderer;
+
+import z0.Constants;
+import z0.Log;
+import z0.Tools;
+
+import z0.nodes.MeshInstance;
+
+import z0.resources.Mesh;
+import z0.resources.Resource;
+
+import z0.vulkan.Buffer;
+import z0.vulkan.Descriptors;
+import z0.vulkan.Device;
+
+namespace z0 {
+
+    // skinning.comp reads & writes the vertices as arrays of 16 floats
+    static_assert(sizeof(Vertex) == 16 * sizeof(float));
+
+    SkinningRenderer::SkinningRenderer(Device &device) :
+        Renderpass{device, VkClearValue{}},
+        Renderer{false} {
+        frameData.resize(device.getFramesInFlight());
+        for (auto& frame : frameData) {
+            createBuffers(frame, INITIAL_PALETTES_COUNT, INITIAL_VERTICES_COUNT, INITIAL_VERTICES_COUNT);
+        }
+        createOrUpdateResources(true, &pushConstantRange, 1);
+    }
+
+    void SkinningRenderer::addModel(const shared_ptr<MeshInstance>& meshInstance, const uint32_t currentFrame) {
+        auto& frame = frameData[currentFrame];
+        frame.models[meshInstance.get()] = Model{ .meshInstance = meshInstance };
+        frame.layoutDirty = true;
+    }
+
+    void SkinningRenderer::removeModel(const shared_ptr<MeshInstance>& meshInstance, const uint32_t currentFrame) {
+        auto& frame = frameData[currentFrame];
+        if (frame.models.erase(meshInstance.get()) > 0) {
+            frame.layoutDirty = true;
+        }
+    }
+
+    void SkinningRenderer::cleanup() {
+        for (auto& frame : frameData) {
+            frame.models.clear();
+            frame.palettesBuffer.reset();
+            frame.sourceBuffer.reset();
+            frame.skinBuffer.reset();
+            frame.verticesBuffer.reset();
+        }
+        skinningShader.reset();
+        Renderpass::cleanup();
+    }
+
+    void SkinningRenderer::update(const uint32_t currentFrame) {
+        auto& frame = frameData[currentFrame];
+        if (frame.layoutDirty) {
+            layout(frame, currentFrame);
+        }
+        // The GPU has finished with this frame : the skinning matrices of the modified poses can be written
+        frame.dispatches.clear();
+        for (auto& [meshInstance, model] : frame.models) {
+            if (model.version == meshInstance->_getPoseVersion()) { continue; }
+            model.version = meshInstance->_getPoseVersion();
+            const auto& palette = meshInstance->_getPalette();
+            frame.palettesBuffer->writeToBuffer(
+                palette.data(),
+                palette.size() * sizeof(mat4),
+                model.paletteOffset * sizeof(mat4));
+            frame.dispatches.push_back({
+                .sourceOffset = model.sourceOffset,
+                .vertexOffset = model.vertexOffset,
+                .paletteOffset = model.paletteOffset,
+                .vertexCount = static_cast<uint32_t>(meshInstance->getMesh()->getVertices().size()),
+            });
+        }
+    }
+
+    void SkinningRenderer::drawFrame(const uint32_t currentFrame, const bool isLast) {
+        const auto& frame = frameData[currentFrame];
+        if (frame.dispatches.empty()) { return; }
+        const auto commandBuffer = commandBuffers[currentFrame];
+        vkCmdBindShadersEXT(commandBuffer, 1, skinningShader->getStage(), skinningShader->getShader());
+        vkCmdBindDescriptorSets(commandBuffer,
+                                VK_PIPELINE_BIND_POINT_COMPUTE,
+                                pipelineLayout,
+                                0,
+                                1,
+                                &descriptorSet[currentFrame],
+                                0,
+                                nullptr);
+        // The instances write to distinct ranges of the skinned vertices : no barrier between the dispatches
+        for (const auto& pushConstants : frame.dispatches) {
+            vkCmdPushConstants(commandBuffer,
+                               pipelineLayout,
+                               VK_SHADER_STAGE_COMPUTE_BIT,
+                               0,
+                               PUSHCONSTANTS_SIZE,
+                               &pushConstants);
+            vkCmdDispatch(commandBuffer, (pushConstants.vertexCount + WORK_GROUP_SIZE - 1) / WORK_GROUP_SIZE, 1, 1);
+        }
+        // The skinned vertices are read by all the next renderers of the frame
+        const VkMemoryBarrier barrier{
+            .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+            .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT,
+        };
+        vkCmdPipelineBarrier(commandBuffer,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                             0,
+                             1, &barrier,
+                             0, nullptr,
+                             0, nullptr);
+    }
+
+    void SkinningRenderer::layout(FrameData& frame, const uint32_t currentFrame) {
+        frame.layoutDirty = false;
+        // The meshes shared by multiple instances are uploaded once
+        auto meshesOffsets = map<Resource::id_t, uint32_t>{};
+        auto meshes = list<const Mesh*>{};
+        auto palettesCount = uint32_t{0};
+        auto sourceCount = uint32_t{0};
+        auto verticesCount = uint32_t{0};
+        for (auto& [meshInstance, model] : frame.models) {
+            const auto& mesh = meshInstance->getMesh();
+            const auto vertexCount = static_cast<uint32_t>(mesh->getVertices().size());
+            if (!meshesOffsets.contains(mesh->getId())) {
+                meshesOffsets[mesh->getId()] = sourceCount;
+                meshes.push_back(mesh.get());
+                sourceCount += vertexCount;
+            }
+            model.sourceOffset = meshesOffsets[mesh->getId()];
+            model.vertexOffset = verticesCount;
+            model.paletteOffset = palettesCount;
+            model.version = NO_POSE_VERSION;
+            verticesCount += vertexCount;
+            palettesCount += mesh->getSkeleton()->getJointsCount();
+        }
+        createBuffers(frame, palettesCount, sourceCount, verticesCount);
+        for (const auto* mesh : meshes) {
+            const auto offset = meshesOffsets[mesh->getId()];
+            frame.sourceBuffer->writeToBuffer(
+                mesh->getVertices().data(),
+                mesh->getVertices().size() * sizeof(Vertex),
+                offset * sizeof(Vertex));
+            frame.skinBuffer->writeToBuffer(
+                mesh->getSkinVertices().data(),
+                mesh->getSkinVertices().size() * sizeof(SkinVertex),
+                offset * sizeof(SkinVertex));
+        }
+        // The buffers can have been re-created
+        writeDescriptorSet(frame, currentFrame, false);
+        DEBUG("SkinningRenderer::layout ", frame.models.size(), " instances, ", verticesCount, " vertices");
+    }
+
+    void SkinningRenderer::createBuffers(FrameData& frame,
+                                         const uint32_t palettesCount,
+                                         const uint32_t sourceCount,
+                                         const uint32_t verticesCount) const {
+        // The buffers only grow, doubling their size to avoid re-creating them when instances are added one by one
+        const auto grow = [](const uint32_t capacity, const uint32_t count) {
+            auto newCapacity = std::max(capacity, 1u);
+            while (newCapacity < count) { newCapacity *= 2; }
+            return newCapacity;
+        };
+        if (palettesCount > frame.palettesCapacity) {
+            frame.palettesCapacity = grow(frame.palettesCapacity, palettesCount);
+            frame.palettesBuffer = createStorageBuffer(sizeof(mat4) * frame.palettesCapacity);
+        }
+        if (sourceCount > frame.sourceCapacity) {
+            frame.sourceCapacity = grow(frame.sourceCapacity, sourceCount);
+            frame.sourceBuffer = createStorageBuffer(sizeof(Vertex) * frame.sourceCapacity);
+            frame.skinBuffer = createStorageBuffer(sizeof(SkinVertex) * frame.sourceCapacity);
+        }
+        if (verticesCount > frame.verticesCapacity) {
+            frame.verticesCapacity = grow(frame.verticesCapacity, verticesCount);
+            frame.verticesBuffer = make_unique<Buffer>(
+                sizeof(Vertex),
+                frame.verticesCapacity,
+                VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+        }
+    }
+
+    void SkinningRenderer::loadShaders() {
+        skinningShader = createShader("skinning.comp", VK_SHADER_STAGE_COMPUTE_BIT, 0);
+    }
+
+    void SkinningRenderer::createDescriptorSetLayout() {
+        descriptorPool = DescriptorPool::Builder(device)
+                .setMaxSets(device.getFramesInFlight())
+                .addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 4 * device.getFramesInFlight())
+                .build();
+        setLayout = DescriptorSetLayout::Builder(device)
+                // skinning matrices
+                .addBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+                // source vertices
+                .addBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+                // skinning attributes
+                .addBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+                // skinned vertices
+                .addBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+                .build();
+    }
+
+    void SkinningRenderer::createOrUpdateDescriptorSet(const bool create) {
+        for (auto frameIndex = 0; frameIndex < device.getFramesInFlight(); frameIndex++) {
+            writeDescriptorSet(frameData[frameIndex], frameIndex, create);
+        }
+    }
+
+    void SkinningRenderer::writeDescriptorSet(const FrameData& frame, const uint32_t currentFrame, const bool create) {
+        const auto palettesInfo = frame.palettesBuffer->descriptorInfo();
+        const auto sourceInfo = frame.sourceBuffer->descriptorInfo();
+        const auto skinInfo = frame.skinBuffer->descriptorInfo();
+        const auto verticesInfo = frame.verticesBuffer->descriptorInfo();
+        auto writer = DescriptorWriter(*setLayout, *descriptorPool)
+            .writeBuffer(0, &palettesInfo)
+            .writeBuffer(1, &sourceInfo)
+            .writeBuffer(2, &skinInfo)
+            .writeBuffer(3, &verticesInfo);
+        if (!writer.build(descriptorSet.at(currentFrame), create)) {
+            die("Cannot allocate descriptor set for skinning renderer");
+        }
+    }
+
+}
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2024-2025 Henri Michelon
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+*/
+module;
+#include "z0/vulkan.h"
+#include "z0/libraries.h"
+
+export module z0.vulkan.SkinningRenderer;
+
+import z0.nodes.MeshInstance;
+
+import z0.vulkan.Buffer;
+import z0.vulkan.Descriptors;
+import z0.vulkan.Device;
+import z0.vulkan.Renderer;
+import z0.vulkan.Renderpass;
+import z0.vulkan.Shader;
+
+export namespace z0 {
+
+    /*
+     * Compute pre-pass deforming the vertices of the skinned mesh instances with the skinning matrices of their pose.
+     * The skinned vertices of all the instances are stored in one vertex buffer per frame in flight, used
+     * instead of the mesh vertex buffer by the scene, depth pre-pass, outlines and shadow map renderers.
+     * Only the instances with a modified pose are deformed again.
+     */
+    class SkinningRenderer : public Renderpass, public Renderer {
+    public:
+        explicit SkinningRenderer(Device &device);
+
+        void addModel(const shared_ptr<MeshInstance>& meshInstance, uint32_t currentFrame);
+
+        void removeModel(const shared_ptr<MeshInstance>& meshInstance, uint32_t currentFrame);
+
+        // Returns the skinned vertices of all the instances for a frame in flight
+        [[nodiscard]] inline VkBuffer getVertexBuffer(const uint32_t currentFrame) const {
+            return frameData[currentFrame].verticesBuffer->getBuffer();
+        }
+
+        // Returns the offset of the first skinned vertex of an instance, to use as the vertexOffset of the draw commands
+        [[nodiscard]] inline int32_t getVertexOffset(const MeshInstance& meshInstance, const uint32_t currentFrame) const {
+            return static_cast<int32_t>(frameData[currentFrame].models.at(&meshInstance).vertexOffset);
+        }
+
+        void cleanup() override;
+
+        void update(uint32_t currentFrame) override;
+
+        void drawFrame(uint32_t currentFrame, bool isLast) override;
+
+    private:
+        // Work group size of skinning.comp
+        static constexpr uint32_t WORK_GROUP_SIZE{64};
+        // Initial number of vertices & skinning matrices of the buffers, grown on demand
+        static constexpr uint32_t INITIAL_VERTICES_COUNT{4096};
+        static constexpr uint32_t INITIAL_PALETTES_COUNT{256};
+        // Forces the deformation of an instance
+        static constexpr auto     NO_POSE_VERSION{numeric_limits<uint32_t>::max()};
+
+        struct PushConstants {
+            uint32_t sourceOffset;
+            uint32_t vertexOffset;
+            uint32_t paletteOffset;
+            uint32_t vertexCount;
+        };
+        static constexpr auto PUSHCONSTANTS_SIZE{sizeof(PushConstants)};
+        static constexpr VkPushConstantRange pushConstantRange {
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+            .offset = 0,
+            .size = PUSHCONSTANTS_SIZE
+        };
+
+        struct Model {
+            shared_ptr<MeshInstance> meshInstance;
+            // Index of the first vertex of the mesh in the source vertices
+            uint32_t                 sourceOffset{0};
+            // Index of the first vertex of the instance in the skinned vertices
+            uint32_t                 vertexOffset{0};
+            // Index of the first skinning matrix of the instance in the palettes
+            uint32_t                 paletteOffset{0};
+            // Pose version of the last deformation
+            uint32_t                 version{NO_POSE_VERSION};
+        };
+
+        struct FrameData {
+            map<const MeshInstance*, Model> models;
+            // The instances have been added or removed since the last layout of the buffers
+            bool                            layoutDirty{false};
+            // Skinning matrices of all the instances
+            unique_ptr<Buffer>              palettesBuffer;
+            uint32_t                        palettesCapacity{0};
+            // Bind pose vertices & skinning attributes, one copy per mesh
+            unique_ptr<Buffer>              sourceBuffer;
+            unique_ptr<Buffer>              skinBuffer;
+            uint32_t                        sourceCapacity{0};
+            // Skinned vertices, one copy per instance
+            unique_ptr<Buffer>              verticesBuffer;
+            uint32_t                        verticesCapacity{0};
+            // Instances to deform this frame
+            vector<PushConstants>           dispatches;
+        };
+        vector<FrameData>  frameData;
+        unique_ptr<Shader> skinningShader;
+
+        // Computes the offsets of the instances & meshes and uploads the meshes vertices
+        void layout(FrameData& frame, uint32_t currentFrame);
+
+        void createBuffers(FrameData& frame, uint32_t palettesCount, uint32_t sourceCount, uint32_t verticesCount) const;
+
+        void writeDescriptorSet(const FrameData& frame, uint32_t currentFrame, bool create);
+
+        void loadShaders() override;
+
+        void createDescriptorSetLayout() override;
+
+        void createOrUpdateDescriptorSet(bool create) override;
+    };
+
+}
@@ -26,7 +26,7 @@ namespace z0 {
 
     SkyboxRenderer::SkyboxRenderer(Device &device, const VkClearValue clearColor):
         Renderpass{device, clearColor} {
-        globalBuffer.resize(device.getFramesInFlight());
+        globalBufferOffset.resize(device.getFramesInFlight());
         static constexpr float skyboxVertices[] = {
                 // positions
             -1.0f, 1.0f, -1.0f,
@@ -98,7 +98,6 @@ namespace z0 {
     }
 
     void SkyboxRenderer::cleanup() {
-        globalBuffer.clear();
         vertexBuffer.reset();
         cubemap.reset();
         Renderpass::cleanup();
@@ -114,7 +113,7 @@ namespace z0 {
         if (currentEnvironment != nullptr) {
             globalUbo.ambient = currentEnvironment->getAmbientColorAndIntensity();
         }
-        writeUniformBuffer(globalBuffer.at(currentFrame), &globalUbo);
+        globalBufferOffset.at(currentFrame) = writeFrameData(currentFrame, &globalUbo, sizeof(GobalUniformBuffer));
     }
 
     void SkyboxRenderer::loadShaders() {
@@ -125,17 +124,13 @@ namespace z0 {
     void SkyboxRenderer::createDescriptorSetLayout() {
         descriptorPool = DescriptorPool::Builder(device)
                          .setMaxSets(device.getFramesInFlight())
-                         .addPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, device.getFramesInFlight())
+                         .addPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, device.getFramesInFlight())
                          .addPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, device.getFramesInFlight())
                          .build();
 
-        for (auto i = 0; i < device.getFramesInFlight(); i++) {
-            globalBuffer.at(i) = createUniformBuffer(sizeof(GobalUniformBuffer));
-        }
-
         setLayout = DescriptorSetLayout::Builder(device)
                     .addBinding(0,
-                                VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+                                VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
                                 VK_SHADER_STAGE_VERTEX_BIT)
                     .addBinding(1,
                                 VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
@@ -154,7 +149,7 @@ namespace z0 {
                 cm = cubemap;
             }
             for (auto i = 0; i < device.getFramesInFlight(); i++) {
-                auto globalBufferInfo = globalBuffer.at(i)->descriptorInfo(sizeof(GobalUniformBuffer));
+                auto globalBufferInfo = frameDataInfo(sizeof(GobalUniformBuffer));
                 auto imageInfo        = cm->getImageInfo();
                 auto writer           = DescriptorWriter(*setLayout, *descriptorPool)
                     .writeBuffer(0, &globalBufferInfo)
@@ -191,7 +186,7 @@ namespace z0 {
                                &attributeDescription);
         vkCmdSetCullMode(commandBuffer, VK_CULL_MODE_BACK_BIT);
         vkCmdSetDepthCompareOp(commandBuffer, VK_COMPARE_OP_LESS_OR_EQUAL);
-        bindDescriptorSets(commandBuffer, currentFrame);
+        bindDescriptorSets(commandBuffer, currentFrame, 1, &globalBufferOffset.at(currentFrame));
         const VkBuffer         buffers[] = {vertexBuffer->getBuffer()};
         constexpr VkDeviceSize offsets[] = {0};
         vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers, offsets);
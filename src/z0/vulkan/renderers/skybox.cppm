@@ -52,7 +52,8 @@ export namespace z0 {
             vec4 ambient{1.0f, 1.0f, 1.0f, 1.0f}; // RGB + Intensity;
         };
 
-        vector<unique_ptr<Buffer>>  globalBuffer;
+        // Offsets of the global uniform buffer in the device frame ring buffer
+        vector<uint32_t>            globalBufferOffset;
         uint32_t                    vertexCount;
         unique_ptr<Buffer>          vertexBuffer;
         shared_ptr<VulkanCubemap>   cubemap;
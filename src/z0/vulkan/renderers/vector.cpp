@@ -5,6 +5,7 @@
  * https://opensource.org/licenses/MIT
 */
 module;
+#include <cassert>
 #include "z0/libraries.h"
 #include "z0/vulkan.h"
 
@@ -24,9 +25,11 @@ import z0.vulkan.Buffer;
 import z0.vulkan.Descriptors;
 import z0.vulkan.Device;
 import z0.vulkan.ColorFrameBufferHDR;
+import z0.vulkan.GlyphAtlas;
 import z0.vulkan.Renderer;
 import z0.vulkan.Renderpass;
 import z0.vulkan.Image;
+import z0.vulkan.VertexRingBuffer;
 
 namespace z0 {
 
@@ -57,9 +60,9 @@ namespace z0 {
         const auto scaled_start = (start + translate) / Application::get().getVectorExtent();
         const auto scaled_end   = (end + translate) / Application::get().getVectorExtent();
         const auto color = vec4{vec3{penColor}, glm::max(0.0f, penColor.a - transparency)};
-        vertices.emplace_back(scaled_start);
-        vertices.emplace_back(scaled_end);
-        commands.emplace_back(PRIMITIVE_LINE, 2, color);
+        currentLayer->vertices.emplace_back(scaled_start);
+        currentLayer->vertices.emplace_back(scaled_end);
+        currentLayer->commands.emplace_back(PRIMITIVE_LINE, 2, color);
     }
 
     void VectorRenderer::drawFilledRect(const Rect &rect, const float clip_w, const float clip_h) {
@@ -98,6 +101,7 @@ namespace z0 {
         const Vertex v1{vec2{pos.x, pos.y + size.y}, vec2{0.0f, 0.0f}};
         const Vertex v2{vec2{pos.x + size.x, pos.y}, vec2{1.0f, 1.0f}};
         const Vertex v3{vec2{pos.x + size.x, pos.y + size.y}, vec2{1.0f, 0.0f}};
+        auto &vertices = currentLayer->vertices;
         // First triangle
         vertices.emplace_back(v0);
         vertices.emplace_back(v1);
@@ -108,10 +112,7 @@ namespace z0 {
         vertices.emplace_back(v2);
 
         const auto color = vec4{vec3{penColor}, std::max(0.0f, penColor.a - transparency)};
-        commands.emplace_back(PRIMITIVE_RECT, 6, color, texture, clip_w / w, clip_h / h);
-        if (texture != nullptr) {
-            addImage(texture);
-        }
+        currentLayer->commands.emplace_back(PRIMITIVE_RECT, 6, color, texture, clip_w / w, clip_h / h);
     }
 
     void VectorRenderer::drawText(const string &text, Font &font, const Rect &rect, const float clip_w,
@@ -124,63 +125,204 @@ namespace z0 {
                                   const float   w,
                                   const float   h, const float clip_w,
                                   const float   clip_h) {
-        drawFilledRect(x, y, w, h, clip_w, clip_h, font.renderToImage(text));
+        auto textWidth = 0.0f;
+        auto textHeight = 0.0f;
+        font.getSize(text, textWidth, textHeight);
+        if (textWidth <= 0.0f || textHeight <= 0.0f) { return; }
+        // The text is scaled from font pixels to the destination rectangle
+        const auto scale = vec2{w / textWidth, h / textHeight};
+        const auto clipRight = x + clip_w;
+        const auto clipTop = y + clip_h;
+        const auto extent = Application::get().getVectorExtent();
+        const auto codepoints = to_u32string(text);
+        auto &vertices = currentLayer->vertices;
+        const auto firstVertex = vertices.size();
+        auto pen = 0.0f;
+        for (auto i = 0; i < codepoints.size(); i++) {
+            const auto codepoint = codepoints[i];
+            const auto &glyph = font.getGlyph(codepoint);
+            const auto advance = glyph.advance;
+            if (const auto *region = glyphAtlas->getRegion(font, codepoint)) {
+                currentLayer->glyphShelves.insert(region->shelf);
+                const auto left = x + (pen + glyph.xOffset) * scale.x;
+                const auto top = y + h - glyph.yOffset * scale.y;
+                const auto right = left + region->width * scale.x;
+                const auto bottom = top - region->height * scale.y;
+                // Clip the quad on the CPU, the fragment shader clipping works for a single quad only
+                const auto visibleLeft = std::max(left, x);
+                const auto visibleRight = std::min(right, clipRight);
+                const auto visibleBottom = std::max(bottom, y);
+                const auto visibleTop = std::min(top, clipTop);
+                if (visibleLeft < visibleRight && visibleBottom < visibleTop) {
+                    // UVs in atlas pixels, normalized in endDraw() when the atlas size is known
+                    const auto u0 = region->x + (visibleLeft - left) / scale.x;
+                    const auto u1 = region->x + (visibleRight - left) / scale.x;
+                    const auto v0 = region->y + (top - visibleBottom) / scale.y;
+                    const auto v1 = region->y + (top - visibleTop) / scale.y;
+                    /*
+                     * v1 ---- v3
+                     * |  \     |
+                     * |    \   |
+                     * v0 ---- v2
+                     */
+                    const Vertex bl{(vec2{visibleLeft, visibleBottom} + translate) / extent, vec2{u0, v0}};
+                    const Vertex tl{(vec2{visibleLeft, visibleTop} + translate) / extent, vec2{u0, v1}};
+                    const Vertex br{(vec2{visibleRight, visibleBottom} + translate) / extent, vec2{u1, v0}};
+                    const Vertex tr{(vec2{visibleRight, visibleTop} + translate) / extent, vec2{u1, v1}};
+                    vertices.emplace_back(bl);
+                    vertices.emplace_back(tl);
+                    vertices.emplace_back(br);
+                    vertices.emplace_back(tl);
+                    vertices.emplace_back(tr);
+                    vertices.emplace_back(br);
+                }
+            }
+            pen += advance;
+            if (i + 1 < codepoints.size()) {
+                pen += font.getKerning(codepoint, codepoints[i + 1]);
+            }
+        }
+        const auto count = static_cast<uint32_t>(vertices.size() - firstVertex);
+        if (count == 0) { return; }
+        // Consecutive texts of the same color are drawn with a single command
+        const auto color = vec4{vec3{penColor}, std::max(0.0f, penColor.a - transparency)};
+        auto &commands = currentLayer->commands;
+        if (!commands.empty() && commands.back().primitive == PRIMITIVE_TEXT && commands.back().color == color) {
+            commands.back().count += count;
+        } else {
+            commands.emplace_back(PRIMITIVE_TEXT, count, color, nullptr, 1.0f, 1.0f);
+        }
     }
 
     void VectorRenderer::beginDraw() {
-        vertices.clear();
-        commands.clear();
+        glyphAtlas->beginSession();
+        // The glyphs of the retained layers must stay in the atlas until the layers are regenerated
+        for (const auto &layer : layers | views::values) {
+            for (const auto shelf : layer.glyphShelves) {
+                glyphAtlas->keep(shelf);
+            }
+        }
+        composedLayers.clear();
+        currentLayer = &layers[nullptr];
+        currentLayer->commands.clear();
+        currentLayer->vertices.clear();
+        currentLayer->glyphShelves.clear();
+        currentLayer->atlasSize = 0;
+        currentLayer->version += 1;
+        composedLayers.push_back(currentLayer);
+    }
+
+    void VectorRenderer::beginLayer(const void *owner) {
+        assert(owner != nullptr && "The immediate layer can't be regenerated with beginLayer()");
+        auto &layer = layers[owner];
+        layer.commands.clear();
+        layer.vertices.clear();
+        layer.glyphShelves.clear();
+        layer.atlasSize = 0;
+        layer.version += 1;
+        composedLayers.push_back(&layer);
+        currentLayer = &layer;
+    }
+
+    void VectorRenderer::endLayer() {
+        currentLayer = &layers[nullptr];
+    }
+
+    bool VectorRenderer::keepLayer(const void *owner) {
+        const auto it = layers.find(owner);
+        if (owner == nullptr || it == layers.end()) { return false; }
+        composedLayers.push_back(&it->second);
+        return true;
+    }
+
+    void VectorRenderer::removeLayer(const void *owner) {
+        // The frames in flight keep the vertex buffers alive
+        if (const auto it = layers.find(owner); owner != nullptr && it != layers.end()) {
+            if (currentLayer == &it->second) { endLayer(); }
+            if (erase(composedLayers, &it->second) > 0) { compositionVersion += 1; }
+            layers.erase(it);
+        }
+    }
+
+    void VectorRenderer::endDraw() {
+        currentLayer = &layers[nullptr];
+        if (ranges::any_of(composedLayers, [](const Layer *layer) { return !layer->glyphShelves.empty(); })) {
+            // Grow the atlas image, the new glyphs are copied by drawFrame().
+            // Then use the final atlas size to normalize the glyphs UVs
+            glyphAtlas->upload();
+            for (auto *layer : composedLayers) {
+                if (!layer->glyphShelves.empty() && layer->atlasSize != glyphAtlas->getSize()) {
+                    normalizeTexts(*layer, glyphAtlas->getSize());
+                }
+            }
+        }
         textures.clear();
         texturesIndices.clear();
+        for (const auto *layer : composedLayers) {
+            for (const auto &command : layer->commands) {
+                if (command.texture != nullptr) {
+                    addImage(command.texture);
+                }
+            }
+        }
+        compositionVersion += 1;
     }
 
-    void VectorRenderer::endDraw() {
-        // Destroy the previous buffer when we are sure they aren't used by the VkCommandBuffer
-        oldBuffers.clear();
-        if (!vertices.empty()) {
-            // Resize the buffers only if needed by recreating them
-            // Buffer are only resized on grow
-            if ((vertexBuffer == VK_NULL_HANDLE) || (vertices.size() > vertexCount)) {
-                // Put the current buffers in the recycle bin since they are currently used by the VkCommandBuffer
-                // and can't be destroyed now
-                oldBuffers.push_back(stagingBuffer);
-                oldBuffers.push_back(vertexBuffer);
-                // Allocate new buffers to change size
-                vertexCount      = vertices.size();
-                vertexBufferSize = VERTEX_BUFFER_SIZE * vertexCount;
-                stagingBuffer    = make_shared<Buffer>(
-                        VERTEX_BUFFER_SIZE,
-                        vertexCount,
-                        VK_BUFFER_USAGE_TRANSFER_SRC_BIT
-                        );
-                vertexBuffer = make_shared<Buffer>(
-                        VERTEX_BUFFER_SIZE,
-                        vertexCount,
-                        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT
-                        );
+    void VectorRenderer::update(const uint32_t currentFrame) {
+        auto &frame = frameData[currentFrame];
+        if (frame.version == compositionVersion) { return; }
+        // The GPU has finished with this frame : the vertex buffers of the frame can be written or grown in place
+        frame.layers.clear();
+        for (auto *layer : composedLayers) {
+            if (layer->vertices.empty()) { continue; }
+            if (layer->vertexBuffer == nullptr) {
+                layer->vertexBuffer = make_unique<VertexRingBuffer>(VERTEX_BUFFER_SIZE, device.getFramesInFlight());
+                layer->frameVersions.resize(device.getFramesInFlight(), 0);
+            }
+            // Only the regenerated layers are written
+            if (layer->frameVersions[currentFrame] != layer->version) {
+                layer->vertexBuffer->reserve(currentFrame, layer->vertices.size());
+                layer->vertexBuffer->write(currentFrame, layer->vertices.data(), layer->vertices.size());
+                layer->frameVersions[currentFrame] = layer->version;
             }
-            // Push new vertices data to GPU memory
-            stagingBuffer->writeToBuffer(vertices.data());
-            const auto commandBuffer = device.beginOneTimeCommandBuffer();
-            stagingBuffer->copyTo(commandBuffer.commandBuffer, *(vertexBuffer), vertexBufferSize);
-            device.endOneTimeCommandBuffer(commandBuffer);
+            frame.layers.emplace_back(layer->vertexBuffer->getBuffer(currentFrame), layer->commands);
         }
-        vkQueueWaitIdle(device.getGraphicsQueue());
-        ranges::for_each(frameData, [&](FrameData& frame) {
-            frame.commands = commands;
-        });
-        // Initialize or update pipeline layout & descriptors sets if needed
-        descriptorSetNeedUpdate = true;
-        createOrUpdateResources();
+        frame.textures = textures;
+        frame.texturesIndices = texturesIndices;
+        // Only the descriptor set of this frame is updated, the other frames can still be in flight
+        writeDescriptorSet(currentFrame, false);
+        frame.version = compositionVersion;
+    }
+
+    void VectorRenderer::normalizeTexts(Layer &layer, const uint32_t atlasSize) const {
+        // UVs are in atlas pixels before the first normalization
+        const auto ratio = layer.atlasSize == 0 ?
+            1.0f / static_cast<float>(atlasSize) :
+            static_cast<float>(layer.atlasSize) / static_cast<float>(atlasSize);
+        auto firstVertex = 0u;
+        for (auto &command : layer.commands) {
+            if (command.primitive == PRIMITIVE_TEXT) {
+                for (auto i = firstVertex; i < firstVertex + command.count; i++) {
+                    layer.vertices[i].uv *= ratio;
+                }
+                command.texture = glyphAtlas->getImage();
+            }
+            firstVertex += command.count;
+        }
+        layer.atlasSize = atlasSize;
+        layer.version += 1;
     }
 
     void VectorRenderer::drawFrame(const uint32_t currentFrame, bool isLast) {
+        auto &frame = frameData.at(currentFrame);
+        const auto& commandBuffer = commandBuffers[currentFrame];
+        // The new glyphs are copied before the rendering, in the same queue as the frames sampling the atlas
+        glyphAtlas->record(commandBuffer, currentFrame);
         beginRendering(currentFrame);
-        if (vertices.empty()) {
+        if (frame.layers.empty()) {
             endRendering(currentFrame, isLast);
             return;
         }
-        const auto& commandBuffer = commandBuffers[currentFrame];
 
         bindShaders(commandBuffer);
         setViewport(commandBuffer, device.getSwapChainExtent().width, device.getSwapChainExtent().height);
@@ -209,46 +351,46 @@ namespace z0 {
         vkCmdSetPrimitiveTopology(commandBuffer,VK_PRIMITIVE_TOPOLOGY_LINE_LIST);
         vkCmdSetLineRasterizationModeEXT(commandBuffer, VK_LINE_RASTERIZATION_MODE_RECTANGULAR);
 
-        const VkBuffer buffers[] = {vertexBuffer->getBuffer()};
-        constexpr VkDeviceSize vertexOffsets[] = {0};
-        vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers, vertexOffsets);
         {
             //auto lock = lock_guard(descriptorSetMutex);
             bindDescriptorSets(commandBuffer, currentFrame);
         }
 
-        auto vertexIndex{0};
-        auto commandIndex{0};
         auto lastPrimitive = PRIMITIVE_LINE;
-        for (const auto &command : frameData.at(currentFrame).commands) {
-            if (lastPrimitive != command.primitive) {
-                vkCmdSetPrimitiveTopology(commandBuffer,
-                                          command.primitive == PRIMITIVE_LINE
-                                          ? VK_PRIMITIVE_TOPOLOGY_LINE_LIST
-                                          : VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
-                lastPrimitive = command.primitive;
+        for (const auto &layer : frame.layers) {
+            const VkBuffer buffers[] = {layer.vertexBuffer->getBuffer()};
+            constexpr VkDeviceSize vertexOffsets[] = {0};
+            vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers, vertexOffsets);
+            auto vertexIndex{0};
+            for (const auto &command : layer.commands) {
+                if (lastPrimitive != command.primitive) {
+                    vkCmdSetPrimitiveTopology(commandBuffer,
+                                              command.primitive == PRIMITIVE_LINE
+                                              ? VK_PRIMITIVE_TOPOLOGY_LINE_LIST
+                                              : VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
+                    lastPrimitive = command.primitive;
+                }
+                const auto pushConstants = PushConstants {
+                    .color = command.color,
+                    .textureIndex = (command.texture == nullptr ? -1 : frame.texturesIndices[command.texture->getId()]),
+                    .clipX = command.clipW,
+                    .clipY = 1.0f - command.clipH
+                };
+                vkCmdPushConstants(
+                    commandBuffer,
+                    pipelineLayout,
+                    VK_SHADER_STAGE_FRAGMENT_BIT,
+                    0,
+                    PUSH_CONSTANTS_SIZE,
+                    &pushConstants);
+                vkCmdDraw(
+                    commandBuffer,
+                    command.count,
+                    1,
+                    vertexIndex,
+                    0);
+                vertexIndex += command.count;
             }
-            const auto pushConstants = PushConstants {
-                .color = command.color,
-                .textureIndex = (command.texture == nullptr ? -1 : texturesIndices[command.texture->getId()]),
-                .clipX = command.clipW,
-                .clipY = 1.0f - command.clipH
-            };
-            vkCmdPushConstants(
-                commandBuffer,
-                pipelineLayout,
-                VK_SHADER_STAGE_FRAGMENT_BIT,
-                0,
-                PUSH_CONSTANTS_SIZE,
-                &pushConstants);
-            vkCmdDraw(
-                commandBuffer,
-                command.count,
-                1,
-                vertexIndex,
-                0);
-            vertexIndex += command.count;
-            commandIndex += 1;
         }
         endRendering(currentFrame, isLast);
     }
@@ -332,11 +474,15 @@ namespace z0 {
 
     void VectorRenderer::cleanup() {
         vkDestroyCommandPool(device.getDevice(), commandPool, nullptr);
-        commands.clear();
+        composedLayers.clear();
+        currentLayer = nullptr;
+        layers.clear();
+        for (auto &frame : frameData) {
+            frame.layers.clear();
+            frame.textures.clear();
+        }
         textures.clear();
-        vertexBuffer.reset();
-        stagingBuffer.reset();
-        oldBuffers.clear();
+        glyphAtlas.reset();
         if (internalColorFrameBuffer) {
             for (int i = 0; i < colorFrameBufferHdr.size(); i++) {
                 colorFrameBufferHdr[i]->cleanupImagesResources();
@@ -367,27 +513,34 @@ namespace z0 {
     }
 
     void VectorRenderer::createOrUpdateDescriptorSet(const bool create) {
-        //auto lock = lock_guard(descriptorSetMutex);
         for (auto i = 0; i < device.getFramesInFlight(); i++) {
-            uint32_t imageIndex = 0;
-            for (const auto &image : textures) {
-                frameData[i].imagesInfo[imageIndex] = image->getImageInfo();
-                imageIndex += 1;
-            }
-            // initialize the rest of the image info array with the blank image
-            for (uint32_t j = imageIndex; j < frameData[i].imagesInfo.size(); j++) {
-                frameData[i].imagesInfo[j] = blankImage->getImageInfo();
-            }
-            auto writer = DescriptorWriter(*setLayout, *descriptorPool)
-                .writeImage(0, frameData[i].imagesInfo.data());
-            if (!writer.build(descriptorSet.at(i), create)) {
-                die("Cannot allocate descriptor set for vector renderer");
-            }
+            writeDescriptorSet(i, create);
+        }
+    }
+
+    void VectorRenderer::writeDescriptorSet(const uint32_t currentFrame, const bool create) {
+        //auto lock = lock_guard(descriptorSetMutex);
+        auto &frame = frameData[currentFrame];
+        uint32_t imageIndex = 0;
+        for (const auto &image : frame.textures) {
+            frame.imagesInfo[imageIndex] = image->getImageInfo();
+            imageIndex += 1;
+        }
+        // initialize the rest of the image info array with the blank image
+        for (uint32_t j = imageIndex; j < frame.imagesInfo.size(); j++) {
+            frame.imagesInfo[j] = blankImage->getImageInfo();
+        }
+        auto writer = DescriptorWriter(*setLayout, *descriptorPool)
+            .writeImage(0, frame.imagesInfo.data());
+        if (!writer.build(descriptorSet.at(currentFrame), create)) {
+            die("Cannot allocate descriptor set for vector renderer");
         }
     }
 
     void VectorRenderer::init() {
         commandPool = device.createCommandPool();
+        glyphAtlas = make_unique<GlyphAtlas>(device);
+        currentLayer = &layers[nullptr];
         createImagesResources();
         attributeDescriptions.push_back({
                 VK_STRUCTURE_TYPE_VERTEX_INPUT_ATTRIBUTE_DESCRIPTION_2_EXT,
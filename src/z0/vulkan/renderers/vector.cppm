@@ -23,9 +23,11 @@ import z0.vulkan.Buffer;
 import z0.vulkan.ColorFrameBufferHDR;
 import z0.vulkan.Descriptors;
 import z0.vulkan.Device;
+import z0.vulkan.GlyphAtlas;
 import z0.vulkan.Renderer;
 import z0.vulkan.Renderpass;
 import z0.vulkan.Image;
+import z0.vulkan.VertexRingBuffer;
 
 using namespace z0::ui;
 
@@ -36,7 +38,12 @@ namespace z0 {
      * Coordinates system :<br>
      *  - origin : {0.0, 0.0} bottom left<br>
      *  - max values : { 1000.0, 1000.0 } top right (use VECTOR_SCALE constant)<br>
-     *  Currently not very efficient since all data are re-uploaded to the GPU on any UI change
+     *  Texts are drawn with one textured quad per glyph, from a glyph atlas shared by all the fonts.<br>
+     *  Drawing commands are grouped in retained layers, each layer having its own per-frame vertex buffers
+     *  rewritten only when the layer is regenerated. Commands outside a layer go to the immediate layer,
+     *  regenerated on each drawing session and composed first.<br>
+     *  Vertices are written directly in persistently mapped buffers when a frame is updated, drawing never
+     *  waits for the GPU.
      */
     export class VectorRenderer : public Renderpass, public Renderer {
     public:
@@ -70,7 +77,7 @@ namespace z0 {
                       float             clip_w,
                       float             clip_h);
 
-        // Draw a rectangle filled with a text
+        // Draw an UTF-8 text, scaled to fill a rectangle and clipped to [clip_w, clip_h]
         void drawText(const string &text, Font &font,
                       float         x, float                      y,
                       float         w, float                      h,
@@ -85,10 +92,24 @@ namespace z0 {
         // Change the global transparency for the next drawing commands. Value is subtracted from the vertex alpha
         inline auto setTransparency(const float a) { transparency = a; }
 
-        // Restart a new drawing session, clearing all the previous data (vertices and drawing commands)
+        // Restart a new drawing session, clearing the immediate layer. Retained layers are composed only if
+        // regenerated with beginLayer() or kept with keepLayer()
         void beginDraw();
 
-        // Send the data of the drawing commands to the GPU
+        // Regenerate a retained layer identified by its owner : the next drawing commands replace the layer content
+        void beginLayer(const void *owner);
+
+        // End the regeneration of a retained layer, the next drawing commands go to the immediate layer
+        void endLayer();
+
+        // Compose a retained layer without regenerating it.
+        // Returns false if the layer does not exist and must be regenerated
+        [[nodiscard]] bool keepLayer(const void *owner);
+
+        // Destroy a retained layer
+        void removeLayer(const void *owner);
+
+        // Compose the layers drawn or kept since beginDraw(). The vertices are written in the frames buffers by update()
         void endDraw();
 
         [[nodiscard]] inline VkImage getImage(const uint32_t currentFrame) const override {
@@ -101,6 +122,8 @@ namespace z0 {
             PRIMITIVE_NONE,
             PRIMITIVE_LINE,
             PRIMITIVE_RECT,
+            // Glyphs quads, with UVs in glyph atlas pixels until endDraw()
+            PRIMITIVE_TEXT,
         };
 
         // A drawing command
@@ -153,28 +176,54 @@ namespace z0 {
         // Global transparency for the next drawing commands. Value is subtracted from the vertex alpha
         float transparency{0.0f};
 
-        // All drawing commands
-        list<Command> commands;
-        // All the vertices generated by the drawing commands
-        vector<Vertex> vertices;
-        // Number of vertices for the currently allocated VkBuffers, used to check if we need to resize the buffers
-        uint32_t vertexCount{0};
-        // Current VkBuffer memory size
-        VkDeviceSize vertexBufferSize{0};
-        // Staging vertex buffer used when updating GPU memory
-        shared_ptr<Buffer> stagingBuffer{VK_NULL_HANDLE};
-        // Vertex buffer in GPU memory
-        shared_ptr<Buffer> vertexBuffer{VK_NULL_HANDLE};
-        // Used when we need to postpone the buffers destruction when they are in use by a VkCommandBuffer
-        list<shared_ptr<Buffer>> oldBuffers;
-        // All the images used in the scene
+        // Retained drawing commands and vertices
+        struct Layer {
+            // Drawing commands
+            list<Command>      commands;
+            // Vertices generated by the drawing commands
+            vector<Vertex>     vertices;
+            // Glyph atlas shelves used by the texts, protected from eviction while the layer is retained
+            set<uint32_t>      glyphShelves;
+            // Glyph atlas size used to normalize the texts UVs, 0 if not normalized
+            uint32_t           atlasSize{0};
+            // Incremented each time the vertices change
+            uint64_t           version{1};
+            // Vertices version written in the vertex buffer of each frame
+            vector<uint64_t>   frameVersions;
+            // Per-frame vertex buffers
+            unique_ptr<VertexRingBuffer> vertexBuffer;
+        };
+
+        // A layer composed in a frame
+        struct LayerDraw {
+            shared_ptr<Buffer> vertexBuffer;
+            list<Command>      commands;
+        };
+
+        // All the layers, the immediate layer has a null owner
+        map<const void*, Layer> layers;
+        // Layers composed in the current drawing session, in drawing order
+        vector<Layer*> composedLayers;
+        // Layer receiving the drawing commands
+        Layer* currentLayer{nullptr};
+        // Incremented each time the composition changes, frames are updated when outdated
+        uint64_t compositionVersion{1};
+        // All the images used by the composed layers
         list<shared_ptr<VulkanImage>> textures;
         // Indices of each images in the descriptor binding
         map<Resource::id_t, int32_t> texturesIndices{};
+        // Glyphs of all the texts
+        unique_ptr<GlyphAtlas> glyphAtlas;
 
         struct FrameData {
-            // Read only copy of the commands we have to draw
-            list<Command> commands;
+            // Composition version of the frame data
+            uint64_t version{0};
+            // Read only copy of the layers we have to draw
+            vector<LayerDraw> layers;
+            // Images used by the frame, kept alive as long as the frame is in flight
+            list<shared_ptr<VulkanImage>> textures;
+            // Indices of each images in the descriptor binding
+            map<Resource::id_t, int32_t> texturesIndices{};
             // Images infos for descriptor sets, pre-filled with blank images
             array<VkDescriptorImageInfo, MAX_IMAGES> imagesInfo;
         };
@@ -198,6 +247,11 @@ namespace z0 {
 
         void addImage(const shared_ptr<Image> &image);
 
+        // Rescale the texts UVs of a layer to a new glyph atlas size
+        void normalizeTexts(Layer &layer, uint32_t atlasSize) const;
+
+        void writeDescriptorSet(uint32_t currentFrame, bool create);
+
         void beginRendering(uint32_t currentFrame);
 
         void endRendering( uint32_t currentFrame, bool isLast);
@@ -210,6 +264,8 @@ namespace z0 {
 
         void cleanup() override;
 
+        void update(uint32_t currentFrame) override;
+
         void loadShaders() override;
 
         void createDescriptorSetLayout() override;
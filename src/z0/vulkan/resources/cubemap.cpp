@@ -12,6 +12,7 @@ module;
 module z0.vulkan.Cubemap;
 
 import z0.Constants;
+import z0.KTX2;
 import z0.Tools;
 
 import z0.resources.Image;
@@ -152,6 +153,98 @@ namespace z0 {
         createTextureSampler();
     }
 
+    VulkanCubemap::VulkanCubemap(const Device &  device,
+                     const KTX2 &    ktx,
+                     const VkFormat  format,
+                     const string &  name):
+        Cubemap(ktx.getWidth(), ktx.getHeight(), TYPE_STANDARD, name), device{device}, textureFormat{format}  {
+        assert(ktx.getFaces() == 6 && "Must have 6 faces for a cubemap");
+        if (!device.isFormatSupported(format)) {
+            die("Cubemap format of", name, "not supported by the GPU");
+        }
+        const auto levels = static_cast<uint32_t>(ktx.getLevels().size());
+        const auto command = device.beginOneTimeCommandBuffer();
+        // The whole file is copied in the staging buffer so the levels offsets can be used as is
+        const auto& textureStagingBuffer = device.createOneTimeBuffer(
+                command,
+                ktx.getDataSize(),
+                1,
+                VK_BUFFER_USAGE_TRANSFER_SRC_BIT
+        );
+        textureStagingBuffer.writeToBuffer(ktx.getData());
+
+        // Create image in GPU memory, one image in memory for the 6 images of the cubemap
+        device.createImage(width,
+                           height,
+                           levels,
+                           VK_SAMPLE_COUNT_1_BIT,
+                           textureFormat,
+                           VK_IMAGE_TILING_OPTIMAL,
+                           VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                           VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                           textureImage,
+                           textureImageMemory,
+                           VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT,
+                           6);
+
+        // In a KTX2 level the faces are tightly packed in the +X, -X, +Y, -Y, +Z, -Z order,
+        // the same order as the cubemap layers
+        auto regions = vector<VkBufferImageCopy>{};
+        for (uint32_t level = 0; level < levels; level++) {
+            for (uint32_t face = 0; face < 6; face++) {
+                regions.push_back({
+                    .bufferOffset      = ktx.getLevels().at(level).offset + ktx.getFaceSize(level) * face,
+                    .imageSubresource  = {
+                        .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                        .mipLevel = level,
+                        .baseArrayLayer = face,
+                        .layerCount = 1,
+                    },
+                    .imageExtent = {
+                        std::max(1u, width >> level),
+                        std::max(1u, height >> level),
+                        1
+                    },
+                });
+            }
+        }
+        Device::transitionImageLayout(command.commandBuffer,
+                                      textureImage,
+                                      VK_IMAGE_LAYOUT_UNDEFINED,
+                                      VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                      0,
+                                      VK_ACCESS_TRANSFER_WRITE_BIT,
+                                      VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                                      VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                      VK_IMAGE_ASPECT_COLOR_BIT,
+                                      levels);
+        vkCmdCopyBufferToImage(
+                command.commandBuffer,
+                textureStagingBuffer.getBuffer(),
+                textureImage,
+                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                regions.size(),
+                regions.data());
+        Device::transitionImageLayout(command.commandBuffer,
+                                      textureImage,
+                                      VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                      VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                      VK_ACCESS_TRANSFER_WRITE_BIT,
+                                      VK_ACCESS_TRANSFER_READ_BIT,
+                                      VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                      VK_PIPELINE_STAGE_TRANSFER_BIT ,
+                                      VK_IMAGE_ASPECT_COLOR_BIT,
+                                      levels);
+        device.endOneTimeCommandBuffer(command);
+
+        textureImageView = device.createImageView(textureImage,
+                                                  textureFormat,
+                                                  VK_IMAGE_ASPECT_COLOR_BIT,
+                                                  levels,
+                                                  VK_IMAGE_VIEW_TYPE_CUBE);
+        createTextureSampler(levels);
+    }
+
     VulkanCubemap::~VulkanCubemap() {
         vkDestroySampler(device.getDevice(), textureSampler, nullptr);
         vkDestroyImageView(device.getDevice(), textureImageView, nullptr);
@@ -159,7 +252,7 @@ namespace z0 {
         vkFreeMemory(device.getDevice(), textureImageMemory, nullptr);
     }
 
-    void VulkanCubemap::createTextureSampler() {
+    void VulkanCubemap::createTextureSampler(const uint32_t levels) {
         VkSamplerCreateInfo samplerInfo{};
         samplerInfo.sType        = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
         samplerInfo.magFilter    = VK_FILTER_LINEAR;
@@ -176,7 +269,7 @@ namespace z0 {
         samplerInfo.compareOp               = VK_COMPARE_OP_ALWAYS;
         samplerInfo.mipmapMode              = VK_SAMPLER_MIPMAP_MODE_LINEAR;
         samplerInfo.minLod                  = 0.0f;
-        samplerInfo.maxLod                  = 1.0f;
+        samplerInfo.maxLod                  = static_cast<float>(levels);
         samplerInfo.mipLodBias              = 0.0f;
         if (vkCreateSampler(device.getDevice(), &samplerInfo, nullptr, &textureSampler) != VK_SUCCESS) {
             die("failed to create skybox texture sampler");
@@ -10,6 +10,8 @@ module;
 
 export module z0.vulkan.Cubemap;
 
+import z0.KTX2;
+
 import z0.resources.Cubemap;
 
 import z0.vulkan.Device;
@@ -32,6 +34,14 @@ export namespace z0 {
                 VkFormat            format = VK_FORMAT_R16G16B16A16_SFLOAT,
                 const string &      name = "Cubemap");
 
+        /*
+         * Uploads the 6 faces of a KTX2 cubemap with all their precomputed mip levels, without any conversion
+         */
+        VulkanCubemap(const Device &device,
+                const KTX2 &        ktx,
+                VkFormat            format,
+                const string &      name = "Cubemap");
+
         VulkanCubemap(VulkanCubemap &&) = delete;
         VulkanCubemap(VulkanCubemap &) = delete;
 
@@ -57,7 +67,7 @@ export namespace z0 {
         const VkFormat textureFormat;
 
     private:
-        void createTextureSampler();
+        void createTextureSampler(uint32_t levels = 1);
     };
 
 }
@@ -13,6 +13,7 @@ module;
 module z0.vulkan.Image;
 
 import z0.Constants;
+import z0.KTX2;
 import z0.Log;
 import z0.Tools;
 import z0.ZRes;
@@ -264,6 +265,90 @@ namespace z0 {
             static_cast<VkSamplerAddressMode>(textureHeader.samplerAddressModeV));
     }
 
+    VulkanImage::VulkanImage(const Device &device,
+               const string &             name,
+               const KTX2 &               ktx,
+               const VkFormat             format,
+               const VkFilter             magFiter,
+               const VkFilter             minFiler,
+               const VkSamplerAddressMode samplerAddressModeU,
+               const VkSamplerAddressMode samplerAddressModeV):
+        Image(ktx.getWidth(), ktx.getHeight(), name),
+        device{device},
+        mipLevels{static_cast<uint32_t>(ktx.getLevels().size())} {
+        DEBUG("VulkanImage uploading KTX2 ", name);
+        if (!device.isFormatSupported(format)) {
+            die("Image format of", name, "not supported by the GPU");
+        }
+        const auto command = device.beginOneTimeCommandBuffer();
+        // The whole file is copied in the staging buffer so the levels offsets can be used as is
+        const auto& textureStagingBuffer = device.createOneTimeBuffer(
+                command,
+                ktx.getDataSize(),
+                1,
+                VK_BUFFER_USAGE_TRANSFER_SRC_BIT
+        );
+        textureStagingBuffer.writeToBuffer(ktx.getData());
+
+        // One copy region for each precomputed mip level
+        auto copyRegions = vector<VkBufferImageCopy>{};
+        for (uint32_t mip_level = 0; mip_level < mipLevels; mip_level++) {
+            copyRegions.push_back({
+                .bufferOffset       = ktx.getLevels().at(mip_level).offset,
+                .imageSubresource {
+                    .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+                    .mipLevel       = mip_level,
+                    .layerCount     = 1,
+                },
+                .imageExtent {
+                    .width          = std::max(1u, width >> mip_level),
+                    .height         = std::max(1u, height >> mip_level),
+                    .depth          = 1,
+                },
+            });
+        }
+        device.createImage(width,
+                           height,
+                           mipLevels,
+                           VK_SAMPLE_COUNT_1_BIT,
+                           format,
+                           VK_IMAGE_TILING_OPTIMAL,
+                           VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                           VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                           textureImage,
+                           textureImageMemory);
+        Device::transitionImageLayout(command.commandBuffer,
+                                      textureImage,
+                                      VK_IMAGE_LAYOUT_UNDEFINED,
+                                      VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                      0,
+                                      VK_ACCESS_TRANSFER_WRITE_BIT,
+                                      VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                                      VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                      VK_IMAGE_ASPECT_COLOR_BIT,
+                                      mipLevels);
+        vkCmdCopyBufferToImage(
+                command.commandBuffer,
+                textureStagingBuffer.getBuffer(),
+                textureImage,
+                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                copyRegions.size(),
+                copyRegions.data());
+        Device::transitionImageLayout(command.commandBuffer,
+                                   textureImage,
+                                   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                   VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                   VK_ACCESS_TRANSFER_WRITE_BIT,
+                                   0,
+                                   VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                   VK_PIPELINE_STAGE_TRANSFER_BIT ,
+                                   VK_IMAGE_ASPECT_COLOR_BIT,
+                                   mipLevels);
+        device.endOneTimeCommandBuffer(command);
+        textureImageView = device.createImageView(textureImage, format, VK_IMAGE_ASPECT_COLOR_BIT, mipLevels);
+        createTextureSampler(magFiter, minFiler, samplerAddressModeU, samplerAddressModeV);
+    }
+
     VulkanImage::~VulkanImage() {
         DEBUG("~VulkanImage ", getName());
         vkDestroySampler(device.getDevice(), textureSampler, nullptr);
@@ -272,6 +357,37 @@ namespace z0 {
         if (textureImageMemory != VK_NULL_HANDLE) { vkFreeMemory(device.getDevice(), textureImageMemory, nullptr); }
     }
 
+    void VulkanImage::copyFrom(const VkCommandBuffer    commandBuffer,
+                               const Buffer&            buffer,
+                               const VkBufferImageCopy& region,
+                               const bool               initialize) const {
+        Device::transitionImageLayout(commandBuffer,
+                                      textureImage,
+                                      initialize ? VK_IMAGE_LAYOUT_UNDEFINED : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                      VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                      initialize ? 0 : VK_ACCESS_SHADER_READ_BIT,
+                                      VK_ACCESS_TRANSFER_WRITE_BIT,
+                                      initialize ? VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT : VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                                      VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                      VK_IMAGE_ASPECT_COLOR_BIT);
+        vkCmdCopyBufferToImage(
+                commandBuffer,
+                buffer.getBuffer(),
+                textureImage,
+                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                1,
+                &region);
+        Device::transitionImageLayout(commandBuffer,
+                                      textureImage,
+                                      VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                      VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                      VK_ACCESS_TRANSFER_WRITE_BIT,
+                                      VK_ACCESS_SHADER_READ_BIT,
+                                      VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                      VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                                      VK_IMAGE_ASPECT_COLOR_BIT);
+    }
+
     void VulkanImage::createTextureSampler(
         const VkFilter magFilter,
         const VkFilter minFilter,
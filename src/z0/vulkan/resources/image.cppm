@@ -12,6 +12,7 @@ module;
 
 export module z0.vulkan.Image;
 
+import z0.KTX2;
 import z0.ZRes;
 
 import z0.resources.Image;
@@ -75,6 +76,18 @@ export namespace z0 {
                 uint64_t                      bufferOffset,
                 VkImageTiling                 tiling             = VK_IMAGE_TILING_OPTIMAL);
 
+        /*
+         * Uploads the payload of a 2D KTX2 file with all its precomputed mip levels, without any conversion
+         */
+        VulkanImage(const Device &  device,
+               const string &       name,
+               const KTX2 &         ktx,
+               VkFormat             format,
+               VkFilter             magFiter            = VK_FILTER_LINEAR,
+               VkFilter             minFiler            = VK_FILTER_LINEAR,
+               VkSamplerAddressMode samplerAddressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT,
+               VkSamplerAddressMode samplerAddressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT);
+
         VulkanImage(VulkanImage&&) = delete;
         VulkanImage(VulkanImage&) = delete;
 
@@ -91,6 +104,16 @@ export namespace z0 {
 
         [[nodiscard]] inline auto getImage() const { return textureImage; }
 
+        /*
+         * Copies a buffer into a region of an image without mip levels, for partial updates.
+         * The image must be, and stays, in the VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL layout.
+         * With `initialize` the previous content is discarded, for the first copy into a new image.
+         */
+        void copyFrom(VkCommandBuffer          commandBuffer,
+                      const Buffer&            buffer,
+                      const VkBufferImageCopy& region,
+                      bool                     initialize = false) const;
+
         [[nodiscard]] inline auto getImageView() const { return textureImageView; }
 
         static VkFormat formatSRGB(VkFormat format, const string& name);
@@ -91,6 +91,14 @@ namespace z0 {
         vkCmdBindIndexBuffer(commandBuffer, indexBuffer->getBuffer(), 0, VK_INDEX_TYPE_UINT32);
     }
 
+    void VulkanMesh::bind(const VkCommandBuffer commandBuffer, const VkBuffer vertices) const {
+        assert(indexBuffer != nullptr);
+        const VkBuffer         buffers[] = {vertices};
+        constexpr VkDeviceSize offsets[] = {0};
+        vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers, offsets);
+        vkCmdBindIndexBuffer(commandBuffer, indexBuffer->getBuffer(), 0, VK_INDEX_TYPE_UINT32);
+    }
+
     void VulkanMesh::buildModel() {
         optimize();
         const auto &device = Device::get();
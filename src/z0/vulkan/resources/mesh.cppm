@@ -35,6 +35,9 @@ export namespace z0 {
 
         void bind(VkCommandBuffer commandBuffer) const;
 
+        // Binds the indices of the mesh with other vertices, like the skinned vertices of a mesh instance
+        void bind(VkCommandBuffer commandBuffer, VkBuffer vertices) const;
+
         void buildModel();
 
     private:
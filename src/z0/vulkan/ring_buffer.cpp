@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2024-2025 Henri Michelon
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+*/
+module;
+#include "z0/libraries.h"
+#include "z0/vulkan.h"
+
+module z0.vulkan.RingBuffer;
+
+import z0.Log;
+import z0.Tools;
+
+import z0.vulkan.Buffer;
+
+namespace z0 {
+
+    RingBuffer::RingBuffer(const VkDeviceSize frameSize,
+                           const uint32_t     framesInFlight,
+                           const VkDeviceSize alignment):
+        frameSize{(frameSize + alignment - 1) & ~(alignment - 1)},
+        alignment{alignment},
+        heads{make_unique<atomic<VkDeviceSize>[]>(framesInFlight)} {
+        buffer = make_unique<Buffer>(
+            this->frameSize,
+            framesInFlight,
+            VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            alignment);
+        if (buffer->map() != VK_SUCCESS) { die("Error mapping ring buffer to GPU memory"); }
+        for (auto i = 0; i < framesInFlight; i++) {
+            heads[i] = 0;
+        }
+        DEBUG("Created RingBuffer ", this->frameSize, "*", framesInFlight);
+    }
+
+    void RingBuffer::reset(const uint32_t currentFrame) {
+        heads[currentFrame] = 0;
+    }
+
+    uint32_t RingBuffer::write(const uint32_t currentFrame, const void *data, const VkDeviceSize size) {
+        const auto alignedSize = (size + alignment - 1) & ~(alignment - 1);
+        const auto offset = heads[currentFrame].fetch_add(alignedSize);
+        if ((offset + alignedSize) > frameSize) {
+            die("Ring buffer overflow, increase ApplicationConfig::frameDataSize");
+        }
+        const auto frameOffset = frameSize * currentFrame + offset;
+        buffer->writeToBuffer(data, size, frameOffset);
+        return static_cast<uint32_t>(frameOffset);
+    }
+
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2024-2025 Henri Michelon
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+*/
+module;
+#include "z0/vulkan.h"
+#include "z0/libraries.h"
+
+export module z0.vulkan.RingBuffer;
+
+import z0.vulkan.Buffer;
+
+export namespace z0 {
+
+    /*
+     * Per-frame linear allocator for the renderers transient data.
+     * One persistently mapped buffer is divided into one region per frame in flight, the renderers append
+     * their data to the region of the current frame and bind it with a dynamic offset.
+     * A region is recycled when the fence of its frame is signaled, so the buffer and the descriptor sets
+     * using it are never recreated.
+     */
+    class RingBuffer {
+    public:
+        RingBuffer(VkDeviceSize frameSize, uint32_t framesInFlight, VkDeviceSize alignment);
+
+        /* Frees all the allocations of a frame. The GPU must have finished with the frame. */
+        void reset(uint32_t currentFrame);
+
+        /* Copies data in the region of the frame and returns the dynamic offset to use when binding. Thread safe. */
+        [[nodiscard]] uint32_t write(uint32_t currentFrame, const void *data, VkDeviceSize size);
+
+        /*
+         * Descriptor for the dynamic uniform or storage buffers, the offset is given when binding.
+         * The non-dynamic descriptors use the offset returned by write() and must be written each frame.
+         */
+        [[nodiscard]] inline auto descriptorInfo(const VkDeviceSize size, const VkDeviceSize offset = 0) const {
+            return buffer->descriptorInfo(size, offset);
+        }
+
+        [[nodiscard]] inline auto getFrameSize() const { return frameSize; }
+
+    private:
+        const VkDeviceSize                 frameSize;
+        const VkDeviceSize                 alignment;
+        unique_ptr<Buffer>                 buffer;
+        // Allocation head of each frame region, relative to the start of the region
+        unique_ptr<atomic<VkDeviceSize>[]> heads;
+
+    public:
+        RingBuffer(const RingBuffer &) = delete;
+
+        RingBuffer &operator=(const RingBuffer &) = delete;
+    };
+
+}
@@ -20,7 +20,8 @@ namespace z0 {
                    string                       _name,
                    const vector<char> &         code,
                    const VkDescriptorSetLayout *pSetLayouts,
-                   const VkPushConstantRange *  pPushConstantRange):
+                   const VkPushConstantRange *  pPushConstantRange,
+                   const VkSpecializationInfo * pSpecializationInfo):
         device{dev},
         stage{stageFlagsBits},
         stageFlags{nextStageFlags},
@@ -40,6 +41,17 @@ namespace z0 {
         shaderCreateInfo.pushConstantRangeCount = pPushConstantRange != nullptr ? 1 : 0;
         shaderCreateInfo.pPushConstantRanges    = pPushConstantRange;
         shaderCreateInfo.pSpecializationInfo    = nullptr;
+        if (pSpecializationInfo != nullptr) {
+            specializationEntries.assign(pSpecializationInfo->pMapEntries,
+                                         pSpecializationInfo->pMapEntries + pSpecializationInfo->mapEntryCount);
+            const auto* data = static_cast<const char*>(pSpecializationInfo->pData);
+            specializationData.assign(data, data + pSpecializationInfo->dataSize);
+            specializationInfo.mapEntryCount     = static_cast<uint32_t>(specializationEntries.size());
+            specializationInfo.pMapEntries       = specializationEntries.data();
+            specializationInfo.dataSize          = specializationData.size();
+            specializationInfo.pData             = specializationData.data();
+            shaderCreateInfo.pSpecializationInfo = &specializationInfo;
+        }
     }
 
     Shader::~Shader() {
@@ -25,7 +25,8 @@ export namespace z0 {
                string                       _name,
                const vector<char> &         code,
                const VkDescriptorSetLayout *pSetLayouts,
-               const VkPushConstantRange *  pPushConstantRange);
+               const VkPushConstantRange *  pPushConstantRange,
+               const VkSpecializationInfo * pSpecializationInfo = nullptr);
 
         Shader(Shader &&) = delete;
         Shader(Shader &) = delete;
@@ -34,6 +35,8 @@ export namespace z0 {
 
         [[nodiscard]] inline auto getShaderCreateInfo() const { return shaderCreateInfo; }
 
+        [[nodiscard]] inline const auto& getName() const { return shaderName; }
+
         [[nodiscard]] inline auto getStage() { return &stage; }
 
         [[nodiscard]] inline auto getShader() { return &shader; }
@@ -44,11 +47,16 @@ export namespace z0 {
         const Device &        device;
         string                shaderName;
         uint32_t              refCount{0};
-        vector<char>          spirv;
+        // SPIR-V code owned by the ShaderCache
+        const vector<char>&   spirv;
         VkShaderStageFlagBits stage;
         VkShaderStageFlags    stageFlags;
         VkShaderEXT           shader{VK_NULL_HANDLE};
         VkShaderCreateInfoEXT shaderCreateInfo;
+        // Copy of the specialization constants, referenced by shaderCreateInfo
+        vector<VkSpecializationMapEntry> specializationEntries;
+        vector<char>          specializationData;
+        VkSpecializationInfo  specializationInfo{};
 
     public:
         inline auto _incrementReferenceCounter() { refCount += 1; }
@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2024-2025 Henri Michelon
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+*/
+module;
+#include "z0/libraries.h"
+#include "z0/vulkan.h"
+
+module z0.vulkan.ShaderCache;
+
+import z0.Log;
+import z0.Tools;
+import z0.VirtualFS;
+
+namespace z0 {
+
+    ShaderCache::ShaderCache(const VkDevice device, const VkPhysicalDevice physicalDevice, const filesystem::path& directory):
+        device{device},
+        directory{directory} {
+        // The binaries are only compatible with the same shaderBinaryUUID & shaderBinaryVersion,
+        // the pipeline cache data with the same pipelineCacheUUID
+        auto shaderObjectProperties = VkPhysicalDeviceShaderObjectPropertiesEXT{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_OBJECT_PROPERTIES_EXT,
+        };
+        auto idProperties = VkPhysicalDeviceIDProperties{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES,
+            .pNext = &shaderObjectProperties,
+        };
+        auto properties = VkPhysicalDeviceProperties2{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+            .pNext = &idProperties,
+        };
+        vkGetPhysicalDeviceProperties2(physicalDevice, &properties);
+        shadersHeader.vendorID = properties.properties.vendorID;
+        shadersHeader.deviceID = properties.properties.deviceID;
+        shadersHeader.driverVersion = properties.properties.driverVersion;
+        memcpy(shadersHeader.deviceUUID, idProperties.deviceUUID, VK_UUID_SIZE);
+        pipelinesHeader = shadersHeader;
+        shadersHeader.binaryVersion = shaderObjectProperties.shaderBinaryVersion;
+        memcpy(shadersHeader.cacheUUID, shaderObjectProperties.shaderBinaryUUID, VK_UUID_SIZE);
+        memcpy(pipelinesHeader.cacheUUID, properties.properties.pipelineCacheUUID, VK_UUID_SIZE);
+
+        auto data = vector<char>{};
+        auto header = CacheHeader{};
+        if (readFile(SHADERS_FILE, shadersHeader, header, data)) {
+            auto offset = size_t{0};
+            for (auto index = 0; index < header.count; index++) {
+                auto key = uint64_t{0};
+                auto size = uint64_t{0};
+                if (offset + sizeof(key) + sizeof(size) > data.size()) { break; }
+                memcpy(&key, data.data() + offset, sizeof(key));
+                memcpy(&size, data.data() + offset + sizeof(key), sizeof(size));
+                offset += sizeof(key) + sizeof(size);
+                if (offset + size > data.size()) { break; }
+                binaries[key] = vector<char>(data.begin() + offset, data.begin() + offset + size);
+                offset += size;
+            }
+            DEBUG("ShaderCache : ", binaries.size(), " shader binaries loaded");
+        }
+        data.clear();
+        if (!readFile(PIPELINES_FILE, pipelinesHeader, header, data)) {
+            data.clear();
+        }
+        const auto createInfo = VkPipelineCacheCreateInfo {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+            .initialDataSize = data.size(),
+            .pInitialData = data.empty() ? nullptr : data.data(),
+        };
+        if (vkCreatePipelineCache(device, &createInfo, nullptr, &pipelineCache) != VK_SUCCESS) {
+            die("Failed to create pipeline cache");
+        }
+    }
+
+    ShaderCache::~ShaderCache() {
+        vkDestroyPipelineCache(device, pipelineCache, nullptr);
+    }
+
+    const vector<char>& ShaderCache::getSpirv(const string& filename) {
+        auto lock = lock_guard(cacheMutex);
+        if (!spirvCodes.contains(filename)) {
+            spirvCodes[filename] = VirtualFS::loadShader(filename);
+        }
+        return spirvCodes.at(filename);
+    }
+
+    VkShaderEXT ShaderCache::createShader(const string&                filename,
+                                          const VkShaderCreateInfoEXT& createInfo,
+                                          const uint64_t               layoutSignature) {
+        // The binary is only valid for the same code and the same create parameters
+        auto key = hash(createInfo.pCode, createInfo.codeSize);
+        key = hash(filename.data(), filename.size(), key);
+        key = hash(&createInfo.stage, sizeof(createInfo.stage), key);
+        key = hash(&createInfo.nextStage, sizeof(createInfo.nextStage), key);
+        key = hash(&layoutSignature, sizeof(layoutSignature), key);
+        for (auto index = 0; index < createInfo.pushConstantRangeCount; index++) {
+            key = hash(&createInfo.pPushConstantRanges[index], sizeof(VkPushConstantRange), key);
+        }
+        if (createInfo.pSpecializationInfo != nullptr) {
+            const auto& specializationInfo = *createInfo.pSpecializationInfo;
+            key = hash(specializationInfo.pMapEntries,
+                       specializationInfo.mapEntryCount * sizeof(VkSpecializationMapEntry),
+                       key);
+            key = hash(specializationInfo.pData, specializationInfo.dataSize, key);
+        }
+
+        auto lock = lock_guard(cacheMutex);
+        auto shader = VkShaderEXT{VK_NULL_HANDLE};
+        if (binaries.contains(key)) {
+            const auto& binary = binaries.at(key);
+            auto binaryCreateInfo = createInfo;
+            binaryCreateInfo.codeType = VK_SHADER_CODE_TYPE_BINARY_EXT;
+            binaryCreateInfo.codeSize = binary.size();
+            binaryCreateInfo.pCode = binary.data();
+            if (vkCreateShadersEXT(device, 1, &binaryCreateInfo, nullptr, &shader) == VK_SUCCESS) {
+                return shader;
+            }
+            // Incompatible binary, replaced by the binary of the SPIR-V code
+            binaries.erase(key);
+            shader = VK_NULL_HANDLE;
+        }
+        if (vkCreateShadersEXT(device, 1, &createInfo, nullptr, &shader) != VK_SUCCESS) {
+            die("vkCreateShadersEXT failed for", filename);
+        }
+        auto size = size_t{0};
+        if (vkGetShaderBinaryDataEXT(device, shader, &size, nullptr) == VK_SUCCESS && size > 0) {
+            auto binary = vector<char>(size);
+            if (vkGetShaderBinaryDataEXT(device, shader, &size, binary.data()) == VK_SUCCESS) {
+                binaries[key] = std::move(binary);
+                binariesModified = true;
+            }
+        }
+        return shader;
+    }
+
+    void ShaderCache::save() {
+        if (directory.empty()) { return; }
+        auto lock = lock_guard(cacheMutex);
+        if (binariesModified) {
+            auto data = vector<char>{};
+            for (const auto& [key, binary] : binaries) {
+                const auto size = static_cast<uint64_t>(binary.size());
+                data.insert(data.end(),
+                            reinterpret_cast<const char*>(&key),
+                            reinterpret_cast<const char*>(&key) + sizeof(key));
+                data.insert(data.end(),
+                            reinterpret_cast<const char*>(&size),
+                            reinterpret_cast<const char*>(&size) + sizeof(size));
+                data.insert(data.end(), binary.begin(), binary.end());
+            }
+            auto header = shadersHeader;
+            header.count = binaries.size();
+            writeFile(SHADERS_FILE, header, data);
+            binariesModified = false;
+        }
+        auto size = size_t{0};
+        if (vkGetPipelineCacheData(device, pipelineCache, &size, nullptr) == VK_SUCCESS && size > 0) {
+            auto data = vector<char>(size);
+            if (vkGetPipelineCacheData(device, pipelineCache, &size, data.data()) == VK_SUCCESS) {
+                data.resize(size);
+                auto header = pipelinesHeader;
+                header.count = size;
+                writeFile(PIPELINES_FILE, header, data);
+            }
+        }
+    }
+
+    uint64_t ShaderCache::hash(const void* data, const size_t size, uint64_t hash) {
+        // FNV-1a
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        for (auto index = 0; index < size; index++) {
+            hash ^= bytes[index];
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    bool ShaderCache::readFile(const string&      name,
+                               const CacheHeader& expected,
+                               CacheHeader&       header,
+                               vector<char>&      data) const {
+        if (directory.empty()) { return false; }
+        auto file = ifstream{directory / name, ios::binary | ios::ate};
+        if (!file.is_open()) { return false; }
+        const auto fileSize = static_cast<size_t>(file.tellg());
+        if (fileSize < sizeof(CacheHeader)) { return false; }
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+        // Only use the cache files made for the same device & driver
+        if (header.magic != expected.magic ||
+            header.version != expected.version ||
+            header.vendorID != expected.vendorID ||
+            header.deviceID != expected.deviceID ||
+            header.driverVersion != expected.driverVersion ||
+            header.binaryVersion != expected.binaryVersion ||
+            memcmp(header.deviceUUID, expected.deviceUUID, VK_UUID_SIZE) != 0 ||
+            memcmp(header.cacheUUID, expected.cacheUUID, VK_UUID_SIZE) != 0) {
+            DEBUG("ShaderCache : ignoring ", name, " made for another device or driver");
+            return false;
+        }
+        data.resize(fileSize - sizeof(CacheHeader));
+        file.read(data.data(), data.size());
+        return !file.fail();
+    }
+
+    void ShaderCache::writeFile(const string& name, const CacheHeader& header, const vector<char>& data) const {
+        // Write into a temporary file first so an interrupted write never leaves a truncated cache file
+        auto error = error_code{};
+        filesystem::create_directories(directory, error);
+        const auto filepath = directory / name;
+        auto tempPath = filepath;
+        tempPath += ".tmp";
+        {
+            auto file = ofstream{tempPath, ios::binary};
+            if (!file.is_open()) {
+                WARNING("Cannot write shader cache file ", tempPath.string());
+                return;
+            }
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(data.data(), data.size());
+        }
+        filesystem::rename(tempPath, filepath, error);
+        if (error) {
+            WARNING("Cannot write shader cache file ", filepath.string());
+        }
+    }
+
+}
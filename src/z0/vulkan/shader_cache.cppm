@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2024-2025 Henri Michelon
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+*/
+module;
+#include "z0/vulkan.h"
+#include "z0/libraries.h"
+
+export module z0.vulkan.ShaderCache;
+
+export namespace z0 {
+
+    /*
+     * Shaders & pipelines cache of the device.
+     * The SPIR-V files are loaded once and shared by all the renderers. The shader objects are created from
+     * the driver binaries of the previous creations when possible, and the compute pipelines use a VkPipelineCache.
+     * The binaries and the pipeline cache are saved to disk files only used by the same device & driver.
+     */
+    class ShaderCache {
+    public:
+        /*
+         * Creates the cache and loads the cache files from the directory, if not empty
+         */
+        ShaderCache(VkDevice device, VkPhysicalDevice physicalDevice, const filesystem::path& directory);
+
+        ~ShaderCache();
+
+        /* Returns the SPIR-V code of a shader, loaded on the first call. Thread safe. */
+        [[nodiscard]] const vector<char>& getSpirv(const string& filename);
+
+        /*
+         * Creates a shader object, using the binary of a previous creation with the same code & layout if any.
+         * `layoutSignature` identifies the descriptor set layout given in the create info. Thread safe.
+         */
+        [[nodiscard]] VkShaderEXT createShader(const string&                filename,
+                                               const VkShaderCreateInfoEXT& createInfo,
+                                               uint64_t                     layoutSignature);
+
+        [[nodiscard]] inline auto getPipelineCache() const { return pipelineCache; }
+
+        /* Writes the new shader binaries and the pipeline cache to the cache files */
+        void save();
+
+    private:
+        // Identifies the cache files made for the same device & driver
+        struct CacheHeader {
+            uint32_t magic{MAGIC};
+            uint32_t version{VERSION};
+            uint32_t vendorID{0};
+            uint32_t deviceID{0};
+            uint32_t driverVersion{0};
+            uint32_t binaryVersion{0};
+            uint8_t  deviceUUID[VK_UUID_SIZE]{};
+            uint8_t  cacheUUID[VK_UUID_SIZE]{};
+            uint64_t count{0};
+        };
+        static constexpr uint32_t MAGIC{0x4353305a}; // "Z0SC"
+        static constexpr uint32_t VERSION{1};
+        static constexpr auto     SHADERS_FILE{"shaders.zsc"};
+        static constexpr auto     PIPELINES_FILE{"pipelines.zsc"};
+
+        const VkDevice                        device;
+        const filesystem::path                directory;
+        // Headers of the shader binaries & pipeline cache files for the device
+        CacheHeader                           shadersHeader;
+        CacheHeader                           pipelinesHeader;
+        VkPipelineCache                       pipelineCache{VK_NULL_HANDLE};
+        std::mutex                            cacheMutex;
+        unordered_map<string, vector<char>>   spirvCodes;
+        // Shader binaries by shader key
+        unordered_map<uint64_t, vector<char>> binaries;
+        // Shader binaries added since the cache files were loaded
+        bool                                  binariesModified{false};
+
+        [[nodiscard]] static uint64_t hash(const void* data, size_t size, uint64_t hash = 14695981039346656037ull);
+
+        // Reads a cache file, returns the content after the header if the header match
+        [[nodiscard]] bool readFile(const string& name, const CacheHeader& expected, CacheHeader& header, vector<char>& data) const;
+
+        // Writes a cache file through a temporary file
+        void writeFile(const string& name, const CacheHeader& header, const vector<char>& data) const;
+
+    public:
+        ShaderCache(const ShaderCache &) = delete;
+
+        ShaderCache &operator=(const ShaderCache &) = delete;
+    };
+
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2024-2025 Henri Michelon
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+*/
+module;
+#include <cassert>
+#include "z0/libraries.h"
+#include "z0/vulkan.h"
+
+module z0.vulkan.VertexRingBuffer;
+
+import z0.Tools;
+
+import z0.vulkan.Buffer;
+
+namespace z0 {
+
+    VertexRingBuffer::VertexRingBuffer(const VkDeviceSize vertexSize, const uint32_t framesInFlight):
+        vertexSize{vertexSize},
+        buffers(framesInFlight),
+        capacities(framesInFlight, 0) {
+    }
+
+    void VertexRingBuffer::reserve(const uint32_t currentFrame, const uint32_t count) {
+        if (count <= capacities[currentFrame]) { return; }
+        auto capacity = std::max(MIN_CAPACITY, capacities[currentFrame]);
+        while (capacity < count) { capacity *= 2; }
+        // The previous buffer is destroyed here if no command buffer keeps it alive
+        buffers[currentFrame] = make_shared<Buffer>(
+                vertexSize,
+                capacity,
+                VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+        if (buffers[currentFrame]->map() != VK_SUCCESS) { die("Error mapping vertex buffer to GPU memory"); }
+        capacities[currentFrame] = capacity;
+    }
+
+    void VertexRingBuffer::write(const uint32_t currentFrame,
+                                 const void *   vertices,
+                                 const uint32_t count,
+                                 const uint32_t firstVertex) const {
+        assert(firstVertex + count <= capacities[currentFrame]);
+        if (count == 0) { return; }
+        buffers[currentFrame]->writeToBuffer(vertices, vertexSize * count, vertexSize * firstVertex);
+    }
+
+}
@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2024-2025 Henri Michelon
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+*/
+module;
+#include "z0/vulkan.h"
+#include "z0/libraries.h"
+
+export module z0.vulkan.VertexRingBuffer;
+
+import z0.vulkan.Buffer;
+
+export namespace z0 {
+
+    /*
+     * Per-frame vertex buffers for the vertices regenerated by the CPU.
+     * Each frame in flight has its own persistently mapped buffer, written directly by the CPU when the frame
+     * is updated : no staging buffer, no transfer command and no queue wait.
+     * The buffer of a frame grows geometrically and is only recreated when the GPU has finished with the frame.
+     */
+    class VertexRingBuffer {
+    public:
+        VertexRingBuffer(VkDeviceSize vertexSize, uint32_t framesInFlight);
+
+        /* Makes room for vertices in the buffer of a frame. The GPU must have finished with the frame.
+         * The content of the buffer is lost if the buffer grows. */
+        void reserve(uint32_t currentFrame, uint32_t count);
+
+        /* Copies vertices in the buffer of a frame, starting at a vertex index. */
+        void write(uint32_t currentFrame, const void *vertices, uint32_t count, uint32_t firstVertex = 0) const;
+
+        /* Returns the buffer of a frame, the caller can keep it alive as long as a command buffer uses it. */
+        [[nodiscard]] inline const auto& getBuffer(const uint32_t currentFrame) const { return buffers.at(currentFrame); }
+
+    private:
+        // Minimum number of vertices of a buffer
+        static constexpr uint32_t MIN_CAPACITY{1024};
+
+        const VkDeviceSize         vertexSize;
+        vector<shared_ptr<Buffer>> buffers;
+        // Number of vertices of each buffer
+        vector<uint32_t>           capacities;
+
+    public:
+        VertexRingBuffer(const VertexRingBuffer &) = delete;
+
+        VertexRingBuffer &operator=(const VertexRingBuffer &) = delete;
+    };
+
+}
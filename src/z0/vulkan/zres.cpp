@@ -24,25 +24,42 @@ namespace z0 {
         const vector<ImageHeader>& imageHeaders,
         const vector<vector<MipLevelInfo>>&levelHeaders,
         const vector<TextureHeader>& textureHeaders,
+        const vector<ChunkInfo>& imageChunks,
         const uint64_t totalImageSize) {
 
         // Upload all images into VRAM using one big staging buffer
         const auto command = device.beginOneTimeCommandBuffer();
-        const auto& textureStagingBuffer = device.createOneTimeBuffer(
+        auto& textureStagingBuffer = device.createOneTimeBuffer(
             command,
             totalImageSize,
             1,
             VK_BUFFER_USAGE_TRANSFER_SRC_BIT
         );
-        static constexpr size_t BLOCK_SIZE = 64 * 1024;
-        auto transferBuffer = vector<char> (BLOCK_SIZE);
-        auto transferOffset = VkDeviceSize{0};
-        while (stream.read(transferBuffer.data(), BLOCK_SIZE) || stream.gcount() > 0) {
-            const auto bytesRead = stream.gcount();
-            textureStagingBuffer.writeToBuffer(transferBuffer.data(), bytesRead, transferOffset);
-            transferOffset += bytesRead;
+        if (imageChunks.empty()) {
+            static constexpr size_t BLOCK_SIZE = 64 * 1024;
+            auto transferBuffer = vector<char> (BLOCK_SIZE);
+            auto transferOffset = VkDeviceSize{0};
+            while (stream.read(transferBuffer.data(), BLOCK_SIZE) || stream.gcount() > 0) {
+                const auto bytesRead = stream.gcount();
+                textureStagingBuffer.writeToBuffer(transferBuffer.data(), bytesRead, transferOffset);
+                transferOffset += bytesRead;
+            }
+            //printf("%llu bytes read\n", transferOffset);
+        } else {
+            // Each image is decompressed by a worker thread while the next ones are read, then copied
+            // in the staging buffer. The decompression is not done in the staging buffer itself since
+            // the decompressors read back their output and the staging memory can be uncached.
+            if (textureStagingBuffer.map() != VK_SUCCESS) {
+                die("Failed to map the images staging buffer");
+            }
+            for (auto imageIndex = 0; imageIndex < header.imagesCount; ++imageIndex) {
+                const auto& image = imageHeaders[imageIndex];
+                readChunk(stream, imageChunks.at(imageIndex), [&textureStagingBuffer, image](const char* data) {
+                    textureStagingBuffer.writeToBuffer(data, image.dataSize, image.dataOffset);
+                });
+            }
+            waitChunks();
         }
-        //printf("%llu bytes read\n", transferOffset);
 
         // Create all images from this staging buffer
         vector<shared_ptr<VulkanImage>> vulkanImages;
@@ -49,8 +49,10 @@ export import z0.resources.Image;
 export import z0.resources.Material;
 export import z0.resources.Mesh;
 export import z0.resources.MeshShape;
+export import z0.resources.Prefab;
 export import z0.resources.Resource;
 export import z0.resources.Shape;
+export import z0.resources.Skeleton;
 export import z0.resources.StaticCompoundShape;
 export import z0.resources.SubShape;
 export import z0.resources.Texture;
@@ -61,6 +63,8 @@ export import z0.ui.Event;
 export import z0.ui.Frame;
 export import z0.ui.Image;
 export import z0.ui.Line;
+export import z0.ui.ListModel;
+export import z0.ui.ListView;
 export import z0.ui.Manager;
 export import z0.ui.Panel;
 export import z0.ui.Rect;
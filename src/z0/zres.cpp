@@ -5,6 +5,11 @@
  * https://opensource.org/licenses/MIT
 */
 module;
+#include <glm/gtx/matrix_decompose.hpp>
+#include <glm/gtx/quaternion.hpp>
+#include <lz4.h>
+#include <meshoptimizer.h>
+#include <zstd.h>
 #include "z0/libraries.h"
 #include "z0/vulkan.h"
 
@@ -23,6 +28,7 @@ import z0.resources.Image;
 import z0.resources.Material;
 import z0.resources.Mesh;
 import z0.resources.Resource;
+import z0.resources.Skeleton;
 import z0.resources.Texture;
 
 import z0.vulkan.Device;
@@ -52,7 +58,7 @@ namespace z0 {
             header.magic[3] != MAGIC[3]) {
             die("ZScene bad magic");
         }
-        if (header.version != VERSION) {
+        if (header.version < VERSION_MIN || header.version > VERSION) {
             die("ZScene bad version");
         }
         // print(header);
@@ -84,16 +90,24 @@ namespace z0 {
         auto meshesHeaders = vector<MeshHeader>(header.meshesCount);
         auto surfaceInfo = vector<vector<SurfaceInfo>> {header.meshesCount};
         auto uvsInfos = vector<vector<vector<DataInfo>>> {header.meshesCount};
+        auto lodsInfos = vector<vector<vector<DataInfo>>> {header.meshesCount};
         for (auto meshIndex = 0; meshIndex < header.meshesCount; ++meshIndex) {
             stream.read(reinterpret_cast<istream::char_type *>(&meshesHeaders[meshIndex]), sizeof(MeshHeader));
             // print(meshesHeaders[meshIndex]);
             surfaceInfo[meshIndex].resize(meshesHeaders[meshIndex].surfacesCount);
             uvsInfos[meshIndex].resize(meshesHeaders[meshIndex].surfacesCount);
+            lodsInfos[meshIndex].resize(meshesHeaders[meshIndex].surfacesCount);
             for (auto surfaceIndex = 0; surfaceIndex < meshesHeaders[meshIndex].surfacesCount; ++surfaceIndex) {
                 stream.read(reinterpret_cast<istream::char_type *>(&surfaceInfo[meshIndex][surfaceIndex]), sizeof(SurfaceInfo));
                 // print(surfaceInfo[meshIndex][surfaceIndex]);
                 uvsInfos[meshIndex][surfaceIndex].resize(surfaceInfo[meshIndex][surfaceIndex].uvsCount);
                 stream.read(reinterpret_cast<istream::char_type *>(uvsInfos[meshIndex][surfaceIndex].data()), sizeof(DataInfo) * uvsInfos[meshIndex][surfaceIndex].size());
+                if (header.version > 2) {
+                    uint32_t lodsCount;
+                    stream.read(reinterpret_cast<istream::char_type *>(&lodsCount), sizeof(uint32_t));
+                    lodsInfos[meshIndex][surfaceIndex].resize(lodsCount);
+                    stream.read(reinterpret_cast<istream::char_type *>(lodsInfos[meshIndex][surfaceIndex].data()), sizeof(DataInfo) * lodsCount);
+                }
             }
         }
 
@@ -112,37 +126,79 @@ namespace z0 {
         for (auto animationIndex = 0; animationIndex < header.animationsCount; ++animationIndex) {
             stream.read(reinterpret_cast<istream::char_type *>(&animationHeaders.at(animationIndex)), sizeof(AnimationHeader));
             tracksInfos[animationIndex].resize(animationHeaders[animationIndex].tracksCount);
-            stream.read(reinterpret_cast<istream::char_type *>(tracksInfos[animationIndex].data()), sizeof(TrackInfo) * tracksInfos[animationIndex].size());
+            if (header.version > 4) {
+                stream.read(reinterpret_cast<istream::char_type *>(tracksInfos[animationIndex].data()), sizeof(TrackInfo) * tracksInfos[animationIndex].size());
+            } else {
+                // TrackInfo::encoding was added in version 5
+                for (auto& trackInfo : tracksInfos[animationIndex]) {
+                    stream.read(reinterpret_cast<istream::char_type *>(&trackInfo), offsetof(TrackInfo, encoding));
+                }
+            }
             // log("Animation ", animationHeaders[animationIndex].name, " ", to_string(animationHeaders[animationIndex].tracksCount), "tracks");
         }
 
-        // Skip padding
-        // auto pad = vector<uint8_t>(vector<uint8_t>::size_type(32), 0);
-        // if (header.headersPadding > 0) {
-            // stream.read(reinterpret_cast<istream::char_type *>(pad.data()), header.headersPadding);
-        // }
-
-        // Read the meshes data
-        uint32_t count;
-        stream.read(reinterpret_cast<istream::char_type *>(&count), sizeof(uint32_t));
-        vector<uint32_t> indices(count);
-        stream.read(reinterpret_cast<istream::char_type *>(indices.data()), count * sizeof(uint32_t));
-
-        stream.read(reinterpret_cast<istream::char_type *>(&count), sizeof(uint32_t));
-        vector<vec3> positions{count};
-        stream.read(reinterpret_cast<istream::char_type *>(positions.data()), count * sizeof(vec3));
-
-        stream.read(reinterpret_cast<istream::char_type *>(&count), sizeof(uint32_t));
-        vector<vec3> normals{count};
-        stream.read(reinterpret_cast<istream::char_type *>(normals.data()), count * sizeof(vec3));
+        // Read the skeletons headers
+        auto skinHeaders = vector<SkinHeader>{};
+        auto jointsInfos = vector<vector<JointInfo>>{};
+        if (header.version > 3) {
+            uint32_t skinsCount;
+            stream.read(reinterpret_cast<istream::char_type *>(&skinsCount), sizeof(uint32_t));
+            skinHeaders.resize(skinsCount);
+            jointsInfos.resize(skinsCount);
+            for (auto skinIndex = 0; skinIndex < skinsCount; ++skinIndex) {
+                stream.read(reinterpret_cast<istream::char_type *>(&skinHeaders[skinIndex]), sizeof(SkinHeader));
+                jointsInfos[skinIndex].resize(skinHeaders[skinIndex].jointsCount);
+                stream.read(reinterpret_cast<istream::char_type *>(jointsInfos[skinIndex].data()), sizeof(JointInfo) * jointsInfos[skinIndex].size());
+            }
+        }
 
-        stream.read(reinterpret_cast<istream::char_type *>(&count), sizeof(uint32_t));
-        vector<vec2> uvs{count};
-        stream.read(reinterpret_cast<istream::char_type *>(uvs.data()), count * sizeof(vec2));
+        // Read the chunks table
+        auto chunks = vector<ChunkInfo>{};
+        if (header.version > 1) {
+            uint32_t chunksCount;
+            stream.read(reinterpret_cast<istream::char_type *>(&chunksCount), sizeof(uint32_t));
+            chunks.resize(chunksCount);
+            stream.read(reinterpret_cast<istream::char_type *>(chunks.data()), chunksCount * sizeof(ChunkInfo));
+            chunksData = stream.tellg();
+        }
+        auto getChunk = [&](const ChunkType type) -> const ChunkInfo& {
+            const auto it = ranges::find_if(chunks, [type](const ChunkInfo& chunk) {
+                return chunk.type == static_cast<uint32_t>(type);
+            });
+            if (it == chunks.end()) { die("ZScene missing chunk"); }
+            return *it;
+        };
 
-        stream.read(reinterpret_cast<istream::char_type *>(&count), sizeof(uint32_t));
-        vector<vec4> tangents{count};
-        stream.read(reinterpret_cast<istream::char_type *>(tangents.data()), count * sizeof(vec4));
+        // Read the meshes data
+        vector<uint32_t> indices;
+        vector<vec3> positions;
+        vector<vec3> normals;
+        vector<vec2> uvs;
+        vector<vec4> tangents;
+        auto readData = [&]<typename T>(vector<T>& data, const ChunkType type) {
+            if (header.version == 1) {
+                uint32_t count;
+                stream.read(reinterpret_cast<istream::char_type *>(&count), sizeof(uint32_t));
+                data.resize(count);
+                stream.read(reinterpret_cast<istream::char_type *>(data.data()), count * sizeof(T));
+            } else {
+                // decoded in a worker thread while the next chunks are read
+                const auto& chunk = getChunk(type);
+                data.resize(chunk.size / sizeof(T));
+                readChunk(stream, chunk, data.data());
+            }
+        };
+        readData(indices, ChunkType::INDICES);
+        readData(positions, ChunkType::POSITIONS);
+        readData(normals, ChunkType::NORMALS);
+        readData(uvs, ChunkType::UVS);
+        readData(tangents, ChunkType::TANGENTS);
+        vector<u16vec4> joints;
+        vector<vec4> weights;
+        if (!skinHeaders.empty()) {
+            readData(joints, ChunkType::JOINTS);
+            readData(weights, ChunkType::WEIGHTS);
+        }
 
         // log(format("{} indices, {} positions, {} normals, {} uvs, {} tangents",
             // indices.size(), positions.size(), normals.size(), uvs.size(), tangents.size()));
@@ -151,38 +207,111 @@ namespace z0 {
         // }
 
         // Read the animations data
-        auto animationPlayers = map<uint32_t, shared_ptr<AnimationPlayer>>{};
+        auto animationsData = vector<char>{};
+        auto animationsDataOffset = size_t{0};
+        if (header.version > 1) {
+            const auto& chunk = getChunk(ChunkType::ANIMATIONS);
+            animationsData.resize(chunk.size);
+            readChunk(stream, chunk, animationsData.data(), false);
+        }
+        auto readAnimationData = [&](void* data, const size_t size) {
+            if (header.version == 1) {
+                stream.read(reinterpret_cast<istream::char_type *>(data), size);
+            } else {
+                memcpy(data, animationsData.data() + animationsDataOffset, size);
+                animationsDataOffset += size;
+            }
+        };
+        // The tracks of the joints nodes are joint tracks, in one animation per skinned node, for each skeleton using the joint
+        auto skinnedJoints = map<int32_t, vector<pair<int32_t, int32_t>>>{};
+        for (auto skinIndex = 0; skinIndex < skinHeaders.size(); ++skinIndex) {
+            for (auto jointIndex = 0; jointIndex < jointsInfos[skinIndex].size(); ++jointIndex) {
+                skinnedJoints[jointsInfos[skinIndex][jointIndex].nodeIndex].push_back({skinHeaders[skinIndex].nodeIndex, jointIndex});
+            }
+        }
+        auto animationPlayers = map<int32_t, shared_ptr<AnimationPlayer>>{};
+        auto addAnimation = [&](const int32_t nodeIndex, const shared_ptr<Animation>& anim) {
+            if (!animationPlayers.contains(nodeIndex)) {
+                auto animationPlayer = make_shared<AnimationPlayer>(); // node association is made later
+                animationPlayer->add("", make_shared<AnimationLibrary>());
+                animationPlayers[nodeIndex] = animationPlayer;
+            }
+            const auto& animationPlayer = animationPlayers[nodeIndex];
+            animationPlayer->getLibrary()->add(anim->getName(), anim);
+            animationPlayer->setCurrentAnimation(anim->getName());
+        };
         for (auto animationIndex = 0; animationIndex < header.animationsCount; animationIndex++) {
-            auto anim = make_shared<Animation>(static_cast<uint32_t>(animationHeaders[animationIndex].tracksCount), animationHeaders[animationIndex].name);
+            const auto& name = animationHeaders[animationIndex].name;
+            const auto nodeTracksCount = ranges::count_if(tracksInfos[animationIndex], [&](const TrackInfo& trackInfo) {
+                return !skinnedJoints.contains(trackInfo.nodeIndex);
+            });
+            auto anim = make_shared<Animation>(static_cast<uint32_t>(nodeTracksCount), name);
+            auto nodeTrackIndex = 0;
+            auto jointTracks = map<int32_t, vector<Animation::Track>>{};
             for (auto trackIndex = 0; trackIndex < animationHeaders[animationIndex].tracksCount; trackIndex++) {
-                auto animationPlayer = shared_ptr<AnimationPlayer>{};
                 auto& trackInfo = tracksInfos[animationIndex][trackIndex];
                 auto nodeIndex = trackInfo.nodeIndex;
-                if (animationPlayers.contains(nodeIndex)) {
-                    animationPlayer = animationPlayers[nodeIndex];
-                } else {
-                    animationPlayer = make_shared<AnimationPlayer>(); // node association is made later
-                    animationPlayer->add("", make_shared<AnimationLibrary>());
-                    animationPlayers[nodeIndex] = animationPlayer;
-                }
-                animationPlayer->getLibrary()->add(anim->getName(), anim);
-                animationPlayer->setCurrentAnimation(anim->getName());
-                auto& track = anim->getTrack(trackIndex);
-                track.type = static_cast<AnimationType>(trackInfo.type);
-                track.interpolation = static_cast<AnimationInterpolation>(trackInfo.interpolation);
+                auto track = Animation::Track{
+                    .type = static_cast<AnimationType>(trackInfo.type),
+                    .interpolation = static_cast<AnimationInterpolation>(trackInfo.interpolation),
+                };
                 track.keyTime.resize(trackInfo.keysCount);
-                stream.read(reinterpret_cast<istream::char_type *>(track.keyTime.data()), trackInfo.keysCount * sizeof(float));
+                readAnimationData(track.keyTime.data(), trackInfo.keysCount * sizeof(float));
                 track.duration = track.keyTime.back() + track.keyTime.front();
-                track.keyValue.resize(trackInfo.keysCount);
-                stream.read(reinterpret_cast<istream::char_type *>(track.keyValue.data()), trackInfo.keysCount * sizeof(vec3));
+                const auto joint = skinnedJoints.contains(nodeIndex);
+                if (track.type != AnimationType::ROTATION) {
+                    track.keyValue.resize(trackInfo.keysCount);
+                    readAnimationData(track.keyValue.data(), trackInfo.keysCount * sizeof(vec3));
+                } else if (trackInfo.encoding == static_cast<uint32_t>(TrackEncoding::QUANTIZED)) {
+                    track.keyQuantizedRotation.resize(trackInfo.keysCount);
+                    readAnimationData(track.keyQuantizedRotation.data(), trackInfo.keysCount * sizeof(Animation::QuantizedRotation));
+                } else if (header.version < 5 && !joint) {
+                    // Before version 5 the nodes rotations are Euler angles relative to the node rotation
+                    auto eulers = vector<vec3>(trackInfo.keysCount);
+                    readAnimationData(eulers.data(), trackInfo.keysCount * sizeof(vec3));
+                    vec3 scale, translation, skew;
+                    vec4 perspective;
+                    quat rest;
+                    decompose(nodeHeaders.at(nodeIndex).transform, scale, rest, translation, skew, perspective);
+                    const auto inverseRest = inverse(rest);
+                    track.keyRotation.resize(trackInfo.keysCount);
+                    for (auto i = 0; i < trackInfo.keysCount; i++) {
+                        track.keyRotation[i] = inverseRest * quat(eulerAngles(rest) + eulers[i]);
+                    }
+                } else {
+                    track.keyRotation.resize(trackInfo.keysCount);
+                    readAnimationData(track.keyRotation.data(), trackInfo.keysCount * sizeof(quat));
+                }
+                if (joint) {
+                    for (const auto& [skinnedNode, jointIndex] : skinnedJoints[nodeIndex]) {
+                        track.joint = jointIndex;
+                        jointTracks[skinnedNode].push_back(track);
+                    }
+                } else {
+                    anim->getTrack(nodeTrackIndex++) = std::move(track);
+                    addAnimation(nodeIndex, anim);
+                }
+            }
+            for (auto& [skinnedNode, tracks] : jointTracks) {
+                auto skinAnim = make_shared<Animation>(static_cast<uint32_t>(tracks.size()), name);
+                for (auto trackIndex = 0; trackIndex < tracks.size(); trackIndex++) {
+                    skinAnim->getTrack(trackIndex) = std::move(tracks[trackIndex]);
+                }
+                addAnimation(skinnedNode, skinAnim);
             }
         }
 
         // Read, upload and create the Image and Texture objets (Vulkan specific)
         auto& device = Device::get();
         if (header.imagesCount > 0) {
-            loadImagesAndTextures(device, stream, imageHeaders, levelHeaders, textureHeaders, totalImageSize);
+            auto imageChunks = vector<ChunkInfo>{};
+            ranges::copy_if(chunks, back_inserter(imageChunks), [](const ChunkInfo& chunk) {
+                return chunk.type == static_cast<uint32_t>(ChunkType::IMAGE);
+            });
+            loadImagesAndTextures(device, stream, imageHeaders, levelHeaders, textureHeaders, imageChunks, totalImageSize);
         }
+        // The meshes data must be decoded before creating the meshes
+        waitChunks();
 
         // Create the Material objects
         vector<shared_ptr<Material>> materials{static_cast<vector<shared_ptr<Material>>::size_type>(header.materialsCount)};
@@ -215,6 +344,24 @@ namespace z0 {
             materials.at(materialIndex) = material;
         }
 
+        // Create the Skeleton objects, attached to the meshes of the skinned nodes
+        auto skeletons = map<int32_t, shared_ptr<Skeleton>>{};
+        for (auto skinIndex = 0; skinIndex < skinHeaders.size(); ++skinIndex) {
+            const auto meshIndex = nodeHeaders.at(skinHeaders[skinIndex].nodeIndex).meshIndex;
+            if (meshIndex == -1 || skeletons.contains(meshIndex)) { continue; }
+            auto skeletonJoints = vector<Skeleton::Joint>(jointsInfos[skinIndex].size());
+            for (auto jointIndex = 0; jointIndex < skeletonJoints.size(); ++jointIndex) {
+                const auto& info = jointsInfos[skinIndex][jointIndex];
+                skeletonJoints[jointIndex] = {
+                    .name = info.name,
+                    .parent = info.parent,
+                    .inverseBindMatrix = info.inverseBindMatrix,
+                    .rest = { .position = info.position, .rotation = info.rotation, .scale = info.scale },
+                };
+            }
+            skeletons[meshIndex] = make_shared<Skeleton>(skeletonJoints, skinHeaders[skinIndex].transform);
+        }
+
         // Create the Mesh, Surface & Vertex objects
         vector<shared_ptr<Mesh>> meshes{static_cast<vector<shared_ptr<Mesh>>::size_type>(header.meshesCount)};
         for (auto meshIndex = 0; meshIndex < header.meshesCount; ++meshIndex) {
@@ -253,6 +400,17 @@ namespace z0 {
                     meshVertices[firstVertex + i].tangent = tangents[info.tangents.first + i];
                     // log(format("mesh {} surface {} tangents  {}", meshIndex, surfaceIndex, to_string(tangents[info.tangents.first + i])));
                 }
+                // Load skinning joints & weights, parallel to the positions
+                if (skeletons.contains(meshIndex)) {
+                    auto &skinVertices = mesh->getSkinVertices();
+                    skinVertices.resize(meshVertices.size());
+                    for(auto i = 0; i < info.positions.count; ++i) {
+                        skinVertices[firstVertex + i] = {
+                            .joints = uvec4{joints[info.positions.first + i]},
+                            .weights = weights[info.positions.first + i],
+                        };
+                    }
+                }
                 if (info.materialIndex != -1) {
                     // associate material to surface & mesh
                     const auto& material = materials[info.materialIndex];
@@ -298,6 +456,19 @@ namespace z0 {
                 }
                 mesh->getSurfaces().push_back(surface);
             }
+            // Load the precomputed levels of detail after all the surfaces
+            for (auto surfaceIndex = 0; surfaceIndex < header.surfacesCount; ++surfaceIndex) {
+                const auto& surface = mesh->getSurfaces()[surfaceIndex];
+                for (const auto& lodInfo : lodsInfos.at(meshIndex)[surfaceIndex]) {
+                    surface->lods.push_back({static_cast<uint32_t>(meshIndices.size()), lodInfo.count});
+                    meshIndices.insert(meshIndices.end(),
+                                       indices.begin() + lodInfo.first,
+                                       indices.begin() + lodInfo.first + lodInfo.count);
+                }
+            }
+            if (skeletons.contains(meshIndex)) {
+                mesh->setSkeleton(skeletons[meshIndex]);
+            }
             mesh->buildModel();
             meshes[meshIndex] = mesh;
         }
@@ -320,15 +491,9 @@ namespace z0 {
             nodes[nodeIndex] = newNode;
         }
 
-        for (auto animationIndex = 0; animationIndex < header.animationsCount; animationIndex++) {
-            for (auto trackIndex = 0; trackIndex < animationHeaders[animationIndex].tracksCount; trackIndex++) {
-                auto nodeIndex = tracksInfos[animationIndex][trackIndex].nodeIndex;
-                auto& player = animationPlayers[nodeIndex];
-                if (!player->getParent()) {
-                    auto& node = nodes[nodeIndex];
-                    // player->setNode(node);
-                    node->addChild(player);
-                }
+        for (const auto& [nodeIndex, player] : animationPlayers) {
+            if (nodeIndex != -1) {
+                nodes[nodeIndex]->addChild(player);
             }
         }
 
@@ -348,6 +513,115 @@ namespace z0 {
         }
     }
 
+    void ZRes::seekChunk(ifstream& stream, const ChunkInfo& chunk) const {
+        const auto position = chunksData + static_cast<streamoff>(chunk.offset);
+        if (stream.tellg() != position) {
+            stream.seekg(position);
+        }
+    }
+
+    void ZRes::readChunk(ifstream& stream, const ChunkInfo& chunk, void* destination, const bool async) {
+        seekChunk(stream, chunk);
+        if (chunk.encoding == static_cast<uint32_t>(ChunkEncoding::NONE) &&
+            chunk.compression == static_cast<uint32_t>(ChunkCompression::NONE)) {
+            // Raw chunks are read in place
+            stream.read(static_cast<istream::char_type *>(destination), chunk.size);
+            return;
+        }
+        auto source = make_shared<vector<char>>(chunk.storedSize);
+        stream.read(source->data(), chunk.storedSize);
+        if (async) {
+            decodeAsync([chunk, source, destination] {
+                decodeChunk(chunk, source->data(), static_cast<char*>(destination));
+            });
+        } else {
+            decodeChunk(chunk, source->data(), static_cast<char*>(destination));
+        }
+    }
+
+    void ZRes::readChunk(ifstream& stream, const ChunkInfo& chunk, const function<void(const char*)>& consumer) {
+        seekChunk(stream, chunk);
+        auto source = make_shared<vector<char>>(chunk.storedSize);
+        stream.read(source->data(), chunk.storedSize);
+        if (chunk.encoding == static_cast<uint32_t>(ChunkEncoding::NONE) &&
+            chunk.compression == static_cast<uint32_t>(ChunkCompression::NONE)) {
+            consumer(source->data());
+            return;
+        }
+        decodeAsync([chunk, source, consumer] {
+            auto data = vector<char>(chunk.size);
+            decodeChunk(chunk, source->data(), data.data());
+            consumer(data.data());
+        });
+    }
+
+    void ZRes::decodeAsync(function<void()>&& decode) {
+        // Limit the number of chunks decoded in parallel (and the memory used by the read chunks)
+        const auto maxDecodingChunks = std::max(1u, thread::hardware_concurrency());
+        while (decodingChunks.size() >= maxDecodingChunks) {
+            decodingChunks.front().get();
+            decodingChunks.pop_front();
+        }
+        decodingChunks.push_back(async(launch::async, std::move(decode)));
+    }
+
+    void ZRes::waitChunks() {
+        while (!decodingChunks.empty()) {
+            decodingChunks.front().get();
+            decodingChunks.pop_front();
+        }
+    }
+
+    void ZRes::decodeChunk(const ChunkInfo& chunk, const char* source, char* destination) {
+        const auto encoding = static_cast<ChunkEncoding>(chunk.encoding);
+        const auto compression = static_cast<ChunkCompression>(chunk.compression);
+        auto encodedData = source;
+        auto decompressed = vector<char>{};
+        if (compression != ChunkCompression::NONE) {
+            // Decompress directly in the destination when the data is not encoded
+            auto target = destination;
+            if (encoding != ChunkEncoding::NONE) {
+                decompressed.resize(chunk.encodedSize);
+                target = decompressed.data();
+            }
+            auto size = size_t{0};
+            if (compression == ChunkCompression::ZSTD) {
+                size = ZSTD_decompress(target, chunk.encodedSize, source, chunk.storedSize);
+                if (ZSTD_isError(size)) { die("ZScene chunk decompression error", ZSTD_getErrorName(size)); }
+            } else if (compression == ChunkCompression::LZ4) {
+                const auto result = LZ4_decompress_safe(source, target,
+                                                        static_cast<int>(chunk.storedSize),
+                                                        static_cast<int>(chunk.encodedSize));
+                if (result < 0) { die("ZScene chunk decompression error"); }
+                size = result;
+            } else {
+                die("ZScene unknown chunk compression");
+            }
+            if (size != chunk.encodedSize) { die("ZScene corrupted chunk"); }
+            encodedData = target;
+        }
+        const auto encodedBuffer = reinterpret_cast<const unsigned char*>(encodedData);
+        const auto count = chunk.elementSize == 0 ? 0 : chunk.size / chunk.elementSize;
+        auto result = 0;
+        switch (encoding) {
+        case ChunkEncoding::NONE:
+            if (encodedData != destination) { memcpy(destination, encodedData, chunk.size); }
+            break;
+        case ChunkEncoding::MESHOPT_VERTEX:
+            result = meshopt_decodeVertexBuffer(destination, count, chunk.elementSize, encodedBuffer, chunk.encodedSize);
+            break;
+        case ChunkEncoding::MESHOPT_INDEX_BUFFER:
+            result = meshopt_decodeIndexBuffer(destination, count, chunk.elementSize, encodedBuffer, chunk.encodedSize);
+            break;
+        case ChunkEncoding::MESHOPT_INDEX_SEQUENCE:
+            result = meshopt_decodeIndexSequence(destination, count, chunk.elementSize, encodedBuffer, chunk.encodedSize);
+            break;
+        default:
+            die("ZScene unknown chunk encoding");
+        }
+        if (result != 0) { die("ZScene chunk decoding error"); }
+    }
+
     void ZRes::print(const Header& header) {
         printf("Version : %d\nImages count : %d\nTextures count : %d\nMaterials count : %d\nMeshes count : %d\nNodes count : %d\nAnimations count : %d\nHeaders size : %llu\n",
             header.version,
@@ -394,6 +668,16 @@ namespace z0 {
         printf("First : %d\nCount : %d\n", header.first, header.count);
     }
 
+    void ZRes::print(const ChunkInfo& header) {
+        printf("Type : %d\nEncoding : %d\nCompression : %d\nOffset : %llu\nStored size : %llu\nSize : %llu\n",
+            header.type,
+            header.encoding,
+            header.compression,
+            header.offset,
+            header.storedSize,
+            header.size);
+    }
+
     void ZRes::print(const SurfaceInfo& header) {
         printf("materialIndex : %d\nindices : %d,%d\npositions : %d,%d\nnormals : %d,%d\ntangents : %d,%d\nuvsCount : %d\n",
             header.materialIndex,
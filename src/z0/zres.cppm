@@ -42,6 +42,32 @@ export namespace z0 {
      * array<MeshHeader + array<SurfaceInfo, surfacesCount> + array<DataInfo, surfacesCount * uvsCount>, meshesCount> : meshes headers
      * array<NodeHeader + array<uint32_t, childrenCount>, nodesCount> : nodes headers
      * array<AnimationHeader + array<TrackInfo, tracksCount>, animationCount> : animation headers
+     * ```
+     * Version 5 files stores the rotations of the nodes tracks as quaternions relative to the node rotation instead
+     * of Euler angles, and the TrackInfo encoding : the keys of the compressed tracks are reduced and their rotations
+     * are stored as Animation::QuantizedRotation.<br>
+     * Version 4 files stores, after the animation headers, the skeletons of the skinned meshes. The JOINTS & WEIGHTS
+     * chunks, parallel to the positions, are stored after the TANGENTS chunk when the file have skeletons.
+     * The tracks of the animations with a joint node as nodeIndex stores absolute values, and quaternions for the rotations :
+     * ```
+     * uint32_t : skinsCount
+     * array<SkinHeader + array<JointInfo, jointsCount>, skinsCount> : skeletons headers
+     * ```
+     * Version 3 files stores, after the UV coordinates DataInfo array of each surface, the simplified levels of detail
+     * of the surface, from the finest to the coarsest, as ranges of the indices data bloc :
+     * ```
+     * uint32_t : lodsCount
+     * array<DataInfo, lodsCount> : levels of detail indices
+     * ```
+     * Version 2 files stores the data blocs in chunks, optionally encoded with the meshoptimizer codecs
+     * and compressed with Zstandard or LZ4. The chunks are decoded in parallel while the next ones are read :
+     * ```
+     * uint32_t : chunksCount
+     * array<ChunkInfo, chunksCount> : chunks table
+     * array<chunk, chunksCount> : chunks data, in the ChunkType order with one IMAGE chunk per image
+     * ```
+     * Version 1 files, still readable, stores the data blocs without chunks :
+     * ```
      * uint32_t : indicesCount
      * array<uint32_t, indicesCount> : indices data bloc
      * uint32_t : positionsCount
@@ -71,7 +97,76 @@ export namespace z0 {
         /*
          * Current format version
          */
-        static constexpr uint32_t VERSION{1};
+        static constexpr uint32_t VERSION{5};
+
+        /*
+         * Oldest format version still readable
+         */
+        static constexpr uint32_t VERSION_MIN{1};
+
+        /*
+         * Data bloc stored in a chunk
+         */
+        enum class ChunkType : uint32_t {
+            INDICES    = 0,
+            POSITIONS  = 1,
+            NORMALS    = 2,
+            UVS        = 3,
+            TANGENTS   = 4,
+            //! Keys times & values of all the tracks
+            ANIMATIONS = 5,
+            //! All the mip levels of one image
+            IMAGE      = 6,
+            //! Skinning joints indices, u16vec4 parallel to the positions
+            JOINTS     = 7,
+            //! Skinning weights, vec4 parallel to the positions
+            WEIGHTS    = 8,
+        };
+
+        /*
+         * Encoding of the data of a chunk, applied before the compression
+         */
+        enum class ChunkEncoding : uint32_t {
+            //! Raw data
+            NONE                   = 0,
+            //! meshoptimizer vertex buffer codec
+            MESHOPT_VERTEX         = 1,
+            //! meshoptimizer triangles list index buffer codec
+            MESHOPT_INDEX_BUFFER   = 2,
+            //! meshoptimizer index sequence codec
+            MESHOPT_INDEX_SEQUENCE = 3,
+        };
+
+        /*
+         * Compression of a chunk
+         */
+        enum class ChunkCompression : uint32_t {
+            NONE = 0,
+            ZSTD = 1,
+            LZ4  = 2,
+        };
+
+        /*
+         * Description of a chunk
+         */
+        struct ChunkInfo {
+            //! ChunkType
+            uint32_t type;
+            //! ChunkEncoding
+            uint32_t encoding;
+            //! ChunkCompression
+            uint32_t compression;
+            //! Size in bytes of one element (vertex attribute or index) for the meshoptimizer codecs
+            uint32_t elementSize;
+            //! Start of the chunk, relative to the start of the chunks data bloc
+            uint64_t offset;
+            //! Size in bytes of the chunk in the file
+            uint64_t storedSize;
+            //! Size in bytes of the encoded data, after decompression
+            uint64_t encodedSize;
+            //! Size in bytes of the decoded data
+            uint64_t size;
+        };
 
         /*
          * Global file header
@@ -247,13 +342,55 @@ export namespace z0 {
             uint32_t tracksCount;
         };
 
+        /*
+         * Encoding of the keys of a track
+         */
+        enum class TrackEncoding : uint32_t {
+            //! vec3 translations & scales, quat rotations
+            NONE      = 0,
+            //! vec3 translations & scales, Animation::QuantizedRotation rotations
+            QUANTIZED = 1,
+        };
+
         struct TrackInfo {
             int32_t  nodeIndex{-1};
             uint32_t type;
             uint32_t interpolation;
             uint32_t keysCount;
+            //! TrackEncoding, since version 5
+            uint32_t encoding{0};
             // + keyCount * float keyTime
-            // + keyCount * variant<vec3, quat> keyValue
+            // + keyCount * variant<vec3, quat, Animation::QuantizedRotation> keyValue
+        };
+
+        /*
+         * Description of the skeleton of a skinned mesh
+         */
+        struct SkinHeader {
+            //! Skinned node, with a mesh
+            int32_t  nodeIndex;
+            //! Number of JointInfo elements in the array following this struct
+            uint32_t jointsCount;
+            //! Transform of the parent of the root joints, in the mesh space
+            mat4     transform;
+        };
+
+        /*
+         * Description of a joint of a skeleton
+         */
+        struct JointInfo {
+            //! Name
+            char     name[NAME_SIZE];
+            //! Node of the joint
+            int32_t  nodeIndex;
+            //! Parent joint, -1 for the root joints
+            int32_t  parent;
+            //! Inverse bind matrix
+            mat4     inverseBindMatrix;
+            //! Rest pose
+            vec3     position;
+            quat     rotation;
+            vec3     scale;
         };
 
         /*
@@ -276,20 +413,51 @@ export namespace z0 {
         static void print(const MeshHeader& header);
         static void print(const SurfaceInfo& header);
         static void print(const DataInfo& header);
+        static void print(const ChunkInfo& header);
+
+        /*
+         * Decodes a chunk read from a file
+         * @param chunk chunk description
+         * @param source chunk data, ChunkInfo::storedSize bytes
+         * @param destination decoded data, ChunkInfo::size bytes
+         */
+        static void decodeChunk(const ChunkInfo& chunk, const char* source, char* destination);
 
     protected:
         Header header{};
         vector<shared_ptr<Texture>>  textures{};
+        // Chunks being decoded while the next ones are read
+        list<future<void>> decodingChunks;
+        // Start of the chunks data bloc in the file, the chunks offsets are relative to it
+        streampos          chunksData{0};
 
         void loadScene(const shared_ptr<Node>& rootNode, ifstream& stream);
 
+        // imageChunks is empty for version 1 files
         void loadImagesAndTextures(
             const Device& device,
             ifstream& stream,
             const vector<ImageHeader>&,
             const vector<vector<MipLevelInfo>>&,
             const vector<TextureHeader>&,
+            const vector<ChunkInfo>& imageChunks,
             uint64_t totalImageSize);
+
+        // Reads a chunk at its offset and decodes it in a worker thread, in cached CPU memory
+        void readChunk(ifstream& stream, const ChunkInfo& chunk, void* destination, bool async = true);
+
+        // Reads a chunk at its offset, decodes it in a worker thread and gives the decoded data to the consumer,
+        // in the worker thread
+        void readChunk(ifstream& stream, const ChunkInfo& chunk, const function<void(const char*)>& consumer);
+
+        // Waits for all the chunks to be decoded
+        void waitChunks();
+
+    private:
+        void decodeAsync(function<void()>&& decode);
+
+        // Moves the stream to the start of a chunk, the chunks are usually read in the file order
+        void seekChunk(ifstream& stream, const ChunkInfo& chunk) const;
     };
 
 }